@@ -6,7 +6,30 @@
 //#################################################################################################
 
 #include "bic2200.h"
+#if BIC2200_ENABLE_FLOAT
+#include <math.h>
+#endif
 
+// Registers with a Cache and Stats Entry, Index = Slot
+static const int _slotRegisters[BIC2200_REGISTER_SLOTS] = {
+    CMD_OPERATION,
+    CMD_VOUT_SET,
+    CMD_IOUT_SET,
+    CMD_FAULT_STATUS,
+    CMD_READ_VIN,
+    CMD_READ_VOUT,
+    CMD_READ_IOUT,
+    CMD_READ_TEMPERATURE_1,
+    CMD_SCALING_FACTOR,
+    CMD_SYSTEM_STATUS,
+    CMD_SYSTEM_CONFIG,
+    CMD_DIRECTION_CTRL,
+    CMD_REVERSE_VOUT_SET,
+    CMD_REVERSE_IOUT_SET,
+    CMD_BIDIRECTIONAL_CONFIG
+};
+
+#ifdef ARDUINO
 int BIC2200::begin(int CS_Pin, byte CAN_Adress) {
 //#################################################################################################
 //  Function:       begin
@@ -14,32 +37,98 @@ int BIC2200::begin(int CS_Pin, byte CAN_Adress) {
 //  Input:          CS_Pin (int) Chip Select Pin 
 //                  CAN_Adress (byte) [0x00 - 0x07] CAN Bus Adress of BIC-2200
 //  Output:         (int) 0 = CAN Initialisiation unsuccessfull; 1 = CAN Initialisiation successfull
-//  Description:    Initialises the CAN Object and Calculates the CAN IDs
+//  Description:    Attaches the Device to the Default Bus. The CAN Controller is only 
+//                  initialised by the first Device, all further Devices share it. Units on
+//                  further MCP2515 need their own BIC2200Bus, see BIC2200MCP2515Transport
+//#################################################################################################
+    if (!BIC2200DefaultBus.isStarted() && !BIC2200DefaultBus.begin(CS_Pin)) {
+        return 0;
+    }
+    return begin(BIC2200DefaultBus, CAN_Adress);
+}
+#endif
+
+int BIC2200::begin(BIC2200Bus & bus, byte CAN_Adress) {
+//#################################################################################################
+//  Function:       begin
+//  Access:         Public
+//  Input:          bus (BIC2200Bus &) initialised Bus the Device is connected to
+//                  CAN_Adress (byte) [0x00 - 0x07] CAN Bus Adress of BIC-2200
+//  Output:         (int) 0 = Adress invalid or already used; 1 = Device attached
+//  Description:    Attaches the Device to a Bus, Calculates the CAN IDs and loads the
+//                  Scaling Factors (Datasheet Defaults are kept if the Device does not answer)
 //#################################################################################################
-    _CS = CS_Pin;
+    if (!bus.attach(*this, CAN_Adress)) {
+        return 0;
+    }
+    _bus = &bus;
+    _address = CAN_Adress;
     _CAN_ID_SEND = MSG_ID_CAN_SEND_00 + CAN_Adress;
     _CAN_ID_RECEIVE = MSG_ID_CAN_RECEIVE_00 + CAN_Adress;
+    loadScalingFactors();
+    return 1;
+}
+
+long BIC2200::readTemperatureDeci() {
+//#################################################################################################
+//  Function:       readTemperatureDeci
+//  Access:         Public
+//  Input:          -
+//  Output:         (long) BIC2200_INVALID_VALUE = Readout Unsuccessfull; else Temperature in 0.1 deg C
+//  Description:    Read the Internal Temperature of BIC-2200 without float Math
+//#################################################################################################
+    return readScaled<BIC2200Reg::ReadTemperature1>();
+}
+
+long BIC2200::readInputVoltageMilli() {
+//#################################################################################################
+//  Function:       readInputVoltageMilli
+//  Access:         Public
+//  Input:          -
+//  Output:         (long) BIC2200_INVALID_VALUE = Readout Unsuccessfull; else Input Voltage in mV
+//  Description:    Read the Input Voltage of BIC-2200 without float Math
+//#################################################################################################
+    return readScaled<BIC2200Reg::ReadVin>();
+}
 
-    CAN.setPins(_CS);
-    CAN.setClockFrequency(CAN_CLK_FREQUENCY);
-    return CAN.begin(CAN_BAUDRATE);
+long BIC2200::readOutputVoltageMilli() {
+//#################################################################################################
+//  Function:       readOutputVoltageMilli
+//  Access:         Public
+//  Input:          -
+//  Output:         (long) BIC2200_INVALID_VALUE = Readout Unsuccessfull; else Output Voltage in mV
+//  Description:    Read the Output Voltage of BIC-2200 without float Math
+//#################################################################################################
+    return readScaled<BIC2200Reg::ReadVout>();
+}
 
+long BIC2200::readOutputCurrentMilli() {
+//#################################################################################################
+//  Function:       readOutputCurrentMilli
+//  Access:         Public
+//  Input:          -
+//  Output:         (long) BIC2200_INVALID_VALUE = Readout Unsuccessfull; else Output Current in mA
+//                  (negative while discharging)
+//  Description:    Read the Output Current of BIC-2200 without float Math
+//#################################################################################################
+    return readScaled<BIC2200Reg::ReadIout>();
 }
 
+#if BIC2200_ENABLE_FLOAT
 float BIC2200::readTemperature() {
 //#################################################################################################
 //  Function:       readTemperature
 //  Access:         Public
 //  Input:          -
-//  Output:         (float) -1.0 = Temperature Readout Unsuccessfull; > 0.0 Temperature of BIC-2200
+//  Output:         (float) NAN = Temperature Readout Unsuccessfull (check with isnan()); else
+//                  Temperature of BIC-2200 in deg C, may be negative
 //  Description:    Read the Internal Temperature of BIC-2200
 //#################################################################################################
-    byte data[2];
-    float temperature = -1.0;
-    if (_getRegisterValue(CMD_READ_TEMPERATURE_1, data)) {
-        temperature = ( ( data[1] << 8 ) + data[0]) * 0.1;
+    long temperature = readTemperatureDeci();
+    if (temperature == BIC2200_INVALID_VALUE) {
+        return NAN;
     }
-    return temperature;
+    return temperature * 0.1;
 }
 
 float BIC2200::readInputVoltage() {
@@ -50,12 +139,11 @@ float BIC2200::readInputVoltage() {
 //  Output:         (float) -1.0 = Voltage Readout Unsuccessfull; > 0.0 Input Voltage of BIC-2200
 //  Description:    Read the Input Voltage of BIC-2200
 //#################################################################################################
-    byte data[2];
-    float temperature = -1.0;
-    if (_getRegisterValue(CMD_READ_VIN, data)) {
-        temperature = ( ( data[1] << 8 ) + data[0]) * 0.1;
+    long voltage = readInputVoltageMilli();
+    if (voltage == BIC2200_INVALID_VALUE) {
+        return -1.0;
     }
-    return temperature;
+    return voltage * 0.001;
 }
 
 float BIC2200::readOutputVoltage() {
@@ -66,28 +154,29 @@ float BIC2200::readOutputVoltage() {
 //  Output:         (float) -1.0 = Voltage Readout Unsuccessfull; > 0.0 Output Voltage of BIC-2200
 //  Description:    Read the Output Voltage of BIC-2200
 //#################################################################################################
-    byte data[2];
-    float temperature = -1.0;
-    if (_getRegisterValue(CMD_READ_VOUT, data)) {
-        temperature = ( ( data[1] << 8 ) + data[0]) * 0.01;
+    long voltage = readOutputVoltageMilli();
+    if (voltage == BIC2200_INVALID_VALUE) {
+        return -1.0;
     }
-    return temperature;
+    return voltage * 0.001;
 }
+
 float BIC2200::readOutputCurrent() {
 //#################################################################################################
 //  Function:       readOutputCurrent
 //  Access:         Public
 //  Input:          -
-//  Output:         (float) -1.0 = Current Readout Unsuccessfull; > 0.0 Output Current of BIC-2200
+//  Output:         (float) NAN = Current Readout Unsuccessfull (check with isnan()); else
+//                  Output Current of BIC-2200 in A (negative while discharging)
 //  Description:    Read the Output Current of BIC-2200
 //#################################################################################################
-    byte data[2];
-    float temperature = -1.0;
-    if (_getRegisterValue(CMD_READ_IOUT, data)) {
-        temperature = ( ( data[1] << 8 ) + data[0]) * 0.01;
+    long current = readOutputCurrentMilli();
+    if (current == BIC2200_INVALID_VALUE) {
+        return NAN;
     }
-    return temperature;
+    return current * 0.001;
 }
+#endif
 
 void BIC2200::setSystemConfig(int config) {
 //#################################################################################################
@@ -103,11 +192,7 @@ void BIC2200::setSystemConfig(int config) {
 //  Output:         -
 //  Description:    Set the System Config Register of BIC-2200
 //#################################################################################################
-    byte data[2];
-    data[0] = lowByte(config);
-    data[1] = highByte(config);
-    
-    _setRegisterValue(CMD_SYSTEM_CONFIG, data, 2);
+    write<BIC2200Reg::SystemConfig>(config);
 }
 
 int BIC2200::getSystemConfig() {
@@ -124,12 +209,8 @@ int BIC2200::getSystemConfig() {
 //                       5 = 0x101 = CAN Controll enabled; Preset is previous set value
 //  Description:    Get the System Config Register of BIC-2200
 //#################################################################################################
-    byte data[2];
-    int config = -1;
-    if ( _getRegisterValue(CMD_SYSTEM_CONFIG, data) ) {
-        config = ( ( data[1] << 8 ) + data[0]);
-    }
-    return config;
+    uint16_t config;
+    return read<BIC2200Reg::SystemConfig>(config) ? config : -1;
 }
 
 void BIC2200::setBidirecitonalConfig(int config) {
@@ -142,11 +223,7 @@ void BIC2200::setBidirecitonalConfig(int config) {
 //  Output:         -
 //  Description:    Set the Bidirectional Config Register of BIC-2200
 //#################################################################################################
-    byte data[2];
-    data[0] = lowByte(config);
-    data[1] = highByte(config);
-    
-    _setRegisterValue(CMD_BIDIRECTIONAL_CONFIG, data, 2);
+    write<BIC2200Reg::BidirectionalConfig>(config);
 }
 
 int BIC2200::getBidirecitonalConfig() {
@@ -159,12 +236,8 @@ int BIC2200::getBidirecitonalConfig() {
 //                       1 = 0x001 = Bi-direction battery mode. DIR_CTRL and C/D control (analogy) controllable
 //  Description:    Get the Bidirectional Config Register of BIC-2200
 //#################################################################################################
-    byte data[2];
-    int config = -1;
-    if ( _getRegisterValue(CMD_BIDIRECTIONAL_CONFIG, data) ) {
-        config = ( ( data[1] << 8 ) + data[0]);
-    }
-    return config;
+    uint16_t config;
+    return read<BIC2200Reg::BidirectionalConfig>(config) ? config : -1;
 }
 
 void BIC2200::setOutputVoltage(int voltage) {
@@ -175,11 +248,7 @@ void BIC2200::setOutputVoltage(int voltage) {
 //  Output:         -
 //  Description:    Sets the Output Voltage of the BIC-2200 (4800 = 48.0V)
 //#################################################################################################
-    byte data[2];
-    data[0] = lowByte(voltage);
-    data[1] = highByte(voltage);
-    
-    _setRegisterValue(CMD_VOUT_SET, data, 2);
+    write<BIC2200Reg::VoutSet>(voltage);
 }
 
 int BIC2200::getOutputVoltage() {
@@ -190,12 +259,8 @@ int BIC2200::getOutputVoltage() {
 //  Output:         (int) voltage (Factor 0.01)
 //  Description:    Gets the Output Voltage of the BIC-2200 (4800 = 48.0V)
 //#################################################################################################
-    byte data[2];
-    int voltage = -1;
-    if ( _getRegisterValue(CMD_VOUT_SET, data) ) {
-        voltage = ( ( data[1] << 8 ) + data[0]);
-    }
-    return voltage;
+    uint16_t voltage;
+    return read<BIC2200Reg::VoutSet>(voltage) ? voltage : -1;
 }
 
 void BIC2200::setOutputCurrent(int current) {
@@ -206,11 +271,7 @@ void BIC2200::setOutputCurrent(int current) {
 //  Output:         -
 //  Description:    Sets the Output Current of the BIC-2200 (1000 = 10.0A)
 //#################################################################################################
-    byte data[2];
-    data[0] = lowByte(current);
-    data[1] = highByte(current);
-    
-    _setRegisterValue(CMD_IOUT_SET, data, 2);
+    write<BIC2200Reg::IoutSet>(current);
 }
 
 int BIC2200::getOutputCurrent() {
@@ -221,12 +282,8 @@ int BIC2200::getOutputCurrent() {
 //  Output:         (int) current (Factor 0.01)
 //  Description:    Gets the Output Current of the BIC-2200 (1000 = 10.0A)
 //#################################################################################################
-    byte data[2];
-    int current = -1;
-    if ( _getRegisterValue(CMD_IOUT_SET, data) ) {
-        current = ( ( data[1] << 8 ) + data[0]);
-    }
-    return current;
+    uint16_t current;
+    return read<BIC2200Reg::IoutSet>(current) ? current : -1;
 }
 
 void BIC2200::setReverseOutputVoltage(int voltage) {
@@ -237,11 +294,7 @@ void BIC2200::setReverseOutputVoltage(int voltage) {
 //  Output:         -
 //  Description:    Sets the Reverse Output Voltage of the BIC-2200 (4800 = 48.0V)
 //#################################################################################################
-    byte data[2];
-    data[0] = lowByte(voltage);
-    data[1] = highByte(voltage);
-    
-    _setRegisterValue(CMD_REVERSE_VOUT_SET, data, 2);
+    write<BIC2200Reg::ReverseVoutSet>(voltage);
 }
 
 int BIC2200::getReverseOutputVoltage() {
@@ -252,12 +305,8 @@ int BIC2200::getReverseOutputVoltage() {
 //  Output:         (int) voltage (Factor 0.01)
 //  Description:    Gets the Reverse Output Voltage of the BIC-2200 (4800 = 48.0V)
 //#################################################################################################
-    byte data[2];
-    int voltage = -1;
-    if ( _getRegisterValue(CMD_REVERSE_VOUT_SET, data) ) {
-        voltage = ( ( data[1] << 8 ) + data[0]);
-    }
-    return voltage;
+    uint16_t voltage;
+    return read<BIC2200Reg::ReverseVoutSet>(voltage) ? voltage : -1;
 }
 
 void BIC2200::setReverseOutputCurrent(int current) {
@@ -268,11 +317,7 @@ void BIC2200::setReverseOutputCurrent(int current) {
 //  Output:         -
 //  Description:    Sets the Reverse Output Current of the BIC-2200 (1000 = 10.0A)
 //#################################################################################################
-    byte data[2];
-    data[0] = lowByte(current);
-    data[1] = highByte(current);
-    
-    _setRegisterValue(CMD_REVERSE_IOUT_SET, data, 2);
+    write<BIC2200Reg::ReverseIoutSet>(current);
 }
 
 int BIC2200::getReverseOutputCurrent() {
@@ -283,12 +328,8 @@ int BIC2200::getReverseOutputCurrent() {
 //  Output:         (int) current (Factor 0.01)
 //  Description:    Gets the Reverse Output Current of the BIC-2200 (1000 = 10.0A)
 //#################################################################################################
-    byte data[2];
-    int current = -1;
-    if ( _getRegisterValue(CMD_REVERSE_IOUT_SET, data) ) {
-        current = ( ( data[1] << 8 ) + data[0]);
-    }
-    return current;
+    uint16_t current;
+    return read<BIC2200Reg::ReverseIoutSet>(current) ? current : -1;
 }
 
 void BIC2200::setOperation(bool operation) {
@@ -299,14 +340,7 @@ void BIC2200::setOperation(bool operation) {
 //  Output:         -
 //  Description:    Sets the Device ON or OFF
 //#################################################################################################
-    byte data[1];
-    if (operation) {
-        data[0] = 0x01;
-    } else {
-        data[0] = 0x00;
-    }
-    
-    _setRegisterValue(CMD_OPERATION, data, 1);
+    write<BIC2200Reg::Operation>(operation ? 0x01 : 0x00);
 }
 
 int BIC2200::getOperation() {
@@ -317,12 +351,8 @@ int BIC2200::getOperation() {
 //  Output:         (bool) operation - false = OFF; true = ON
 //  Description:    Gets the State of the Device (ON/OFF)
 //#################################################################################################
-    byte data[1];
-    int operation = -1;
-    if (_getRegisterValue(CMD_OPERATION, data)) {
-        operation = data[0];
-    }
-    return operation;
+    uint8_t operation;
+    return read<BIC2200Reg::Operation>(operation) ? operation : -1;
 }
 
 void BIC2200::setDirection(bool direction) {
@@ -333,14 +363,7 @@ void BIC2200::setDirection(bool direction) {
 //  Output:         -
 //  Description:    Sets the Power Direction of the BIC-2200 
 //#################################################################################################
-    byte data[1];
-    if (direction) {
-        data[0] = 0x01;
-    } else {
-        data[0] = 0x00;
-    }
-    
-    _setRegisterValue(CMD_DIRECTION_CTRL, data, 1);
+    write<BIC2200Reg::DirectionCtrl>(direction ? 0x01 : 0x00);
 }
 
 int BIC2200::getDirection() {
@@ -351,12 +374,8 @@ int BIC2200::getDirection() {
 //  Output:         (bool) direction - false = AC->DC; true = DC->AC
 //  Description:    Gets the Power Direction of the BIC-2200 
 //#################################################################################################
-    byte data[1];
-    int direction = -1;
-    if (_getRegisterValue(CMD_DIRECTION_CTRL, data)) {
-        direction = data[0];
-    }
-    return direction;
+    uint8_t direction;
+    return read<BIC2200Reg::DirectionCtrl>(direction) ? direction : -1;
 }
 
 int BIC2200::getSystemStatus() {
@@ -367,12 +386,20 @@ int BIC2200::getSystemStatus() {
 //  Output:         (int) Details: https://www.meanwell.com/upload/pdf/bic-2200-e.pdf
 //  Description:    Gets the System State of the BIC-2200
 //#################################################################################################
-    byte data[2];
-    int status = -1;
-    if ( _getRegisterValue(CMD_SYSTEM_STATUS, data) ) {
-        status = ( ( data[1] << 8 ) + data[0]);
-    }
-    return status;
+    uint16_t status;
+    return read<BIC2200Reg::SystemStatus>(status) ? status : -1;
+}
+
+int BIC2200::getFaultStatus() {
+//#################################################################################################
+//  Function:       getFaultStatus
+//  Access:         Public
+//  Input:          -
+//  Output:         (int) -1 = Readout Unsuccessfull; else BIC2200_FAULT_* Bits
+//  Description:    Gets the Fault Flags of the BIC-2200 (FAN_FAIL, OTP, OVP, OLP, SHORT, ...)
+//#################################################################################################
+    uint16_t status;
+    return read<BIC2200Reg::FaultStatus>(status) ? status : -1;
 }
 
 int BIC2200::getScalingFactors() {
@@ -383,75 +410,736 @@ int BIC2200::getScalingFactors() {
 //  Output:         (int) Details: https://www.meanwell.com/upload/pdf/bic-2200-e.pdf
 //  Description:    Gets the Scaling Factors of the BIC-2200
 //#################################################################################################
-    byte data[2];
-    int factors = -1;
-    if ( _getRegisterValue(CMD_SCALING_FACTOR, data) ) {
-        factors = ( ( data[1] << 8 ) + data[0]);
+    BIC2200Bytes6 factors;
+    if (!read<BIC2200Reg::ScalingFactor>(factors)) {
+        return -1;
+    }
+    return ( factors.b[1] << 8 ) + factors.b[0];
+}
+
+bool BIC2200::loadScalingFactors() {
+//#################################################################################################
+//  Function:       loadScalingFactors
+//  Access:         Public
+//  Input:          -
+//  Output:         (bool) false = Register not readable, previous Scales stay; true = Scales updated
+//  Description:    Reads CMD_SCALING_FACTOR and precomputes the integer Conversions of VOUT, IOUT,
+//                  VIN and Temperature for this Model (12/24/48/96 V Variants differ).
+//                  Byte 0: VOUT (Bit 0-3), IOUT (Bit 4-7); Byte 1: VIN (Bit 0-3);
+//                  Byte 2: Temperature (Bit 0-3)
+//#################################################################################################
+    BIC2200Bytes6 factors;
+    if (!read<BIC2200Reg::ScalingFactor>(factors)) {
+        return false;
     }
-    return factors;
+    _applyScalingFactors(factors.b);
+    return true;
 }
 
+void BIC2200::_applyScalingFactors(const byte * factors) {
+//#################################################################################################
+//  Function:       _applyScalingFactors
+//  Access:         Private
+//  Input:          factors (const byte *) 6 Byte Value of CMD_SCALING_FACTOR
+//  Output:         -
+//  Description:    Precomputes the Conversions, a Nibble of 0 keeps the previous Scale
+//#################################################################################################
+    if ((factors[0] & 0x0F) != 0) {
+        _voutScale = BIC2200Scale::fromFactor(factors[0] & 0x0F, BIC2200_FACTOR_0_001);
+    }
+    if ((factors[0] >> 4) != 0) {
+        _ioutScale = BIC2200Scale::fromFactor(factors[0] >> 4, BIC2200_FACTOR_0_001);
+    }
+    if ((factors[1] & 0x0F) != 0) {
+        _vinScale = BIC2200Scale::fromFactor(factors[1] & 0x0F, BIC2200_FACTOR_0_001);
+    }
+    if ((factors[2] & 0x0F) != 0) {
+        _temperatureScale = BIC2200Scale::fromFactor(factors[2] & 0x0F, BIC2200_FACTOR_0_1);
+    }
+}
 
-int BIC2200::_getRegisterValue(int reg, byte * data){
+BIC2200Scale BIC2200::getScale(int reg) {
 //#################################################################################################
-//  Function:       _getRegisterValue
+//  Function:       getScale
+//  Access:         Public
+//  Input:          reg (int) CMD_READ_VIN, CMD_READ_VOUT, CMD_READ_IOUT or CMD_READ_TEMPERATURE_1
+//  Output:         (BIC2200Scale) Conversion of the raw Word to mV, mA or 0.1 deg C
+//  Description:    Gives access to the Scales of this Device, e.g. to convert raw Snapshots.
+//                  The Setpoint Registers use the Scale of their Measurement
+//#################################################################################################
+    switch (reg) {
+        case CMD_READ_VIN:
+            return _vinScale;
+        case CMD_READ_VOUT:
+        case CMD_VOUT_SET:
+        case CMD_REVERSE_VOUT_SET:
+            return _voutScale;
+        case CMD_READ_IOUT:
+        case CMD_IOUT_SET:
+        case CMD_REVERSE_IOUT_SET:
+            return _ioutScale;
+        case CMD_READ_TEMPERATURE_1:
+            return _temperatureScale;
+    }
+    return _scaleOf(BIC2200_SCALE_NONE);
+}
+
+const BIC2200Scale & BIC2200::_scaleOf(byte scale) {
+//#################################################################################################
+//  Function:       _scaleOf
+//  Access:         Private
+//  Input:          scale (byte) BIC2200_SCALE_* of a Register Descriptor
+//  Output:         (const BIC2200Scale &) Conversion of this Device
+//  Description:    Resolves the Scale of a Register Descriptor to the loaded Scaling Factors
+//#################################################################################################
+    static const BIC2200Scale identity = { 1, 1 };
+    switch (scale) {
+        case BIC2200_SCALE_VOUT:
+            return _voutScale;
+        case BIC2200_SCALE_IOUT:
+            return _ioutScale;
+        case BIC2200_SCALE_VIN:
+            return _vinScale;
+        case BIC2200_SCALE_TEMPERATURE:
+            return _temperatureScale;
+    }
+    return identity;
+}
+
+long BIC2200::_readScaled(int reg, byte scale, bool isSigned) {
+//#################################################################################################
+//  Function:       _readScaled
 //  Access:         Private
+//  Input:          reg (int) 16 Bit Measurement or Setpoint Register
+//                  scale (byte) BIC2200_SCALE_* of the Register
+//                  isSigned (bool) true = Register holds a two's Complement Value
+//  Output:         (long) BIC2200_INVALID_VALUE = Readout Unsuccessfull; else scaled Value
+//  Description:    Shared Body of readScaled<R>(), keeps one Copy of the Code for all Registers
+//#################################################################################################
+    byte data[2];
+    if (!_getRegisterValue(reg, data, sizeof(data))) {
+        return BIC2200_INVALID_VALUE;
+    }
+    unsigned int raw = ( ( data[1] << 8 ) + data[0]);
+    if (isSigned) {
+        return _scaleOf(scale).apply((int16_t)raw);
+    }
+    return _scaleOf(scale).apply(raw);
+}
+
+BIC2200Scale BIC2200Scale::fromFactor(byte factor, byte unitFactor) {
+//#################################################################################################
+//  Function:       fromFactor
+//  Access:         Public (static)
+//  Input:          factor (byte) BIC2200_FACTOR_* Code of the Register
+//                  unitFactor (byte) BIC2200_FACTOR_* Code of the Target Unit (0.001 = milli)
+//  Output:         (BIC2200Scale) Conversion from Register to Target Unit
+//  Description:    Looks the Conversion up in a Power of 10 Table, no Math at Runtime
+//#################################################################################################
+    static const long pow10[] = { 1L, 10L, 100L, 1000L, 10000L, 100000L };
+    BIC2200Scale scale = { 1, 1 };
+    if (factor < BIC2200_FACTOR_0_001 || factor > BIC2200_FACTOR_100) {
+        return scale;
+    }
+    if (factor >= unitFactor) {
+        scale.mul = pow10[factor - unitFactor];
+    } else {
+        scale.div = pow10[unitFactor - factor];
+    }
+    return scale;
+}
+
+
+BIC2200Snapshot BIC2200::readSnapshot() {
+//#################################################################################################
+//  Function:       readSnapshot
+//  Access:         Public
+//  Input:          -
+//  Output:         (BIC2200Snapshot) Live Measurements with Timestamp and Validity Bits
+//  Description:    Reads VIN, VOUT, IOUT, Temperature, System and Fault Status back to back in
+//                  one pipelined Burst, so all Values belong to (nearly) the same Moment
+//#################################################################################################
+    static const int regs[] = {
+        CMD_READ_VIN,
+        CMD_READ_VOUT,
+        CMD_READ_IOUT,
+        CMD_READ_TEMPERATURE_1,
+        CMD_SYSTEM_STATUS,
+        CMD_FAULT_STATUS
+    };
+    unsigned int values[6] = {};
+    BIC2200Snapshot snapshot = {};
+
+    if (_bus == NULL) {
+        return snapshot;
+    }
+    snapshot.timestamp = _bus->micros();
+    snapshot.valid = readRegisters(regs, 6, values);
+    snapshot.span = _bus->micros() - snapshot.timestamp;
+    snapshot.vin = values[0];
+    snapshot.vout = values[1];
+    snapshot.iout = values[2];
+    snapshot.temperature = values[3];
+    snapshot.systemStatus = values[4];
+    snapshot.faultStatus = values[5];
+    return snapshot;
+}
+
+bool BIC2200::requestRead(int reg) {
+//#################################################################################################
+//  Function:       requestRead
+//  Access:         Public
 //  Input:          reg (int) Register to Read from BIC2200
+//  Output:         (bool) false = no free Transaction Slot; true = Read queued
+//  Description:    Queues a non-blocking Read. The Request is sent by poll(), the Result is 
+//                  delivered to the Reply Callback or fetched with getResult()
+//#################################################################################################
+    return _queueRead(reg, false) >= 0;
+}
+
+int BIC2200::poll() {
+//#################################################################################################
+//  Function:       poll
+//  Access:         Public
+//  Input:          -
+//  Output:         (int) Number of Transactions finished (Reply or Timeout) during this Call
+//  Description:    Drives the Transaction Engine without blocking: sends queued Requests up to
+//                  the Pipeline Depth, matches received Replies by their Register Echo and
+//                  expires Requests without Reply after the Timeout (learned from the Round
+//                  Trip Times, see getTimeout()), expired Reads are retried. Replies are
+//                  drained after every sent Request, so the Device Queue never has to hold
+//                  more than the Replies of one Frame Time. The Timeout restarts with every
+//                  Frame received on the Bus, a pipelined Reply queues behind the Frames of all
+//                  Devices, but not beyond BIC2200_TIMEOUT_LIMIT after the Request
+//#################################################################################################
+    int finished = 0;
+    byte inFlight = 0;
+    unsigned long now;
+
+    if (_bus == NULL) {
+        return 0;
+    }
+    finished += _drainReplies();
+
+    now = _bus->micros();
+#if BIC2200_ENABLE_ADAPTIVE_TIMEOUT
+    unsigned long timeout = _timeout();
+#else
+    unsigned long timeout = CAN_REPLY_TIME + CAN_TIMEOUT;
+#endif
+    for (byte i = 0; i < BIC2200_MAX_PENDING; i++) {
+        BIC2200Transaction & transaction = _transactions[i];
+        if (transaction.state != BIC2200_TX_SENT) {
+            continue;
+        }
+        unsigned long elapsed = now - transaction.sentAt;
+        bool expired = (elapsed >= BIC2200_TIMEOUT_LIMIT);
+        if ((now - _bus->lastReceiveAt()) < elapsed) {
+            elapsed = now - _bus->lastReceiveAt();
+        }
+        if (expired || elapsed >= timeout) {
+#if BIC2200_ENABLE_STATS
+            _statsTimeout(transaction.reg);
+#endif
+#if BIC2200_ENABLE_ADAPTIVE_TIMEOUT
+            if (_expire(transaction, timeout)) {
+                continue;
+            }
+#endif
+            transaction.state = BIC2200_TX_TIMEOUT;
+            transaction.len = 0;
+            ++finished;
+        } else {
+            ++inFlight;
+        }
+    }
+
+    while (inFlight < _pipelineDepth) {
+        int slot = _findOldest(-1, BIC2200_TX_QUEUED);
+        if (slot < 0) {
+            break;
+        }
+#if BIC2200_ENABLE_ADAPTIVE_TIMEOUT
+        if (!_admit(_transactions[slot])) {
+            ++finished;
+            continue;
+        }
+#endif
+        _sendRequest(_transactions[slot]);
+        ++inFlight;
+        finished += _drainReplies();
+    }
+
+    if (_replyCallback != NULL) {
+        for (byte i = 0; i < BIC2200_MAX_PENDING; i++) {
+            BIC2200Transaction & transaction = _transactions[i];
+            if (transaction.blocking || 
+                (transaction.state != BIC2200_TX_DONE && transaction.state != BIC2200_TX_TIMEOUT)) {
+                continue;
+            }
+            bool valid = (transaction.state == BIC2200_TX_DONE);
+            transaction.state = BIC2200_TX_FREE;
+            _replyCallback(*this, transaction.reg, transaction.data, transaction.len, valid);
+        }
+    }
+
+    return finished;
+}
+
+int BIC2200::getResult(int reg, byte * data, int len) {
+//#################################################################################################
+//  Function:       getResult
+//  Access:         Public
+//  Input:          reg (int) Register of a Read queued with requestRead()
 //                  data (byte *) Pointer to a Byte Array where the data should be written to
-//  Output:         (int) 0 = data Array not Valid; 1 = data Array is valid
-//  Description:    Reads a Register from BIC-2200 
+//                  len (int) Size of the data Array
+//  Output:         (int) -1 = no finished Read for reg; 0 = Timeout; 1 = data Array is valid
+//  Description:    Fetches the oldest finished Read of a Register and frees its Slot
 //#################################################################################################
-    unsigned long startTime;
-    unsigned int index = 0;
-    int retVal = 0;
-    byte data_received[8];
-    bool blnDataValid = true;
-    
-    CAN.beginExtendedPacket(_CAN_ID_SEND);
-    CAN.write(lowByte(reg));
-    CAN.write(highByte(reg));
-    CAN.endPacket();
-
-    startTime = micros();
-
-    while (((micros() - startTime ) < CAN_TIMEOUT ) && blnDataValid ) {
-        int packetSize = CAN.parsePacket();
-        if (packetSize || CAN.packetId() != -1) {
-            while (CAN.available() && index < 8) {
-                data_received[index] = CAN.read();
-                ++index;
+    int slot = _findOldest(reg, BIC2200_TX_DONE);
+    if (slot < 0) {
+        slot = _findOldest(reg, BIC2200_TX_TIMEOUT);
+    }
+    if (slot < 0 || _transactions[slot].blocking) {
+        return -1;
+    }
+    return _takeResult(slot, data, len, _replyNeeded(reg));
+}
+
+bool BIC2200::isBusy() {
+//#################################################################################################
+//  Function:       isBusy
+//  Access:         Public
+//  Input:          -
+//  Output:         (bool) true = at least one Read is queued or waiting for its Reply
+//  Description:    Checks if the Transaction Engine has outstanding Requests
+//#################################################################################################
+    for (byte i = 0; i < BIC2200_MAX_PENDING; i++) {
+        if (_transactions[i].state == BIC2200_TX_QUEUED || _transactions[i].state == BIC2200_TX_SENT) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void BIC2200::setPipelineDepth(byte depth) {
+//#################################################################################################
+//  Function:       setPipelineDepth
+//  Access:         Public
+//  Input:          depth (byte) [1 - BIC2200_MAX_PENDING] Max. Requests on the Bus at once
+//  Output:         -
+//  Description:    Limits how many Requests may wait for a Reply at the same Time
+//#################################################################################################
+    if (depth < 1) {
+        depth = 1;
+    }
+    if (depth > BIC2200_MAX_PENDING) {
+        depth = BIC2200_MAX_PENDING;
+    }
+    _pipelineDepth = depth;
+}
+
+void BIC2200::onReply(BIC2200ReplyCallback callback) {
+//#################################################################################################
+//  Function:       onReply
+//  Access:         Public
+//  Input:          callback (BIC2200ReplyCallback) Function called for every finished Read, NULL = off
+//  Output:         -
+//  Description:    Registers a Callback for Reads queued with requestRead(). With a Callback 
+//                  set, the Slots are freed after the Call and getResult() is not needed
+//#################################################################################################
+    _replyCallback = callback;
+}
+
+unsigned long BIC2200::readRegisters(const int * regs, byte count, unsigned int * values) {
+//#################################################################################################
+//  Function:       readRegisters
+//  Access:         Public
+//  Input:          regs (const int *) Registers to Read [max. 32]
+//                  count (byte) Number of Registers
+//                  values (unsigned int *) Destination of the 16 Bit Register Values
+//  Output:         (unsigned long) Bit i set = values[i] is valid
+//  Description:    Reads several Registers in one pipelined Burst and waits until every
+//                  Request got a Reply or timed out
+//#################################################################################################
+    byte data[2 * 32];
+
+    if (count > 32) {
+        count = 32;
+    }
+    unsigned long validMask = _readBurst(regs, count, data, 2);
+    for (byte i = 0; i < count; i++) {
+        if (validMask & (1UL << i)) {
+            values[i] = ( ( data[2 * i + 1] << 8 ) + data[2 * i]);
+        }
+    }
+    return validMask;
+}
+
+unsigned long BIC2200::_readBurst(const int * regs, byte count, byte * data, byte width) {
+//#################################################################################################
+//  Function:       _readBurst
+//  Access:         Private
+//  Input:          regs (const int *) Registers to Read [max. 32]
+//                  count (byte) Number of Registers
+//                  data (byte *) count * width Bytes, Register i at data + i * width
+//                  width (byte) [1 - 6] Data Bytes per Register, missing Bytes are 0
+//  Output:         (unsigned long) Bit i set = Register i is valid
+//  Description:    Keeps the Pipeline full: a Slot freed by a Reply or Timeout is refilled
+//                  with the next Register at once
+//#################################################################################################
+    int slots[32];
+    byte next = 0;
+    byte outstanding = 0;
+    unsigned long validMask = 0;
+
+    if (count > 32) {
+        count = 32;
+    }
+    memset(data, 0, count * width);
+
+    while (next < count || outstanding > 0) {
+        while (next < count) {
+            slots[next] = _queueRead(regs[next], true);
+            if (slots[next] < 0) {
+                break;
             }
-            if (lowByte(reg) == data_received[0] && highByte(reg) == data_received[1]) {
-                for (unsigned int i = 0; i < (index - 2); i++) {
-                    data[i] = data_received[i + 2];
-                }
-            } else {
-                blnDataValid = false;
+            ++next;
+            ++outstanding;
+        }
+        if (outstanding == 0) {
+            // All Slots hold unfetched non-blocking Results
+            break;
+        }
+        poll();
+        for (byte i = 0; i < next; i++) {
+            byte state = (slots[i] < 0) ? BIC2200_TX_FREE : _transactions[slots[i]].state;
+            if (state != BIC2200_TX_DONE && state != BIC2200_TX_TIMEOUT) {
+                continue;
             }
-            if (blnDataValid) {
-                retVal = 1; 
+            if (_takeResult(slots[i], data + i * width, width, _replyNeeded(regs[i]))) {
+                validMask |= (1UL << i);
             }
+            slots[i] = -1;
+            --outstanding;
         }
-    }  
+    }
+    return validMask;
+}
 
-    return retVal;
+int BIC2200::_getRegisterValue(int reg, byte * data, int len){
+//#################################################################################################
+//  Function:       _getRegisterValue
+//  Access:         Private
+//  Input:          reg (int) Register to Read from BIC2200
+//                  data (byte *) Pointer to a Byte Array where the data should be written to
+//                  len (int) Size of the data Array
+//  Output:         (int) 0 = data Array not Valid; 1 = data Array is valid
+//  Description:    Reads a Register from BIC-2200 through the Transaction Engine. Returns as 
+//                  soon as the Reply with the matching Register Echo has arrived. Live Shadow
+//                  Values are returned without Bus Access. A Reply shorter than an 8 or 16 Bit
+//                  Register fails, only the 6 Byte Registers may be shorter
+//#################################################################################################
+#if BIC2200_ENABLE_CACHE
+    if (_cacheLookup(reg, data, len)) {
+        return 1;
+    }
+#endif
+    int slot = _queueRead(reg, true);
+    if (slot < 0) {
+        return 0;
+    }
+    while (_transactions[slot].state == BIC2200_TX_QUEUED || _transactions[slot].state == BIC2200_TX_SENT) {
+        poll();
+    }
+    return _takeResult(slot, data, len, _replyNeeded(reg));
 }
 
 void BIC2200::_setRegisterValue(int reg, byte * data, int len){
 //#################################################################################################
-//  Function:       _getRegisterValue
+//  Function:       _setRegisterValue
 //  Access:         Private
 //  Input:          reg (int) Register to Write to BIC2200
 //                  data (byte *) Pointer to a Byte Array containing the Data to Write
 //  Output:         (int) 0 = Register Value set unsuccessfull; 1 = Register Value sucessfully written
-//  Description:    Writes a Register to BIC-2200 
+//  Description:    Writes a Register to BIC-2200. The Write is skipped if the live Shadow
+//                  Value already equals data
 //#################################################################################################
+    byte frame[8];
 
-    CAN.beginExtendedPacket(_CAN_ID_SEND);
-    CAN.write(lowByte(reg));
-    CAN.write(highByte(reg));
+    if (_bus == NULL) {
+        return;
+    }
+#if BIC2200_ENABLE_CACHE
+    if (_cacheIsCurrent(reg, data, len)) {
+        return;
+    }
+#endif
+    if (len > 6) {
+        len = 6;
+    }
+    frame[0] = lowByte(reg);
+    frame[1] = highByte(reg);
     for (int i = 0; i < len; i++) {
-        CAN.write(data[i]);
+        frame[i + 2] = data[i];
     }
-    CAN.endPacket();
-}
\ No newline at end of file
+    _bus->send(_CAN_ID_SEND, frame, len + 2);
+#if BIC2200_ENABLE_STATS
+    _statsSent(reg);
+#endif
+#if BIC2200_ENABLE_CACHE
+    ++_cacheStats.writes;
+    _cacheStore(reg, data, len);
+#endif
+}
+
+int BIC2200::_queueRead(int reg, bool blocking){
+//#################################################################################################
+//  Function:       _queueRead
+//  Access:         Private
+//  Input:          reg (int) Register to Read from BIC2200
+//                  blocking (bool) true = Result is taken by the Caller, never by the Callback
+//  Output:         (int) -1 = no free Slot; >= 0 Index of the Transaction Slot
+//  Description:    Puts a Read Request into a free Transaction Slot
+//#################################################################################################
+    if (_bus == NULL) {
+        return -1;
+    }
+    for (byte i = 0; i < BIC2200_MAX_PENDING; i++) {
+        BIC2200Transaction & transaction = _transactions[i];
+        if (transaction.state != BIC2200_TX_FREE) {
+            continue;
+        }
+        transaction.reg = reg;
+        transaction.blocking = blocking;
+        transaction.len = 0;
+        transaction.retries = 0;
+        transaction.seq = _seq++;
+        transaction.state = BIC2200_TX_QUEUED;
+        return i;
+    }
+    return -1;
+}
+
+int BIC2200::_findOldest(int reg, byte state){
+//#################################################################################################
+//  Function:       _findOldest
+//  Access:         Private
+//  Input:          reg (int) Register to look for; -1 = any Register
+//                  state (byte) Transaction State to look for
+//  Output:         (int) -1 = nothing found; >= 0 Index of the oldest matching Transaction Slot
+//  Description:    Replies of one Register arrive in Request Order, so they always belong to
+//                  the oldest Transaction of that Register
+//#################################################################################################
+    int oldest = -1;
+    for (byte i = 0; i < BIC2200_MAX_PENDING; i++) {
+        BIC2200Transaction & transaction = _transactions[i];
+        if (transaction.state != state || (reg != -1 && transaction.reg != reg)) {
+            continue;
+        }
+        if (oldest < 0 || (int)(transaction.seq - _transactions[oldest].seq) < 0) {
+            oldest = i;
+        }
+    }
+    return oldest;
+}
+
+void BIC2200::_sendRequest(BIC2200Transaction & transaction){
+//#################################################################################################
+//  Function:       _sendRequest
+//  Access:         Private
+//  Input:          transaction (BIC2200Transaction &) queued Read
+//  Output:         -
+//  Description:    Sends the Read Request of a Transaction and starts its Timeout
+//#################################################################################################
+    byte data[2];
+    data[0] = lowByte(transaction.reg);
+    data[1] = highByte(transaction.reg);
+    _bus->send(_CAN_ID_SEND, data, 2);
+
+    transaction.sentAt = _bus->micros();
+    transaction.state = BIC2200_TX_SENT;
+#if BIC2200_ENABLE_STATS
+    _statsSent(transaction.reg);
+#endif
+}
+
+int BIC2200::_drainReplies(){
+//#################################################################################################
+//  Function:       _drainReplies
+//  Access:         Private
+//  Input:          -
+//  Output:         (int) Number of Transactions finished by the received Replies
+//  Description:    Takes all received Frames of this Device from the Bus Queue
+//#################################################################################################
+    BIC2200Frame frame;
+    int finished = 0;
+    while (_bus->receive(_address, frame)) {
+        if (_matchReply(frame)) {
+            ++finished;
+        }
+    }
+    return finished;
+}
+
+bool BIC2200::_matchReply(const BIC2200Frame & frame){
+//#################################################################################################
+//  Function:       _matchReply
+//  Access:         Private
+//  Input:          frame (const BIC2200Frame &) received Frame
+//  Output:         (bool) true = Frame finished a Transaction
+//  Description:    Assigns a received Frame to the oldest sent Request with the same Register.
+//                  A Frame sooner than CAN_REPLY_MIN_TIME after that Request is a late Reply of
+//                  an expired one (e.g. before a Retry) and is dropped
+//#################################################################################################
+#if BIC2200_ENABLE_STATS
+    ++_stats.framesReceived;
+#endif
+    if (frame.id != _CAN_ID_RECEIVE || frame.len < 2) {
+#if BIC2200_ENABLE_STATS
+        _statsMismatch(-1);
+#endif
+        return false;
+    }
+    int reg = frame.data[0] | (frame.data[1] << 8);
+    int slot = _findOldest(reg, BIC2200_TX_SENT);
+    if (slot < 0) {
+#if BIC2200_ENABLE_STATS
+        _statsMismatch(reg);
+#endif
+        return false;
+    }
+    BIC2200Transaction & transaction = _transactions[slot];
+    unsigned long rtt = _bus->micros() - transaction.sentAt;
+    if (rtt < CAN_REPLY_MIN_TIME) {
+#if BIC2200_ENABLE_STATS
+        _statsMismatch(reg);
+#endif
+        return false;
+    }
+#if BIC2200_ENABLE_STATS
+    _statsReply(reg, rtt);
+#endif
+#if BIC2200_ENABLE_ADAPTIVE_TIMEOUT
+    _rttSample(transaction, rtt);
+#endif
+    transaction.len = frame.len - 2;
+    if (transaction.len > BIC2200_REPLY_BYTES) {
+        transaction.len = BIC2200_REPLY_BYTES;
+    }
+    for (byte i = 0; i < transaction.len; i++) {
+        transaction.data[i] = frame.data[i + 2];
+    }
+    transaction.state = BIC2200_TX_DONE;
+#if BIC2200_ENABLE_CACHE
+    _cacheStore(transaction.reg, transaction.data, transaction.len);
+#endif
+    return true;
+}
+
+int BIC2200::registerSlot(int reg){
+//#################################################################################################
+//  Function:       registerSlot
+//  Access:         Public (static)
+//  Input:          reg (int) Register
+//  Output:         (int) -1 = Register has no Slot; else Index into the Cache and Stats Tables
+//  Description:    Maps a Register to its Entry in the per Register Tables
+//#################################################################################################
+    for (byte i = 0; i < BIC2200_REGISTER_SLOTS; i++) {
+        if (_slotRegisters[i] == reg) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int BIC2200::slotRegister(byte slot){
+//#################################################################################################
+//  Function:       slotRegister
+//  Access:         Public (static)
+//  Input:          slot (byte) Index into the per Register Tables
+//  Output:         (int) -1 = no such Slot; else Register
+//  Description:    Inverse of registerSlot(), e.g. to decode a Log written with Slot Numbers
+//#################################################################################################
+    if (slot >= BIC2200_REGISTER_SLOTS) {
+        return -1;
+    }
+    return _slotRegisters[slot];
+}
+
+byte BIC2200::registerWidth(int reg){
+//#################################################################################################
+//  Function:       registerWidth
+//  Access:         Public (static)
+//  Input:          reg (int) Register
+//  Output:         (byte) 0 = unknown Register; else Data Bytes of the Register
+//  Description:    Width of a Register at Runtime, the typed Accessors take it from BIC2200Reg
+//#################################################################################################
+    switch (reg) {
+        case CMD_OPERATION:
+        case CMD_DIRECTION_CTRL:
+            return 1;
+        case CMD_VOUT_SET:
+        case CMD_IOUT_SET:
+        case CMD_FAULT_STATUS:
+        case CMD_READ_VIN:
+        case CMD_READ_VOUT:
+        case CMD_READ_IOUT:
+        case CMD_READ_TEMPERATURE_1:
+        case CMD_SYSTEM_STATUS:
+        case CMD_SYSTEM_CONFIG:
+        case CMD_REVERSE_VOUT_SET:
+        case CMD_REVERSE_IOUT_SET:
+        case CMD_BIDIRECTIONAL_CONFIG:
+            return 2;
+        case CMD_MFR_ID_B0B5:
+        case CMD_MFR_ID_B6B11:
+        case CMD_MFR_MODEL_B0B5:
+        case CMD_MFR_MODEL_B6B11:
+        case CMD_MFR_REVISION_B0B5:
+        case CMD_MFR_LOCATION_B0B2:
+        case CMD_MFR_DATE_B0B5:
+        case CMD_MFR_SERIAL_B0B5:
+        case CMD_MFR_SERIAL_B6B11:
+        case CMD_SCALING_FACTOR:
+            return 6;
+    }
+    return 0;
+}
+
+int BIC2200::_replyNeeded(int reg){
+//#################################################################################################
+//  Function:       _replyNeeded
+//  Access:         Private (static)
+//  Input:          reg (int) Register
+//  Output:         (int) Data Bytes a Reply must carry to be valid
+//  Description:    The full Width of 8 and 16 Bit Registers; the 6 Byte Registers and unknown
+//                  ones may reply shorter, the missing Bytes are 0
+//#################################################################################################
+    byte width = registerWidth(reg);
+    return (width > 2) ? 0 : width;
+}
+
+int BIC2200::_takeResult(int slot, byte * data, int len, int needed){
+//#################################################################################################
+//  Function:       _takeResult
+//  Access:         Private
+//  Input:          slot (int) Index of a finished Transaction Slot
+//                  data (byte *) Pointer to a Byte Array where the data should be written to
+//                  len (int) Size of the data Array
+//                  needed (int) Data Bytes the Reply must carry, a shorter Reply fails
+//  Output:         (int) 0 = Timeout or short Reply; 1 = data Array is valid
+//  Description:    Copies the Reply Data of a finished Transaction and frees its Slot. Bytes
+//                  the Reply did not carry are 0
+//#################################################################################################
+    BIC2200Transaction & transaction = _transactions[slot];
+    int retVal = 0;
+    if (transaction.state == BIC2200_TX_DONE && transaction.len >= needed) {
+        for (int i = 0; i < len; i++) {
+            data[i] = (i < transaction.len) ? transaction.data[i] : 0;
+        }
+        retVal = 1;
+    }
+    transaction.state = BIC2200_TX_FREE;
+    return retVal;
+}
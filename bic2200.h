@@ -8,8 +8,13 @@
 #ifndef BIC2200_H
 #define BIC2200_H
 
-#include <Arduino.h>
-#include <CAN.h>
+#include "bic2200_platform.h"
+#include "bic2200_ringbuffer.h"
+#include "bic2200_transport.h"
+#include "bic2200_bus.h"
+#ifdef ARDUINO
+#include "bic2200_mcp2515.h"
+#endif
 
 // CAN Registers of BIC-2200:
 // Source: https://www.meanwell.com/upload/pdf/bic-2200-e.pdf
@@ -41,22 +46,260 @@
 
 #define MSG_ID_CAN_SEND_00          0x000C0300    // Add CAN Device Address to this Adress 
 #define MSG_ID_CAN_RECEIVE_00       0x000C0200    // Add CAN Device Address to this Adress 
-#define MSG_ID_BROADCAST            0x000C0300FF
+#define MSG_ID_BROADCAST            0x000C03FF    // Write to all Devices at once, no Reply
+
+#include "bic2200_registers.h"
 
 #define CAN_BAUDRATE 250E3
 #define CAN_CLK_FREQUENCY 8E6
 #define CAN_TIMEOUT     500
+// Wire Time of the longest Reply (Extended Frame, 8 Data Bytes = 131 Bit). A Request only times
+// out CAN_TIMEOUT after its Reply could have been completely received
+#define CAN_REPLY_TIME  ((131UL * 1000000UL) / (unsigned long)CAN_BAUDRATE)
+// Wire Time of the shortest Reply (3 Data Bytes = 91 Bit). A Reply matched sooner after the
+// Request is the late Reply of an expired Request of the same Register
+#define CAN_REPLY_MIN_TIME  ((91UL * 1000000UL) / (unsigned long)CAN_BAUDRATE)
+#define BIC2200_MAX_PENDING     8   // Transaction Slots per Device
+#define BIC2200_REPLY_BYTES     6   // Max. Data Bytes of a Reply (without Register Echo)
+
+#ifndef BIC2200_ENABLE_FLOAT
+#define BIC2200_ENABLE_FLOAT    1   // 0 = remove the float Accessors, only the fixed Point API stays
+#endif
+#define BIC2200_INVALID_VALUE   (-2147483647L - 1)  // Returned by the fixed Point Readers on Error
+
+// Scaling Factor Codes of CMD_SCALING_FACTOR (one Nibble per Value)
+#define BIC2200_FACTOR_0_001    0x4
+#define BIC2200_FACTOR_0_01     0x5
+#define BIC2200_FACTOR_0_1      0x6
+#define BIC2200_FACTOR_1        0x7
+#define BIC2200_FACTOR_10       0x8
+#define BIC2200_FACTOR_100      0x9
+
+#define BIC2200_REGISTER_SLOTS  15  // Registers with Cache and Stats Entries (all except MFR_*)
+
+#ifndef BIC2200_ENABLE_CACHE
+#define BIC2200_ENABLE_CACHE    1   // 0 = remove the Register Shadow Cache (saves ~170 Byte RAM per Device)
+#endif
+#define BIC2200_CACHE_REGISTERS BIC2200_REGISTER_SLOTS
+#define BIC2200_TTL_NEVER       0UL             // Register is never served from the Cache
+#define BIC2200_TTL_INFINITE    0xFFFFFFFFUL    // Cached until written or invalidated
+
+#ifndef BIC2200_ENABLE_STATS
+#define BIC2200_ENABLE_STATS    1   // 0 = remove the Hot Path Counters (saves ~170 Byte RAM per Device)
+#endif
+#define BIC2200_STATS_BUCKETS   8   // Reply Latency Histogram Buckets over the Timeout Window
+#define BIC2200_STATS_BUCKET_US ((CAN_REPLY_TIME + CAN_TIMEOUT) / BIC2200_STATS_BUCKETS)
+
+#ifndef BIC2200_ENABLE_ADAPTIVE_TIMEOUT
+#define BIC2200_ENABLE_ADAPTIVE_TIMEOUT 1   // 0 = fixed CAN_REPLY_TIME + CAN_TIMEOUT, no Retries (saves ~70 Byte RAM per Device)
+#endif
+#ifndef BIC2200_RETRIES
+#define BIC2200_RETRIES         2   // Default Retries of a Read after a Timeout
+#endif
+#ifndef BIC2200_RTT_K
+#define BIC2200_RTT_K           4   // Timeout = smoothed RTT + K * smoothed Deviation (TCP, RFC 6298)
+#endif
+#ifndef BIC2200_TIMEOUT_MARGIN
+#define BIC2200_TIMEOUT_MARGIN  100 // us, min. Distance of the Timeout above the smoothed RTT
+#endif
+#define BIC2200_TIMEOUT_MAX     (4 * (CAN_REPLY_TIME + CAN_TIMEOUT))    // Upper Bound incl. Backoff
+#ifndef BIC2200_TIMEOUT_LIMIT
+// us after which a Request expires even while other Devices keep the Bus busy: a full Pipeline
+// of Replies queued behind their Frames. Must be >= BIC2200_TIMEOUT_MAX
+#define BIC2200_TIMEOUT_LIMIT   (BIC2200_MAX_PENDING * (CAN_REPLY_TIME + CAN_TIMEOUT))
+#endif
+#ifndef BIC2200_DEGRADE_AFTER
+#define BIC2200_DEGRADE_AFTER   3   // Reads failed in a Row until a Device is degraded, 0 = never
+#endif
+#ifndef BIC2200_PROBE_INTERVAL
+#define BIC2200_PROBE_INTERVAL  1000    // ms between the Requests to a degraded Device
+#endif
+
+#ifndef BIC2200_ENABLE_IDENTITY
+#define BIC2200_ENABLE_IDENTITY 1   // 0 = remove identify() (saves ~60 Byte RAM per Device)
+#endif
+#define BIC2200_TEXT_LENGTH     12  // Characters of the MFR_* Texts split over two Registers
+
+// Transaction States
+#define BIC2200_TX_FREE         0
+#define BIC2200_TX_QUEUED       1   // Waiting to be sent
+#define BIC2200_TX_SENT         2   // Request on the Bus, waiting for Reply
+#define BIC2200_TX_DONE         3   // Reply received
+#define BIC2200_TX_TIMEOUT      4   // No Reply within the Timeout and its Retries
+
+// Validity Bits of BIC2200Snapshot::valid
+#define BIC2200_SNAP_VIN            0x01
+#define BIC2200_SNAP_VOUT           0x02
+#define BIC2200_SNAP_IOUT           0x04
+#define BIC2200_SNAP_TEMPERATURE    0x08
+#define BIC2200_SNAP_SYSTEM_STATUS  0x10
+#define BIC2200_SNAP_FAULT_STATUS   0x20
+#define BIC2200_SNAP_ALL            0x3F
+
+// Bits of CMD_FAULT_STATUS and CMD_SYSTEM_STATUS as Events, Status Bits are offset by 16
+// Source: https://www.meanwell.com/upload/pdf/bic-2200-e.pdf
+enum BIC2200Event {
+    BIC2200_FAULT_FAN_FAIL      = 0,    // Fan locked
+    BIC2200_FAULT_OTP           = 1,    // Over Temperature
+    BIC2200_FAULT_OVP           = 2,    // Output Over Voltage
+    BIC2200_FAULT_OLP           = 3,    // Output Over Current
+    BIC2200_FAULT_SHORT         = 4,    // Output Short
+    BIC2200_FAULT_AC_FAIL       = 5,    // AC abnormal
+    BIC2200_FAULT_OP_OFF        = 6,    // Output turned off
+    BIC2200_FAULT_HI_TEMP       = 7,    // Internal high Temperature
+    BIC2200_FAULT_HV_OVP        = 8,    // HV Side Over Voltage
+    BIC2200_STATUS_SLAVE        = 16,   // 0 = Master, 1 = Slave
+    BIC2200_STATUS_DC_OK        = 17,   // Secondary DD Output Voltage OK
+    BIC2200_STATUS_PFC_OK       = 18,   // Primary PFC OK
+    BIC2200_STATUS_ADL_ON       = 20,   // Active Dummy Load on
+    BIC2200_STATUS_INITIAL      = 21,   // Device in Initial State
+    BIC2200_STATUS_EEPROM_ERROR = 22    // EEPROM Data Access Error
+};
+#define BIC2200_FAULT_BITS      0x01FF  // defined Bits of CMD_FAULT_STATUS
+#define BIC2200_STATUS_BITS     0x0077  // defined Bits of CMD_SYSTEM_STATUS
+
+// Live Measurements of one Device, read in one Burst. Values are raw Register Words
+struct __attribute__((packed)) BIC2200Snapshot {
+    uint32_t timestamp;         // micros() at the Start of the Burst
+    uint16_t span;              // us from first Request to last Reply
+    uint16_t vin;               // Factor 0.1 V
+    uint16_t vout;              // Factor 0.01 V
+    int16_t iout;               // Factor 0.01 A
+    int16_t temperature;        // Factor 0.1 deg C
+    uint16_t systemStatus;
+    uint16_t faultStatus;
+    byte valid;                 // BIC2200_SNAP_* Bits
+};
+
+//#################################################################################################
+//  Struct:         BIC2200Scale
+//  Description:    Integer Conversion of a raw Register Word into a fixed Point Unit 
+//                  (mV, mA or 0.1 deg C). Either mul or div is 1, so apply() costs one Multiply 
+//                  or one Divide and no float Math
+//#################################################################################################
+struct BIC2200Scale {
+    long mul;
+    long div;
+
+    long apply(long raw) const { return (div == 1) ? raw * mul : raw / div; }
+    long unapply(long value) const { return (div == 1) ? value / mul : value * div; }
+    static BIC2200Scale fromFactor(byte factor, byte unitFactor);
+};
+
+// MFR_* Registers of one Device, Texts joined from the 6 Byte Fragments without Padding
+struct BIC2200Identity {
+    char manufacturer[BIC2200_TEXT_LENGTH + 1];     // MFR_ID, "MEAN WELL"
+    char model[BIC2200_TEXT_LENGTH + 1];            // MFR_MODEL, e.g. "BIC-2200-48"
+    char serial[BIC2200_TEXT_LENGTH + 1];           // MFR_SERIAL
+    char date[7];                                   // MFR_DATE, YYMMDD
+    char location[4];                               // MFR_LOCATION
+    byte revision[6];                               // MFR_REVISION, Firmware per MCU, 0xFF = none
+    byte voltage;                                   // Model Variant 12, 24, 48 or 96 V; 0 = unknown
+    bool valid;                                     // all Registers read
+};
+
+// Setpoint Ranges of a Model Variant
+struct BIC2200ModelLimits {
+    byte voltage;               // nominal V, 0 = unknown Model
+    long voutMin;               // mV, VOUT_SET / REVERSE_VOUT_SET
+    long voutMax;
+    long ioutMax;               // mA, IOUT_SET / REVERSE_IOUT_SET
+};
+
+struct BIC2200CacheEntry {
+    unsigned int value;
+    bool valid;
+    unsigned long updatedAt;    // millis()
+    unsigned long ttl;          // ms
+};
+
+struct BIC2200CacheStats {
+    unsigned long hits;         // Reads served from the Cache
+    unsigned long misses;       // Reads that went to the Bus
+    unsigned long writes;       // Writes sent to the Bus
+    unsigned long skippedWrites; // Writes dropped because the Value was unchanged
+};
+
+// Counters of one Register, 16 Bit wide to save RAM (they wrap around)
+struct BIC2200RegisterStats {
+    unsigned int sent;          // Read Requests and Writes
+    unsigned int received;      // Replies matched to a Request
+    unsigned int timeouts;      // Requests without Reply
+    unsigned int mismatches;    // Replies with this Echo but no outstanding Request (late or stray)
+};
+
+struct BIC2200Stats {
+    unsigned long framesSent;       // Read Requests and Writes
+    unsigned long framesReceived;   // Frames taken from the Device Queue
+    unsigned long timeouts;
+    unsigned long mismatches;       // Replies whose Echo matched no outstanding Request or without Echo
+    unsigned long rttMin;           // us from Request sent to Reply received
+    unsigned long rttMax;
+    unsigned long rttSum;
+    unsigned long rttCount;
+    unsigned int histogram[BIC2200_STATS_BUCKETS];  // Bucket i = RTT in [i, i+1) * BIC2200_STATS_BUCKET_US
+    BIC2200RegisterStats registers[BIC2200_REGISTER_SLOTS];
+
+    unsigned long rttAverage() const { return rttCount ? rttSum / rttCount : 0; }
+};
+
+// Round Trip Estimate, Retries and degraded State of one Device
+struct BIC2200TimeoutStats {
+    unsigned long rtt;          // us, smoothed Round Trip Time, 0 = no Sample yet
+    unsigned long rttDeviation; // us, smoothed mean Deviation
+    unsigned long timeout;      // us, current Timeout incl. Backoff
+    unsigned long expired;      // Requests without Reply in Time, incl. Retries
+    unsigned long retries;      // Requests sent again after a Timeout
+    unsigned long recovered;    // Reads answered after a Retry
+    unsigned long failed;       // Reads given up after all Retries
+    unsigned long skipped;      // Reads failed at once because the Device is degraded
+    unsigned long degraded;     // Times the Device went degraded
+    unsigned long waitFixed;    // us CAN_REPLY_TIME + CAN_TIMEOUT would have waited for expired and skipped Requests
+    unsigned long waitActual;   // us waited for the expired Requests
+
+    long timeSaved() const { return (long)(waitFixed - waitActual); }
+};
+
+class BIC2200;
+
+// Called from poll() for every finished non-blocking Read
+typedef void (*BIC2200ReplyCallback)(BIC2200 & device, int reg, const byte * data, byte len, bool valid);
+
+struct BIC2200Transaction {
+    int reg;
+    byte state;
+    bool blocking;
+    byte len;
+    byte retries;               // Requests sent again after a Timeout
+    byte data[BIC2200_REPLY_BYTES];
+    unsigned int seq;
+    unsigned long sentAt;
+};
 
 
 class BIC2200 {
+    friend class BIC2200Bus;
 
 public:
+#ifdef ARDUINO
     int begin(int CS_Pin, byte CAN_Adress);
+#endif
+    int begin(BIC2200Bus & bus, byte CAN_Adress);
+    BIC2200Bus * getBus() { return _bus; }          // NULL = not attached
+    byte getAddress() { return _address; }
+
+    long readTemperatureDeci();         // 0.1 deg C
+    long readInputVoltageMilli();       // mV
+    long readOutputVoltageMilli();      // mV
+    long readOutputCurrentMilli();      // mA
 
+#if BIC2200_ENABLE_FLOAT
+    // Failed Reads: NAN for the signed Temperature and Current, -1.0 for the Voltages
     float readTemperature();
     float readInputVoltage();
     float readOutputVoltage();
     float readOutputCurrent();
+#endif
 
     void setSystemConfig(int config);
     int getSystemConfig();
@@ -83,16 +326,193 @@ public:
     int getDirection();
 
     int getSystemStatus();
+    int getFaultStatus();
     int getScalingFactors();
+    bool loadScalingFactors();
+    BIC2200Scale getScale(int reg);
+
+    BIC2200Snapshot readSnapshot();
+
+    // Typed Access generated from the Register Table in bic2200_registers.h
+    template <class R> bool read(typename R::type & value);
+    template <class R> void write(typename R::type value);
+    template <class R> long readScaled();
+    template <class R> void writeScaled(long value);
+
+    bool requestRead(int reg);
+    int poll();
+    int getResult(int reg, byte * data, int len);
+    bool isBusy();
+    void setPipelineDepth(byte depth);
+    void onReply(BIC2200ReplyCallback callback);
+    unsigned long readRegisters(const int * regs, byte count, unsigned int * values);
+
+    // Index of the per Register Tables (Cache, Stats, Log), all Registers except MFR_*
+    static int registerSlot(int reg);
+    static int slotRegister(byte slot);
+    static byte registerWidth(int reg);
+
+#if BIC2200_ENABLE_IDENTITY
+    bool identify();
+    const BIC2200Identity & getIdentity();
+    BIC2200ModelLimits getLimits();
+#endif
+    static byte modelVoltage(const char * model);
+    static BIC2200ModelLimits modelLimits(unsigned int voltage);
+
+#if BIC2200_ENABLE_CACHE
+    void enableCache(bool enable);
+    bool setCacheTTL(int reg, unsigned long ttl);
+    void invalidateCache();
+    void invalidateCache(int reg);
+    BIC2200CacheStats getCacheStats();
+    void resetCacheStats();
+#endif
+
+#if BIC2200_ENABLE_ADAPTIVE_TIMEOUT
+    void setAdaptiveTimeout(bool enable);
+    void setRetries(byte retries);
+    void setDegradeAfter(byte failures);
+    unsigned long getTimeout();
+    bool isDegraded();
+    BIC2200TimeoutStats getTimeoutStats();
+    void resetTimeoutStats();
+#endif
+
+#if BIC2200_ENABLE_STATS
+    const BIC2200Stats & getStats();
+    BIC2200RegisterStats getRegisterStats(int reg);
+    void resetStats();
+#endif
 
 private:
-	int _CS;
+    BIC2200Bus * _bus = NULL;
+    byte _address;
     unsigned long _CAN_ID_RECEIVE;
     unsigned long _CAN_ID_SEND;
 
-    int _getRegisterValue(int reg, byte * data);
+    BIC2200Transaction _transactions[BIC2200_MAX_PENDING] = {};
+    unsigned int _seq = 0;
+    byte _pipelineDepth = BIC2200_MAX_PENDING;
+    BIC2200ReplyCallback _replyCallback = NULL;
+
+    // Defaults match the 0.1 / 0.01 Factors of the Datasheet until loadScalingFactors() succeeds
+    BIC2200Scale _vinScale = { 100, 1 };
+    BIC2200Scale _voutScale = { 10, 1 };
+    BIC2200Scale _ioutScale = { 10, 1 };
+    BIC2200Scale _temperatureScale = { 1, 1 };
+
+    int _getRegisterValue(int reg, byte * data, int len);
     void _setRegisterValue(int reg, byte * data, int len);
 
+    int _queueRead(int reg, bool blocking);
+    int _findOldest(int reg, byte state);
+    void _sendRequest(BIC2200Transaction & transaction);
+    int _drainReplies();
+    bool _matchReply(const BIC2200Frame & frame);
+    int _takeResult(int slot, byte * data, int len, int needed);
+    static int _replyNeeded(int reg);
+    unsigned long _readBurst(const int * regs, byte count, byte * data, byte width);
+    void _applyScalingFactors(const byte * factors);
+    const BIC2200Scale & _scaleOf(byte scale);
+    long _readScaled(int reg, byte scale, bool isSigned);
+
+#if BIC2200_ENABLE_IDENTITY
+    BIC2200Identity _identity = {};
+#endif
+
+#if BIC2200_ENABLE_CACHE
+    bool _cacheEnabled = false;
+    bool _cacheInitialised = false;
+    BIC2200CacheEntry _cache[BIC2200_CACHE_REGISTERS];
+    BIC2200CacheStats _cacheStats = {};
+
+    BIC2200CacheEntry * _cacheEntry(int reg);
+    bool _cacheLookup(int reg, byte * data, int len);
+    bool _cacheIsCurrent(int reg, const byte * data, int len);
+    void _cacheStore(int reg, const byte * data, int len);
+#endif
+
+#if BIC2200_ENABLE_ADAPTIVE_TIMEOUT
+    bool _adaptive = true;
+    byte _retries = BIC2200_RETRIES;
+    byte _degradeAfter = BIC2200_DEGRADE_AFTER;
+    byte _backoff = 0;              // Timeout Doublings since the last RTT Sample
+    byte _failures = 0;             // Reads failed in a Row
+    bool _degraded = false;
+    unsigned long _probeAt = 0;     // millis() of the last Request while degraded
+    long _srtt = 0;                 // us * 8, 0 = no Sample yet
+    long _rttvar = 0;               // us * 4
+    BIC2200TimeoutStats _timeoutStats = {};
+
+    unsigned long _timeout();
+    bool _admit(BIC2200Transaction & transaction);
+    bool _expire(BIC2200Transaction & transaction, unsigned long timeout);
+    void _rttSample(const BIC2200Transaction & transaction, unsigned long rtt);
+#endif
+
+#if BIC2200_ENABLE_STATS
+    BIC2200Stats _stats = {};
+
+    void _statsSent(int reg);
+    void _statsReply(int reg, unsigned long rtt);
+    void _statsTimeout(int reg);
+    void _statsMismatch(int reg);
+#endif
+
 };
 
+template <class R>
+bool BIC2200::read(typename R::type & value) {
+    static_assert(R::access & BIC2200_READ, "Register is not readable");
+    byte data[R::width];
+    if (R::width > 2) {
+        // Replies may be shorter than the 6 Byte Registers
+        memset(data, 0, R::width);
+    }
+    if (!_getRegisterValue(R::cmd, data, R::width)) {
+        return false;
+    }
+    value = R::decode(data);
+    return true;
+}
+
+template <class R>
+void BIC2200::write(typename R::type value) {
+    static_assert(R::access & BIC2200_WRITE, "Register is not writable");
+    byte data[R::width];
+    R::encode(value, data);
+    _setRegisterValue(R::cmd, data, R::width);
+}
+
+template <class R>
+long BIC2200::readScaled() {
+    static_assert(R::scale != BIC2200_SCALE_NONE, "Register has no Scale");
+    static_assert(R::width == 2, "Scaled Registers are 16 Bit");
+    return _readScaled(R::cmd, R::scale, R::isSigned);
+}
+
+template <class R>
+void BIC2200::writeScaled(long value) {
+    static_assert(R::scale != BIC2200_SCALE_NONE, "Register has no Scale");
+    write<R>(_scaleOf(R::scale).unapply(value));
+}
+
+template <class R>
+void BIC2200Bus::broadcast(typename R::type value) {
+    static_assert(R::access & BIC2200_WRITE, "Register is not writable");
+    byte data[R::width];
+    R::encode(value, data);
+    broadcast(R::cmd, data, R::width);
+}
+
+template <class R>
+byte BIC2200Bus::broadcastVerified(typename R::type value) {
+    static_assert((R::access & BIC2200_RW) == BIC2200_RW, "Register is not read- and writable");
+    byte data[R::width];
+    R::encode(value, data);
+    broadcast(R::cmd, data, R::width);
+    return readBack(R::cmd, data, R::width);
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,332 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200_bus.h"
+#include "bic2200.h"
+#if BIC2200_ENABLE_TRACE
+#include "bic2200_trace.h"
+#endif
+
+#ifdef ARDUINO
+#include "bic2200_mcp2515.h"
+
+BIC2200Bus BIC2200DefaultBus;
+static BIC2200MCP2515Transport _defaultTransport;
+
+int BIC2200Bus::begin(int CS_Pin) {
+//#################################################################################################
+//  Function:       begin
+//  Access:         Public
+//  Input:          CS_Pin (int) Chip Select Pin of the MCP2515
+//  Output:         (int) 0 = CAN Initialisiation unsuccessfull; 1 = CAN Initialisiation successfull
+//  Description:    Starts the Bus on the MCP2515 of the global CAN Object. For further
+//                  MCP2515 use begin(transport) with an own BIC2200MCP2515Transport each
+//#################################################################################################
+    _defaultTransport.setPins(CS_Pin);
+    return begin(_defaultTransport);
+}
+#endif
+
+int BIC2200Bus::begin(BIC2200Transport & transport) {
+//#################################################################################################
+//  Function:       begin
+//  Access:         Public
+//  Input:          transport (BIC2200Transport &) CAN Controller and Clock of this Bus
+//  Output:         (int) 0 = CAN Initialisiation unsuccessfull; 1 = CAN Initialisiation successfull
+//  Description:    Initialises the Transport, which from now on hands every received Frame 
+//                  to dispatch()
+//#################################################################################################
+    _transport = &transport;
+    _started = (transport.begin(*this) == 1);
+    return _started ? 1 : 0;
+}
+
+bool BIC2200Bus::isStarted() {
+//#################################################################################################
+//  Function:       isStarted
+//  Access:         Public
+//  Input:          -
+//  Output:         (bool) true = CAN Controller is initialised
+//  Description:    Checks if begin() was successfull
+//#################################################################################################
+    return _started;
+}
+
+bool BIC2200Bus::attach(BIC2200 & device, byte CAN_Adress) {
+//#################################################################################################
+//  Function:       attach
+//  Access:         Public
+//  Input:          device (BIC2200 &) Device to serve
+//                  CAN_Adress (byte) [0x00 - 0x07] CAN Bus Adress of BIC-2200
+//  Output:         (bool) false = Adress invalid or already used; true = Device attached
+//  Description:    Registers a Device so its Replies get queued and poll() drives it
+//#################################################################################################
+    if (CAN_Adress >= BIC2200_MAX_DEVICES) {
+        return false;
+    }
+    if (_devices[CAN_Adress] != NULL && _devices[CAN_Adress] != &device) {
+        return false;
+    }
+    _queues[CAN_Adress].clear();
+    _devices[CAN_Adress] = &device;
+    return true;
+}
+
+void BIC2200Bus::detach(byte CAN_Adress) {
+//#################################################################################################
+//  Function:       detach
+//  Access:         Public
+//  Input:          CAN_Adress (byte) [0x00 - 0x07] CAN Bus Adress of BIC-2200
+//  Output:         -
+//  Description:    Removes a Device from the Bus
+//#################################################################################################
+    if (CAN_Adress < BIC2200_MAX_DEVICES) {
+        _devices[CAN_Adress] = NULL;
+    }
+}
+
+int BIC2200Bus::poll() {
+//#################################################################################################
+//  Function:       poll
+//  Access:         Public
+//  Input:          -
+//  Output:         (int) Number of Transactions finished during this Call on all Devices
+//  Description:    Drives the Transaction Engines of all attached Devices, so Reads to 
+//                  different Devices overlap on the Bus
+//#################################################################################################
+    int finished = 0;
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        if (_devices[i] != NULL) {
+            finished += _devices[i]->poll();
+        }
+    }
+    return finished;
+}
+
+bool BIC2200Bus::isBusy() {
+//#################################################################################################
+//  Function:       isBusy
+//  Access:         Public
+//  Input:          -
+//  Output:         (bool) true = at least one Device has outstanding Requests
+//  Description:    Checks all attached Devices for outstanding Requests
+//#################################################################################################
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        if (_devices[i] != NULL && _devices[i]->isBusy()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+byte BIC2200Bus::attachedMask() {
+//#################################################################################################
+//  Function:       attachedMask
+//  Access:         Public
+//  Input:          -
+//  Output:         (byte) Bit i set = Device with Adress i is attached
+//  Description:    Devices served by this Bus, e.g. to compare with the Result of readBack()
+//#################################################################################################
+    byte mask = 0;
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        if (_devices[i] != NULL) {
+            mask |= (1 << i);
+        }
+    }
+    return mask;
+}
+
+void BIC2200Bus::broadcast(int reg, const byte * data, byte len) {
+//#################################################################################################
+//  Function:       broadcast
+//  Access:         Public
+//  Input:          reg (int) writable Register
+//                  data (const byte *) Value to Write
+//                  len (byte) [1 - 6] Number of Data Bytes
+//  Output:         -
+//  Description:    Writes a Register of every BIC-2200 on the Bus with one Frame to
+//                  MSG_ID_BROADCAST, so all Units take the Value at the same Moment. The
+//                  Shadow Registers of the attached Devices are updated like by a Write
+//#################################################################################################
+    byte frame[8];
+
+    if (len > 6) {
+        len = 6;
+    }
+    frame[0] = lowByte(reg);
+    frame[1] = highByte(reg);
+    memcpy(frame + 2, data, len);
+    send(MSG_ID_BROADCAST, frame, len + 2);
+
+#if BIC2200_ENABLE_CACHE
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        if (_devices[i] != NULL) {
+            _devices[i]->_cacheStore(reg, data, len);
+        }
+    }
+#endif
+}
+
+byte BIC2200Bus::readBack(int reg, const byte * data, byte len) {
+//#################################################################################################
+//  Function:       readBack
+//  Access:         Public
+//  Input:          reg (int) Register to check
+//                  data (const byte *) expected Value
+//                  len (byte) [1 - 6] Number of Data Bytes
+//  Output:         (byte) Bit i set = Device with Adress i holds the Value
+//  Description:    Reads the Register of all attached Devices in one pipelined Burst, bypassing
+//                  the Shadow Cache, and compares it with the expected Value
+//#################################################################################################
+    int slots[BIC2200_MAX_DEVICES];
+    byte value[BIC2200_REPLY_BYTES];
+    byte confirmed = 0;
+    bool waiting = true;
+
+    if (len > BIC2200_REPLY_BYTES) {
+        len = BIC2200_REPLY_BYTES;
+    }
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        slots[i] = (_devices[i] != NULL) ? _devices[i]->_queueRead(reg, true) : -1;
+    }
+    while (waiting) {
+        poll();
+        waiting = false;
+        for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+            if (slots[i] < 0) {
+                continue;
+            }
+            byte state = _devices[i]->_transactions[slots[i]].state;
+            if (state == BIC2200_TX_QUEUED || state == BIC2200_TX_SENT) {
+                waiting = true;
+                continue;
+            }
+            memset(value, 0, sizeof(value));
+            if (_devices[i]->_takeResult(slots[i], value, len, BIC2200::_replyNeeded(reg)) && memcmp(value, data, len) == 0) {
+                confirmed |= (1 << i);
+            }
+            slots[i] = -1;
+        }
+    }
+    return confirmed;
+}
+
+void BIC2200Bus::send(unsigned long id, const byte * data, byte len) {
+//#################################################################################################
+//  Function:       send
+//  Access:         Public
+//  Input:          id (unsigned long) Extended CAN ID
+//                  data (const byte *) Frame Data
+//                  len (byte) [0 - 8] Number of Data Bytes
+//  Output:         -
+//  Description:    Sends one Extended Frame. A Trace records it before it is handed to the
+//                  Transport, so its Reply can not be recorded in front of it
+//#################################################################################################
+    BIC2200Frame frame;
+
+    if (_transport == NULL) {
+        return;
+    }
+    frame.id = id;
+    frame.len = (len > 8) ? 8 : len;
+    memcpy(frame.data, data, frame.len);
+#if BIC2200_ENABLE_TRACE
+    if (_trace != NULL) {
+        BIC2200_LOCK();
+        _trace->record(frame, true);
+        BIC2200_UNLOCK();
+    }
+#endif
+    _transport->send(frame);
+}
+
+bool BIC2200Bus::receive(byte CAN_Adress, BIC2200Frame & frame) {
+//#################################################################################################
+//  Function:       receive
+//  Access:         Public
+//  Input:          CAN_Adress (byte) [0x00 - 0x07] CAN Bus Adress of BIC-2200
+//                  frame (BIC2200Frame &) Destination of the received Frame
+//  Output:         (bool) false = Queue of the Device is empty; true = frame is valid
+//  Description:    Takes the oldest received Frame of one Device and notes the Time for the
+//                  Request Timeouts of all Devices
+//#################################################################################################
+    if (CAN_Adress >= BIC2200_MAX_DEVICES) {
+        return false;
+    }
+    if (_transport != NULL) {
+        _transport->service();
+    }
+    if (!_queues[CAN_Adress].pop(frame)) {
+        return false;
+    }
+    _lastReceiveAt = micros();
+    return true;
+}
+
+void BIC2200Bus::dispatch(const BIC2200Frame & frame) {
+//#################################################################################################
+//  Function:       dispatch
+//  Access:         Public (Transport, may be Interrupt Context)
+//  Input:          frame (const BIC2200Frame &) received Frame
+//  Output:         -
+//  Description:    Puts a received Reply into the Queue of the sending Device, other Frames
+//                  are dropped and counted in the Bus Stats. A Trace records all Frames
+//#################################################################################################
+#if BIC2200_ENABLE_TRACE
+    if (_trace != NULL) {
+        _trace->record(frame, false);
+    }
+#endif
+    ++_received;
+    unsigned long adress = frame.id - MSG_ID_CAN_RECEIVE_00;
+    if (adress >= BIC2200_MAX_DEVICES) {
+        ++_foreign;
+        return;
+    }
+    if (_devices[adress] == NULL) {
+        ++_unattached;
+        return;
+    }
+    if (!_queues[adress].push(frame)) {
+        ++_overflows;
+    }
+}
+
+BIC2200BusStats BIC2200Bus::getStats() {
+//#################################################################################################
+//  Function:       getStats
+//  Access:         Public
+//  Input:          -
+//  Output:         (BIC2200BusStats) Counters of dispatch()
+//  Description:    Shows Frames that never reached a Device: foreign IDs, Replies of not
+//                  attached Adresses and Queue Overflows
+//#################################################################################################
+    BIC2200BusStats stats;
+    BIC2200_LOCK();
+    stats.received = _received;
+    stats.foreign = _foreign;
+    stats.unattached = _unattached;
+    stats.overflows = _overflows;
+    BIC2200_UNLOCK();
+    return stats;
+}
+
+void BIC2200Bus::resetStats() {
+//#################################################################################################
+//  Function:       resetStats
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Sets the Counters of dispatch() to 0
+//#################################################################################################
+    BIC2200_LOCK();
+    _received = 0;
+    _foreign = 0;
+    _unattached = 0;
+    _overflows = 0;
+    BIC2200_UNLOCK();
+}
@@ -0,0 +1,98 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_BUS_H
+#define BIC2200_BUS_H
+
+#include "bic2200_platform.h"
+#include "bic2200_ringbuffer.h"
+#include "bic2200_transport.h"
+
+#define BIC2200_MAX_DEVICES         8   // CAN Adresses 0x00 - 0x07
+#define BIC2200_DEVICE_QUEUE_SIZE   4   // Received Frames per Device, must be a Power of 2
+
+#ifndef BIC2200_ENABLE_TRACE
+#define BIC2200_ENABLE_TRACE        1   // 0 = remove the Frame Trace Hooks of send() / dispatch()
+#endif
+
+class BIC2200;
+class BIC2200Trace;
+
+// Frames dispatch() could not hand to a Device
+struct BIC2200BusStats {
+    unsigned long received;     // Frames from the Transport
+    unsigned long foreign;      // Frames with an ID other than a Reply ID (other Masters, Broadcasts)
+    unsigned long unattached;   // Replies of an Adress without attached Device
+    unsigned long overflows;    // Replies dropped because the Queue of the Device was full
+};
+
+//#################################################################################################
+//  Class:          BIC2200Bus
+//  Description:    Owns the CAN Transport and serves all BIC-2200 on it. Received Frames are
+//                  sorted by Device Adress into one Queue per Device.
+//#################################################################################################
+class BIC2200Bus {
+
+public:
+    int begin(BIC2200Transport & transport);
+#ifdef ARDUINO
+    int begin(int CS_Pin);
+#endif
+    bool isStarted();
+
+    bool attach(BIC2200 & device, byte CAN_Adress);
+    void detach(byte CAN_Adress);
+
+    int poll();
+    bool isBusy();
+
+    byte attachedMask();
+
+    // Setpoints for the whole Rack in one Frame, readBack() confirms them per Device
+    void broadcast(int reg, const byte * data, byte len);
+    byte readBack(int reg, const byte * data, byte len);
+    template <class R> void broadcast(typename R::type value);
+    template <class R> byte broadcastVerified(typename R::type value);
+
+    void send(unsigned long id, const byte * data, byte len);
+    bool receive(byte CAN_Adress, BIC2200Frame & frame);
+    void dispatch(const BIC2200Frame & frame);
+
+#if BIC2200_ENABLE_TRACE
+    // Every sent and received Frame is handed to the Trace, NULL = off
+    void setTrace(BIC2200Trace * trace) { _trace = trace; }
+#endif
+
+    BIC2200BusStats getStats();
+    void resetStats();
+
+    unsigned long lastReceiveAt() { return _lastReceiveAt; }
+    unsigned long micros() { return _transport->micros(); }
+    unsigned long millis() { return _transport->millis(); }
+
+private:
+    bool _started = false;
+    BIC2200Transport * _transport = NULL;
+    unsigned long _lastReceiveAt = 0;   // micros() when a Frame was last taken from a Queue
+    BIC2200 * _devices[BIC2200_MAX_DEVICES] = {};
+    BIC2200RingBuffer<BIC2200_DEVICE_QUEUE_SIZE> _queues[BIC2200_MAX_DEVICES];
+    volatile unsigned long _received = 0;       // BIC2200BusStats, written by dispatch()
+    volatile unsigned long _foreign = 0;
+    volatile unsigned long _unattached = 0;
+    volatile unsigned long _overflows = 0;
+#if BIC2200_ENABLE_TRACE
+    BIC2200Trace * volatile _trace = NULL;
+#endif
+
+};
+
+#ifdef ARDUINO
+// Bus used by BIC2200::begin(CS_Pin, CAN_Adress)
+extern BIC2200Bus BIC2200DefaultBus;
+#endif
+
+#endif
@@ -0,0 +1,218 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200.h"
+
+#if BIC2200_ENABLE_CACHE
+
+// Default Time To Live of the Shadow Entries, in the Order of BIC2200::registerSlot()
+static const unsigned long _cacheDefaultTTL[BIC2200_CACHE_REGISTERS] = {
+    BIC2200_TTL_INFINITE,   // OPERATION
+    BIC2200_TTL_INFINITE,   // VOUT_SET
+    BIC2200_TTL_INFINITE,   // IOUT_SET
+    BIC2200_TTL_NEVER,      // FAULT_STATUS
+    BIC2200_TTL_NEVER,      // READ_VIN
+    BIC2200_TTL_NEVER,      // READ_VOUT
+    BIC2200_TTL_NEVER,      // READ_IOUT
+    BIC2200_TTL_NEVER,      // READ_TEMPERATURE_1
+    BIC2200_TTL_NEVER,      // SCALING_FACTOR, 6 Bytes do not fit an Entry, loadScalingFactors() keeps them
+    BIC2200_TTL_NEVER,      // SYSTEM_STATUS
+    BIC2200_TTL_INFINITE,   // SYSTEM_CONFIG
+    BIC2200_TTL_INFINITE,   // DIRECTION_CTRL
+    BIC2200_TTL_INFINITE,   // REVERSE_VOUT_SET
+    BIC2200_TTL_INFINITE,   // REVERSE_IOUT_SET
+    BIC2200_TTL_INFINITE    // BIDIRECTIONAL_CONFIG
+};
+
+void BIC2200::enableCache(bool enable) {
+//#################################################################################################
+//  Function:       enableCache
+//  Access:         Public
+//  Input:          enable (bool) true = serve Reads from the Shadow Registers; false = always Bus
+//  Output:         -
+//  Description:    Switches the write-through Register Shadow Cache on or off. Setpoints and
+//                  Config Registers are cached until written, Measurements are never cached
+//                  unless a TTL is set with setCacheTTL()
+//#################################################################################################
+    if (!_cacheInitialised) {
+        for (byte i = 0; i < BIC2200_CACHE_REGISTERS; i++) {
+            _cache[i].valid = false;
+            _cache[i].ttl = _cacheDefaultTTL[i];
+        }
+        _cacheInitialised = true;
+    }
+    if (!enable) {
+        invalidateCache();
+    }
+    _cacheEnabled = enable;
+}
+
+bool BIC2200::setCacheTTL(int reg, unsigned long ttl) {
+//#################################################################################################
+//  Function:       setCacheTTL
+//  Access:         Public
+//  Input:          reg (int) Register
+//                  ttl (unsigned long) ms a cached Value stays valid; BIC2200_TTL_NEVER or 
+//                      BIC2200_TTL_INFINITE
+//  Output:         (bool) false = Register has no Shadow Entry or is wider than 16 Bit;
+//                  true = TTL set
+//  Description:    Sets the Time To Live of one Shadow Register
+//#################################################################################################
+    if (!_cacheInitialised) {
+        enableCache(_cacheEnabled);
+    }
+    BIC2200CacheEntry * entry = _cacheEntry(reg);
+    if (entry == NULL || registerWidth(reg) > 2) {
+        return false;
+    }
+    entry->ttl = ttl;
+    return true;
+}
+
+void BIC2200::invalidateCache() {
+//#################################################################################################
+//  Function:       invalidateCache
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Drops all Shadow Values, e.g. after the Device was power cycled
+//#################################################################################################
+    for (byte i = 0; i < BIC2200_CACHE_REGISTERS; i++) {
+        _cache[i].valid = false;
+    }
+}
+
+void BIC2200::invalidateCache(int reg) {
+//#################################################################################################
+//  Function:       invalidateCache
+//  Access:         Public
+//  Input:          reg (int) Register
+//  Output:         -
+//  Description:    Drops the Shadow Value of one Register
+//#################################################################################################
+    BIC2200CacheEntry * entry = _cacheEntry(reg);
+    if (entry != NULL) {
+        entry->valid = false;
+    }
+}
+
+BIC2200CacheStats BIC2200::getCacheStats() {
+//#################################################################################################
+//  Function:       getCacheStats
+//  Access:         Public
+//  Input:          -
+//  Output:         (BIC2200CacheStats) Hit, Miss and Write Counters
+//  Description:    Shows how much Bus Traffic the Cache saves
+//#################################################################################################
+    return _cacheStats;
+}
+
+void BIC2200::resetCacheStats() {
+//#################################################################################################
+//  Function:       resetCacheStats
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Sets all Cache Counters to 0
+//#################################################################################################
+    _cacheStats = BIC2200CacheStats();
+}
+
+BIC2200CacheEntry * BIC2200::_cacheEntry(int reg) {
+//#################################################################################################
+//  Function:       _cacheEntry
+//  Access:         Private
+//  Input:          reg (int) Register
+//  Output:         (BIC2200CacheEntry *) NULL = Register has no Shadow Entry
+//  Description:    Finds the Shadow Entry of a Register
+//#################################################################################################
+    int slot = registerSlot(reg);
+    return (slot < 0) ? NULL : &_cache[slot];
+}
+
+bool BIC2200::_cacheLookup(int reg, byte * data, int len) {
+//#################################################################################################
+//  Function:       _cacheLookup
+//  Access:         Private
+//  Input:          reg (int) Register to Read
+//                  data (byte *) Pointer to a Byte Array where the data should be written to
+//                  len (int) Size of the data Array
+//  Output:         (bool) true = Hit, data Array is valid; false = Miss, Read must go to the Bus
+//  Description:    Serves a Read from the Shadow Register if its Value is still alive
+//#################################################################################################
+    if (!_cacheEnabled) {
+        return false;
+    }
+    BIC2200CacheEntry * entry = _cacheEntry(reg);
+    if (entry == NULL || entry->ttl == BIC2200_TTL_NEVER) {
+        return false;
+    }
+    if (!entry->valid || (entry->ttl != BIC2200_TTL_INFINITE && (_bus->millis() - entry->updatedAt) >= entry->ttl)) {
+        ++_cacheStats.misses;
+        return false;
+    }
+    if (len > 0) {
+        data[0] = lowByte(entry->value);
+    }
+    if (len > 1) {
+        data[1] = highByte(entry->value);
+    }
+    ++_cacheStats.hits;
+    return true;
+}
+
+bool BIC2200::_cacheIsCurrent(int reg, const byte * data, int len) {
+//#################################################################################################
+//  Function:       _cacheIsCurrent
+//  Access:         Private
+//  Input:          reg (int) Register to Write
+//                  data (const byte *) Value to Write
+//                  len (int) Number of Data Bytes
+//  Output:         (bool) true = Device already holds this Value, the Write can be skipped
+//  Description:    Compares a Write with the live Shadow Value of the Register
+//#################################################################################################
+    if (!_cacheEnabled || len > 2) {
+        return false;
+    }
+    BIC2200CacheEntry * entry = _cacheEntry(reg);
+    if (entry == NULL || entry->ttl == BIC2200_TTL_NEVER || !entry->valid) {
+        return false;
+    }
+    if (entry->ttl != BIC2200_TTL_INFINITE && (_bus->millis() - entry->updatedAt) >= entry->ttl) {
+        return false;
+    }
+    unsigned int value = (len > 1) ? ((data[1] << 8) + data[0]) : data[0];
+    if (value != entry->value) {
+        return false;
+    }
+    ++_cacheStats.skippedWrites;
+    return true;
+}
+
+void BIC2200::_cacheStore(int reg, const byte * data, int len) {
+//#################################################################################################
+//  Function:       _cacheStore
+//  Access:         Private
+//  Input:          reg (int) Register
+//                  data (const byte *) Value read from or written to the Device
+//                  len (int) Number of Data Bytes
+//  Output:         -
+//  Description:    Updates the Shadow Value of a Register after a Read Reply or a Write
+//#################################################################################################
+    if (!_cacheEnabled || len < 1 || len > 2) {
+        return;
+    }
+    BIC2200CacheEntry * entry = _cacheEntry(reg);
+    if (entry == NULL) {
+        return;
+    }
+    entry->value = (len > 1) ? ((data[1] << 8) + data[0]) : data[0];
+    entry->updatedAt = _bus->millis();
+    entry->valid = true;
+}
+
+#endif
@@ -0,0 +1,492 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200_dispatch.h"
+
+// Bits of BIC2200DispatchUnit::known
+#define KNOWN_IOUT          0x01
+#define KNOWN_REVERSE_IOUT  0x02
+#define KNOWN_DIRECTION     0x04
+
+void BIC2200Dispatcher::begin(BIC2200Scheduler & scheduler, BIC2200FaultWatch * watch, unsigned long period) {
+//#################################################################################################
+//  Function:       begin
+//  Access:         Public
+//  Input:          scheduler (BIC2200Scheduler &) started Scheduler the Polls are added to
+//                  watch (BIC2200FaultWatch *) Watch of the Units, NULL = Faults are not checked
+//                  period (unsigned long) ms between two READ_TEMPERATURE_1 / READ_VOUT Polls
+//  Output:         -
+//  Description:    Starts the Dispatcher without Units
+//#################################################################################################
+    _scheduler = &scheduler;
+    _watch = watch;
+    _period = period;
+    for (byte i = 0; i < BIC2200_DISPATCH_UNITS; i++) {
+        _units[i].device = NULL;
+    }
+}
+
+bool BIC2200Dispatcher::add(BIC2200 & device, long ioutMax) {
+//#################################################################################################
+//  Function:       add
+//  Access:         Public
+//  Input:          device (BIC2200 &) Unit attached to a Bus, with loaded Scaling Factors
+//                  ioutMax (long) mA Rating of the Unit, 0 = Limit of the identified Model
+//  Output:         (bool) false = Dispatcher full, Unit already added, Rating unknown or over
+//                  Bus Budget
+//  Description:    Adds the Temperature and VOUT Polls of a Unit at BIC2200_PRIORITY_DISPATCH
+//                  and reads IOUT_SET, REVERSE_IOUT_SET and DIRECTION_CTRL in one Burst, so the
+//                  first Dispatch already writes only what differs (blocking, call it in setup())
+//#################################################################################################
+    BIC2200DispatchUnit * slot = NULL;
+    const int regs[3] = { CMD_IOUT_SET, CMD_REVERSE_IOUT_SET, CMD_DIRECTION_CTRL };
+    unsigned int values[3];
+
+    if (_scheduler == NULL || device.getBus() == NULL || _find(device) != NULL) {
+        return false;
+    }
+#if BIC2200_ENABLE_IDENTITY
+    if (ioutMax == 0) {
+        ioutMax = device.getLimits().ioutMax;
+    }
+#endif
+    if (ioutMax <= 0) {
+        return false;
+    }
+    for (byte i = 0; i < BIC2200_DISPATCH_UNITS; i++) {
+        if (_units[i].device == NULL) {
+            slot = &_units[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        return false;
+    }
+    int temperatureEntry = _scheduler->add(device, CMD_READ_TEMPERATURE_1, _period, BIC2200_PRIORITY_DISPATCH);
+    if (temperatureEntry < 0) {
+        return false;
+    }
+    int voutEntry = _scheduler->add(device, CMD_READ_VOUT, _period, BIC2200_PRIORITY_DISPATCH);
+    if (voutEntry < 0) {
+        _scheduler->remove(temperatureEntry);
+        return false;
+    }
+    *slot = BIC2200DispatchUnit();
+    slot->device = &device;
+    slot->temperatureEntry = temperatureEntry;
+    slot->voutEntry = voutEntry;
+    slot->ioutMax = ioutMax;
+    slot->weight = BIC2200_DERATE_FULL;
+    unsigned long valid = device.readRegisters(regs, 3, values);
+    for (byte r = 0; r < 3; r++) {
+        if (valid & (1UL << r)) {
+            _store(*slot, regs[r], (regs[r] == CMD_DIRECTION_CTRL) ? (values[r] & 0x01) : values[r]);
+        }
+    }
+    return true;
+}
+
+void BIC2200Dispatcher::setDerating(int start, int end) {
+//#################################################################################################
+//  Function:       setDerating
+//  Access:         Public
+//  Input:          start (int) 0.1 deg C, READ_TEMPERATURE_1 up to which a Unit takes its full Share
+//                  end (int) 0.1 deg C from which a Unit takes no Share, linear in between
+//  Output:         -
+//  Description:    Sets the Temperature Derating of the Shares
+//#################################################################################################
+    if (end <= start) {
+        end = start + 1;
+    }
+    _derateStart = start;
+    _derateEnd = end;
+}
+
+void BIC2200Dispatcher::setVoltage(long voltage) {
+//#################################################################################################
+//  Function:       setVoltage
+//  Access:         Public
+//  Input:          voltage (long) mV of the DC Bus, e.g. from a Battery Monitor; 0 = Mean of the
+//                  polled READ_VOUT of the Units
+//  Output:         -
+//  Description:    Sets the Voltage the Power Target is converted to Current with
+//#################################################################################################
+    _voltage = voltage;
+}
+
+void BIC2200Dispatcher::setBroadcast(bool enable) {
+//#################################################################################################
+//  Function:       setBroadcast
+//  Access:         Public
+//  Input:          enable (bool) false = one Write per Unit only
+//  Output:         -
+//  Description:    A Broadcast reaches every BIC-2200 on the Wire, so it is only sent when all
+//                  attached Devices of the Bus are Units of this Dispatcher. Turn it off if the
+//                  Bus carries Units the Sketch has not attached
+//#################################################################################################
+    _broadcast = enable;
+}
+
+int BIC2200Dispatcher::dispatch(long power) {
+//#################################################################################################
+//  Function:       dispatch
+//  Access:         Public
+//  Input:          power (long) W, > 0 = Charge (AC->DC), < 0 = Discharge (DC->AC)
+//  Output:         (int) Frames sent, -1 = Voltage unknown (no VOUT Sample and no setVoltage())
+//  Description:    Splits the Current of the Target over the available Units by Rating and
+//                  Temperature Weight, clamped to their Sum. The new Direction's Current is
+//                  written before DIRECTION_CTRL, so a switching Unit never runs the old
+//                  Setpoint the other Way. 0 W keeps the Direction. Only Registers whose Value
+//                  changes are written, degraded Units are skipped and rewritten on Return
+//#################################################################################################
+    int regs[BIC2200_DISPATCH_UNITS];
+    unsigned int words[BIC2200_DISPATCH_UNITS];
+    byte directions[BIC2200_DISPATCH_UNITS];
+    int64_t capacity = 0;
+
+    if (_scheduler == NULL) {
+        return -1;
+    }
+    long voltage = (_voltage > 0) ? _voltage : _busVoltage();
+    if (voltage <= 0) {
+        return -1;
+    }
+    _usedVoltage = voltage;
+    ++_stats.dispatches;
+
+    for (byte i = 0; i < BIC2200_DISPATCH_UNITS; i++) {
+        BIC2200DispatchUnit & unit = _units[i];
+        regs[i] = 0;
+        if (unit.device == NULL) {
+            continue;
+        }
+#if BIC2200_ENABLE_ADAPTIVE_TIMEOUT
+        if (unit.device->isDegraded()) {
+            // Unit may have restarted with Defaults when it answers again
+            unit.known = 0;
+            unit.weight = 0;
+            unit.allocation = 0;
+            continue;
+        }
+#endif
+        unit.weight = _weightOf(unit);
+        capacity += (int64_t)unit.ioutMax * unit.weight / BIC2200_DERATE_FULL;
+        regs[i] = 1;
+    }
+
+    int64_t current = (int64_t)((power < 0) ? -power : power) * 1000000 / voltage;
+    if (current > capacity) {
+        current = capacity;
+        ++_stats.saturated;
+    }
+
+    for (byte i = 0; i < BIC2200_DISPATCH_UNITS; i++) {
+        BIC2200DispatchUnit & unit = _units[i];
+        if (regs[i] == 0) {
+            continue;
+        }
+        byte direction = (power < 0) ? 1 : 0;
+        long share = 0;
+        if (power == 0 || unit.weight == 0) {
+            direction = (unit.known & KNOWN_DIRECTION) ? unit.direction : 0;
+        }
+        if (unit.weight != 0 && capacity > 0) {
+            share = current * ((int64_t)unit.ioutMax * unit.weight / BIC2200_DERATE_FULL) / capacity;
+        }
+        BIC2200Scale scale = unit.device->getScale(CMD_IOUT_SET);
+        words[i] = scale.unapply(share);
+        unit.allocation = direction ? -scale.apply(words[i]) : scale.apply(words[i]);
+        regs[i] = direction ? CMD_REVERSE_IOUT_SET : CMD_IOUT_SET;
+        directions[i] = direction;
+    }
+    int frames = _writeStage(regs, words);
+
+    for (byte i = 0; i < BIC2200_DISPATCH_UNITS; i++) {
+        if (regs[i] != 0) {
+            regs[i] = CMD_DIRECTION_CTRL;
+            words[i] = directions[i];
+        }
+    }
+    frames += _writeStage(regs, words);
+    _stats.frames += frames;
+    return frames;
+}
+
+long BIC2200Dispatcher::getAllocated() {
+//#################################################################################################
+//  Function:       getAllocated
+//  Access:         Public
+//  Input:          -
+//  Output:         (long) W of the last Dispatch after Clamping and Register Resolution,
+//                  < 0 = Discharge
+//  Description:    Sum of the Unit Setpoints at the Voltage of the last Dispatch
+//#################################################################################################
+    int64_t current = 0;
+
+    for (byte i = 0; i < BIC2200_DISPATCH_UNITS; i++) {
+        if (_units[i].device != NULL) {
+            current += _units[i].allocation;
+        }
+    }
+    return (long)(current * _usedVoltage / 1000000);
+}
+
+long BIC2200Dispatcher::getAllocation(BIC2200 & device) {
+//#################################################################################################
+//  Function:       getAllocation
+//  Access:         Public
+//  Input:          device (BIC2200 &) Unit
+//  Output:         (long) mA of the last Dispatch, < 0 = Discharge, 0 = not added
+//  Description:    Setpoint of one Unit as written to IOUT_SET / REVERSE_IOUT_SET
+//#################################################################################################
+    BIC2200DispatchUnit * unit = _find(device);
+    return (unit != NULL) ? unit->allocation : 0;
+}
+
+unsigned int BIC2200Dispatcher::getWeight(BIC2200 & device) {
+//#################################################################################################
+//  Function:       getWeight
+//  Access:         Public
+//  Input:          device (BIC2200 &) Unit
+//  Output:         (unsigned int) Share / BIC2200_DERATE_FULL of the last Dispatch, 0 = out or
+//                  not added
+//  Description:    Temperature Weight of one Unit, 0 while faulted or degraded
+//#################################################################################################
+    BIC2200DispatchUnit * unit = _find(device);
+    return (unit != NULL) ? unit->weight : 0;
+}
+
+BIC2200DispatchStats BIC2200Dispatcher::getStats() {
+//#################################################################################################
+//  Function:       getStats
+//  Access:         Public
+//  Input:          -
+//  Output:         (BIC2200DispatchStats) Counters since the last resetStats()
+//  Description:    Frames, Broadcasts and skipped Writes of all Dispatches
+//#################################################################################################
+    return _stats;
+}
+
+void BIC2200Dispatcher::resetStats() {
+//#################################################################################################
+//  Function:       resetStats
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Sets all Counters to 0
+//#################################################################################################
+    _stats = BIC2200DispatchStats();
+}
+
+BIC2200DispatchUnit * BIC2200Dispatcher::_find(BIC2200 & device) {
+//#################################################################################################
+//  Function:       _find
+//  Access:         Private
+//  Input:          device (BIC2200 &) Device
+//  Output:         (BIC2200DispatchUnit *) NULL = Device not added
+//  Description:    Finds the Slot of a Unit
+//#################################################################################################
+    for (byte i = 0; i < BIC2200_DISPATCH_UNITS; i++) {
+        if (_units[i].device == &device) {
+            return &_units[i];
+        }
+    }
+    return NULL;
+}
+
+long BIC2200Dispatcher::_busVoltage() {
+//#################################################################################################
+//  Function:       _busVoltage
+//  Access:         Private
+//  Input:          -
+//  Output:         (long) mV, Mean of the polled READ_VOUT of all Units; 0 = no Sample yet
+//  Description:    The Units are paralleled on one DC Bus, so their Output Voltages only differ
+//                  by the Measurement Error
+//#################################################################################################
+    unsigned int value;
+    int64_t sum = 0;
+    byte count = 0;
+
+    for (byte i = 0; i < BIC2200_DISPATCH_UNITS; i++) {
+        BIC2200DispatchUnit & unit = _units[i];
+        if (unit.device != NULL && _scheduler->getValue(unit.voutEntry, value)) {
+            sum += unit.device->getScale(CMD_READ_VOUT).apply(value);
+            ++count;
+        }
+    }
+    return count ? (long)(sum / count) : 0;
+}
+
+unsigned int BIC2200Dispatcher::_weightOf(BIC2200DispatchUnit & unit) {
+//#################################################################################################
+//  Function:       _weightOf
+//  Access:         Private
+//  Input:          unit (BIC2200DispatchUnit &) Unit
+//  Output:         (unsigned int) 0 - BIC2200_DERATE_FULL
+//  Description:    0 while a Fault of BIC2200_DISPATCH_FAULTS is active, else the Derating of the
+//                  last polled Temperature. A Unit without Sample yet takes its full Share
+//#################################################################################################
+    unsigned int value;
+
+    if (_watch != NULL && (_watch->getFaults(*unit.device) & BIC2200_DISPATCH_FAULTS)) {
+        return 0;
+    }
+    if (!_scheduler->getValue(unit.temperatureEntry, value)) {
+        return BIC2200_DERATE_FULL;
+    }
+    long temperature = unit.device->getScale(CMD_READ_TEMPERATURE_1).apply((int16_t)value);
+    if (temperature <= _derateStart) {
+        return BIC2200_DERATE_FULL;
+    }
+    if (temperature >= _derateEnd) {
+        return 0;
+    }
+    return (unsigned int)((long)BIC2200_DERATE_FULL * (_derateEnd - temperature) / (_derateEnd - _derateStart));
+}
+
+int BIC2200Dispatcher::_writeStage(const int * regs, const unsigned int * words) {
+//#################################################################################################
+//  Function:       _writeStage
+//  Access:         Private
+//  Input:          regs (const int *) Register per Unit Slot, 0 = Unit not written
+//                  words (const unsigned int *) Value per Unit Slot
+//  Output:         (int) Frames sent
+//  Description:    Writes the Values the Units do not hold yet. If every attached Device of a
+//                  Bus is a written Unit with the same Register and Value and at least two of
+//                  them need it, one Broadcast replaces their Writes
+//#################################################################################################
+    bool done[BIC2200_DISPATCH_UNITS] = {};
+    int frames = 0;
+
+    for (byte i = 0; i < BIC2200_DISPATCH_UNITS; i++) {
+        if (_units[i].device == NULL || done[i]) {
+            continue;
+        }
+        BIC2200Bus * bus = _units[i].device->getBus();
+        byte group = 0;
+        byte needed = 0;
+        bool same = true;
+        for (byte j = i; j < BIC2200_DISPATCH_UNITS; j++) {
+            if (_units[j].device == NULL || _units[j].device->getBus() != bus) {
+                continue;
+            }
+            group |= (1 << _units[j].device->getAddress());
+            same = same && regs[j] != 0 && regs[j] == regs[i] && words[j] == words[i];
+            if (regs[j] != 0 && !_holds(_units[j], regs[j], words[j])) {
+                ++needed;
+            }
+        }
+
+        bool broadcast = _broadcast && same && needed >= 2 && group == bus->attachedMask();
+        if (broadcast) {
+            _send(NULL, bus, regs[i], words[i]);
+            ++_stats.broadcasts;
+            ++frames;
+        }
+        for (byte j = i; j < BIC2200_DISPATCH_UNITS; j++) {
+            BIC2200DispatchUnit & unit = _units[j];
+            if (unit.device == NULL || unit.device->getBus() != bus) {
+                continue;
+            }
+            done[j] = true;
+            if (regs[j] == 0) {
+                continue;
+            }
+            if (_holds(unit, regs[j], words[j])) {
+                ++_stats.unchanged;
+            } else if (!broadcast) {
+                _send(unit.device, NULL, regs[j], words[j]);
+                ++frames;
+            }
+            _store(unit, regs[j], words[j]);
+        }
+    }
+    return frames;
+}
+
+void BIC2200Dispatcher::_send(BIC2200 * device, BIC2200Bus * bus, int reg, unsigned int word) {
+//#################################################################################################
+//  Function:       _send
+//  Access:         Private
+//  Input:          device (BIC2200 *) Unit to write, NULL = Broadcast
+//                  bus (BIC2200Bus *) Bus of the Broadcast
+//                  reg (int) CMD_IOUT_SET, CMD_REVERSE_IOUT_SET or CMD_DIRECTION_CTRL
+//                  word (unsigned int) Value
+//  Output:         -
+//  Description:    Writes one Setpoint through the typed Register Accessors
+//#################################################################################################
+    switch (reg) {
+        case CMD_IOUT_SET:
+            if (device != NULL) {
+                device->write<BIC2200Reg::IoutSet>(word);
+            } else {
+                bus->broadcast<BIC2200Reg::IoutSet>(word);
+            }
+            break;
+        case CMD_REVERSE_IOUT_SET:
+            if (device != NULL) {
+                device->write<BIC2200Reg::ReverseIoutSet>(word);
+            } else {
+                bus->broadcast<BIC2200Reg::ReverseIoutSet>(word);
+            }
+            break;
+        case CMD_DIRECTION_CTRL:
+            if (device != NULL) {
+                device->write<BIC2200Reg::DirectionCtrl>(word);
+            } else {
+                bus->broadcast<BIC2200Reg::DirectionCtrl>(word);
+            }
+            break;
+    }
+}
+
+bool BIC2200Dispatcher::_holds(const BIC2200DispatchUnit & unit, int reg, unsigned int word) {
+//#################################################################################################
+//  Function:       _holds
+//  Access:         Private (static)
+//  Input:          unit (const BIC2200DispatchUnit &) Unit
+//                  reg (int) CMD_IOUT_SET, CMD_REVERSE_IOUT_SET or CMD_DIRECTION_CTRL
+//                  word (unsigned int) Value
+//  Output:         (bool) true = the Unit holds this Value, no Write needed
+//  Description:    Compares with the Setpoints read in add() or sent since
+//#################################################################################################
+    switch (reg) {
+        case CMD_IOUT_SET:
+            return (unit.known & KNOWN_IOUT) && unit.current[0] == word;
+        case CMD_REVERSE_IOUT_SET:
+            return (unit.known & KNOWN_REVERSE_IOUT) && unit.current[1] == word;
+        case CMD_DIRECTION_CTRL:
+            return (unit.known & KNOWN_DIRECTION) && unit.direction == word;
+    }
+    return false;
+}
+
+void BIC2200Dispatcher::_store(BIC2200DispatchUnit & unit, int reg, unsigned int word) {
+//#################################################################################################
+//  Function:       _store
+//  Access:         Private (static)
+//  Input:          unit (BIC2200DispatchUnit &) Unit
+//                  reg (int) CMD_IOUT_SET, CMD_REVERSE_IOUT_SET or CMD_DIRECTION_CTRL
+//                  word (unsigned int) Value the Unit holds now
+//  Output:         -
+//  Description:    Records a Setpoint of the Unit
+//#################################################################################################
+    switch (reg) {
+        case CMD_IOUT_SET:
+            unit.current[0] = word;
+            unit.known |= KNOWN_IOUT;
+            break;
+        case CMD_REVERSE_IOUT_SET:
+            unit.current[1] = word;
+            unit.known |= KNOWN_REVERSE_IOUT;
+            break;
+        case CMD_DIRECTION_CTRL:
+            unit.direction = word;
+            unit.known |= KNOWN_DIRECTION;
+            break;
+    }
+}
@@ -0,0 +1,100 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_DISPATCH_H
+#define BIC2200_DISPATCH_H
+
+#include "bic2200_scheduler.h"
+#include "bic2200_faultwatch.h"
+
+#ifndef BIC2200_DISPATCH_UNITS
+#define BIC2200_DISPATCH_UNITS      BIC2200_MAX_DEVICES     // Units of all Buses
+#endif
+#define BIC2200_DISPATCH_PERIOD     1000    // ms between two READ_TEMPERATURE_1 / READ_VOUT Polls
+#define BIC2200_PRIORITY_DISPATCH   64      // Scheduler Priority, below the Energy Meter
+#ifndef BIC2200_DISPATCH_FAULTS
+#define BIC2200_DISPATCH_FAULTS     BIC2200_FAULT_BITS      // FAULT_STATUS Bits taking a Unit out
+#endif
+#ifndef BIC2200_DERATE_START
+#define BIC2200_DERATE_START        500     // 0.1 deg C, full Share below
+#endif
+#ifndef BIC2200_DERATE_END
+#define BIC2200_DERATE_END          700     // 0.1 deg C, no Share above
+#endif
+#define BIC2200_DERATE_FULL         256     // Weight of a Unit below BIC2200_DERATE_START
+
+struct BIC2200DispatchStats {
+    unsigned long dispatches;
+    unsigned long frames;       // Writes and Broadcasts sent
+    unsigned long broadcasts;   // Broadcasts sent instead of one Write per Unit
+    unsigned long unchanged;    // Register Writes skipped, the Unit already held the Value
+    unsigned long saturated;    // Targets above the available Capacity, clamped
+};
+
+struct BIC2200DispatchUnit {
+    BIC2200 * device;           // NULL = Slot free
+    int temperatureEntry;       // Scheduler Entries
+    int voutEntry;
+    long ioutMax;               // mA, Rating of IOUT_SET / REVERSE_IOUT_SET
+    unsigned int current[2];    // IOUT_SET / REVERSE_IOUT_SET on the Device, raw
+    byte direction;             // DIRECTION_CTRL on the Device, 0 = AC->DC, 1 = DC->AC
+    byte known;                 // Bit 0 = IOUT_SET, Bit 1 = REVERSE_IOUT_SET, Bit 2 = Direction
+    unsigned int weight;        // Share / BIC2200_DERATE_FULL of the last Dispatch, 0 = out
+    long allocation;            // mA of the last Dispatch, < 0 = Discharge
+};
+
+//#################################################################################################
+//  Class:          BIC2200Dispatcher
+//  Description:    Splits one signed Power Target (W, > 0 = AC->DC Charge, < 0 = DC->AC
+//                  Discharge) over paralleled Units in Proportion to their Rating, derated by
+//                  Temperature. Faulted and degraded Units get no Share. The Dispatcher keeps
+//                  the Setpoints it sent, so a Dispatch only writes the Registers that change,
+//                  switches DIRECTION_CTRL only on a Sign Change and sends one Broadcast when all
+//                  Units of a Bus need the same Value. Temperature and VOUT come from the
+//                  Scheduler, Faults from an optional Fault Watch, so dispatch() never reads
+//#################################################################################################
+class BIC2200Dispatcher {
+
+public:
+    void begin(BIC2200Scheduler & scheduler, BIC2200FaultWatch * watch = NULL,
+        unsigned long period = BIC2200_DISPATCH_PERIOD);
+    bool add(BIC2200 & device, long ioutMax = 0);
+    void setDerating(int start, int end);
+    void setVoltage(long voltage);
+    void setBroadcast(bool enable);
+
+    int dispatch(long power);
+
+    long getAllocated();
+    long getAllocation(BIC2200 & device);
+    unsigned int getWeight(BIC2200 & device);
+    BIC2200DispatchStats getStats();
+    void resetStats();
+
+private:
+    BIC2200Scheduler * _scheduler = NULL;
+    BIC2200FaultWatch * _watch = NULL;
+    unsigned long _period = BIC2200_DISPATCH_PERIOD;
+    int _derateStart = BIC2200_DERATE_START;
+    int _derateEnd = BIC2200_DERATE_END;
+    long _voltage = 0;          // mV, 0 = Mean of the polled VOUT
+    long _usedVoltage = 0;      // mV of the last Dispatch
+    bool _broadcast = true;
+    BIC2200DispatchUnit _units[BIC2200_DISPATCH_UNITS] = {};
+    BIC2200DispatchStats _stats = {};
+
+    BIC2200DispatchUnit * _find(BIC2200 & device);
+    long _busVoltage();
+    unsigned int _weightOf(BIC2200DispatchUnit & unit);
+    int _writeStage(const int * regs, const unsigned int * words);
+    void _send(BIC2200 * device, BIC2200Bus * bus, int reg, unsigned int word);
+    static bool _holds(const BIC2200DispatchUnit & unit, int reg, unsigned int word);
+    static void _store(BIC2200DispatchUnit & unit, int reg, unsigned int word);
+
+};
+
+#endif
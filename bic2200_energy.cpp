@@ -0,0 +1,282 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200_energy.h"
+
+// Bits of BIC2200MeteredDevice::known
+#define KNOWN_VOUT          0x01
+#define KNOWN_IOUT          0x02
+#define KNOWN_DIRECTION     0x04
+
+void BIC2200EnergyMeter::begin(BIC2200Scheduler & scheduler, unsigned long period, unsigned long directionPeriod) {
+//#################################################################################################
+//  Function:       begin
+//  Access:         Public
+//  Input:          scheduler (BIC2200Scheduler &) started Scheduler the Polls are added to
+//                  period (unsigned long) ms between two VOUT / IOUT Polls of a Device
+//                  directionPeriod (unsigned long) ms between two DIRECTION_CTRL Polls, bounds
+//                  the Time counted for the wrong Direction after a Switch
+//  Output:         -
+//  Description:    Starts the Meter without Devices
+//#################################################################################################
+    _scheduler = &scheduler;
+    _period = period;
+    _directionPeriod = directionPeriod;
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        _devices[i].device = NULL;
+    }
+}
+
+bool BIC2200EnergyMeter::meter(BIC2200 & device) {
+//#################################################################################################
+//  Function:       meter
+//  Access:         Public
+//  Input:          device (BIC2200 &) Device to meter, attached to the Bus of the Scheduler,
+//                  with loaded Scaling Factors
+//  Output:         (bool) false = Meter full, Device already metered or over Bus Budget
+//  Description:    Adds the VOUT, IOUT and DIRECTION_CTRL Polls of a Device at
+//                  BIC2200_PRIORITY_ENERGY. Counting starts with the second IOUT Sample
+//#################################################################################################
+    BIC2200MeteredDevice * slot = NULL;
+
+    if (_scheduler == NULL || _find(device) != NULL) {
+        return false;
+    }
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        if (_devices[i].device == NULL) {
+            slot = &_devices[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        return false;
+    }
+    int directionEntry = _scheduler->add(device, CMD_DIRECTION_CTRL, _directionPeriod, BIC2200_PRIORITY_ENERGY);
+    if (directionEntry < 0) {
+        return false;
+    }
+    int voutEntry = _scheduler->add(device, CMD_READ_VOUT, _period, BIC2200_PRIORITY_ENERGY);
+    if (voutEntry < 0) {
+        _scheduler->remove(directionEntry);
+        return false;
+    }
+    int ioutEntry = _scheduler->add(device, CMD_READ_IOUT, _period, BIC2200_PRIORITY_ENERGY);
+    if (ioutEntry < 0) {
+        _scheduler->remove(directionEntry);
+        _scheduler->remove(voutEntry);
+        return false;
+    }
+    *slot = BIC2200MeteredDevice();
+    slot->device = &device;
+    slot->voutEntry = voutEntry;
+    slot->ioutEntry = ioutEntry;
+    slot->directionEntry = directionEntry;
+    return true;
+}
+
+int BIC2200EnergyMeter::run() {
+//#################################################################################################
+//  Function:       run
+//  Access:         Public
+//  Input:          -
+//  Output:         (int) Number of IOUT Samples integrated during this Call
+//  Description:    Runs the Scheduler (call it instead of scheduler.run()) and integrates the
+//                  new Samples. Next to a Fault Watch call watch.run() and then update()
+//#################################################################################################
+    if (_scheduler == NULL) {
+        return 0;
+    }
+    _scheduler->run();
+    return update();
+}
+
+int BIC2200EnergyMeter::update() {
+//#################################################################################################
+//  Function:       update
+//  Access:         Public
+//  Input:          -
+//  Output:         (int) Number of IOUT Samples integrated during this Call
+//  Description:    Takes the new Samples of the Scheduler without running it. Direction and
+//                  VOUT are taken first, so an IOUT Sample is paired with the latest Voltage
+//#################################################################################################
+    unsigned int value;
+    int integrated = 0;
+
+    if (_scheduler == NULL) {
+        return 0;
+    }
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        BIC2200MeteredDevice & metered = _devices[i];
+        if (metered.device == NULL || metered.ioutEntry < 0) {
+            continue;
+        }
+        unsigned long count = _scheduler->getSamples(metered.directionEntry);
+        if (count != metered.directionSamples && _scheduler->getValue(metered.directionEntry, value)) {
+            metered.directionSamples = count;
+            metered.direction = (value & 0x01) ? BIC2200_DISCHARGE : BIC2200_CHARGE;
+            metered.known |= KNOWN_DIRECTION;
+        }
+        count = _scheduler->getSamples(metered.voutEntry);
+        if (count != metered.voutSamples && _scheduler->getValue(metered.voutEntry, value)) {
+            metered.voutSamples = count;
+            metered.voltage = metered.device->getScale(CMD_READ_VOUT).apply(value);
+            metered.known |= KNOWN_VOUT;
+        }
+        count = _scheduler->getSamples(metered.ioutEntry);
+        if (count == metered.ioutSamples || !_scheduler->getValue(metered.ioutEntry, value)) {
+            continue;
+        }
+        metered.ioutSamples = count;
+        if ((metered.known & (KNOWN_VOUT | KNOWN_DIRECTION)) != (KNOWN_VOUT | KNOWN_DIRECTION)) {
+            continue;
+        }
+        long current = metered.device->getScale(CMD_READ_IOUT).apply((int16_t)value);
+        unsigned long before = metered.samples;
+        _integrate(metered, (current < 0) ? -current : current, _scheduler->getUpdatedAt(metered.ioutEntry));
+        integrated += metered.samples - before;
+    }
+    return integrated;
+}
+
+bool BIC2200EnergyMeter::addSample(BIC2200 & device, long voltage, long current, byte direction, unsigned long at) {
+//#################################################################################################
+//  Function:       addSample
+//  Access:         Public
+//  Input:          device (BIC2200 &) Device of the Sample, metered or not
+//                  voltage (long) mV, e.g. from a Snapshot converted with getScale()
+//                  current (long) mA, the Magnitude is counted
+//                  direction (byte) BIC2200_CHARGE / BIC2200_DISCHARGE
+//                  at (unsigned long) micros() of the Sample
+//  Output:         (bool) false = Meter full
+//  Description:    Integrates a Sample taken by the Sketch (e.g. readSnapshot()) without
+//                  Scheduler Polls. A Device not metered yet gets a Slot without Polls
+//#################################################################################################
+    BIC2200MeteredDevice * metered = _find(device);
+
+    if (metered == NULL) {
+        for (byte i = 0; i < BIC2200_MAX_DEVICES && metered == NULL; i++) {
+            if (_devices[i].device == NULL) {
+                metered = &_devices[i];
+                *metered = BIC2200MeteredDevice();
+                metered->device = &device;
+                metered->voutEntry = -1;
+                metered->ioutEntry = -1;
+                metered->directionEntry = -1;
+            }
+        }
+        if (metered == NULL) {
+            return false;
+        }
+    }
+    metered->voltage = voltage;
+    metered->direction = direction ? BIC2200_DISCHARGE : BIC2200_CHARGE;
+    metered->known |= KNOWN_VOUT | KNOWN_DIRECTION;
+    _integrate(*metered, (current < 0) ? -current : current, at);
+    return true;
+}
+
+BIC2200EnergyTotals BIC2200EnergyMeter::getTotals(BIC2200 & device) {
+//#################################################################################################
+//  Function:       getTotals
+//  Access:         Public
+//  Input:          device (BIC2200 &) metered Device
+//  Output:         (BIC2200EnergyTotals) mWh, mAh and Time per Direction, all 0 = not metered
+//  Description:    Converts the Accumulators, the 64 Bit Divisions only run here. Energy Unit
+//                  2^20 pJ -> mWh: * 2^20 / 3.6e12 = * 4096 / 14062500000, split so the
+//                  Product can not overflow
+//#################################################################################################
+    BIC2200EnergyTotals totals = {};
+    BIC2200MeteredDevice * metered = _find(device);
+    const int64_t energyPerMilliWh = 14062500000LL;
+    const int64_t chargePerMilliAh = 7200000000LL;  // 2 * 3.6e9 mA * us
+
+    if (metered == NULL) {
+        return totals;
+    }
+    for (byte d = 0; d < 2; d++) {
+        int64_t energy = metered->energy[d];
+        totals.energy[d] = energy / energyPerMilliWh * 4096 + energy % energyPerMilliWh * 4096 / energyPerMilliWh;
+        totals.charge[d] = metered->charge[d] / chargePerMilliAh;
+        totals.time[d] = metered->time[d] / 1000;
+    }
+    totals.samples = metered->samples;
+    totals.gaps = metered->gaps;
+    return totals;
+}
+
+void BIC2200EnergyMeter::reset(BIC2200 & device) {
+//#################################################################################################
+//  Function:       reset
+//  Access:         Public
+//  Input:          device (BIC2200 &) metered Device
+//  Output:         -
+//  Description:    Sets the Counters to 0, the next Interval is counted from the last Sample
+//#################################################################################################
+    BIC2200MeteredDevice * metered = _find(device);
+
+    if (metered == NULL) {
+        return;
+    }
+    for (byte d = 0; d < 2; d++) {
+        metered->energy[d] = 0;
+        metered->fraction[d] = 0;
+        metered->charge[d] = 0;
+        metered->time[d] = 0;
+    }
+    metered->samples = 0;
+    metered->gaps = 0;
+}
+
+BIC2200MeteredDevice * BIC2200EnergyMeter::_find(BIC2200 & device) {
+//#################################################################################################
+//  Function:       _find
+//  Access:         Private
+//  Input:          device (BIC2200 &) Device
+//  Output:         (BIC2200MeteredDevice *) NULL = Device not metered
+//  Description:    Finds the Meter Slot of a Device
+//#################################################################################################
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        if (_devices[i].device == &device) {
+            return &_devices[i];
+        }
+    }
+    return NULL;
+}
+
+void BIC2200EnergyMeter::_integrate(BIC2200MeteredDevice & metered, long current, unsigned long at) {
+//#################################################################################################
+//  Function:       _integrate
+//  Access:         Private
+//  Input:          metered (BIC2200MeteredDevice &) Slot with Voltage and Direction of the Sample
+//                  current (long) mA, Magnitude
+//                  at (unsigned long) micros() of the Sample
+//  Output:         -
+//  Description:    Adds the Trapezoid from the previous Sample: (P0 + P1) * dt in 2 pJ and
+//                  (I0 + I1) * dt in mA * us / 2. The Energy Fraction below the Unit is carried
+//                  to the next Sample, so the Sum is exact. Two 64 Bit Multiplies, no Division
+//#################################################################################################
+    int64_t power = (int64_t)metered.voltage * current;
+    unsigned long dt = at - metered.sampledAt;
+
+    if (metered.known & KNOWN_IOUT) {
+        if (dt > BIC2200_ENERGY_MAX_GAP * 1000UL) {
+            ++metered.gaps;
+        } else {
+            byte d = metered.direction;
+            uint64_t area = (uint64_t)(metered.power + power) * dt + metered.fraction[d];
+            metered.energy[d] += area >> BIC2200_ENERGY_SHIFT;
+            metered.fraction[d] = area & BIC2200_ENERGY_FRACTION;
+            metered.charge[d] += (int64_t)(metered.current + current) * dt;
+            metered.time[d] += dt;
+            ++metered.samples;
+        }
+    }
+    metered.power = power;
+    metered.current = current;
+    metered.sampledAt = at;
+    metered.known |= KNOWN_IOUT;
+}
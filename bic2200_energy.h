@@ -0,0 +1,96 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_ENERGY_H
+#define BIC2200_ENERGY_H
+
+#include "bic2200_scheduler.h"
+
+#define BIC2200_ENERGY_PERIOD       20      // ms between two VOUT / IOUT Polls (50 Hz)
+#define BIC2200_DIRECTION_PERIOD    100     // ms between two DIRECTION_CTRL Polls
+#define BIC2200_PRIORITY_ENERGY     128     // Scheduler Priority, below the Fault Watch
+#ifndef BIC2200_ENERGY_MAX_GAP
+#define BIC2200_ENERGY_MAX_GAP      1000    // ms, longer Intervals between two IOUT Samples are not integrated
+#endif
+#if BIC2200_ENERGY_MAX_GAP > 200000
+#error "BIC2200_ENERGY_MAX_GAP: the Trapezoid of 2 * 130 V * 150 A over the Gap must fit 63 Bit"
+#endif
+
+// Energy Accumulator Unit: 2^20 pJ (mV * mA * us / 2^21 of the doubled Trapezoid). A Power of
+// Two keeps the Carry of the Fraction a Shift instead of a 64 Bit Division per Sample
+#define BIC2200_ENERGY_SHIFT        21
+#define BIC2200_ENERGY_FRACTION     ((1UL << BIC2200_ENERGY_SHIFT) - 1)
+
+#define BIC2200_CHARGE              0       // Index of the Totals: AC->DC, DIRECTION_CTRL = 0
+#define BIC2200_DISCHARGE           1       // DC->AC, DIRECTION_CTRL = 1
+
+// Counters of one Device per Direction, Index BIC2200_CHARGE / BIC2200_DISCHARGE
+struct BIC2200EnergyTotals {
+    int64_t energy[2];          // mWh
+    int64_t charge[2];          // mAh
+    uint64_t time[2];           // ms integrated, 32 Bit would wrap after 49.7 Days
+    unsigned long samples;      // IOUT Samples integrated
+    unsigned long gaps;         // Intervals longer than BIC2200_ENERGY_MAX_GAP, skipped
+};
+
+struct BIC2200MeteredDevice {
+    BIC2200 * device;           // NULL = Slot free
+    int voutEntry;              // Scheduler Entries
+    int ioutEntry;
+    int directionEntry;
+    unsigned long voutSamples;  // Sample Count of the last evaluated Value
+    unsigned long ioutSamples;
+    unsigned long directionSamples;
+    unsigned long sampledAt;    // micros() of the previous IOUT Sample
+    long voltage;               // mV, last VOUT Sample
+    long current;               // mA, previous IOUT Sample, Magnitude
+    int64_t power;              // mV * mA (uW), previous Sample
+    byte direction;             // BIC2200_CHARGE / BIC2200_DISCHARGE
+    byte known;                 // Bit 0 = VOUT, Bit 1 = IOUT, Bit 2 = Direction sampled
+    int64_t energy[2];          // 2^20 pJ
+    unsigned long fraction[2];  // 2^-21 of the Energy Unit
+    int64_t charge[2];          // mA * us / 2 (Trapezoid doubled)
+    uint64_t time[2];           // us
+    unsigned long samples;
+    unsigned long gaps;
+};
+
+//#################################################################################################
+//  Class:          BIC2200EnergyMeter
+//  Description:    Counts the Energy (Wh) and Charge (Ah) of several Devices per Direction on
+//                  the Device. VOUT and IOUT are polled through the Scheduler at the Telemetry
+//                  Rate, every new IOUT Sample adds the Trapezoid of Power and Current since the
+//                  previous one in 64 Bit fixed Point, so nothing is lost to Rounding however
+//                  long the Meter runs. The Direction comes from DIRECTION_CTRL, the Interval
+//                  counts for the Direction valid at its End
+//#################################################################################################
+class BIC2200EnergyMeter {
+
+public:
+    void begin(BIC2200Scheduler & scheduler, unsigned long period = BIC2200_ENERGY_PERIOD,
+        unsigned long directionPeriod = BIC2200_DIRECTION_PERIOD);
+    bool meter(BIC2200 & device);
+
+    int run();
+    int update();
+    bool addSample(BIC2200 & device, long voltage, long current, byte direction, unsigned long at);
+
+    BIC2200EnergyTotals getTotals(BIC2200 & device);
+    void reset(BIC2200 & device);
+
+private:
+    BIC2200Scheduler * _scheduler = NULL;
+    unsigned long _period = BIC2200_ENERGY_PERIOD;
+    unsigned long _directionPeriod = BIC2200_DIRECTION_PERIOD;
+    BIC2200MeteredDevice _devices[BIC2200_MAX_DEVICES] = {};
+
+    BIC2200MeteredDevice * _find(BIC2200 & device);
+    void _integrate(BIC2200MeteredDevice & metered, long current, unsigned long at);
+
+};
+
+#endif
@@ -0,0 +1,220 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200_faultwatch.h"
+
+void BIC2200FaultWatch::begin(BIC2200Scheduler & scheduler, unsigned long faultPeriod, unsigned long statusPeriod) {
+//#################################################################################################
+//  Function:       begin
+//  Access:         Public
+//  Input:          scheduler (BIC2200Scheduler &) started Scheduler the Polls are added to
+//                  faultPeriod (unsigned long) ms between two FAULT_STATUS Polls of a Device
+//                  statusPeriod (unsigned long) ms between two SYSTEM_STATUS Polls of a Device
+//  Output:         -
+//  Description:    Starts the Watch without Devices. The Fault Period bounds the Detection
+//                  Latency and costs 8.8 % of a 250 kbit/s Bus per Device at 10 ms, see
+//                  BIC2200Scheduler::loadOf()
+//#################################################################################################
+    _scheduler = &scheduler;
+    _faultPeriod = faultPeriod;
+    _statusPeriod = statusPeriod;
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        _devices[i].device = NULL;
+    }
+}
+
+bool BIC2200FaultWatch::watch(BIC2200 & device) {
+//#################################################################################################
+//  Function:       watch
+//  Access:         Public
+//  Input:          device (BIC2200 &) Device to watch, attached to the Bus of the Scheduler
+//  Output:         (bool) false = Watch full, Device already watched or over Bus Budget
+//  Description:    Adds the FAULT_STATUS and SYSTEM_STATUS Polls of a Device at
+//                  BIC2200_PRIORITY_FAULT. The first Sample is the Baseline: its active Bits
+//                  are reported to the Callback, but counted as initial, not as Edges
+//#################################################################################################
+    BIC2200WatchedDevice * slot = NULL;
+
+    if (_scheduler == NULL || _find(device) != NULL) {
+        return false;
+    }
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        if (_devices[i].device == NULL) {
+            slot = &_devices[i];
+            break;
+        }
+    }
+    if (slot == NULL) {
+        return false;
+    }
+    int faultEntry = _scheduler->add(device, CMD_FAULT_STATUS, _faultPeriod, BIC2200_PRIORITY_FAULT);
+    if (faultEntry < 0) {
+        return false;
+    }
+    int statusEntry = _scheduler->add(device, CMD_SYSTEM_STATUS, _statusPeriod, BIC2200_PRIORITY_FAULT);
+    if (statusEntry < 0) {
+        _scheduler->remove(faultEntry);
+        return false;
+    }
+    *slot = BIC2200WatchedDevice();
+    slot->device = &device;
+    slot->faultEntry = faultEntry;
+    slot->statusEntry = statusEntry;
+    return true;
+}
+
+void BIC2200FaultWatch::onEvent(BIC2200EventCallback callback) {
+//#################################################################################################
+//  Function:       onEvent
+//  Access:         Public
+//  Input:          callback (BIC2200EventCallback) Function called for every Bit Change, NULL = off
+//  Output:         -
+//  Description:    Registers the Edge Callback
+//#################################################################################################
+    _callback = callback;
+}
+
+int BIC2200FaultWatch::run() {
+//#################################################################################################
+//  Function:       run
+//  Access:         Public
+//  Input:          -
+//  Output:         (int) Number of Events reported during this Call
+//  Description:    Runs the Scheduler (call it instead of scheduler.run()) and compares every
+//                  new FAULT_STATUS and SYSTEM_STATUS Sample with the previous one
+//#################################################################################################
+    int events = 0;
+
+    if (_scheduler == NULL) {
+        return 0;
+    }
+    _scheduler->run();
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        BIC2200WatchedDevice & watched = _devices[i];
+        if (watched.device == NULL) {
+            continue;
+        }
+        events += _check(watched, watched.faultEntry, watched.faultSamples, watched.faultAt,
+            watched.fault, watched.faultKnown, BIC2200_FAULT_BITS, 0);
+        events += _check(watched, watched.statusEntry, watched.statusSamples, watched.statusAt,
+            watched.status, watched.statusKnown, BIC2200_STATUS_BITS, 16);
+    }
+    return events;
+}
+
+unsigned int BIC2200FaultWatch::getFaults(BIC2200 & device) {
+//#################################################################################################
+//  Function:       getFaults
+//  Access:         Public
+//  Input:          device (BIC2200 &) watched Device
+//  Output:         (unsigned int) last FAULT_STATUS, 0 = not watched or no Sample yet
+//  Description:    Fault Bits as seen by the Watch, without Bus Access
+//#################################################################################################
+    BIC2200WatchedDevice * watched = _find(device);
+    return (watched != NULL) ? watched->fault : 0;
+}
+
+unsigned int BIC2200FaultWatch::getStatus(BIC2200 & device) {
+//#################################################################################################
+//  Function:       getStatus
+//  Access:         Public
+//  Input:          device (BIC2200 &) watched Device
+//  Output:         (unsigned int) last SYSTEM_STATUS, 0 = not watched or no Sample yet
+//  Description:    System Status Bits as seen by the Watch, without Bus Access
+//#################################################################################################
+    BIC2200WatchedDevice * watched = _find(device);
+    return (watched != NULL) ? watched->status : 0;
+}
+
+BIC2200FaultWatchStats BIC2200FaultWatch::getStats() {
+//#################################################################################################
+//  Function:       getStats
+//  Access:         Public
+//  Input:          -
+//  Output:         (BIC2200FaultWatchStats) Event Count and Detection Latency Bounds
+//  Description:    Shows how fast Changes are detected
+//#################################################################################################
+    return _stats;
+}
+
+void BIC2200FaultWatch::resetStats() {
+//#################################################################################################
+//  Function:       resetStats
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Sets the Event Count and Latency Bounds to 0
+//#################################################################################################
+    _stats = BIC2200FaultWatchStats();
+}
+
+BIC2200WatchedDevice * BIC2200FaultWatch::_find(BIC2200 & device) {
+//#################################################################################################
+//  Function:       _find
+//  Access:         Private
+//  Input:          device (BIC2200 &) Device
+//  Output:         (BIC2200WatchedDevice *) NULL = Device not watched
+//  Description:    Finds the Watch Slot of a Device
+//#################################################################################################
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        if (_devices[i].device == &device) {
+            return &_devices[i];
+        }
+    }
+    return NULL;
+}
+
+int BIC2200FaultWatch::_check(BIC2200WatchedDevice & watched, int entry, unsigned long & samples,
+    unsigned long & sampledAt, unsigned int & value, bool & known, unsigned int bits, byte offset) {
+//#################################################################################################
+//  Function:       _check
+//  Access:         Private
+//  Input:          watched (BIC2200WatchedDevice &) Device
+//                  entry (int) Scheduler Entry of the Register
+//                  samples, sampledAt, value, known: State of the Register in the Watch Slot
+//                  bits (unsigned int) defined Bits of the Register
+//                  offset (byte) Event Number of Bit 0
+//  Output:         (int) Number of Events reported
+//  Description:    Reports the changed Bits of a new Sample. Nothing is done without new Sample
+//                  and the Bits of the first Sample stay out of the Edge and Latency Stats
+//#################################################################################################
+    unsigned long count = _scheduler->getSamples(entry);
+    unsigned int sample;
+    int events = 0;
+
+    if (count == samples || !_scheduler->getValue(entry, sample)) {
+        return 0;
+    }
+    samples = count;
+    unsigned long now = _scheduler->getUpdatedAt(entry);
+    bool first = !known;
+    unsigned long latency = first ? 0 : now - sampledAt;
+    unsigned int changed = (first ? sample : (sample ^ value)) & bits;
+    sampledAt = now;
+    value = sample;
+    known = true;
+
+    for (byte bit = 0; changed != 0; bit++, changed >>= 1) {
+        if (!(changed & 1)) {
+            continue;
+        }
+        ++events;
+        if (first) {
+            ++_stats.initial;
+        } else {
+            ++_stats.events;
+            _stats.latencySum += latency;
+            if (latency > _stats.latencyMax) {
+                _stats.latencyMax = latency;
+            }
+        }
+        if (_callback != NULL) {
+            _callback(*watched.device, (BIC2200Event)(bit + offset), (sample >> bit) & 1, latency);
+        }
+    }
+    return events;
+}
@@ -0,0 +1,79 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_FAULTWATCH_H
+#define BIC2200_FAULTWATCH_H
+
+#include "bic2200_scheduler.h"
+
+#define BIC2200_FAULT_PERIOD        10      // ms between two FAULT_STATUS Polls
+#define BIC2200_STATUS_PERIOD       100     // ms between two SYSTEM_STATUS Polls
+#define BIC2200_PRIORITY_FAULT      255     // Scheduler Priority of the Watch, above all Telemetry
+
+// Called once per changed Bit. latency = us since the previous Sample without the Change,
+// an upper Bound of the Time the Change was on the Device before it was detected. Bits already
+// active at the first Sample are reported with latency 0
+typedef void (*BIC2200EventCallback)(BIC2200 & device, BIC2200Event event, bool active, unsigned long latency);
+
+struct BIC2200FaultWatchStats {
+    unsigned long events;       // Edges reported, without the Bits of the first Sample
+    unsigned long latencyMax;   // us, worst Detection Bound
+    unsigned long latencySum;   // us over all events
+    unsigned long initial;      // Bits already active at the first Sample, no Edge, no Latency
+};
+
+struct BIC2200WatchedDevice {
+    BIC2200 * device;           // NULL = Slot free
+    int faultEntry;             // Scheduler Entries
+    int statusEntry;
+    unsigned long faultSamples; // Sample Count of the last evaluated Value
+    unsigned long statusSamples;
+    unsigned long faultAt;      // micros() of the last evaluated Sample
+    unsigned long statusAt;
+    unsigned int fault;
+    unsigned int status;
+    bool faultKnown;
+    bool statusKnown;
+};
+
+//#################################################################################################
+//  Class:          BIC2200FaultWatch
+//  Description:    Polls FAULT_STATUS and SYSTEM_STATUS of several Devices through the Scheduler
+//                  at the highest Priority and reports every Bit Change as Event. The Watch is
+//                  admitted against the Bus Budget like any other Entry, so it can not starve
+//                  the Telemetry: lower Priorities are shed instead of missing Deadlines.
+//#################################################################################################
+class BIC2200FaultWatch {
+
+public:
+    void begin(BIC2200Scheduler & scheduler, unsigned long faultPeriod = BIC2200_FAULT_PERIOD,
+        unsigned long statusPeriod = BIC2200_STATUS_PERIOD);
+    bool watch(BIC2200 & device);
+    void onEvent(BIC2200EventCallback callback);
+
+    int run();
+
+    unsigned int getFaults(BIC2200 & device);
+    unsigned int getStatus(BIC2200 & device);
+    BIC2200FaultWatchStats getStats();
+    void resetStats();
+
+private:
+    BIC2200Scheduler * _scheduler = NULL;
+    unsigned long _faultPeriod = BIC2200_FAULT_PERIOD;
+    unsigned long _statusPeriod = BIC2200_STATUS_PERIOD;
+    BIC2200EventCallback _callback = NULL;
+    BIC2200WatchedDevice _devices[BIC2200_MAX_DEVICES] = {};
+    BIC2200FaultWatchStats _stats = {};
+
+    BIC2200WatchedDevice * _find(BIC2200 & device);
+    int _check(BIC2200WatchedDevice & watched, int entry, unsigned long & samples,
+        unsigned long & sampledAt, unsigned int & value, bool & known, unsigned int bits, byte offset);
+
+};
+
+#endif
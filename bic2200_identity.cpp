@@ -0,0 +1,144 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200.h"
+
+// Setpoint Ranges of the Model Variants
+// Source: https://www.meanwell.com/upload/pdf/bic-2200-e.pdf
+static const BIC2200ModelLimits _modelLimits[] = {
+    { 12, 10000L,  15000L,  150000L },
+    { 24, 19000L,  28000L,  84000L },
+    { 48, 38000L,  65000L,  45000L },
+    { 96, 76000L,  130000L, 22500L }
+};
+
+#if BIC2200_ENABLE_IDENTITY
+
+// Registers of identify(), in the Order of the Burst
+static const int _identityRegisters[] = {
+    CMD_SCALING_FACTOR,
+    CMD_MFR_ID_B0B5,
+    CMD_MFR_ID_B6B11,
+    CMD_MFR_MODEL_B0B5,
+    CMD_MFR_MODEL_B6B11,
+    CMD_MFR_REVISION_B0B5,
+    CMD_MFR_LOCATION_B0B2,
+    CMD_MFR_DATE_B0B5,
+    CMD_MFR_SERIAL_B0B5,
+    CMD_MFR_SERIAL_B6B11
+};
+#define BIC2200_IDENTITY_REGISTERS  (sizeof(_identityRegisters) / sizeof(_identityRegisters[0]))
+
+static void _joinText(char * text, const byte * data, byte len) {
+//#################################################################################################
+//  Function:       _joinText
+//  Access:         Private (File)
+//  Input:          text (char *) len + 1 Characters
+//                  data (const byte *) Register Bytes, B0 first
+//                  len (byte) Number of Bytes
+//  Output:         -
+//  Description:    Copies a MFR_* Text and strips the Padding (Spaces, 0x00 and 0xFF)
+//#################################################################################################
+    byte end = 0;
+    for (byte i = 0; i < len; i++) {
+        text[i] = data[i];
+        if (data[i] != ' ' && data[i] != 0x00 && data[i] != 0xFF) {
+            end = i + 1;
+        }
+    }
+    text[end] = '\0';
+}
+
+bool BIC2200::identify() {
+//#################################################################################################
+//  Function:       identify
+//  Access:         Public
+//  Input:          -
+//  Output:         (bool) false = at least one Register did not answer; true = Identity valid
+//  Description:    Reads all nine MFR_* Registers and the Scaling Factors in one pipelined
+//                  Burst (~10 Frame Times instead of 10 Round Trips), keeps the joined Texts
+//                  and detects the Model Variant, so Scales and Limits need no Configuration
+//#################################################################################################
+    byte data[BIC2200_IDENTITY_REGISTERS * 6];
+
+    unsigned long valid = _readBurst(_identityRegisters, BIC2200_IDENTITY_REGISTERS, data, 6);
+    _identity = BIC2200Identity();
+    if (valid & 0x001) {
+        _applyScalingFactors(&data[0]);
+    }
+    _joinText(_identity.manufacturer, &data[6], BIC2200_TEXT_LENGTH);
+    _joinText(_identity.model, &data[18], BIC2200_TEXT_LENGTH);
+    memcpy(_identity.revision, &data[30], 6);
+    _joinText(_identity.location, &data[36], 3);
+    _joinText(_identity.date, &data[42], 6);
+    _joinText(_identity.serial, &data[48], BIC2200_TEXT_LENGTH);
+    _identity.voltage = modelVoltage(_identity.model);
+    _identity.valid = (valid == (1UL << BIC2200_IDENTITY_REGISTERS) - 1);
+    return _identity.valid;
+}
+
+const BIC2200Identity & BIC2200::getIdentity() {
+//#################################################################################################
+//  Function:       getIdentity
+//  Access:         Public
+//  Input:          -
+//  Output:         (const BIC2200Identity &) Result of the last identify(), empty before
+//  Description:    Cached Identity, no Bus Access
+//#################################################################################################
+    return _identity;
+}
+
+BIC2200ModelLimits BIC2200::getLimits() {
+//#################################################################################################
+//  Function:       getLimits
+//  Access:         Public
+//  Input:          -
+//  Output:         (BIC2200ModelLimits) Setpoint Ranges of the identified Model, all 0 = unknown
+//  Description:    Limits of this Device after identify()
+//#################################################################################################
+    return modelLimits(_identity.voltage);
+}
+
+#endif
+
+byte BIC2200::modelVoltage(const char * model) {
+//#################################################################################################
+//  Function:       modelVoltage
+//  Access:         Public (static)
+//  Input:          model (const char *) MFR_MODEL Text, e.g. "BIC-2200-48" or "BIC-2200-24CAN"
+//  Output:         (byte) 12, 24, 48 or 96; 0 = not a known BIC-2200 Variant
+//  Description:    Takes the Number behind "2200-" as nominal Output Voltage
+//#################################################################################################
+    const char * p = strstr(model, "2200-");
+    unsigned int voltage = 0;
+
+    if (p == NULL) {
+        return 0;
+    }
+    for (p += 5; *p >= '0' && *p <= '9' && voltage < 1000; p++) {
+        voltage = voltage * 10 + (*p - '0');
+    }
+    return modelLimits(voltage).voltage;
+}
+
+BIC2200ModelLimits BIC2200::modelLimits(unsigned int voltage) {
+//#################################################################################################
+//  Function:       modelLimits
+//  Access:         Public (static)
+//  Input:          voltage (unsigned int) nominal Output Voltage of the Variant, only exact
+//                  Ratings match (a parsed 268 is not 12)
+//  Output:         (BIC2200ModelLimits) Setpoint Ranges, all 0 = unknown Variant
+//  Description:    Looks the Variant up in the Datasheet Table
+//#################################################################################################
+    for (byte i = 0; i < sizeof(_modelLimits) / sizeof(_modelLimits[0]); i++) {
+        if (_modelLimits[i].voltage == voltage) {
+            return _modelLimits[i];
+        }
+    }
+    BIC2200ModelLimits unknown = {};
+    return unknown;
+}
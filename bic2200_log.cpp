@@ -0,0 +1,366 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200_log.h"
+
+static_assert(BIC2200_LOG_BLOCK <= 255, "BIC2200_LOG_BLOCK must fit the Length Byte");
+static_assert(BIC2200_LOG_BYTES >= 2 * (BIC2200_LOG_HEADER + BIC2200_LOG_BLOCK),
+    "BIC2200_LOG_BYTES must hold the open and one closed Block");
+
+void BIC2200Log::begin(BIC2200Bus & bus) {
+//#################################################################################################
+//  Function:       begin
+//  Access:         Public
+//  Input:          bus (BIC2200Bus &) Bus whose millis() timestamps the Samples
+//  Output:         -
+//  Description:    Starts an empty Log
+//#################################################################################################
+    _bus = &bus;
+    clear();
+    resetStats();
+}
+
+bool BIC2200Log::log(byte address, int reg, unsigned int value) {
+//#################################################################################################
+//  Function:       log
+//  Access:         Public
+//  Input:          address (byte) CAN Address of the Device (0..7)
+//                  reg (int) Register the Word was read from, see BIC2200::registerSlot()
+//                  value (unsigned int) raw Register Word
+//  Output:         (bool) false = Register or Address can not be logged
+//  Description:    Appends one Sample. When the Ring is full the oldest Block is dropped, so
+//                  flush() often enough for the Sample Rate (see available())
+//#################################################################################################
+    if (_bus == NULL) {
+        ++_stats.rejected;
+        return false;
+    }
+    return _log(address, reg, value, _bus->millis());
+}
+
+byte BIC2200Log::logSnapshot(byte address, const BIC2200Snapshot & snapshot) {
+//#################################################################################################
+//  Function:       logSnapshot
+//  Access:         Public
+//  Input:          address (byte) CAN Address of the Device (0..7)
+//                  snapshot (const BIC2200Snapshot &) Result of BIC2200::readSnapshot()
+//  Output:         (byte) Number of Words logged
+//  Description:    Logs the valid Values of a Snapshot, they share one Timestamp
+//#################################################################################################
+    static const int regs[] = {
+        CMD_READ_VIN,
+        CMD_READ_VOUT,
+        CMD_READ_IOUT,
+        CMD_READ_TEMPERATURE_1,
+        CMD_SYSTEM_STATUS,
+        CMD_FAULT_STATUS
+    };
+    const unsigned int values[] = {
+        snapshot.vin,
+        snapshot.vout,
+        (uint16_t)snapshot.iout,
+        (uint16_t)snapshot.temperature,
+        snapshot.systemStatus,
+        snapshot.faultStatus
+    };
+    byte count = 0;
+
+    if (_bus == NULL) {
+        return 0;
+    }
+    unsigned long now = _bus->millis();
+    for (byte i = 0; i < 6; i++) {
+        if ((snapshot.valid & (1 << i)) && _log(address, regs[i], values[i], now)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+size_t BIC2200Log::flush(Print & out, bool all) {
+//#################################################################################################
+//  Function:       flush
+//  Access:         Public
+//  Input:          out (Print &) Serial, SD File or any other Print
+//                  all (bool) false = only closed Blocks; true = close and write the open Block too
+//  Output:         (size_t) Bytes written
+//  Description:    Writes whole Blocks and frees their Space. Writing only closed Blocks keeps
+//                  the Blocks full; use all = true before a Power Down or File Close
+//#################################################################################################
+    size_t written = 0;
+
+    if (all) {
+        _closeBlock();
+    }
+    while (_used > 0 && !(_blockOpen && _tail == _blockStart)) {
+        size_t size = _blockSize(_tail);
+        size_t first = (size < BIC2200_LOG_BYTES - _tail) ? size : BIC2200_LOG_BYTES - _tail;
+        size_t n = out.write(&_ring[_tail], first);
+        if (size > first) {
+            n += out.write(_ring, size - first);
+        }
+        _stats.flushed += n;
+        _stats.lost += size - n;
+        written += n;
+        _tail = (_tail + size) % BIC2200_LOG_BYTES;
+        _used -= size;
+    }
+    return written;
+}
+
+void BIC2200Log::clear() {
+//#################################################################################################
+//  Function:       clear
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Discards all Blocks, the next Sample starts a new Block
+//#################################################################################################
+    _tail = 0;
+    _used = 0;
+    _blockLen = 0;
+    _blockOpen = false;
+}
+
+size_t BIC2200Log::available() {
+//#################################################################################################
+//  Function:       available
+//  Access:         Public
+//  Input:          -
+//  Output:         (size_t) Bytes flush() would write now
+//  Description:    Size of all closed Blocks
+//#################################################################################################
+    return _blockOpen ? _used - BIC2200_LOG_HEADER - _blockLen : _used;
+}
+
+BIC2200LogStats BIC2200Log::getStats() {
+//#################################################################################################
+//  Function:       getStats
+//  Access:         Public
+//  Input:          -
+//  Output:         (BIC2200LogStats) Sample and Byte Counters
+//  Description:    bytes / samples is the encoded Size per Sample
+//#################################################################################################
+    return _stats;
+}
+
+void BIC2200Log::resetStats() {
+//#################################################################################################
+//  Function:       resetStats
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Sets all Counters to 0
+//#################################################################################################
+    _stats = BIC2200LogStats();
+}
+
+bool BIC2200Log::_log(byte address, int reg, unsigned int value, unsigned long now) {
+//#################################################################################################
+//  Function:       _log
+//  Access:         Private
+//  Input:          address, reg, value: see log()
+//                  now (unsigned long) ms Timestamp of the Sample
+//  Output:         (bool) false = Register or Address can not be logged
+//  Description:    Encodes the Sample against the Reference of its Device and Register, starts
+//                  a new Block when the open one is full
+//#################################################################################################
+    int slot = BIC2200::registerSlot(reg);
+    byte record[BIC2200_LOG_RECORD_MAX];
+
+    if (slot < 0 || address > 7) {
+        ++_stats.rejected;
+        return false;
+    }
+    byte key = (address << 4) | slot;
+    if (!_blockOpen) {
+        _openBlock(now);
+    }
+    int index = _findKey(key);
+    byte len = _encode(record, key, now, value, index);
+    if (_blockLen + len > BIC2200_LOG_BLOCK) {
+        _closeBlock();
+        _openBlock(now);
+        index = -1;
+        len = _encode(record, key, now, value, index);
+    }
+    _makeRoom(len);
+    _append(record, len);
+    _blockLen += len;
+    _time = now;
+
+    if (index < 0) {
+        if (_keyCount < BIC2200_LOG_KEYS) {
+            index = _keyCount++;
+        } else {
+            index = _nextKey;
+            _nextKey = (_nextKey + 1) % BIC2200_LOG_KEYS;
+        }
+        _keys[index].key = key;
+    }
+    _keys[index].value = value;
+    ++_stats.samples;
+    _stats.bytes += len;
+    return true;
+}
+
+
+int BIC2200Log::_findKey(byte key) {
+//#################################################################################################
+//  Function:       _findKey
+//  Access:         Private
+//  Input:          key (byte) Record Header without Time Bit
+//  Output:         (int) -1 = no Reference in this Block; else Index into _keys
+//  Description:    Looks up the previous Word of a Device / Register Pair
+//#################################################################################################
+    for (byte i = 0; i < _keyCount; i++) {
+        if (_keys[i].key == key) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+byte BIC2200Log::_encode(byte * record, byte key, unsigned long now, unsigned int value, int index) {
+//#################################################################################################
+//  Function:       _encode
+//  Access:         Private
+//  Input:          record (byte *) BIC2200_LOG_RECORD_MAX Bytes for the Record
+//                  key (byte) Record Header without Time Bit
+//                  now (unsigned long) ms of the Sample
+//                  value (unsigned int) raw Register Word
+//                  index (int) Reference from _findKey(), -1 = store absolute
+//  Output:         (byte) Length of the Record
+//  Description:    Encodes without changing the Log State. The Delta is taken modulo 2^16 and
+//                  ZigZag mapped, so small Steps in both Directions need one Byte
+//#################################################################################################
+    byte len = 1;
+    unsigned long field;
+
+    record[0] = key;
+    if (now != _time) {
+        record[0] |= BIC2200_LOG_TIME;
+        len += _putVarint(&record[len], now - _time);
+    }
+    if (index < 0) {
+        field = ((unsigned long)(uint16_t)value << 1) | 1;
+    } else {
+        int16_t delta = (int16_t)(uint16_t)(value - _keys[index].value);
+        uint16_t zigzag = (uint16_t)((uint16_t)delta << 1) ^ (uint16_t)-(delta < 0);
+        field = (unsigned long)zigzag << 1;
+    }
+    len += _putVarint(&record[len], field);
+    return len;
+}
+
+byte BIC2200Log::_putVarint(byte * out, unsigned long value) {
+//#################################################################################################
+//  Function:       _putVarint
+//  Access:         Private (static)
+//  Input:          out (byte *) up to 5 Bytes
+//                  value (unsigned long) Number to encode
+//  Output:         (byte) Bytes written
+//  Description:    7 Bits per Byte, lowest first, Bit 7 set = more Bytes follow
+//#################################################################################################
+    byte len = 0;
+    while (value >= 0x80) {
+        out[len++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[len++] = value;
+    return len;
+}
+
+void BIC2200Log::_openBlock(unsigned long now) {
+//#################################################################################################
+//  Function:       _openBlock
+//  Access:         Private
+//  Input:          now (unsigned long) ms of the first Sample
+//  Output:         -
+//  Description:    Appends a Block Header and forgets all Delta References
+//#################################################################################################
+    byte header[BIC2200_LOG_HEADER] = {
+        BIC2200_LOG_MAGIC, 0,
+        (byte)now, (byte)(now >> 8), (byte)(now >> 16), (byte)(now >> 24)
+    };
+
+    _makeRoom(BIC2200_LOG_HEADER);
+    _blockStart = (_tail + _used) % BIC2200_LOG_BYTES;
+    _append(header, BIC2200_LOG_HEADER);
+    _blockLen = 0;
+    _blockOpen = true;
+    _time = now;
+    _keyCount = 0;
+    _nextKey = 0;
+    _stats.bytes += BIC2200_LOG_HEADER;
+}
+
+void BIC2200Log::_closeBlock() {
+//#################################################################################################
+//  Function:       _closeBlock
+//  Access:         Private
+//  Input:          -
+//  Output:         -
+//  Description:    Writes the Record Length into the Header of the open Block, so flush() can
+//                  take it. An empty Block is removed
+//#################################################################################################
+    if (!_blockOpen) {
+        return;
+    }
+    if (_blockLen == 0) {
+        _used -= BIC2200_LOG_HEADER;
+        _stats.bytes -= BIC2200_LOG_HEADER;
+    } else {
+        _ring[(_blockStart + 1) % BIC2200_LOG_BYTES] = _blockLen;
+    }
+    _blockOpen = false;
+}
+
+void BIC2200Log::_makeRoom(size_t bytes) {
+//#################################################################################################
+//  Function:       _makeRoom
+//  Access:         Private
+//  Input:          bytes (size_t) Space needed at the Head
+//  Output:         -
+//  Description:    Drops the oldest closed Blocks until the Space is free. The open Block is
+//                  never dropped, the static_assert above guarantees it fits
+//#################################################################################################
+    while (BIC2200_LOG_BYTES - _used < bytes && _used > 0 && !(_blockOpen && _tail == _blockStart)) {
+        size_t size = _blockSize(_tail);
+        _tail = (_tail + size) % BIC2200_LOG_BYTES;
+        _used -= size;
+        ++_stats.dropped;
+    }
+}
+
+void BIC2200Log::_append(const byte * data, size_t len) {
+//#################################################################################################
+//  Function:       _append
+//  Access:         Private
+//  Input:          data (const byte *) Bytes to store
+//                  len (size_t) Number of Bytes, Space was made by _makeRoom()
+//  Output:         -
+//  Description:    Copies Bytes to the Head of the Ring
+//#################################################################################################
+    size_t head = (_tail + _used) % BIC2200_LOG_BYTES;
+    for (size_t i = 0; i < len; i++) {
+        _ring[head] = data[i];
+        head = (head + 1) % BIC2200_LOG_BYTES;
+    }
+    _used += len;
+}
+
+size_t BIC2200Log::_blockSize(size_t start) {
+//#################################################################################################
+//  Function:       _blockSize
+//  Access:         Private
+//  Input:          start (size_t) Ring Index of a closed Block
+//  Output:         (size_t) Bytes of the Block incl. Header
+//  Description:    Reads the Length Byte of the Block Header
+//#################################################################################################
+    return BIC2200_LOG_HEADER + _ring[(start + 1) % BIC2200_LOG_BYTES];
+}
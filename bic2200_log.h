@@ -0,0 +1,100 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_LOG_H
+#define BIC2200_LOG_H
+
+#include "bic2200.h"
+
+#ifndef BIC2200_LOG_BYTES
+#define BIC2200_LOG_BYTES       256     // RAM Ring for encoded Blocks
+#endif
+#ifndef BIC2200_LOG_BLOCK
+#define BIC2200_LOG_BLOCK       120     // max. Record Bytes of one Block
+#endif
+#ifndef BIC2200_LOG_KEYS
+#define BIC2200_LOG_KEYS        24      // Device / Register Pairs with a Delta Reference (3 Byte each)
+#endif
+
+// Stream Format, all Values Little Endian:
+//   Block  = BIC2200_LOG_MAGIC, Record Bytes (1), Start Time ms (4), Records
+//   Record = Header (1), [Time Delta ms (Varint)], Value (Varint)
+//   Header = Bit 7: Time Delta follows, Bit 6..4: Device Address, Bit 3..0: Register Slot
+//   Value  = (Word << 1) | 1 absolute, ZigZag(Word - previous Word) << 1 as Delta
+// Every Block starts without References, so Blocks decode on their own and a dropped Block
+// loses nothing but its own Samples
+#define BIC2200_LOG_MAGIC       0xB2
+#define BIC2200_LOG_HEADER      6       // Bytes in Front of the Records of a Block
+#define BIC2200_LOG_RECORD_MAX  9       // Header + 5 Byte Time Delta + 3 Byte Value
+#define BIC2200_LOG_TIME        0x80
+#define BIC2200_LOG_ADDRESS(h)  (((h) >> 4) & 0x07)
+#define BIC2200_LOG_SLOT(h)     ((h) & 0x0F)
+
+struct BIC2200LogStats {
+    unsigned long samples;      // Words accepted by log()
+    unsigned long rejected;     // Words of Registers without Slot or Addresses above 7
+    unsigned long bytes;        // encoded Bytes incl. Block Headers
+    unsigned long flushed;      // Bytes handed to Print
+    unsigned long dropped;      // Blocks overwritten before they were flushed
+    unsigned long lost;         // Bytes Print did not take
+};
+
+struct BIC2200LogKey {
+    byte key;                   // Header without Time Bit
+    unsigned int value;         // previous Word
+};
+
+//#################################################################################################
+//  Class:          BIC2200Log
+//  Description:    Compact binary Telemetry Log. Raw Register Words are stored as Deltas to the
+//                  previous Word of the same Device and Register in a fixed RAM Ring. Snapshots
+//                  of 4 Units need ~2.6 Bytes per Sample instead of ~6 as CSV Text, without
+//                  float Formatting. Closed Blocks are written to any Print (Serial, SD File)
+//                  by flush(). extras/host/logdecode turns the Stream into scaled CSV
+//#################################################################################################
+class BIC2200Log {
+
+public:
+    void begin(BIC2200Bus & bus);
+
+    bool log(byte address, int reg, unsigned int value);
+    byte logSnapshot(byte address, const BIC2200Snapshot & snapshot);
+
+    size_t flush(Print & out, bool all = false);
+    void clear();
+
+    size_t available();
+    BIC2200LogStats getStats();
+    void resetStats();
+
+private:
+    BIC2200Bus * _bus = NULL;
+    byte _ring[BIC2200_LOG_BYTES];
+    size_t _tail = 0;                   // first Byte of the oldest Block
+    size_t _used = 0;                   // Bytes of all Blocks incl. the open one
+    size_t _blockStart = 0;             // Ring Index of the open Block
+    byte _blockLen = 0;                 // Record Bytes of the open Block
+    bool _blockOpen = false;
+    unsigned long _time = 0;            // ms of the last Record
+    BIC2200LogKey _keys[BIC2200_LOG_KEYS];
+    byte _keyCount = 0;
+    byte _nextKey = 0;                  // next Reference replaced when all are used
+    BIC2200LogStats _stats = {};
+
+    bool _log(byte address, int reg, unsigned int value, unsigned long now);
+    int _findKey(byte key);
+    byte _encode(byte * record, byte key, unsigned long now, unsigned int value, int index);
+    static byte _putVarint(byte * out, unsigned long value);
+    void _openBlock(unsigned long now);
+    void _closeBlock();
+    void _makeRoom(size_t bytes);
+    void _append(const byte * data, size_t len);
+    size_t _blockSize(size_t start);
+
+};
+
+#endif
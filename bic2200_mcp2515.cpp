@@ -0,0 +1,137 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifdef ARDUINO
+
+#include "bic2200_mcp2515.h"
+#include "bic2200.h"
+#include <SPI.h>
+
+BIC2200MCP2515Transport * BIC2200MCP2515Transport::_instances[BIC2200_MAX_CONTROLLERS] = {};
+
+// One Interrupt Handler per Controller, attachInterrupt() takes no Context Pointer
+template <byte N> void BIC2200MCP2515Transport::_onInterrupt() {
+    if (_instances[N] != NULL) {
+        _instances[N]->_receive();
+    }
+}
+
+void (* const BIC2200MCP2515Transport::_handlers[BIC2200_MAX_CONTROLLERS])() = {
+    _onInterrupt<0>,
+    _onInterrupt<1>,
+    _onInterrupt<2>,
+    _onInterrupt<3>
+};
+
+BIC2200MCP2515Transport::BIC2200MCP2515Transport(MCP2515Class & controller) : _controller(controller) {
+//#################################################################################################
+//  Function:       BIC2200MCP2515Transport
+//  Access:         Public
+//  Input:          controller (MCP2515Class &) CAN Library Object of the MCP2515, default CAN
+//  Output:         -
+//  Description:    Binds the Transport to a Controller, nothing is started yet
+//#################################################################################################
+}
+
+void BIC2200MCP2515Transport::setPins(int CS_Pin, int IRQ_Pin) {
+//#################################################################################################
+//  Function:       setPins
+//  Access:         Public
+//  Input:          CS_Pin (int) Chip Select Pin of the MCP2515
+//                  IRQ_Pin (int) Interrupt Pin of the MCP2515, -1 = not connected (polled)
+//  Output:         -
+//  Description:    Sets the Pins, must be called before begin()
+//#################################################################################################
+    _CS = CS_Pin;
+    _IRQ = IRQ_Pin;
+}
+
+int BIC2200MCP2515Transport::begin(BIC2200Bus & bus) {
+//#################################################################################################
+//  Function:       begin
+//  Access:         Public
+//  Input:          bus (BIC2200Bus &) Bus which gets the received Frames
+//  Output:         (int) 0 = CAN Initialisiation unsuccessfull; 1 = CAN Initialisiation successfull
+//  Description:    Initialises the CAN Controller, programs the Acceptance Filters to the
+//                  Receive IDs of all 8 Device Adresses and attaches the Receive Interrupt.
+//                  Beyond BIC2200_MAX_CONTROLLERS or without IRQ Pin the Bus polls the
+//                  Controller in service()
+//#################################################################################################
+    _controller.setPins(_CS, (_IRQ >= 0) ? _IRQ : 2);
+    _controller.setClockFrequency(CAN_CLK_FREQUENCY);
+    if (!_controller.begin(CAN_BAUDRATE)) {
+        return 0;
+    }
+    // Accept 0x000C0200 - 0x000C0207 only
+    _controller.filterExtended(MSG_ID_CAN_RECEIVE_00, 0x1FFFFFFF & ~(BIC2200_MAX_DEVICES - 1));
+
+    _bus = &bus;
+    for (byte i = 0; i < BIC2200_MAX_CONTROLLERS && _IRQ >= 0 && _slot < 0; i++) {
+        if (_instances[i] == NULL) {
+            _instances[i] = this;
+            _slot = i;
+        }
+    }
+    if (_slot >= 0) {
+        SPI.usingInterrupt(digitalPinToInterrupt(_IRQ));
+        attachInterrupt(digitalPinToInterrupt(_IRQ), _handlers[_slot], LOW);
+    }
+    return 1;
+}
+
+bool BIC2200MCP2515Transport::send(const BIC2200Frame & frame) {
+//#################################################################################################
+//  Function:       send
+//  Access:         Public
+//  Input:          frame (const BIC2200Frame &) Extended Frame to send
+//  Output:         (bool) false = Frame not sent; true = Frame sent
+//  Description:    Sends one Extended Frame, returns when the Frame has left the Controller
+//#################################################################################################
+    _controller.beginExtendedPacket(frame.id);
+    _controller.write(frame.data, frame.len);
+    return _controller.endPacket() == 1;
+}
+
+void BIC2200MCP2515Transport::service() {
+//#################################################################################################
+//  Function:       service
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Fetches received Frames of a Controller without Interrupt
+//#################################################################################################
+    if (_slot < 0 && _bus != NULL) {
+        _receive();
+    }
+}
+
+void BIC2200MCP2515Transport::_receive() {
+//#################################################################################################
+//  Function:       _receive
+//  Access:         Private (Interrupt Context or service())
+//  Input:          -
+//  Output:         -
+//  Description:    Copies every received Extended Frame and hands it to the Bus. Reading the
+//                  Receive Buffers releases the Interrupt Line of the MCP2515
+//#################################################################################################
+    BIC2200Frame frame;
+
+    while (_controller.parsePacket() > 0) {
+        if (!_controller.packetExtended() || _controller.packetRtr()) {
+            continue;
+        }
+        frame.id = _controller.packetId();
+        frame.len = 0;
+        while (_controller.available() && frame.len < 8) {
+            frame.data[frame.len] = _controller.read();
+            ++frame.len;
+        }
+        _bus->dispatch(frame);
+    }
+}
+
+#endif
@@ -0,0 +1,65 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_MCP2515_H
+#define BIC2200_MCP2515_H
+
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <CAN.h>
+#include "bic2200_transport.h"
+
+// Controllers with Receive Interrupt, further Controllers are polled by service()
+#define BIC2200_MAX_CONTROLLERS     4
+
+//#################################################################################################
+//  Class:          BIC2200MCP2515Transport
+//  Description:    Transport over a MCP2515 with the Arduino CAN Library. Programs the
+//                  Acceptance Filters to the BIC-2200 Reply IDs and hands received Frames to
+//                  the Bus from the Receive Interrupt. Every Instance drives its own Controller
+//                  (default: the global CAN Object), so each MCP2515 carries its own Bus with
+//                  Adresses 0x00 - 0x07:
+//                      MCP2515Class can2;
+//                      BIC2200MCP2515Transport transport2(can2);
+//                      transport2.setPins(9, 3);
+//                      bus2.begin(transport2);
+//                  The CAN Library routes every Interrupt to the global CAN Object, so the
+//                  Transport attaches its own Handler per Controller instead of onReceive()
+//#################################################################################################
+class BIC2200MCP2515Transport : public BIC2200Transport {
+
+public:
+    explicit BIC2200MCP2515Transport(MCP2515Class & controller = CAN);
+
+    void setPins(int CS_Pin, int IRQ_Pin = 2);
+
+    int begin(BIC2200Bus & bus);
+    bool send(const BIC2200Frame & frame);
+    void service();
+
+    unsigned long micros() { return ::micros(); }
+    unsigned long millis() { return ::millis(); }
+
+private:
+    MCP2515Class & _controller;
+    int _CS = 10;
+    int _IRQ = 2;                   // -1 = no Interrupt Line, received Frames are polled
+    BIC2200Bus * _bus = NULL;
+    int _slot = -1;                 // Interrupt Handler in use, -1 = polled
+
+    void _receive();
+
+    static BIC2200MCP2515Transport * _instances[BIC2200_MAX_CONTROLLERS];
+    static void (* const _handlers[BIC2200_MAX_CONTROLLERS])();
+    template <byte N> static void _onInterrupt();
+
+};
+
+#endif
+
+#endif
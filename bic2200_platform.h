@@ -0,0 +1,52 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_PLATFORM_H
+#define BIC2200_PLATFORM_H
+
+// The Library Core only needs these Arduino Basics. Outside of Arduino (Host Builds with the
+// Simulator or SocketCAN) they are defined here.
+#ifdef ARDUINO
+
+#include <Arduino.h>
+
+// Guards Data shared with the CAN Receive Interrupt, only used in the Main Loop
+#define BIC2200_LOCK()      noInterrupts()
+#define BIC2200_UNLOCK()    interrupts()
+
+#else
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef uint8_t byte;
+
+#define lowByte(w)  ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+
+// Host Transports hand received Frames over in service(), i.e. in the Thread of the Library
+#define BIC2200_LOCK()
+#define BIC2200_UNLOCK()
+
+// Output Interface of the Log, the same Signatures as the Arduino Print Class
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t * buffer, size_t size) {
+        size_t n = 0;
+        while (n < size && write(buffer[n])) {
+            ++n;
+        }
+        return n;
+    }
+};
+
+#endif
+
+#endif
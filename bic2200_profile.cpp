@@ -0,0 +1,535 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200_profile.h"
+
+#define PROFILE_ACTIVE(state)   ((state) == BIC2200_PROFILE_CC || (state) == BIC2200_PROFILE_CV || \
+                                 (state) == BIC2200_PROFILE_FLOAT)
+
+void BIC2200ProfileEngine::begin(BIC2200Scheduler & scheduler, unsigned long period) {
+//#################################################################################################
+//  Function:       begin
+//  Access:         Public
+//  Input:          scheduler (BIC2200Scheduler &) started Scheduler the Polls are added to
+//                  period (unsigned long) ms between two VOUT / IOUT Polls of a Device, bounds
+//                  the Delay of a detected Transition
+//  Output:         -
+//  Description:    Starts the Engine without Devices
+//#################################################################################################
+    _scheduler = &scheduler;
+    _period = period;
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        _devices[i].device = NULL;
+    }
+}
+
+bool BIC2200ProfileEngine::start(BIC2200 & device, const BIC2200ProfileConfig & config) {
+//#################################################################################################
+//  Function:       start
+//  Access:         Public
+//  Input:          device (BIC2200 &) Device attached to the Bus of the Scheduler, with loaded
+//                  Scaling Factors
+//                  config (const BIC2200ProfileConfig &) Charge or Discharge Parameters
+//  Output:         (bool) false = Engine full or Polls over Bus Budget
+//  Description:    Starts a Profile in CC, a running one is replaced. The first start() of a
+//                  Device adds its VOUT and IOUT Polls at BIC2200_PRIORITY_PROFILE. tick()
+//                  writes the Current Setpoint (ramped up from 0), the Voltage Setpoint and
+//                  then DIRECTION_CTRL, so the Device never runs the old Setpoints the new Way
+//#################################################################################################
+    BIC2200ProfiledDevice * slot = _find(device);
+
+    if (_scheduler == NULL || device.getBus() == NULL) {
+        return false;
+    }
+    if (slot == NULL) {
+        for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+            if (_devices[i].device == NULL) {
+                slot = &_devices[i];
+                break;
+            }
+        }
+        if (slot == NULL) {
+            return false;
+        }
+        int voutEntry = _scheduler->add(device, CMD_READ_VOUT, _period, BIC2200_PRIORITY_PROFILE);
+        if (voutEntry < 0) {
+            return false;
+        }
+        int ioutEntry = _scheduler->add(device, CMD_READ_IOUT, _period, BIC2200_PRIORITY_PROFILE);
+        if (ioutEntry < 0) {
+            _scheduler->remove(voutEntry);
+            return false;
+        }
+        *slot = BIC2200ProfiledDevice();
+        slot->device = &device;
+        slot->voutEntry = voutEntry;
+        slot->ioutEntry = ioutEntry;
+    }
+
+    unsigned long now = device.getBus()->millis();
+    slot->config = config;
+    slot->voutAt = now;
+    slot->ioutAt = now;
+    slot->directionSent = false;
+    slot->currentSet = BIC2200ProfileRamp();
+    slot->currentSet.to = config.current;
+    slot->currentSet.startAt = now;
+    slot->voltageSet = BIC2200ProfileRamp();
+    slot->voltageSet.from = config.voltage;
+    slot->voltageSet.to = config.voltage;
+    slot->voltageSet.startAt = now;
+    _enter(*slot, BIC2200_PROFILE_CC, now);
+    return true;
+}
+
+void BIC2200ProfileEngine::stop(BIC2200 & device) {
+//#################################################################################################
+//  Function:       stop
+//  Access:         Public
+//  Input:          device (BIC2200 &) Device with a Profile
+//  Output:         -
+//  Description:    Ends the Profile, tick() sets the Current Setpoint to 0 without Ramp and
+//                  then removes the VOUT and IOUT Polls and frees the Slot of the Device. Call
+//                  it after DONE or ERROR too, these keep polling so the State stays readable
+//#################################################################################################
+    BIC2200ProfiledDevice * profiled = _find(device);
+
+    if (profiled != NULL && profiled->state != BIC2200_PROFILE_IDLE) {
+        _enter(*profiled, BIC2200_PROFILE_IDLE, device.getBus()->millis());
+    }
+}
+
+void BIC2200ProfileEngine::onTransition(BIC2200ProfileCallback callback) {
+//#################################################################################################
+//  Function:       onTransition
+//  Access:         Public
+//  Input:          callback (BIC2200ProfileCallback) Function called on every State Change,
+//                  NULL = off
+//  Output:         -
+//  Description:    Registers the Transition Callback
+//#################################################################################################
+    _callback = callback;
+}
+
+int BIC2200ProfileEngine::run() {
+//#################################################################################################
+//  Function:       run
+//  Access:         Public
+//  Input:          -
+//  Output:         (int) Number of State Changes during this Call
+//  Description:    Runs the Scheduler (call it instead of scheduler.run()) and then tick().
+//                  Next to a Fault Watch call watch.run() and then tick()
+//#################################################################################################
+    if (_scheduler == NULL) {
+        return 0;
+    }
+    _scheduler->run();
+    return tick();
+}
+
+int BIC2200ProfileEngine::tick() {
+//#################################################################################################
+//  Function:       tick
+//  Access:         Public
+//  Input:          -
+//  Output:         (int) Number of State Changes during this Call
+//  Description:    Evaluates the new Samples of every Device, changes States and writes the
+//                  due Setpoints. Never waits for a Reply and sends at most
+//                  BIC2200_PROFILE_WRITES Frames; the first Device is rotated, so a Device
+//                  with a long Ramp can not hold back the others
+//#################################################################################################
+    unsigned long transitions = _stats.transitions;
+    byte budget = BIC2200_PROFILE_WRITES;
+
+    if (_scheduler == NULL) {
+        return 0;
+    }
+    for (byte k = 0; k < BIC2200_MAX_DEVICES; k++) {
+        BIC2200ProfiledDevice & profiled = _devices[(_next + k) % BIC2200_MAX_DEVICES];
+        if (profiled.device == NULL) {
+            continue;
+        }
+        unsigned long now = profiled.device->getBus()->millis();
+        if (_sample(profiled, now)) {
+            _step(profiled, now);
+        }
+        budget -= _write(profiled, now, budget);
+        if (profiled.state == BIC2200_PROFILE_IDLE && profiled.currentSet.sent && profiled.currentSet.word == 0) {
+            _release(profiled);
+        }
+    }
+    _next = (_next + 1) % BIC2200_MAX_DEVICES;
+    ++_stats.ticks;
+    return _stats.transitions - transitions;
+}
+
+byte BIC2200ProfileEngine::getState(BIC2200 & device) {
+//#################################################################################################
+//  Function:       getState
+//  Access:         Public
+//  Input:          device (BIC2200 &) Device
+//  Output:         (byte) BIC2200_PROFILE_*, IDLE = no Profile started
+//  Description:    State of the Profile of a Device
+//#################################################################################################
+    BIC2200ProfiledDevice * profiled = _find(device);
+    return (profiled != NULL) ? profiled->state : BIC2200_PROFILE_IDLE;
+}
+
+unsigned long BIC2200ProfileEngine::getStateTime(BIC2200 & device) {
+//#################################################################################################
+//  Function:       getStateTime
+//  Access:         Public
+//  Input:          device (BIC2200 &) Device
+//  Output:         (unsigned long) ms since the last State Change, 0 = no Profile started
+//  Description:    Time in the current State, e.g. to report the Absorption Time
+//#################################################################################################
+    BIC2200ProfiledDevice * profiled = _find(device);
+    return (profiled != NULL) ? device.getBus()->millis() - profiled->stateAt : 0;
+}
+
+BIC2200ProfileStats BIC2200ProfileEngine::getStats() {
+//#################################################################################################
+//  Function:       getStats
+//  Access:         Public
+//  Input:          -
+//  Output:         (BIC2200ProfileStats) Counters since the last resetStats()
+//  Description:    Ticks, Transitions and Setpoint Frames of all Devices
+//#################################################################################################
+    return _stats;
+}
+
+void BIC2200ProfileEngine::resetStats() {
+//#################################################################################################
+//  Function:       resetStats
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Sets all Counters to 0
+//#################################################################################################
+    _stats = BIC2200ProfileStats();
+}
+
+BIC2200ProfileConfig BIC2200ProfileEngine::chargeConfig(long voltage, long current, long floatVoltage) {
+//#################################################################################################
+//  Function:       chargeConfig
+//  Access:         Public (static)
+//  Input:          voltage (long) mV Absorption Voltage
+//                  current (long) mA Charge Current
+//                  floatVoltage (long) mV after Absorption, 0 = DONE
+//  Output:         (BIC2200ProfileConfig) Charge Profile
+//  Description:    CV Band 100 mV, Tail at 1/10 of the Current for 10 s, no CV Time Limit and
+//                  no Ramps. Change the Fields before start() to tune it
+//#################################################################################################
+    BIC2200ProfileConfig config = { false, voltage, current, floatVoltage, 100, current / 10, 10000UL, 0, 0, 0 };
+    return config;
+}
+
+BIC2200ProfileConfig BIC2200ProfileEngine::dischargeConfig(long cutoff, long current) {
+//#################################################################################################
+//  Function:       dischargeConfig
+//  Access:         Public (static)
+//  Input:          cutoff (long) mV VOUT is held at once CV is reached
+//                  current (long) mA Discharge Current
+//  Output:         (BIC2200ProfileConfig) Discharge Profile ending in DONE
+//  Description:    CV Band 100 mV, Tail at 1/10 of the Current for 10 s, no CV Time Limit and
+//                  no Ramps. Change the Fields before start() to tune it
+//#################################################################################################
+    BIC2200ProfileConfig config = { true, cutoff, current, 0, 100, current / 10, 10000UL, 0, 0, 0 };
+    return config;
+}
+
+BIC2200ProfiledDevice * BIC2200ProfileEngine::_find(BIC2200 & device) {
+//#################################################################################################
+//  Function:       _find
+//  Access:         Private
+//  Input:          device (BIC2200 &) Device
+//  Output:         (BIC2200ProfiledDevice *) NULL = no Profile started on the Device
+//  Description:    Finds the Slot of a Device
+//#################################################################################################
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        if (_devices[i].device == &device) {
+            return &_devices[i];
+        }
+    }
+    return NULL;
+}
+
+void BIC2200ProfileEngine::_release(BIC2200ProfiledDevice & profiled) {
+//#################################################################################################
+//  Function:       _release
+//  Access:         Private
+//  Input:          profiled (BIC2200ProfiledDevice &) stopped Device with Current Setpoint 0
+//  Output:         -
+//  Description:    Removes the Polls of the Device and frees its Slot. Waits for the next
+//                  tick() while a Poll is open, so tick() never waits for its Reply
+//#################################################################################################
+    if (_scheduler->isWaiting(profiled.voutEntry) || _scheduler->isWaiting(profiled.ioutEntry)) {
+        return;
+    }
+    _scheduler->remove(profiled.voutEntry);
+    _scheduler->remove(profiled.ioutEntry);
+    profiled.device = NULL;
+}
+
+bool BIC2200ProfileEngine::_sample(BIC2200ProfiledDevice & profiled, unsigned long now) {
+//#################################################################################################
+//  Function:       _sample
+//  Access:         Private
+//  Input:          profiled (BIC2200ProfiledDevice &) Device
+//                  now (unsigned long) millis()
+//  Output:         (bool) true = new VOUT or IOUT Sample
+//  Description:    Takes the new Samples of the Scheduler. A running Profile goes to ERROR
+//                  when one of them is older than BIC2200_PROFILE_TIMEOUT
+//#################################################################################################
+    unsigned int value;
+    bool fresh = false;
+
+    unsigned long count = _scheduler->getSamples(profiled.voutEntry);
+    if (count != profiled.voutSamples && _scheduler->getValue(profiled.voutEntry, value)) {
+        profiled.voutSamples = count;
+        profiled.voutAt = now;
+        profiled.voltage = profiled.device->getScale(CMD_READ_VOUT).apply(value);
+        fresh = true;
+    }
+    count = _scheduler->getSamples(profiled.ioutEntry);
+    if (count != profiled.ioutSamples && _scheduler->getValue(profiled.ioutEntry, value)) {
+        profiled.ioutSamples = count;
+        profiled.ioutAt = now;
+        long current = profiled.device->getScale(CMD_READ_IOUT).apply((int16_t)value);
+        profiled.current = (current < 0) ? -current : current;
+        fresh = true;
+    }
+    if (PROFILE_ACTIVE(profiled.state) &&
+        (now - profiled.voutAt > BIC2200_PROFILE_TIMEOUT || now - profiled.ioutAt > BIC2200_PROFILE_TIMEOUT)) {
+        _enter(profiled, BIC2200_PROFILE_ERROR, now);
+        return false;
+    }
+    return fresh;
+}
+
+bool BIC2200ProfileEngine::_step(BIC2200ProfiledDevice & profiled, unsigned long now) {
+//#################################################################################################
+//  Function:       _step
+//  Access:         Private
+//  Input:          profiled (BIC2200ProfiledDevice &) Device with new Samples
+//                  now (unsigned long) millis()
+//  Output:         (bool) true = State changed
+//  Description:    CC -> CV when VOUT enters the CV Band (from below for Charge, from above
+//                  for Discharge). CV -> FLOAT (or DONE) when IOUT stayed at or below the
+//                  Tail Current for the Tail Time or the CV Time Limit is over
+//#################################################################################################
+    const BIC2200ProfileConfig & config = profiled.config;
+
+    if (profiled.voutSamples == 0 || profiled.ioutSamples == 0) {
+        return false;
+    }
+    if (profiled.state == BIC2200_PROFILE_CC) {
+        bool reached = config.discharge ? (profiled.voltage <= config.voltage + config.cvBand) :
+            (profiled.voltage >= config.voltage - config.cvBand);
+        if (reached) {
+            _enter(profiled, BIC2200_PROFILE_CV, now);
+            return true;
+        }
+    } else if (profiled.state == BIC2200_PROFILE_CV) {
+        bool finished = (config.cvMaxTime != 0 && now - profiled.stateAt >= config.cvMaxTime);
+        if (profiled.current <= config.tailCurrent) {
+            if (!profiled.tail) {
+                profiled.tail = true;
+                profiled.tailSince = now;
+            }
+            finished = finished || (now - profiled.tailSince >= config.tailTime);
+        } else {
+            profiled.tail = false;
+        }
+        if (finished) {
+            _enter(profiled, config.floatVoltage ? BIC2200_PROFILE_FLOAT : BIC2200_PROFILE_DONE, now);
+            return true;
+        }
+    }
+    return false;
+}
+
+void BIC2200ProfileEngine::_enter(BIC2200ProfiledDevice & profiled, byte state, unsigned long now) {
+//#################################################################################################
+//  Function:       _enter
+//  Access:         Private
+//  Input:          profiled (BIC2200ProfiledDevice &) Device
+//                  state (byte) BIC2200_PROFILE_*
+//                  now (unsigned long) millis()
+//  Output:         -
+//  Description:    Changes the State, retargets the Setpoints and calls the Callback
+//#################################################################################################
+    profiled.state = state;
+    profiled.stateAt = now;
+    profiled.tail = false;
+    switch (state) {
+        case BIC2200_PROFILE_FLOAT:
+            _retarget(profiled.voltageSet, profiled.config.floatVoltage, profiled.config.voltageRamp, now);
+            break;
+        case BIC2200_PROFILE_IDLE:
+        case BIC2200_PROFILE_DONE:
+        case BIC2200_PROFILE_ERROR:
+            profiled.currentSet.from = 0;
+            profiled.currentSet.to = 0;
+            profiled.currentSet.startAt = now;
+            break;
+    }
+    ++_stats.transitions;
+    if (_callback != NULL) {
+        _callback(*profiled.device, state);
+    }
+}
+
+byte BIC2200ProfileEngine::_write(BIC2200ProfiledDevice & profiled, unsigned long now, byte budget) {
+//#################################################################################################
+//  Function:       _write
+//  Access:         Private
+//  Input:          profiled (BIC2200ProfiledDevice &) Device
+//                  now (unsigned long) millis()
+//                  budget (byte) Frames this Device may send
+//  Output:         (byte) Frames sent
+//  Description:    Writes the due Setpoints in the Order Current, Voltage, DIRECTION_CTRL. A
+//                  Setpoint is due when its Register Value changes, a ramping one at most
+//                  every BIC2200_PROFILE_RAMP_STEP ms
+//#################################################################################################
+    const BIC2200ProfileConfig & config = profiled.config;
+    int currentReg = config.discharge ? CMD_REVERSE_IOUT_SET : CMD_IOUT_SET;
+    int voltageReg = config.discharge ? CMD_REVERSE_VOUT_SET : CMD_VOUT_SET;
+    bool active = PROFILE_ACTIVE(profiled.state);
+    bool pending = false;
+    byte frames = 0;
+    unsigned int word;
+
+    if (_due(profiled, profiled.currentSet, active ? config.currentRamp : 0, currentReg, now, word)) {
+        if (frames < budget) {
+            _send(*profiled.device, currentReg, word);
+            profiled.currentSet.word = word;
+            profiled.currentSet.sent = true;
+            profiled.currentSet.sentAt = now;
+            ++frames;
+        } else {
+            pending = true;
+        }
+    }
+    if (active && _due(profiled, profiled.voltageSet, config.voltageRamp, voltageReg, now, word)) {
+        if (frames < budget) {
+            _send(*profiled.device, voltageReg, word);
+            profiled.voltageSet.word = word;
+            profiled.voltageSet.sent = true;
+            profiled.voltageSet.sentAt = now;
+            ++frames;
+        } else {
+            pending = true;
+        }
+    }
+    if (active && !profiled.directionSent && profiled.currentSet.sent && profiled.voltageSet.sent) {
+        if (frames < budget) {
+            _send(*profiled.device, CMD_DIRECTION_CTRL, config.discharge ? 1 : 0);
+            profiled.directionSent = true;
+            ++frames;
+        } else {
+            pending = true;
+        }
+    }
+    if (pending) {
+        ++_stats.deferred;
+    }
+    _stats.frames += frames;
+    return frames;
+}
+
+bool BIC2200ProfileEngine::_due(BIC2200ProfiledDevice & profiled, BIC2200ProfileRamp & ramp, long rate, int reg,
+    unsigned long now, unsigned int & word) {
+//#################################################################################################
+//  Function:       _due
+//  Access:         Private
+//  Input:          profiled (BIC2200ProfiledDevice &) Device
+//                  ramp (BIC2200ProfileRamp &) Setpoint
+//                  rate (long) mA/s or mV/s, 0 = Step
+//                  reg (int) Setpoint Register
+//                  now (unsigned long) millis()
+//                  word (unsigned int &) Destination of the raw Value to write
+//  Output:         (bool) true = Setpoint has to be written
+//  Description:    Converts the ramped Value into Register Resolution and compares it with the
+//                  Value on the Device. The Target itself is never held back
+//#################################################################################################
+    long value = _rampValue(ramp, rate, now);
+
+    word = profiled.device->getScale(reg).unapply(value);
+    if (ramp.sent && word == ramp.word) {
+        return false;
+    }
+    if (ramp.sent && value != ramp.to && now - ramp.sentAt < BIC2200_PROFILE_RAMP_STEP) {
+        return false;
+    }
+    return true;
+}
+
+void BIC2200ProfileEngine::_send(BIC2200 & device, int reg, unsigned int word) {
+//#################################################################################################
+//  Function:       _send
+//  Access:         Private (static)
+//  Input:          device (BIC2200 &) Device
+//                  reg (int) Setpoint Register or CMD_DIRECTION_CTRL
+//                  word (unsigned int) raw Value
+//  Output:         -
+//  Description:    Writes one Setpoint through the typed Register Accessors
+//#################################################################################################
+    switch (reg) {
+        case CMD_VOUT_SET:
+            device.write<BIC2200Reg::VoutSet>(word);
+            break;
+        case CMD_IOUT_SET:
+            device.write<BIC2200Reg::IoutSet>(word);
+            break;
+        case CMD_REVERSE_VOUT_SET:
+            device.write<BIC2200Reg::ReverseVoutSet>(word);
+            break;
+        case CMD_REVERSE_IOUT_SET:
+            device.write<BIC2200Reg::ReverseIoutSet>(word);
+            break;
+        case CMD_DIRECTION_CTRL:
+            device.write<BIC2200Reg::DirectionCtrl>(word);
+            break;
+    }
+}
+
+void BIC2200ProfileEngine::_retarget(BIC2200ProfileRamp & ramp, long to, long rate, unsigned long now) {
+//#################################################################################################
+//  Function:       _retarget
+//  Access:         Private (static)
+//  Input:          ramp (BIC2200ProfileRamp &) Setpoint
+//                  to (long) new Target
+//                  rate (long) Slope of the running Ramp, 0 = Step
+//                  now (unsigned long) millis()
+//  Output:         -
+//  Description:    Starts a new Ramp from the Value the running one has reached
+//#################################################################################################
+    ramp.from = _rampValue(ramp, rate, now);
+    ramp.to = to;
+    ramp.startAt = now;
+}
+
+long BIC2200ProfileEngine::_rampValue(const BIC2200ProfileRamp & ramp, long rate, unsigned long now) {
+//#################################################################################################
+//  Function:       _rampValue
+//  Access:         Private (static)
+//  Input:          ramp (const BIC2200ProfileRamp &) Setpoint
+//                  rate (long) mA/s or mV/s, 0 = Step
+//                  now (unsigned long) millis()
+//  Output:         (long) Value of the Ramp at now
+//  Description:    Computed from the Start of the Ramp, so short Ticks lose no Fraction
+//#################################################################################################
+    if (rate <= 0) {
+        return ramp.to;
+    }
+    int64_t delta = (int64_t)rate * (now - ramp.startAt) / 1000;
+    if (ramp.from < ramp.to) {
+        return (ramp.from + delta < ramp.to) ? (long)(ramp.from + delta) : ramp.to;
+    }
+    return (ramp.from - delta > ramp.to) ? (long)(ramp.from - delta) : ramp.to;
+}
@@ -0,0 +1,137 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_PROFILE_H
+#define BIC2200_PROFILE_H
+
+#include "bic2200_scheduler.h"
+
+#define BIC2200_PROFILE_PERIOD      100     // ms between two VOUT / IOUT Polls of a Device
+#define BIC2200_PRIORITY_PROFILE    192     // Scheduler Priority, below the Fault Watch
+#ifndef BIC2200_PROFILE_WRITES
+#define BIC2200_PROFILE_WRITES      1       // Setpoint Frames per tick() of all Devices, bounds its Time
+#endif
+#ifndef BIC2200_PROFILE_RAMP_STEP
+#define BIC2200_PROFILE_RAMP_STEP   100     // ms between two Writes of a ramped Setpoint
+#endif
+#ifndef BIC2200_PROFILE_TIMEOUT
+#define BIC2200_PROFILE_TIMEOUT     2000    // ms without VOUT / IOUT Sample until the Profile stops
+#endif
+
+// Profile States
+#define BIC2200_PROFILE_IDLE        0       // not started or stopped, Current Setpoint 0, Slot freed
+#define BIC2200_PROFILE_CC          1       // constant Current until VOUT reaches the CV Band
+#define BIC2200_PROFILE_CV          2       // constant Voltage until IOUT stays below the Tail
+#define BIC2200_PROFILE_FLOAT       3       // Voltage held at the Float Setpoint
+#define BIC2200_PROFILE_DONE        4       // CV finished without Float, Current Setpoint 0
+#define BIC2200_PROFILE_ERROR       5       // Telemetry lost, Current Setpoint 0
+
+// Called on every State Change from tick()
+typedef void (*BIC2200ProfileCallback)(BIC2200 & device, byte state);
+
+// Parameters of one Charge or Discharge. Discharge uses DIRECTION_CTRL = 1 and the
+// REVERSE_VOUT_SET / REVERSE_IOUT_SET Registers, its CV Voltage is the lower Limit of VOUT
+struct BIC2200ProfileConfig {
+    bool discharge;
+    long voltage;               // mV, CV Setpoint (Absorption or Discharge Cutoff)
+    long current;               // mA, CC Setpoint
+    long floatVoltage;          // mV after CV, 0 = DONE instead of FLOAT
+    long cvBand;                // mV, CC -> CV when VOUT is within this of voltage
+    long tailCurrent;           // mA, CV -> FLOAT when IOUT stays at or below for tailTime
+    unsigned long tailTime;     // ms
+    unsigned long cvMaxTime;    // ms, CV -> FLOAT after this at the latest, 0 = no Limit
+    long currentRamp;           // mA/s Slope of the Current Setpoint, 0 = Step
+    long voltageRamp;           // mV/s Slope of the Voltage Setpoint, 0 = Step
+};
+
+struct BIC2200ProfileStats {
+    unsigned long ticks;
+    unsigned long transitions;
+    unsigned long frames;       // Setpoint Writes
+    unsigned long deferred;     // Writes moved to a later tick() by BIC2200_PROFILE_WRITES
+};
+
+// Setpoint ramped from a Start Value to a Target, written in Register Resolution
+struct BIC2200ProfileRamp {
+    long from;
+    long to;
+    unsigned long startAt;      // millis()
+    unsigned int word;          // raw Value on the Device
+    bool sent;                  // word is valid
+    unsigned long sentAt;       // millis() of the last Write
+};
+
+struct BIC2200ProfiledDevice {
+    BIC2200 * device;           // NULL = Slot free
+    int voutEntry;              // Scheduler Entries
+    int ioutEntry;
+    BIC2200ProfileConfig config;
+    byte state;
+    unsigned long stateAt;      // millis() of the last State Change
+    unsigned long voutSamples;  // Sample Count of the last evaluated Value
+    unsigned long ioutSamples;
+    unsigned long voutAt;       // millis() of the last new VOUT / IOUT Sample or of start()
+    unsigned long ioutAt;
+    long voltage;               // mV, last VOUT Sample
+    long current;               // mA, last IOUT Sample, Magnitude
+    bool tail;                  // IOUT below the Tail since tailSince
+    unsigned long tailSince;    // millis()
+    bool directionSent;         // DIRECTION_CTRL written for this Profile
+    BIC2200ProfileRamp voltageSet;
+    BIC2200ProfileRamp currentSet;
+};
+
+//#################################################################################################
+//  Class:          BIC2200ProfileEngine
+//  Description:    Runs CC -> CV -> Float Charge and Discharge Profiles of several Devices as
+//                  State Machines driven by tick(). VOUT and IOUT come from the Scheduler, so a
+//                  tick never waits for a Reply; Setpoints are ramped and written only when the
+//                  Register Value changes, at most BIC2200_PROFILE_WRITES Frames per tick, so
+//                  the Time of a tick is bounded by that many Frames on the Wire
+//#################################################################################################
+class BIC2200ProfileEngine {
+
+public:
+    void begin(BIC2200Scheduler & scheduler, unsigned long period = BIC2200_PROFILE_PERIOD);
+    bool start(BIC2200 & device, const BIC2200ProfileConfig & config);
+    void stop(BIC2200 & device);
+    void onTransition(BIC2200ProfileCallback callback);
+
+    int run();
+    int tick();
+
+    byte getState(BIC2200 & device);
+    unsigned long getStateTime(BIC2200 & device);
+    BIC2200ProfileStats getStats();
+    void resetStats();
+
+    static BIC2200ProfileConfig chargeConfig(long voltage, long current, long floatVoltage);
+    static BIC2200ProfileConfig dischargeConfig(long cutoff, long current);
+
+private:
+    BIC2200Scheduler * _scheduler = NULL;
+    unsigned long _period = BIC2200_PROFILE_PERIOD;
+    BIC2200ProfileCallback _callback = NULL;
+    BIC2200ProfiledDevice _devices[BIC2200_MAX_DEVICES] = {};
+    byte _next = 0;             // Device served first by the next tick(), Round Robin
+    BIC2200ProfileStats _stats = {};
+
+    BIC2200ProfiledDevice * _find(BIC2200 & device);
+    void _release(BIC2200ProfiledDevice & profiled);
+    bool _sample(BIC2200ProfiledDevice & profiled, unsigned long now);
+    bool _step(BIC2200ProfiledDevice & profiled, unsigned long now);
+    void _enter(BIC2200ProfiledDevice & profiled, byte state, unsigned long now);
+    byte _write(BIC2200ProfiledDevice & profiled, unsigned long now, byte budget);
+    bool _due(BIC2200ProfiledDevice & profiled, BIC2200ProfileRamp & ramp, long rate, int reg,
+        unsigned long now, unsigned int & word);
+    static void _send(BIC2200 & device, int reg, unsigned int word);
+    static void _retarget(BIC2200ProfileRamp & ramp, long to, long rate, unsigned long now);
+    static long _rampValue(const BIC2200ProfileRamp & ramp, long rate, unsigned long now);
+
+};
+
+#endif
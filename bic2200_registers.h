@@ -0,0 +1,108 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_REGISTERS_H
+#define BIC2200_REGISTERS_H
+
+#include "bic2200_platform.h"
+
+// Register Access
+#define BIC2200_READ            0x01
+#define BIC2200_WRITE           0x02
+#define BIC2200_RW              (BIC2200_READ | BIC2200_WRITE)
+
+// Scale of a Register: which Scaling Factor of the Device converts it
+#define BIC2200_SCALE_NONE          0
+#define BIC2200_SCALE_VOUT          1   // -> mV
+#define BIC2200_SCALE_IOUT          2   // -> mA
+#define BIC2200_SCALE_VIN           3   // -> mV
+#define BIC2200_SCALE_TEMPERATURE   4   // -> 0.1 deg C
+
+// 6 Byte Payload of the MFR_* and SCALING_FACTOR Registers
+struct BIC2200Bytes6 {
+    byte b[6];
+};
+
+//#################################################################################################
+//  Struct:         BIC2200Codec
+//  Description:    Little Endian Encode / Decode of the Register Payload, one Specialisation
+//                  per Value Type. Everything is inlined, no Code is left at Runtime
+//#################################################################################################
+template <typename T> struct BIC2200Codec;
+
+template <> struct BIC2200Codec<uint8_t> {
+    static uint8_t decode(const byte * data) { return data[0]; }
+    static void encode(uint8_t value, byte * data) { data[0] = value; }
+};
+
+template <> struct BIC2200Codec<uint16_t> {
+    static uint16_t decode(const byte * data) { return ( data[1] << 8 ) + data[0]; }
+    static void encode(uint16_t value, byte * data) { data[0] = lowByte(value); data[1] = highByte(value); }
+};
+
+template <> struct BIC2200Codec<int16_t> {
+    static int16_t decode(const byte * data) { return (int16_t)(( data[1] << 8 ) + data[0]); }
+    static void encode(int16_t value, byte * data) { data[0] = lowByte(value); data[1] = highByte(value); }
+};
+
+template <> struct BIC2200Codec<BIC2200Bytes6> {
+    static BIC2200Bytes6 decode(const byte * data) { BIC2200Bytes6 v; memcpy(v.b, data, 6); return v; }
+    static void encode(const BIC2200Bytes6 & value, byte * data) { memcpy(data, value.b, 6); }
+};
+
+template <typename T> struct BIC2200IsSigned { static const bool value = false; };
+template <> struct BIC2200IsSigned<int16_t> { static const bool value = true; };
+
+//#################################################################################################
+//  Struct:         BIC2200Register
+//  Description:    Compile Time Descriptor of one Register: Command Code, Value Type (gives
+//                  Width and Signedness), Scale and Access. BIC2200::read<R>() and write<R>()
+//                  generate the Accessors from it and reject wrong Access at Compile Time
+//#################################################################################################
+template <int Cmd, typename T, byte Scale, byte Access>
+struct BIC2200Register {
+    typedef T type;
+    static const int cmd = Cmd;
+    static const byte width = sizeof(T);
+    static const byte scale = Scale;
+    static const byte access = Access;
+    static const bool isSigned = BIC2200IsSigned<T>::value;
+
+    static T decode(const byte * data) { return BIC2200Codec<T>::decode(data); }
+    static void encode(T value, byte * data) { BIC2200Codec<T>::encode(value, data); }
+};
+
+// Register Table of the BIC-2200
+// Source: https://www.meanwell.com/upload/pdf/bic-2200-e.pdf
+namespace BIC2200Reg {
+    typedef BIC2200Register<CMD_OPERATION,            uint8_t,       BIC2200_SCALE_NONE,        BIC2200_RW>   Operation;
+    typedef BIC2200Register<CMD_VOUT_SET,             uint16_t,      BIC2200_SCALE_VOUT,        BIC2200_RW>   VoutSet;
+    typedef BIC2200Register<CMD_IOUT_SET,             uint16_t,      BIC2200_SCALE_IOUT,        BIC2200_RW>   IoutSet;
+    typedef BIC2200Register<CMD_FAULT_STATUS,         uint16_t,      BIC2200_SCALE_NONE,        BIC2200_READ> FaultStatus;
+    typedef BIC2200Register<CMD_READ_VIN,             uint16_t,      BIC2200_SCALE_VIN,         BIC2200_READ> ReadVin;
+    typedef BIC2200Register<CMD_READ_VOUT,            uint16_t,      BIC2200_SCALE_VOUT,        BIC2200_READ> ReadVout;
+    typedef BIC2200Register<CMD_READ_IOUT,            int16_t,       BIC2200_SCALE_IOUT,        BIC2200_READ> ReadIout;
+    typedef BIC2200Register<CMD_READ_TEMPERATURE_1,   int16_t,       BIC2200_SCALE_TEMPERATURE, BIC2200_READ> ReadTemperature1;
+    typedef BIC2200Register<CMD_MFR_ID_B0B5,          BIC2200Bytes6, BIC2200_SCALE_NONE,        BIC2200_READ> MfrIdB0B5;
+    typedef BIC2200Register<CMD_MFR_ID_B6B11,         BIC2200Bytes6, BIC2200_SCALE_NONE,        BIC2200_READ> MfrIdB6B11;
+    typedef BIC2200Register<CMD_MFR_MODEL_B0B5,       BIC2200Bytes6, BIC2200_SCALE_NONE,        BIC2200_READ> MfrModelB0B5;
+    typedef BIC2200Register<CMD_MFR_MODEL_B6B11,      BIC2200Bytes6, BIC2200_SCALE_NONE,        BIC2200_READ> MfrModelB6B11;
+    typedef BIC2200Register<CMD_MFR_REVISION_B0B5,    BIC2200Bytes6, BIC2200_SCALE_NONE,        BIC2200_READ> MfrRevisionB0B5;
+    typedef BIC2200Register<CMD_MFR_LOCATION_B0B2,    BIC2200Bytes6, BIC2200_SCALE_NONE,        BIC2200_READ> MfrLocationB0B2;
+    typedef BIC2200Register<CMD_MFR_DATE_B0B5,        BIC2200Bytes6, BIC2200_SCALE_NONE,        BIC2200_READ> MfrDateB0B5;
+    typedef BIC2200Register<CMD_MFR_SERIAL_B0B5,      BIC2200Bytes6, BIC2200_SCALE_NONE,        BIC2200_READ> MfrSerialB0B5;
+    typedef BIC2200Register<CMD_MFR_SERIAL_B6B11,     BIC2200Bytes6, BIC2200_SCALE_NONE,        BIC2200_READ> MfrSerialB6B11;
+    typedef BIC2200Register<CMD_SCALING_FACTOR,       BIC2200Bytes6, BIC2200_SCALE_NONE,        BIC2200_READ> ScalingFactor;
+    typedef BIC2200Register<CMD_SYSTEM_STATUS,        uint16_t,      BIC2200_SCALE_NONE,        BIC2200_READ> SystemStatus;
+    typedef BIC2200Register<CMD_SYSTEM_CONFIG,        uint16_t,      BIC2200_SCALE_NONE,        BIC2200_RW>   SystemConfig;
+    typedef BIC2200Register<CMD_DIRECTION_CTRL,       uint8_t,       BIC2200_SCALE_NONE,        BIC2200_RW>   DirectionCtrl;
+    typedef BIC2200Register<CMD_REVERSE_VOUT_SET,     uint16_t,      BIC2200_SCALE_VOUT,        BIC2200_RW>   ReverseVoutSet;
+    typedef BIC2200Register<CMD_REVERSE_IOUT_SET,     uint16_t,      BIC2200_SCALE_IOUT,        BIC2200_RW>   ReverseIoutSet;
+    typedef BIC2200Register<CMD_BIDIRECTIONAL_CONFIG, uint16_t,      BIC2200_SCALE_NONE,        BIC2200_RW>   BidirectionalConfig;
+}
+
+#endif
@@ -0,0 +1,73 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_RINGBUFFER_H
+#define BIC2200_RINGBUFFER_H
+
+#include "bic2200_platform.h"
+
+// Compiler Barrier: keeps the Frame Copy in front of the Index Update
+#define BIC2200_BARRIER()   __asm__ __volatile__("" ::: "memory")
+
+struct BIC2200Frame {
+    unsigned long id;
+    byte len;
+    byte data[8];
+};
+
+//#################################################################################################
+//  Class:          BIC2200RingBuffer
+//  Description:    Lock free Single Producer / Single Consumer Ring Buffer for CAN Frames.
+//                  The Producer is the CAN Receive Interrupt, the Consumer is the Main Loop.
+//                  Indices are single Bytes so every Access is atomic on AVR as well.
+//                  N must be a Power of 2 and <= 128. One Slot always stays free.
+//#################################################################################################
+template <byte N>
+class BIC2200RingBuffer {
+
+    static_assert(N >= 2 && N <= 128 && (N & (N - 1)) == 0, "Ring Buffer Size must be a Power of 2");
+
+public:
+    BIC2200RingBuffer() : _head(0), _tail(0), _overflows(0) {}
+
+    bool push(const BIC2200Frame & frame) {
+        byte head = _head;
+        byte next = (head + 1) & (N - 1);
+        if (next == _tail) {
+            ++_overflows;
+            return false;
+        }
+        _frames[head] = frame;
+        BIC2200_BARRIER();
+        _head = next;
+        return true;
+    }
+
+    bool pop(BIC2200Frame & frame) {
+        byte tail = _tail;
+        if (tail == _head) {
+            return false;
+        }
+        frame = _frames[tail];
+        BIC2200_BARRIER();
+        _tail = (tail + 1) & (N - 1);
+        return true;
+    }
+
+    bool isEmpty() const { return _tail == _head; }
+    void clear() { _tail = _head; }
+    unsigned int overflows() const { return _overflows; }
+
+private:
+    BIC2200Frame _frames[N];
+    volatile byte _head;
+    volatile byte _tail;
+    volatile unsigned int _overflows;
+
+};
+
+#endif
@@ -0,0 +1,425 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200_scheduler.h"
+
+// 0.01 % of the Bus per Bit and us of Period
+#define BIC2200_LOAD_PER_BIT    ((unsigned long)(10000000000.0 / CAN_BAUDRATE))
+
+void BIC2200Scheduler::begin(BIC2200Bus & bus) {
+//#################################################################################################
+//  Function:       begin
+//  Access:         Public
+//  Input:          bus (BIC2200Bus &) Bus of all scheduled Devices, gives the Clock
+//  Output:         -
+//  Description:    Starts the Scheduler without Entries
+//#################################################################################################
+    _bus = &bus;
+    _count = 0;
+    _phase = 0;
+    for (byte i = 0; i < BIC2200_SCHEDULER_ENTRIES; i++) {
+        _entries[i].device = NULL;
+    }
+}
+
+int BIC2200Scheduler::add(BIC2200 & device, int reg, unsigned long period, byte priority) {
+//#################################################################################################
+//  Function:       add
+//  Access:         Public
+//  Input:          device (BIC2200 &) Device to Poll, attached to the Bus of begin()
+//                  reg (int) Register to Read [up to 16 Bit]
+//                  period (unsigned long) [1 - 2000000] ms between two Polls, e.g. 20 = 50 Hz
+//                  priority (byte) higher Value = shed later
+//  Output:         (int) -1 = rejected (full, duplicate, too wide or over Budget); else Entry
+//  Description:    Admits a periodic Poll if the projected Load of all Entries with the same
+//                  or a higher Priority stays within the Budget. Entries with a lower Priority
+//                  are shed to make Room. The first Poll is due after the Frames of the Entries
+//                  added before, so the Polls are spread over the Period
+//#################################################################################################
+    int free = -1;
+    unsigned int load;
+    unsigned long demand = 0;
+
+    if (_bus == NULL || period == 0 || period > 2000000UL || _bitsOf(reg) == 0) {
+        return -1;
+    }
+    for (byte i = 0; i < BIC2200_SCHEDULER_ENTRIES; i++) {
+        BIC2200ScheduleEntry & entry = _entries[i];
+        if (entry.device == NULL) {
+            if (free < 0) {
+                free = i;
+            }
+            continue;
+        }
+        if (entry.device == &device && entry.reg == reg) {
+            return -1;
+        }
+        if (entry.priority >= priority) {
+            demand += entry.load;
+        }
+    }
+    load = loadOf(reg, period * 1000);
+    if (free < 0 || demand + load > _budget) {
+        return -1;
+    }
+
+    BIC2200ScheduleEntry & entry = _entries[free];
+    entry = BIC2200ScheduleEntry();
+    entry.device = &device;
+    entry.reg = reg;
+    entry.period = period * 1000;
+    // Start behind the Frames of the Entries added before, so they do not all get due at once
+    entry.nextDue = _bus->micros() + _phase % entry.period;
+    _phase += (_bitsOf(reg) * 1000000UL) / (unsigned long)CAN_BAUDRATE;
+    entry.load = load;
+    entry.priority = priority;
+
+    // Insert behind all Entries with the same or a higher Priority
+    byte pos = _count;
+    while (pos > 0 && _entries[_order[pos - 1]].priority < priority) {
+        _order[pos] = _order[pos - 1];
+        --pos;
+    }
+    _order[pos] = free;
+    ++_count;
+
+    _rebalance();
+    return free;
+}
+
+void BIC2200Scheduler::remove(int entry) {
+//#################################################################################################
+//  Function:       remove
+//  Access:         Public
+//  Input:          entry (int) Entry returned by add()
+//  Output:         -
+//  Description:    Stops a periodic Poll. An open Request is finished first (max. one Timeout),
+//                  so its Transaction Slot is freed. Shed Entries may come back
+//#################################################################################################
+    if (entry < 0 || entry >= BIC2200_SCHEDULER_ENTRIES || _entries[entry].device == NULL) {
+        return;
+    }
+    while (_entries[entry].waiting) {
+        _bus->poll();
+        _collect(_entries[entry]);
+    }
+    _entries[entry].device = NULL;
+
+    byte pos = 0;
+    for (byte i = 0; i < _count; i++) {
+        if (_order[i] != entry) {
+            _order[pos++] = _order[i];
+        }
+    }
+    _count = pos;
+    _rebalance();
+}
+
+bool BIC2200Scheduler::setBudget(byte percent) {
+//#################################################################################################
+//  Function:       setBudget
+//  Access:         Public
+//  Input:          percent (byte) [1 - 100] Share of the Bus the scheduled Polls may use
+//  Output:         (bool) false = percent invalid; true = Budget set
+//  Description:    Changes the Budget and sheds or restores Entries by Priority. Leave Room for
+//                  Writes and other Traffic on the Bus
+//#################################################################################################
+    if (percent < 1 || percent > 100) {
+        return false;
+    }
+    _budget = percent * 100;
+    _rebalance();
+    return true;
+}
+
+unsigned long BIC2200Scheduler::getLoad() {
+//#################################################################################################
+//  Function:       getLoad
+//  Access:         Public
+//  Input:          -
+//  Output:         (unsigned long) projected Bus Load of the polled Entries in 0.01 %
+//  Description:    Worst Case Frame Bits per Second of all not shed Entries against CAN_BAUDRATE
+//#################################################################################################
+    unsigned long load = 0;
+    for (byte i = 0; i < _count; i++) {
+        if (!_entries[_order[i]].shed) {
+            load += _entries[_order[i]].load;
+        }
+    }
+    return load;
+}
+
+unsigned long BIC2200Scheduler::getDemand() {
+//#################################################################################################
+//  Function:       getDemand
+//  Access:         Public
+//  Input:          -
+//  Output:         (unsigned long) projected Bus Load of all Entries incl. shed ones in 0.01 %
+//  Description:    Load the Schedule would need to poll every Entry
+//#################################################################################################
+    unsigned long load = 0;
+    for (byte i = 0; i < _count; i++) {
+        load += _entries[_order[i]].load;
+    }
+    return load;
+}
+
+bool BIC2200Scheduler::isShed(int entry) {
+//#################################################################################################
+//  Function:       isShed
+//  Access:         Public
+//  Input:          entry (int) Entry returned by add()
+//  Output:         (bool) true = Entry is over Budget and not polled
+//  Description:    Checks if an Entry was shed in favour of higher Priorities
+//#################################################################################################
+    if (entry < 0 || entry >= BIC2200_SCHEDULER_ENTRIES || _entries[entry].device == NULL) {
+        return false;
+    }
+    return _entries[entry].shed;
+}
+
+bool BIC2200Scheduler::isWaiting(int entry) {
+//#################################################################################################
+//  Function:       isWaiting
+//  Access:         Public
+//  Input:          entry (int) Entry returned by add()
+//  Output:         (bool) true = a Request of the Entry is open
+//  Description:    Checks if remove() would have to wait for a Reply or Timeout
+//#################################################################################################
+    if (entry < 0 || entry >= BIC2200_SCHEDULER_ENTRIES || _entries[entry].device == NULL) {
+        return false;
+    }
+    return _entries[entry].waiting;
+}
+
+int BIC2200Scheduler::run() {
+//#################################################################################################
+//  Function:       run
+//  Access:         Public
+//  Input:          -
+//  Output:         (int) Number of Requests issued during this Call
+//  Description:    Issues every due Poll in Priority Order, drives the Bus and collects the
+//                  Replies. Call it as often as possible from loop(). A Poll whose previous
+//                  Request is still open when it gets due is counted as Deadline Miss and its
+//                  Period is skipped
+//#################################################################################################
+    int issued = 0;
+
+    if (_bus == NULL) {
+        return 0;
+    }
+    unsigned long now = _bus->micros();
+    for (byte i = 0; i < _count; i++) {
+        BIC2200ScheduleEntry & entry = _entries[_order[i]];
+        if (entry.shed || (long)(now - entry.nextDue) < 0) {
+            continue;
+        }
+        unsigned long late = now - entry.nextDue;
+        if (!entry.waiting && entry.device->requestRead(entry.reg)) {
+            entry.waiting = true;
+            ++entry.stats.issued;
+            entry.stats.jitterSum += late;
+            if (late > entry.stats.jitterMax) {
+                entry.stats.jitterMax = late;
+            }
+            ++issued;
+        } else if (!entry.waiting && late < entry.period) {
+            // No free Transaction Slot, try again with the next Call
+            continue;
+        } else {
+            ++entry.stats.misses;
+        }
+        entry.nextDue += entry.period;
+        if ((long)(now - entry.nextDue) >= 0) {
+            // More than one Period behind, restart the Phase instead of bursting
+            entry.nextDue = now + entry.period;
+        }
+    }
+
+    _bus->poll();
+
+    for (byte i = 0; i < _count; i++) {
+        _collect(_entries[_order[i]]);
+    }
+    return issued;
+}
+
+bool BIC2200Scheduler::getValue(int entry, unsigned int & value) {
+//#################################################################################################
+//  Function:       getValue
+//  Access:         Public
+//  Input:          entry (int) Entry returned by add()
+//                  value (unsigned int &) Destination of the raw Register Word
+//  Output:         (bool) false = no valid Reply yet; true = value is valid
+//  Description:    Latest polled Value of an Entry, see getAge() for its Freshness
+//#################################################################################################
+    if (entry < 0 || entry >= BIC2200_SCHEDULER_ENTRIES || !_entries[entry].valid) {
+        return false;
+    }
+    value = _entries[entry].value;
+    return true;
+}
+
+unsigned long BIC2200Scheduler::getAge(int entry) {
+//#################################################################################################
+//  Function:       getAge
+//  Access:         Public
+//  Input:          entry (int) Entry returned by add()
+//  Output:         (unsigned long) 0xFFFFFFFF = no valid Reply yet; else us since the last Reply
+//  Description:    Freshness of the Value of an Entry
+//#################################################################################################
+    if (entry < 0 || entry >= BIC2200_SCHEDULER_ENTRIES || !_entries[entry].valid) {
+        return 0xFFFFFFFFUL;
+    }
+    return _bus->micros() - _entries[entry].updatedAt;
+}
+
+unsigned long BIC2200Scheduler::getSamples(int entry) {
+//#################################################################################################
+//  Function:       getSamples
+//  Access:         Public
+//  Input:          entry (int) Entry returned by add()
+//  Output:         (unsigned long) Number of valid Replies so far
+//  Description:    Cheap Check for a new Value: the Count changes with every Reply
+//#################################################################################################
+    if (entry < 0 || entry >= BIC2200_SCHEDULER_ENTRIES) {
+        return 0;
+    }
+    return _entries[entry].stats.received;
+}
+
+unsigned long BIC2200Scheduler::getUpdatedAt(int entry) {
+//#################################################################################################
+//  Function:       getUpdatedAt
+//  Access:         Public
+//  Input:          entry (int) Entry returned by add()
+//  Output:         (unsigned long) micros() of the last valid Reply
+//  Description:    Time Stamp of the Value returned by getValue()
+//#################################################################################################
+    if (entry < 0 || entry >= BIC2200_SCHEDULER_ENTRIES) {
+        return 0;
+    }
+    return _entries[entry].updatedAt;
+}
+
+BIC2200ScheduleStats BIC2200Scheduler::getStats(int entry) {
+//#################################################################################################
+//  Function:       getStats
+//  Access:         Public
+//  Input:          entry (int) Entry returned by add()
+//  Output:         (BIC2200ScheduleStats) Request, Reply, Timeout, Miss and Jitter Counters
+//  Description:    Shows if an Entry keeps its Rate
+//#################################################################################################
+    if (entry < 0 || entry >= BIC2200_SCHEDULER_ENTRIES) {
+        return BIC2200ScheduleStats();
+    }
+    return _entries[entry].stats;
+}
+
+void BIC2200Scheduler::resetStats() {
+//#################################################################################################
+//  Function:       resetStats
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Sets the Counters of all Entries to 0
+//#################################################################################################
+    for (byte i = 0; i < BIC2200_SCHEDULER_ENTRIES; i++) {
+        _entries[i].stats = BIC2200ScheduleStats();
+    }
+}
+
+unsigned int BIC2200Scheduler::loadOf(int reg, unsigned long period) {
+//#################################################################################################
+//  Function:       loadOf
+//  Access:         Public (static)
+//  Input:          reg (int) Register
+//                  period (unsigned long) us between two Polls
+//  Output:         (unsigned int) 0 = Register not supported; else Bus Load in 0.01 % (rounded up)
+//  Description:    Worst Case Bits of the Request and the Reply Frame per Period
+//#################################################################################################
+    return (_bitsOf(reg) * BIC2200_LOAD_PER_BIT + period - 1) / period;
+}
+
+unsigned long BIC2200Scheduler::_bitsOf(int reg) {
+//#################################################################################################
+//  Function:       _bitsOf
+//  Access:         Private (static)
+//  Input:          reg (int) Register
+//  Output:         (unsigned long) 0 = Register not supported; else Worst Case Bits of one Poll
+//  Description:    Bits of the 2 Byte Request and the Reply with Register Echo and Value
+//#################################################################################################
+    byte replyBytes;
+    switch (reg) {
+        case CMD_OPERATION:
+        case CMD_DIRECTION_CTRL:
+            replyBytes = 1;
+            break;
+        case CMD_VOUT_SET:
+        case CMD_IOUT_SET:
+        case CMD_FAULT_STATUS:
+        case CMD_READ_VIN:
+        case CMD_READ_VOUT:
+        case CMD_READ_IOUT:
+        case CMD_READ_TEMPERATURE_1:
+        case CMD_SYSTEM_STATUS:
+        case CMD_SYSTEM_CONFIG:
+        case CMD_REVERSE_VOUT_SET:
+        case CMD_REVERSE_IOUT_SET:
+        case CMD_BIDIRECTIONAL_CONFIG:
+            replyBytes = 2;
+            break;
+        default:
+            return 0;
+    }
+    return BIC2200_FRAME_BITS(2) + BIC2200_FRAME_BITS(2 + replyBytes);
+}
+
+void BIC2200Scheduler::_rebalance() {
+//#################################################################################################
+//  Function:       _rebalance
+//  Access:         Private
+//  Input:          -
+//  Output:         -
+//  Description:    Fills the Budget by Priority, Entries which do not fit any more are shed
+//#################################################################################################
+    unsigned long load = 0;
+    for (byte i = 0; i < _count; i++) {
+        BIC2200ScheduleEntry & entry = _entries[_order[i]];
+        entry.shed = (load + entry.load > _budget);
+        if (!entry.shed) {
+            load += entry.load;
+        }
+    }
+}
+
+void BIC2200Scheduler::_collect(BIC2200ScheduleEntry & entry) {
+//#################################################################################################
+//  Function:       _collect
+//  Access:         Private
+//  Input:          entry (BIC2200ScheduleEntry &) Entry with an open Request
+//  Output:         -
+//  Description:    Fetches the Result of the open Request of an Entry, if finished
+//#################################################################################################
+    byte data[2] = {};
+    if (!entry.waiting) {
+        return;
+    }
+    int result = entry.device->getResult(entry.reg, data, sizeof(data));
+    if (result < 0) {
+        return;
+    }
+    entry.waiting = false;
+    if (result == 1) {
+        entry.value = ( data[1] << 8 ) + data[0];
+        entry.updatedAt = _bus->micros();
+        entry.valid = true;
+        ++entry.stats.received;
+    } else {
+        ++entry.stats.timeouts;
+    }
+}
@@ -0,0 +1,92 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_SCHEDULER_H
+#define BIC2200_SCHEDULER_H
+
+#include "bic2200.h"
+
+#ifndef BIC2200_SCHEDULER_ENTRIES
+#define BIC2200_SCHEDULER_ENTRIES   16  // Periodic Polls of all Devices
+#endif
+#define BIC2200_SCHEDULER_BUDGET    70  // Default % of the Bus the scheduled Polls may use
+
+// Worst Case Bits of an Extended Frame with len Data Bytes incl. Stuff Bits and Interframe Space
+#define BIC2200_FRAME_BITS(len)     (67 + 8 * (len) + (53 + 8 * (len)) / 4)
+
+// Counters of one Schedule Entry
+struct BIC2200ScheduleStats {
+    unsigned long issued;       // Requests sent
+    unsigned long received;     // valid Replies
+    unsigned long timeouts;
+    unsigned long misses;       // Periods skipped because the previous Poll was still open
+    unsigned long jitterMax;    // us from Due Time to Request queued
+    unsigned long jitterSum;
+};
+
+struct BIC2200ScheduleEntry {
+    BIC2200 * device;           // NULL = Entry free
+    int reg;
+    unsigned long period;       // us
+    unsigned long nextDue;      // micros()
+    unsigned int load;          // 0.01 % of the Bus
+    unsigned int value;
+    unsigned long updatedAt;    // micros() of the last valid Reply
+    byte priority;              // higher Value = more important
+    bool shed;                  // over Budget, not polled
+    bool waiting;               // Request open
+    bool valid;
+    BIC2200ScheduleStats stats;
+};
+
+//#################################################################################################
+//  Class:          BIC2200Scheduler
+//  Description:    Cooperative Scheduler for periodic Register Polls of several Devices. Every
+//                  Entry costs a projected Share of the Bus (Request + Reply Frame per Period);
+//                  Entries are admitted against a Bus Budget and the lowest Priorities are shed
+//                  when the Budget is exceeded. run() never blocks, Replies are collected with
+//                  getResult(), so the Devices must not have a Reply Callback.
+//#################################################################################################
+class BIC2200Scheduler {
+
+public:
+    void begin(BIC2200Bus & bus);
+    int add(BIC2200 & device, int reg, unsigned long period, byte priority);
+    void remove(int entry);
+    bool setBudget(byte percent);
+
+    unsigned long getLoad();
+    unsigned long getDemand();
+    bool isShed(int entry);
+    bool isWaiting(int entry);
+
+    int run();
+
+    bool getValue(int entry, unsigned int & value);
+    unsigned long getAge(int entry);
+    unsigned long getSamples(int entry);
+    unsigned long getUpdatedAt(int entry);
+    BIC2200ScheduleStats getStats(int entry);
+    void resetStats();
+
+    static unsigned int loadOf(int reg, unsigned long period);
+
+private:
+    BIC2200Bus * _bus = NULL;
+    unsigned int _budget = BIC2200_SCHEDULER_BUDGET * 100;  // 0.01 % of the Bus
+    BIC2200ScheduleEntry _entries[BIC2200_SCHEDULER_ENTRIES] = {};
+    byte _order[BIC2200_SCHEDULER_ENTRIES];                  // Entry Indices by Priority
+    byte _count = 0;
+    unsigned long _phase = 0;                                // us, Start Offset of the next Entry
+
+    static unsigned long _bitsOf(int reg);
+    void _rebalance();
+    void _collect(BIC2200ScheduleEntry & entry);
+
+};
+
+#endif
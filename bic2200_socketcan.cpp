@@ -0,0 +1,212 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     // ppoll()
+#endif
+
+#include "bic2200_socketcan.h"
+#include "bic2200.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+BIC2200SocketCANTransport::BIC2200SocketCANTransport(const char * interface) {
+//#################################################################################################
+//  Function:       BIC2200SocketCANTransport
+//  Access:         Public
+//  Input:          interface (const char *) Name of the SocketCAN Interface, e.g. "can0"
+//  Output:         -
+//  Description:    Binds the Transport to an Interface, nothing is opened yet
+//#################################################################################################
+    snprintf(_interface, sizeof(_interface), "%s", interface);
+}
+
+BIC2200SocketCANTransport::~BIC2200SocketCANTransport() {
+//#################################################################################################
+//  Function:       ~BIC2200SocketCANTransport
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Closes the Socket
+//#################################################################################################
+    end();
+}
+
+int BIC2200SocketCANTransport::begin(BIC2200Bus & bus) {
+//#################################################################################################
+//  Function:       begin
+//  Access:         Public
+//  Input:          bus (BIC2200Bus &) Bus which gets the received Frames
+//  Output:         (int) 0 = Interface not usable, see getError(); 1 = Socket open
+//  Description:    Opens a non-blocking raw CAN Socket on the Interface and filters the
+//                  Receive IDs of all 8 Device Adresses, like the MCP2515 Acceptance Filters
+//#################################################################################################
+    struct ifreq request;
+    struct sockaddr_can address;
+    struct can_filter filter;
+
+    end();
+    _socket = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (_socket < 0) {
+        _error = errno;
+        return 0;
+    }
+
+    memset(&request, 0, sizeof(request));
+    snprintf(request.ifr_name, sizeof(request.ifr_name), "%s", _interface);
+    memset(&address, 0, sizeof(address));
+    address.can_family = AF_CAN;
+    // Accept 0x000C0200 - 0x000C0207 only
+    filter.can_id = MSG_ID_CAN_RECEIVE_00 | CAN_EFF_FLAG;
+    filter.can_mask = (CAN_EFF_MASK & ~(BIC2200_MAX_DEVICES - 1)) | CAN_EFF_FLAG | CAN_RTR_FLAG;
+
+    if (ioctl(_socket, SIOCGIFINDEX, &request) < 0 ||
+        setsockopt(_socket, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof(filter)) < 0 ||
+        fcntl(_socket, F_SETFL, fcntl(_socket, F_GETFL) | O_NONBLOCK) < 0) {
+        _error = errno;
+        end();
+        return 0;
+    }
+    address.can_ifindex = request.ifr_ifindex;
+    if (bind(_socket, (struct sockaddr *)&address, sizeof(address)) < 0) {
+        _error = errno;
+        end();
+        return 0;
+    }
+    _bus = &bus;
+    _error = 0;
+    return 1;
+}
+
+void BIC2200SocketCANTransport::end() {
+//#################################################################################################
+//  Function:       end
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Closes the Socket, begin() opens it again
+//#################################################################################################
+    if (_socket >= 0) {
+        close(_socket);
+        _socket = -1;
+    }
+    _bus = NULL;
+}
+
+bool BIC2200SocketCANTransport::send(const BIC2200Frame & frame) {
+//#################################################################################################
+//  Function:       send
+//  Access:         Public
+//  Input:          frame (const BIC2200Frame &) Extended Frame to send
+//  Output:         (bool) false = Frame not sent, see getError(); true = Frame queued
+//  Description:    Queues one Extended Frame in the TX Queue of the Interface. A full Queue
+//                  (ENOBUFS, e.g. no Acknowledge on the Bus) is waited for up to
+//                  BIC2200_SOCKETCAN_SEND_WAIT ms
+//#################################################################################################
+    struct can_frame out;
+
+    if (_socket < 0) {
+        return false;
+    }
+    memset(&out, 0, sizeof(out));
+    out.can_id = (frame.id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+    out.can_dlc = (frame.len > 8) ? 8 : frame.len;
+    memcpy(out.data, frame.data, out.can_dlc);
+
+    unsigned long startedAt = millis();
+    while (write(_socket, &out, sizeof(out)) != (ssize_t)sizeof(out)) {
+        if ((errno != ENOBUFS && errno != EAGAIN) || millis() - startedAt >= BIC2200_SOCKETCAN_SEND_WAIT) {
+            _error = errno;
+            return false;
+        }
+        // ENOBUFS does not wake up poll(), retry after a Frame Time
+        _waitFor(POLLOUT, 500);
+    }
+    return true;
+}
+
+void BIC2200SocketCANTransport::service() {
+//#################################################################################################
+//  Function:       service
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Hands every received Data Frame to the Bus. Sleeps up to the Wait Time of
+//                  setWait() if no Frame is there yet
+//#################################################################################################
+    struct can_frame in;
+    BIC2200Frame frame;
+
+    if (_socket < 0 || _bus == NULL) {
+        return;
+    }
+    if (_wait > 0) {
+        _waitFor(POLLIN, _wait);
+    }
+    while (read(_socket, &in, sizeof(in)) == (ssize_t)sizeof(in)) {
+        if (!(in.can_id & CAN_EFF_FLAG) || (in.can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG))) {
+            continue;
+        }
+        frame.id = in.can_id & CAN_EFF_MASK;
+        frame.len = (in.can_dlc > 8) ? 8 : in.can_dlc;
+        memcpy(frame.data, in.data, frame.len);
+        _bus->dispatch(frame);
+    }
+}
+
+unsigned long BIC2200SocketCANTransport::micros() {
+//#################################################################################################
+//  Function:       micros
+//  Access:         Public
+//  Input:          -
+//  Output:         (unsigned long) us of the monotonic Clock, wraps like the Arduino micros()
+//  Description:    Clock of the Library Timeouts
+//#################################################################################################
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)((uint64_t)now.tv_sec * 1000000ULL + now.tv_nsec / 1000);
+}
+
+unsigned long BIC2200SocketCANTransport::millis() {
+//#################################################################################################
+//  Function:       millis
+//  Access:         Public
+//  Input:          -
+//  Output:         (unsigned long) ms of the monotonic Clock
+//  Description:    Clock of the Cache and the Probes of degraded Devices
+//#################################################################################################
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)((uint64_t)now.tv_sec * 1000ULL + now.tv_nsec / 1000000);
+}
+
+bool BIC2200SocketCANTransport::_waitFor(short events, unsigned long us) {
+//#################################################################################################
+//  Function:       _waitFor
+//  Access:         Private
+//  Input:          events (short) POLLIN or POLLOUT
+//                  us (unsigned long) max. Wait
+//  Output:         (bool) true = Socket ready
+//  Description:    Sleeps until the Socket is ready or the Time is up
+//#################################################################################################
+    struct pollfd fd = { _socket, events, 0 };
+    struct timespec timeout = { (time_t)(us / 1000000UL), (long)(us % 1000000UL) * 1000L };
+    return ppoll(&fd, 1, &timeout, NULL) > 0;
+}
+
+#endif
@@ -0,0 +1,60 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_SOCKETCAN_H
+#define BIC2200_SOCKETCAN_H
+
+#if !defined(ARDUINO) && defined(__linux__)
+
+#include "bic2200_transport.h"
+
+#ifndef BIC2200_SOCKETCAN_WAIT
+#define BIC2200_SOCKETCAN_WAIT      100     // us service() sleeps for a Frame, 0 = never sleeps
+#endif
+#define BIC2200_SOCKETCAN_SEND_WAIT 100     // ms send() waits for Space in the TX Queue
+
+//#################################################################################################
+//  Class:          BIC2200SocketCANTransport
+//  Description:    Transport over a Linux SocketCAN Interface (can0 with a USB or SPI Adapter,
+//                  vcan0 for Tests). A raw Socket filters the BIC-2200 Reply IDs in the Kernel,
+//                  service() hands the received Frames to the Bus. service() sleeps up to
+//                  BIC2200_SOCKETCAN_WAIT us for a Frame, so the blocking Reads of the Library
+//                  do not spin the CPU. The Interface Bitrate (250 kbit/s) is set by the System:
+//                      ip link set can0 up type can bitrate 250000
+//#################################################################################################
+class BIC2200SocketCANTransport : public BIC2200Transport {
+
+public:
+    explicit BIC2200SocketCANTransport(const char * interface = "can0");
+    ~BIC2200SocketCANTransport();
+
+    void setWait(unsigned long us) { _wait = us; }
+
+    int begin(BIC2200Bus & bus);
+    void end();
+    bool send(const BIC2200Frame & frame);
+    void service();
+
+    unsigned long micros();
+    unsigned long millis();
+
+    int getError() const { return _error; }
+
+private:
+    char _interface[16];
+    int _socket = -1;
+    int _error = 0;                 // errno of the last failed System Call
+    unsigned long _wait = BIC2200_SOCKETCAN_WAIT;
+    BIC2200Bus * _bus = NULL;
+
+    bool _waitFor(short events, unsigned long us);
+
+};
+
+#endif
+
+#endif
@@ -0,0 +1,126 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200.h"
+
+#if BIC2200_ENABLE_STATS
+
+const BIC2200Stats & BIC2200::getStats() {
+//#################################################################################################
+//  Function:       getStats
+//  Access:         Public
+//  Input:          -
+//  Output:         (const BIC2200Stats &) Frame, Timeout and Reply Latency Counters
+//  Description:    Shows why Reads fail (Timeout, mismatched or missing Echo) and how close
+//                  the Reply Latency gets to CAN_REPLY_TIME + CAN_TIMEOUT
+//#################################################################################################
+    return _stats;
+}
+
+BIC2200RegisterStats BIC2200::getRegisterStats(int reg) {
+//#################################################################################################
+//  Function:       getRegisterStats
+//  Access:         Public
+//  Input:          reg (int) Register
+//  Output:         (BIC2200RegisterStats) Counters of the Register; all 0 for MFR_* Registers
+//  Description:    Counters of one Register
+//#################################################################################################
+    int slot = registerSlot(reg);
+    if (slot < 0) {
+        return BIC2200RegisterStats();
+    }
+    return _stats.registers[slot];
+}
+
+void BIC2200::resetStats() {
+//#################################################################################################
+//  Function:       resetStats
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Sets all Counters and the Latency Histogram to 0
+//#################################################################################################
+    _stats = BIC2200Stats();
+}
+
+void BIC2200::_statsSent(int reg) {
+//#################################################################################################
+//  Function:       _statsSent
+//  Access:         Private
+//  Input:          reg (int) Register of the Read Request or Write
+//  Output:         -
+//  Description:    Counts a Frame sent to the Device
+//#################################################################################################
+    ++_stats.framesSent;
+    int slot = registerSlot(reg);
+    if (slot >= 0) {
+        ++_stats.registers[slot].sent;
+    }
+}
+
+void BIC2200::_statsReply(int reg, unsigned long rtt) {
+//#################################################################################################
+//  Function:       _statsReply
+//  Access:         Private
+//  Input:          reg (int) Register of the Reply
+//                  rtt (unsigned long) us from Request sent to Reply received
+//  Output:         -
+//  Description:    Counts a matched Reply and adds its Latency to Min / Avg / Max and Histogram
+//#################################################################################################
+    if (_stats.rttCount == 0 || rtt < _stats.rttMin) {
+        _stats.rttMin = rtt;
+    }
+    if (rtt > _stats.rttMax) {
+        _stats.rttMax = rtt;
+    }
+    _stats.rttSum += rtt;
+    ++_stats.rttCount;
+
+    unsigned long bucket = rtt / BIC2200_STATS_BUCKET_US;
+    if (bucket >= BIC2200_STATS_BUCKETS) {
+        bucket = BIC2200_STATS_BUCKETS - 1;
+    }
+    ++_stats.histogram[bucket];
+
+    int slot = registerSlot(reg);
+    if (slot >= 0) {
+        ++_stats.registers[slot].received;
+    }
+}
+
+void BIC2200::_statsTimeout(int reg) {
+//#################################################################################################
+//  Function:       _statsTimeout
+//  Access:         Private
+//  Input:          reg (int) Register of the expired Request
+//  Output:         -
+//  Description:    Counts a Request without Reply
+//#################################################################################################
+    ++_stats.timeouts;
+    int slot = registerSlot(reg);
+    if (slot >= 0) {
+        ++_stats.registers[slot].timeouts;
+    }
+}
+
+void BIC2200::_statsMismatch(int reg) {
+//#################################################################################################
+//  Function:       _statsMismatch
+//  Access:         Private
+//  Input:          reg (int) Register Echo of the Reply, -1 = Reply without Echo
+//  Output:         -
+//  Description:    Counts a Reply which belongs to no outstanding Request, e.g. a late Reply
+//                  after its Timeout
+//#################################################################################################
+    ++_stats.mismatches;
+    int slot = registerSlot(reg);
+    if (slot >= 0) {
+        ++_stats.registers[slot].mismatches;
+    }
+}
+
+#endif
@@ -0,0 +1,220 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200.h"
+
+#if BIC2200_ENABLE_ADAPTIVE_TIMEOUT
+
+#define BIC2200_FIXED_TIMEOUT   (CAN_REPLY_TIME + CAN_TIMEOUT)
+
+void BIC2200::setAdaptiveTimeout(bool enable) {
+//#################################################################################################
+//  Function:       setAdaptiveTimeout
+//  Access:         Public
+//  Input:          enable (bool) false = fixed CAN_REPLY_TIME + CAN_TIMEOUT; true = learned (Default)
+//  Output:         -
+//  Description:    Switches between the Timeout learned from the Round Trip Times and the
+//                  fixed Timeout. Retries and the degraded State work with both
+//#################################################################################################
+    _adaptive = enable;
+}
+
+void BIC2200::setRetries(byte retries) {
+//#################################################################################################
+//  Function:       setRetries
+//  Access:         Public
+//  Input:          retries (byte) Requests sent again after a Timeout before a Read fails
+//  Output:         -
+//  Description:    Bounds the Retries of every Read, Default BIC2200_RETRIES
+//#################################################################################################
+    _retries = retries;
+}
+
+void BIC2200::setDegradeAfter(byte failures) {
+//#################################################################################################
+//  Function:       setDegradeAfter
+//  Access:         Public
+//  Input:          failures (byte) Reads failed in a Row until the Device is degraded, 0 = never
+//  Output:         -
+//  Description:    A degraded Device gets one Request per BIC2200_PROBE_INTERVAL, all other
+//                  Reads fail at once without Bus Access. The first Reply makes it healthy again
+//#################################################################################################
+    _degradeAfter = failures;
+    if (failures == 0) {
+        _degraded = false;
+    }
+}
+
+unsigned long BIC2200::getTimeout() {
+//#################################################################################################
+//  Function:       getTimeout
+//  Access:         Public
+//  Input:          -
+//  Output:         (unsigned long) us without Reply until a Request expires
+//  Description:    Current Timeout of the Device incl. Backoff
+//#################################################################################################
+    return _timeout();
+}
+
+bool BIC2200::isDegraded() {
+//#################################################################################################
+//  Function:       isDegraded
+//  Access:         Public
+//  Input:          -
+//  Output:         (bool) true = Device failed BIC2200_DEGRADE_AFTER Reads in a Row, only probed
+//  Description:    Checks if the Polling of the Device is cut down
+//#################################################################################################
+    return _degraded;
+}
+
+BIC2200TimeoutStats BIC2200::getTimeoutStats() {
+//#################################################################################################
+//  Function:       getTimeoutStats
+//  Access:         Public
+//  Input:          -
+//  Output:         (BIC2200TimeoutStats) Round Trip Estimate, Retry Counters and Waiting Time
+//  Description:    timeSaved() compares the Time waited for Requests without Reply with the
+//                  fixed Timeout, per sent or skipped Request
+//#################################################################################################
+    BIC2200TimeoutStats stats = _timeoutStats;
+    stats.rtt = _srtt >> 3;
+    stats.rttDeviation = _rttvar >> 2;
+    stats.timeout = _timeout();
+    return stats;
+}
+
+void BIC2200::resetTimeoutStats() {
+//#################################################################################################
+//  Function:       resetTimeoutStats
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Sets the Counters to 0, the Round Trip Estimate is kept
+//#################################################################################################
+    _timeoutStats = BIC2200TimeoutStats();
+}
+
+unsigned long BIC2200::_timeout() {
+//#################################################################################################
+//  Function:       _timeout
+//  Access:         Private
+//  Input:          -
+//  Output:         (unsigned long) us without Reply until a Request expires
+//  Description:    Smoothed RTT + K * Deviation (at least BIC2200_TIMEOUT_MARGIN above), the
+//                  fixed Timeout until the first Sample. Doubled for every Timeout since the
+//                  last Sample and bounded by BIC2200_TIMEOUT_MAX
+//#################################################################################################
+    unsigned long timeout = BIC2200_FIXED_TIMEOUT;
+
+    if (!_adaptive) {
+        return timeout;
+    }
+    if (_srtt != 0) {
+        unsigned long deviation = BIC2200_RTT_K * (_rttvar >> 2);
+        timeout = (_srtt >> 3) + ((deviation > BIC2200_TIMEOUT_MARGIN) ? deviation : BIC2200_TIMEOUT_MARGIN);
+    }
+    for (byte i = 0; i < _backoff && timeout < BIC2200_TIMEOUT_MAX; i++) {
+        timeout <<= 1;
+    }
+    return (timeout > BIC2200_TIMEOUT_MAX) ? BIC2200_TIMEOUT_MAX : timeout;
+}
+
+bool BIC2200::_admit(BIC2200Transaction & transaction) {
+//#################################################################################################
+//  Function:       _admit
+//  Access:         Private
+//  Input:          transaction (BIC2200Transaction &) queued Read about to be sent
+//  Output:         (bool) true = send the Request; false = Read failed at once
+//  Description:    Lets every Request of a healthy Device pass. A degraded Device gets one
+//                  Probe per BIC2200_PROBE_INTERVAL, the other Reads time out without Bus Access
+//#################################################################################################
+    if (!_degraded) {
+        return true;
+    }
+    unsigned long now = _bus->millis();
+    if (now - _probeAt >= BIC2200_PROBE_INTERVAL) {
+        _probeAt = now;
+        return true;
+    }
+    transaction.state = BIC2200_TX_TIMEOUT;
+    transaction.len = 0;
+    ++_timeoutStats.skipped;
+    _timeoutStats.waitFixed += BIC2200_FIXED_TIMEOUT;
+    return false;
+}
+
+bool BIC2200::_expire(BIC2200Transaction & transaction, unsigned long timeout) {
+//#################################################################################################
+//  Function:       _expire
+//  Access:         Private
+//  Input:          transaction (BIC2200Transaction &) sent Request without Reply
+//                  timeout (unsigned long) us the Request waited
+//  Output:         (bool) true = queued again for a Retry; false = Read failed
+//  Description:    Backs the Timeout off and retries while Retries are left. A failed Read
+//                  counts towards the degraded State
+//#################################################################################################
+    ++_timeoutStats.expired;
+    _timeoutStats.waitFixed += BIC2200_FIXED_TIMEOUT;
+    _timeoutStats.waitActual += timeout;
+    if (_adaptive && timeout < BIC2200_TIMEOUT_MAX) {
+        ++_backoff;
+    }
+
+    if (transaction.retries < _retries && !_degraded) {
+        ++transaction.retries;
+        ++_timeoutStats.retries;
+        transaction.state = BIC2200_TX_QUEUED;
+        return true;
+    }
+
+    ++_timeoutStats.failed;
+    if (_failures < 255) {
+        ++_failures;
+    }
+    if (!_degraded && _degradeAfter > 0 && _failures >= _degradeAfter) {
+        _degraded = true;
+        _probeAt = _bus->millis();
+        ++_timeoutStats.degraded;
+    }
+    return false;
+}
+
+void BIC2200::_rttSample(const BIC2200Transaction & transaction, unsigned long rtt) {
+//#################################################################################################
+//  Function:       _rttSample
+//  Access:         Private
+//  Input:          transaction (const BIC2200Transaction &) Request which got its Reply
+//                  rtt (unsigned long) us from Request sent to Reply received
+//  Output:         -
+//  Description:    Any Reply makes the Device healthy again. Only Replies to first Requests
+//                  update the Estimate, a Reply after a Retry may belong to either Request
+//                  (Karn). Integer Filter of Jacobson: RTT Gain 1/8, Deviation Gain 1/4
+//#################################################################################################
+    _failures = 0;
+    _degraded = false;
+    if (transaction.retries > 0) {
+        ++_timeoutStats.recovered;
+        return;
+    }
+    _backoff = 0;
+    if (rtt == 0) {
+        rtt = 1;
+    }
+    if (_srtt == 0) {
+        _srtt = (long)rtt << 3;
+        _rttvar = (long)rtt << 1;
+        return;
+    }
+    long error = (long)rtt - (_srtt >> 3);
+    _srtt += error;
+    if (error < 0) {
+        error = -error;
+    }
+    _rttvar += error - (_rttvar >> 2);
+}
+
+#endif
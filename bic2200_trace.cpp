@@ -0,0 +1,338 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200_trace.h"
+
+#if BIC2200_ENABLE_TRACE
+
+static_assert(BIC2200_TRACE_BYTES >= 2 * BIC2200_TRACE_RECORD_MAX, "BIC2200_TRACE_BYTES too small");
+
+#define BIC2200_TRACE_LINE      64      // longest candump Line incl. Interface Name
+
+static const char _hexDigits[] = "0123456789ABCDEF";
+
+void BIC2200Trace::begin(BIC2200Bus & bus) {
+//#################################################################################################
+//  Function:       begin
+//  Access:         Public
+//  Input:          bus (BIC2200Bus &) Bus whose Frames are recorded
+//  Output:         -
+//  Description:    Starts an empty Trace and hooks it into the Bus. The Time of begin() is the
+//                  Start of the Stream and 0.000000 of the candump Timestamps
+//#################################################################################################
+    end();
+    _bus = &bus;
+    clear();
+    resetStats();
+    bus.setTrace(this);
+}
+
+void BIC2200Trace::end() {
+//#################################################################################################
+//  Function:       end
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Stops recording, Records not yet flushed stay available
+//#################################################################################################
+    if (_bus != NULL) {
+        _bus->setTrace(NULL);
+    }
+}
+
+bool BIC2200Trace::record(const BIC2200Frame & frame, bool transmit) {
+//#################################################################################################
+//  Function:       record
+//  Access:         Public (Bus, may be Interrupt Context)
+//  Input:          frame (const BIC2200Frame &) Frame on the Bus
+//                  transmit (bool) true = sent by the Library; false = received
+//  Output:         (bool) false = Ring full, the Frame is dropped
+//  Description:    Appends one Record stamped with micros() of the Bus. Called by the Bus for
+//                  every Frame, the Caller in the Main Loop holds BIC2200_LOCK()
+//#################################################################################################
+    byte record[BIC2200_TRACE_RECORD_MAX];
+
+    if (_bus == NULL) {
+        return false;
+    }
+    unsigned long now = _bus->micros();
+    byte len = _encode(record, frame, transmit, now - _time);
+    if (BIC2200_TRACE_BYTES - _used < len) {
+        ++_stats.dropped;
+        return false;
+    }
+    size_t head = (_tail + _used) % BIC2200_TRACE_BYTES;
+    for (byte i = 0; i < len; i++) {
+        _ring[head] = record[i];
+        head = (head + 1) % BIC2200_TRACE_BYTES;
+    }
+    _used += len;
+    _time = now;
+    ++_stats.frames;
+    _stats.bytes += len;
+    return true;
+}
+
+size_t BIC2200Trace::flush(Print & out, byte format) {
+//#################################################################################################
+//  Function:       flush
+//  Access:         Public
+//  Input:          out (Print &) Serial, SD File or any other Print
+//                  format (byte) BIC2200_TRACE_CANDUMP (Default) or BIC2200_TRACE_BINARY
+//  Output:         (size_t) Bytes written
+//  Description:    Writes all Records and frees their Space. The binary Stream starts with its
+//                  Header on the first flush() after begin() or clear(). Text needs ~40 Byte
+//                  per Frame, at 115200 Baud that is ~280 Frames/s, so flush binary for more
+//#################################################################################################
+    byte record[BIC2200_TRACE_RECORD_MAX];
+    char line[BIC2200_TRACE_LINE];
+    size_t written = 0;
+    size_t len;
+
+    if (format == BIC2200_TRACE_BINARY && !_headerDone) {
+        byte header[BIC2200_TRACE_HEADER] = {
+            'B', '2', 'T', BIC2200_TRACE_VERSION,
+            (byte)_start, (byte)(_start >> 8), (byte)(_start >> 16), (byte)(_start >> 24)
+        };
+        size_t n = out.write(header, BIC2200_TRACE_HEADER);
+        _stats.flushed += n;
+        _stats.lost += BIC2200_TRACE_HEADER - n;
+        written += n;
+        _headerDone = true;
+    }
+    while ((len = _take(record)) > 0) {
+        const byte * data = record;
+        if (format != BIC2200_TRACE_BINARY) {
+            len = _formatLine(line, record, len);
+            data = (const byte *)line;
+        }
+        size_t n = out.write(data, len);
+        _stats.flushed += n;
+        _stats.lost += len - n;
+        written += n;
+    }
+    return written;
+}
+
+void BIC2200Trace::clear() {
+//#################################################################################################
+//  Function:       clear
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Discards all Records and starts a new Stream at the current Time
+//#################################################################################################
+    unsigned long now = (_bus != NULL) ? _bus->micros() : 0;
+
+    BIC2200_LOCK();
+    _tail = 0;
+    _used = 0;
+    _start = now;
+    _time = now;
+    BIC2200_UNLOCK();
+    _seconds = 0;
+    _micros = 0;
+    _headerDone = false;
+}
+
+size_t BIC2200Trace::available() {
+//#################################################################################################
+//  Function:       available
+//  Access:         Public
+//  Input:          -
+//  Output:         (size_t) encoded Bytes waiting for flush()
+//  Description:    Fill Level of the Ring, flush() before it reaches BIC2200_TRACE_BYTES
+//#################################################################################################
+    BIC2200_LOCK();
+    size_t used = _used;
+    BIC2200_UNLOCK();
+    return used;
+}
+
+BIC2200TraceStats BIC2200Trace::getStats() {
+//#################################################################################################
+//  Function:       getStats
+//  Access:         Public
+//  Input:          -
+//  Output:         (BIC2200TraceStats) Frame and Byte Counters
+//  Description:    bytes / frames is the encoded Size per Frame
+//#################################################################################################
+    BIC2200_LOCK();
+    BIC2200TraceStats stats = _stats;
+    BIC2200_UNLOCK();
+    return stats;
+}
+
+void BIC2200Trace::resetStats() {
+//#################################################################################################
+//  Function:       resetStats
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Sets all Counters to 0
+//#################################################################################################
+    BIC2200_LOCK();
+    _stats = BIC2200TraceStats();
+    BIC2200_UNLOCK();
+}
+
+byte BIC2200Trace::_encode(byte * record, const BIC2200Frame & frame, bool transmit, unsigned long delta) {
+//#################################################################################################
+//  Function:       _encode
+//  Access:         Private
+//  Input:          record (byte *) BIC2200_TRACE_RECORD_MAX Bytes for the Record
+//                  frame (const BIC2200Frame &) Frame to store
+//                  transmit (bool) true = sent by the Library
+//                  delta (unsigned long) us since the previous Record
+//  Output:         (byte) Length of the Record
+//  Description:    Stores Requests and Replies of the Addresses 0..7 with Address and Length
+//                  in the Header, all other Frames with their full ID
+//#################################################################################################
+    unsigned long address = frame.id - (transmit ? MSG_ID_CAN_SEND_00 : MSG_ID_CAN_RECEIVE_00);
+    byte flen = (frame.len > 8) ? 8 : frame.len;
+    byte len = 1;
+
+    if (address < BIC2200_MAX_DEVICES && flen > 0) {
+        record[0] = (address << 3) | (flen - 1);
+        len += _putVarint(&record[len], delta);
+    } else {
+        record[0] = BIC2200_TRACE_RAW;
+        len += _putVarint(&record[len], delta);
+        for (byte i = 0; i < 4; i++) {
+            record[len++] = (byte)(frame.id >> (8 * i));
+        }
+        record[len++] = flen;
+    }
+    if (transmit) {
+        record[0] |= BIC2200_TRACE_TX;
+    }
+    memcpy(&record[len], frame.data, flen);
+    return len + flen;
+}
+
+size_t BIC2200Trace::_take(byte * record) {
+//#################################################################################################
+//  Function:       _take
+//  Access:         Private
+//  Input:          record (byte *) BIC2200_TRACE_RECORD_MAX Bytes for the Record
+//  Output:         (size_t) Length of the Record, 0 = Ring empty
+//  Description:    Copies the oldest Record out of the Ring and frees its Space. Locked, the
+//                  Receive Interrupt appends meanwhile
+//#################################################################################################
+    size_t len = 0;
+
+    BIC2200_LOCK();
+    if (_used > 0) {
+        size_t pos = _tail;
+        record[len++] = _ring[pos];
+        pos = (pos + 1) % BIC2200_TRACE_BYTES;
+        do {
+            record[len] = _ring[pos];
+            pos = (pos + 1) % BIC2200_TRACE_BYTES;
+        } while (record[len++] & 0x80);
+        byte rest = BIC2200_TRACE_LENGTH(record[0]);
+        if (record[0] & BIC2200_TRACE_RAW) {
+            for (byte i = 0; i < 5; i++) {
+                record[len++] = _ring[pos];
+                pos = (pos + 1) % BIC2200_TRACE_BYTES;
+            }
+            rest = record[len - 1];
+        }
+        for (byte i = 0; i < rest; i++) {
+            record[len++] = _ring[pos];
+            pos = (pos + 1) % BIC2200_TRACE_BYTES;
+        }
+        _tail = pos;
+        _used -= len;
+    }
+    BIC2200_UNLOCK();
+    return len;
+}
+
+size_t BIC2200Trace::_formatLine(char * line, const byte * record, size_t len) {
+//#################################################################################################
+//  Function:       _formatLine
+//  Access:         Private
+//  Input:          line (char *) BIC2200_TRACE_LINE Characters for the Text
+//                  record (const byte *) Record from _take()
+//                  len (size_t) Length of the Record
+//  Output:         (size_t) Characters of the Line incl. '\n'
+//  Description:    Formats one candump -L Line and advances the Timestamp by the Delta of the
+//                  Record. Without sprintf, it pulls in ~1.5 kB Flash on AVR
+//#################################################################################################
+    size_t pos = 1;
+    unsigned long delta = 0;
+    unsigned long id;
+    byte shift = 0;
+    byte header = record[0];
+    size_t n = 0;
+
+    do {
+        delta |= (unsigned long)(record[pos] & 0x7F) << shift;
+        shift += 7;
+    } while (record[pos++] & 0x80);
+    if (header & BIC2200_TRACE_RAW) {
+        id = (unsigned long)record[pos] | ((unsigned long)record[pos + 1] << 8) |
+            ((unsigned long)record[pos + 2] << 16) | ((unsigned long)record[pos + 3] << 24);
+        pos += 5;
+    } else {
+        id = ((header & BIC2200_TRACE_TX) ? MSG_ID_CAN_SEND_00 : MSG_ID_CAN_RECEIVE_00) +
+            BIC2200_TRACE_ADDRESS(header);
+    }
+
+    _seconds += delta / 1000000UL;
+    _micros += delta % 1000000UL;
+    if (_micros >= 1000000UL) {
+        _micros -= 1000000UL;
+        ++_seconds;
+    }
+
+    line[n++] = '(';
+    for (unsigned long div = 1000000000UL, value = _seconds; div > 0; div /= 10) {
+        line[n++] = '0' + (value / div) % 10;
+    }
+    line[n++] = '.';
+    for (unsigned long div = 100000UL; div > 0; div /= 10) {
+        line[n++] = '0' + (_micros / div) % 10;
+    }
+    line[n++] = ')';
+    line[n++] = ' ';
+    for (const char * name = BIC2200_TRACE_INTERFACE; *name != '\0' && n < BIC2200_TRACE_LINE - 28; name++) {
+        line[n++] = *name;
+    }
+    line[n++] = ' ';
+    for (int i = 28; i >= 0; i -= 4) {
+        line[n++] = _hexDigits[(id >> i) & 0x0F];
+    }
+    line[n++] = '#';
+    for (; pos < len; pos++) {
+        line[n++] = _hexDigits[record[pos] >> 4];
+        line[n++] = _hexDigits[record[pos] & 0x0F];
+    }
+    line[n++] = '\n';
+    return n;
+}
+
+byte BIC2200Trace::_putVarint(byte * out, unsigned long value) {
+//#################################################################################################
+//  Function:       _putVarint
+//  Access:         Private (static)
+//  Input:          out (byte *) up to 5 Bytes
+//                  value (unsigned long) Number to encode
+//  Output:         (byte) Bytes written
+//  Description:    7 Bits per Byte, lowest first, Bit 7 set = more Bytes follow
+//#################################################################################################
+    byte len = 0;
+    while (value >= 0x80) {
+        out[len++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[len++] = value;
+    return len;
+}
+
+#endif
@@ -0,0 +1,90 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_TRACE_H
+#define BIC2200_TRACE_H
+
+#include "bic2200.h"
+
+#ifndef BIC2200_TRACE_BYTES
+#define BIC2200_TRACE_BYTES     256     // RAM Ring for encoded Records
+#endif
+#ifndef BIC2200_TRACE_INTERFACE
+#define BIC2200_TRACE_INTERFACE "can0"  // Interface Name of the candump Lines
+#endif
+
+// Output Formats of flush()
+#define BIC2200_TRACE_CANDUMP   0       // candump -L Text: (seconds.micros) can0 000C0300#6000
+#define BIC2200_TRACE_BINARY    1       // Records as stored in the Ring, see below
+
+// Binary Stream, all Values Little Endian:
+//   Stream = Magic "B2T" (3), Version (1), Start Time us (4), Records
+//   Record = Header (1), Time Delta us (Varint), [ID (4), Length (1)], Data (Length)
+//   Header = Bit 7: sent by the Library, Bit 6: ID and Length follow,
+//            Bit 5..3: Device Address, Bit 2..0: Length - 1
+// Requests to and Replies from the Addresses 0..7 with 1..8 Data Bytes need no ID, all other
+// Frames (Broadcasts, foreign Frames) are stored raw. The Delta is counted from the previous
+// Record, the first one from the Start Time. Records dropped on a full Ring leave no Gap in Time
+#define BIC2200_TRACE_VERSION   1
+#define BIC2200_TRACE_HEADER    8       // Bytes in Front of the Records of a Stream
+#define BIC2200_TRACE_RECORD_MAX 19     // Header + 5 Byte Delta + 5 Byte ID / Length + 8 Byte Data
+#define BIC2200_TRACE_TX        0x80
+#define BIC2200_TRACE_RAW       0x40
+#define BIC2200_TRACE_ADDRESS(h) (((h) >> 3) & 0x07)
+#define BIC2200_TRACE_LENGTH(h) (((h) & 0x07) + 1)
+
+struct BIC2200TraceStats {
+    unsigned long frames;       // Frames recorded
+    unsigned long dropped;      // Frames not recorded, the Ring was full
+    unsigned long bytes;        // encoded Record Bytes
+    unsigned long flushed;      // Bytes handed to Print (Text or Binary)
+    unsigned long lost;         // Bytes Print did not take
+};
+
+//#################################################################################################
+//  Class:          BIC2200Trace
+//  Description:    Capture of all Frames of a Bus with us Timestamps for a later Replay on the
+//                  Host (extras/host/bic2200_replay.h). Records are stored in a compact binary
+//                  Form (~5 Byte per Request, ~9 per Reply) in a fixed RAM Ring, received Frames
+//                  straight from the Interrupt. flush() writes them as candump Text (for
+//                  canplayer, Wireshark, ...) or binary to any Print (Serial, SD File)
+//#################################################################################################
+class BIC2200Trace {
+
+public:
+    void begin(BIC2200Bus & bus);
+    void end();
+
+    bool record(const BIC2200Frame & frame, bool transmit);
+
+    size_t flush(Print & out, byte format = BIC2200_TRACE_CANDUMP);
+    void clear();
+
+    size_t available();
+    BIC2200TraceStats getStats();
+    void resetStats();
+
+private:
+    BIC2200Bus * _bus = NULL;
+    byte _ring[BIC2200_TRACE_BYTES];
+    size_t _tail = 0;                   // first Byte of the oldest Record
+    volatile size_t _used = 0;          // Bytes of all Records, grows in the Receive Interrupt
+    unsigned long _start = 0;           // us when the Trace was started
+    unsigned long _time = 0;            // us of the last Record
+    unsigned long _seconds = 0;         // Time of the last flushed Record as candump Timestamp
+    unsigned long _micros = 0;
+    bool _headerDone = false;           // Stream Header of the binary Format written
+    BIC2200TraceStats _stats = {};
+
+    byte _encode(byte * record, const BIC2200Frame & frame, bool transmit, unsigned long delta);
+    size_t _take(byte * record);
+    size_t _formatLine(char * line, const byte * record, size_t len);
+    static byte _putVarint(byte * out, unsigned long value);
+
+};
+
+#endif
@@ -0,0 +1,39 @@
+//#################################################################################################
+// Library to Control a BIC-2200-XX-CAN with a Arduino and a MCP2525
+// Uses the Arduino CAN Libary by Sandeep Mistry
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_TRANSPORT_H
+#define BIC2200_TRANSPORT_H
+
+#include "bic2200_platform.h"
+#include "bic2200_ringbuffer.h"
+
+class BIC2200Bus;
+
+//#################################################################################################
+//  Class:          BIC2200Transport
+//  Description:    Hardware independent Access to a CAN Controller and a Clock. The Bus sends
+//                  through it and gets every received Frame handed to BIC2200Bus::dispatch(),
+//                  either from an Interrupt (MCP2515) or from service() (polled Transports).
+//                  All Timing of the Library runs on micros() / millis() of the Transport, so
+//                  a Simulator can run it on a virtual Clock.
+//#################################################################################################
+class BIC2200Transport {
+
+public:
+    virtual int begin(BIC2200Bus & bus) = 0;
+    virtual bool send(const BIC2200Frame & frame) = 0;
+    virtual void service() {}
+
+    virtual unsigned long micros() = 0;
+    virtual unsigned long millis() = 0;
+
+protected:
+    ~BIC2200Transport() {}
+
+};
+
+#endif
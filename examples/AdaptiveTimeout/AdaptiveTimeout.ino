@@ -0,0 +1,57 @@
+//#################################################################################################
+// Adaptive Timeout Example for the BIC-2200-XX-CAN Library
+// Reads all Units once per Second and prints the learned Round Trip Time, the Timeout and the
+// Retry Counters of every Unit. Unplug a Unit to see it go degraded (only probed once per
+// BIC2200_PROBE_INTERVAL) and plug it in again to see it recover.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+
+#define CS_PIN          10
+#define DEVICE_COUNT    4
+
+BIC2200Bus bus;
+BIC2200 bic[DEVICE_COUNT];
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial);
+
+    if (!bus.begin(CS_PIN)) {
+        Serial.println("CAN init failed");
+        while (1);
+    }
+    for (byte i = 0; i < DEVICE_COUNT; i++) {
+        bic[i].begin(bus, i);
+    }
+}
+
+void loop() {
+    for (byte i = 0; i < DEVICE_COUNT; i++) {
+        BIC2200Snapshot snapshot = bic[i].readSnapshot();
+        BIC2200TimeoutStats stats = bic[i].getTimeoutStats();
+
+        Serial.print("BIC ");
+        Serial.print(i);
+        Serial.print(snapshot.valid == BIC2200_SNAP_ALL ? " ok" : " incomplete");
+        Serial.print(bic[i].isDegraded() ? " (degraded)" : "");
+        Serial.print(", RTT ");
+        Serial.print(stats.rtt);
+        Serial.print(" +- ");
+        Serial.print(stats.rttDeviation);
+        Serial.print(" us, Timeout ");
+        Serial.print(stats.timeout);
+        Serial.print(" us, Retries ");
+        Serial.print(stats.retries);
+        Serial.print(", recovered ");
+        Serial.print(stats.recovered);
+        Serial.print(", failed ");
+        Serial.print(stats.failed);
+        Serial.print(", saved ");
+        Serial.print(stats.timeSaved());
+        Serial.println(" us");
+    }
+    delay(1000);
+}
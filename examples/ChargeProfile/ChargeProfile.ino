@@ -0,0 +1,66 @@
+//#################################################################################################
+// Charge Profile Example for the BIC-2200-XX-CAN Library
+// Charges a 48 V Battery CC -> CV -> Float with the non-blocking Profile Engine and prints every
+// State Change. Send 'd' to discharge down to 50 V, 's' to stop.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+#include <bic2200_profile.h>
+
+#define CS_PIN          10
+#define CAN_ADDRESS     0x00
+
+BIC2200 bic;
+BIC2200Bus bus;
+BIC2200Scheduler scheduler;
+BIC2200ProfileEngine engine;
+
+const char * stateNames[] = { "IDLE", "CC", "CV", "FLOAT", "DONE", "ERROR" };
+
+void onTransition(BIC2200 & device, byte state) {
+    (void)device;
+    Serial.print(millis());
+    Serial.print(" ms: ");
+    Serial.println(stateNames[state]);
+}
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial);
+
+    if (!bus.begin(CS_PIN)) {
+        Serial.println("CAN init failed");
+        while (1);
+    }
+    scheduler.begin(bus);
+    engine.begin(scheduler);
+    engine.onTransition(onTransition);
+    bic.begin(bus, CAN_ADDRESS);
+
+    // 54.4 V Absorption with 20 A ramped in 2 s, Float at 53.6 V after the Current fell below 2 A for 30 s
+    BIC2200ProfileConfig charge = BIC2200ProfileEngine::chargeConfig(54400, 20000, 53600);
+    charge.tailCurrent = 2000;
+    charge.tailTime = 30000;
+    charge.cvMaxTime = 4UL * 3600UL * 1000UL;
+    charge.currentRamp = 10000;
+    charge.voltageRamp = 100;
+    if (!engine.start(bic, charge)) {
+        Serial.println("Profile not started");
+    }
+}
+
+void loop() {
+    // Never blocks: Polls and at most one Setpoint Frame per Call
+    engine.run();
+
+    if (Serial.available()) {
+        char command = Serial.read();
+        if (command == 'd') {
+            engine.start(bic, BIC2200ProfileEngine::dischargeConfig(50000, 30000));
+        } else if (command == 's') {
+            engine.stop(bic);
+        }
+    }
+}
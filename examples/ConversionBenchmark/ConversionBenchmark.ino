@@ -0,0 +1,56 @@
+//#################################################################################################
+// Conversion Benchmark for the BIC-2200-XX-CAN Library
+// Counts the CPU Cycles per Conversion of a raw Register Word with float Math (raw * 0.01) 
+// against the precomputed integer fixed Point Scale (raw -> mV). Needs no CAN Hardware.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+
+#define ITERATIONS      10000
+
+volatile unsigned int rawInput = 4800;
+volatile float floatSink;
+volatile long fixedSink;
+
+unsigned long cyclesPerIteration(unsigned long elapsed) {
+    return (elapsed * (F_CPU / 1000000UL)) / ITERATIONS;
+}
+
+void setup() {
+    unsigned long start, baseline, floatTime, fixedTime;
+    BIC2200Scale scale = BIC2200Scale::fromFactor(BIC2200_FACTOR_0_01, BIC2200_FACTOR_0_001);
+
+    Serial.begin(115200);
+    while (!Serial);
+
+    // Loop and volatile Access only
+    start = micros();
+    for (unsigned int i = 0; i < ITERATIONS; i++) {
+        fixedSink = rawInput;
+    }
+    baseline = micros() - start;
+
+    start = micros();
+    for (unsigned int i = 0; i < ITERATIONS; i++) {
+        floatSink = rawInput * 0.01;
+    }
+    floatTime = micros() - start;
+
+    start = micros();
+    for (unsigned int i = 0; i < ITERATIONS; i++) {
+        fixedSink = scale.apply(rawInput);
+    }
+    fixedTime = micros() - start;
+
+    Serial.print("float  (raw * 0.01): ");
+    Serial.print(cyclesPerIteration(floatTime - baseline));
+    Serial.println(" cycles");
+    Serial.print("fixed  (raw -> mV):  ");
+    Serial.print(cyclesPerIteration(fixedTime - baseline));
+    Serial.println(" cycles");
+}
+
+void loop() {
+}
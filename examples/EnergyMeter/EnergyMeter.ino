@@ -0,0 +1,62 @@
+//#################################################################################################
+// Energy Meter Example for the BIC-2200-XX-CAN Library
+// Counts charged and discharged Wh and Ah of several BIC-2200 from 50 Hz VOUT / IOUT Samples
+// and prints the Totals every 10 Seconds.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+#include <bic2200_energy.h>
+
+#define CS_PIN          10
+#define DEVICE_COUNT    2
+#define REPORT_MS       10000
+
+BIC2200Bus bus;
+BIC2200 bic[DEVICE_COUNT];
+BIC2200Scheduler scheduler;
+BIC2200EnergyMeter meter;
+unsigned long lastReport = 0;
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial);
+
+    if (!bus.begin(CS_PIN)) {
+        Serial.println("CAN init failed");
+        while (1);
+    }
+    scheduler.begin(bus);
+    meter.begin(scheduler);
+    for (byte i = 0; i < DEVICE_COUNT; i++) {
+        bic[i].begin(bus, i);
+        bic[i].loadScalingFactors();
+        if (!meter.meter(bic[i])) {
+            Serial.println("Meter over Bus Budget");
+        }
+    }
+}
+
+void loop() {
+    meter.run();
+
+    if (millis() - lastReport >= REPORT_MS) {
+        lastReport = millis();
+        for (byte i = 0; i < DEVICE_COUNT; i++) {
+            BIC2200EnergyTotals totals = meter.getTotals(bic[i]);
+            // Serial.print() has no 64 Bit Overload, long holds 2 MWh
+            Serial.print("BIC ");
+            Serial.print(i);
+            Serial.print(": charged ");
+            Serial.print((long)totals.energy[BIC2200_CHARGE]);
+            Serial.print(" mWh / ");
+            Serial.print((long)totals.charge[BIC2200_CHARGE]);
+            Serial.print(" mAh, discharged ");
+            Serial.print((long)totals.energy[BIC2200_DISCHARGE]);
+            Serial.print(" mWh / ");
+            Serial.print((long)totals.charge[BIC2200_DISCHARGE]);
+            Serial.println(" mAh");
+        }
+    }
+}
@@ -0,0 +1,59 @@
+//#################################################################################################
+// Fault Watch Example for the BIC-2200-XX-CAN Library
+// Watches FAULT_STATUS and SYSTEM_STATUS of several BIC-2200 every 10 ms / 100 ms and turns a
+// Unit off as soon as it reports Over Temperature, Over Voltage or Over Load. IOUT keeps being
+// polled at 50 Hz next to the Watch.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+#include <bic2200_faultwatch.h>
+
+#define CS_PIN          10
+#define DEVICE_COUNT    2
+
+BIC2200Bus bus;
+BIC2200 bic[DEVICE_COUNT];
+BIC2200Scheduler scheduler;
+BIC2200FaultWatch watch;
+
+void onEvent(BIC2200 & device, BIC2200Event event, bool active, unsigned long latency) {
+    Serial.print("BIC ");
+    Serial.print(&device - bic);
+    Serial.print(" Event ");
+    Serial.print(event);
+    Serial.print(active ? " on" : " off");
+    Serial.print(", detected within ");
+    Serial.print(latency);
+    Serial.println(" us");
+
+    if (active && (event == BIC2200_FAULT_OTP || event == BIC2200_FAULT_OVP || event == BIC2200_FAULT_OLP)) {
+        // Curtail: a single Write Frame, does not wait for the Bus
+        device.setOperation(false);
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial);
+
+    if (!bus.begin(CS_PIN)) {
+        Serial.println("CAN init failed");
+        while (1);
+    }
+    scheduler.begin(bus);
+    watch.begin(scheduler);
+    watch.onEvent(onEvent);
+    for (byte i = 0; i < DEVICE_COUNT; i++) {
+        bic[i].begin(bus, i);
+        if (!watch.watch(bic[i])) {
+            Serial.println("Watch over Bus Budget");
+        }
+        scheduler.add(bic[i], CMD_READ_IOUT, 20, 1);
+    }
+}
+
+void loop() {
+    watch.run();
+}
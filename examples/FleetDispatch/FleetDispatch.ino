@@ -0,0 +1,71 @@
+//#################################################################################################
+// Fleet Dispatch Example for the BIC-2200-XX-CAN Library
+// Spreads a Power Target read from the Serial Port (W, negative = Discharge) over several
+// paralleled BIC-2200, derated by Temperature and without faulted Units.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+#include <bic2200_dispatch.h>
+
+#define CS_PIN          10
+#define DEVICE_COUNT    4
+#define FAULT_PERIOD    50      // ms, 4 Units at 10 ms would take most of the Bus Budget
+
+BIC2200Bus bus;
+BIC2200 bic[DEVICE_COUNT];
+BIC2200Scheduler scheduler;
+BIC2200FaultWatch watch;
+BIC2200Dispatcher dispatcher;
+long target = 0;
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial);
+
+    if (!bus.begin(CS_PIN)) {
+        Serial.println("CAN init failed");
+        while (1);
+    }
+    scheduler.begin(bus);
+    watch.begin(scheduler, FAULT_PERIOD);
+    dispatcher.begin(scheduler, &watch);
+    for (byte i = 0; i < DEVICE_COUNT; i++) {
+        bic[i].begin(bus, i);
+        bic[i].identify();
+        if (!watch.watch(bic[i]) || !dispatcher.add(bic[i])) {
+            Serial.println("Unit not added");
+        }
+    }
+}
+
+void loop() {
+    static unsigned long lastDispatch = 0;
+    bool stepped = false;
+
+    watch.run();
+
+    if (Serial.available()) {
+        target = Serial.parseInt();
+        stepped = true;
+    }
+    // A new Target goes out at once, otherwise once per Second to follow Temperature and Faults
+    if (stepped || millis() - lastDispatch >= 1000) {
+        lastDispatch = millis();
+        int frames = dispatcher.dispatch(target);
+        if (frames < 0) {
+            Serial.println("no VOUT Sample yet");
+            return;
+        }
+        if (stepped || frames > 0) {
+            Serial.print("target ");
+            Serial.print(target);
+            Serial.print(" W, allocated ");
+            Serial.print(dispatcher.getAllocated());
+            Serial.print(" W, ");
+            Serial.print(frames);
+            Serial.println(" Frames");
+        }
+    }
+}
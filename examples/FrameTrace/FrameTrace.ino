@@ -0,0 +1,48 @@
+//#################################################################################################
+// Frame Trace for the BIC-2200-XX-CAN Library
+// Records every CAN Frame of a Rack Poll and writes it to Serial as candump -L Lines. Capture the
+// Port to a File and play it with canplayer, or replay it through the Library on the PC with
+// BIC2200ReplayTransport (see extras/host/bench_trace.cpp). Set FORMAT to BIC2200_TRACE_BINARY
+// for a few Bytes per Frame instead of ~40 at high Poll Rates, then convert the Capture with
+//   extras/host/build/tracedump capture.bin > capture.log
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+#include <bic2200_trace.h>
+
+#define CS_PIN          10
+#define DEVICE_COUNT    2
+#define PERIOD_MS       500
+#define FORMAT          BIC2200_TRACE_CANDUMP
+
+BIC2200Bus bus;
+BIC2200 bic[DEVICE_COUNT];
+BIC2200Trace trace;
+unsigned long nextPoll;
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial);
+
+    if (!bus.begin(CS_PIN)) {
+        while (1);
+    }
+    trace.begin(bus);
+    for (byte i = 0; i < DEVICE_COUNT; i++) {
+        bic[i].begin(bus, i);
+    }
+    nextPoll = millis();
+}
+
+void loop() {
+    if ((long)(millis() - nextPoll) >= 0) {
+        nextPoll += PERIOD_MS;
+        for (byte i = 0; i < DEVICE_COUNT; i++) {
+            bic[i].readSnapshot();
+        }
+    }
+    // The Ring holds BIC2200_TRACE_BYTES, flush it before the next Poll fills it
+    trace.flush(Serial, FORMAT);
+}
@@ -0,0 +1,61 @@
+//#################################################################################################
+// Commissioning Scan for the BIC-2200-XX-CAN Library
+// Identifies every Unit on the Bus from its MFR_* Registers and prints Model, Serial, Date and
+// the Setpoint Limits of the detected Variant, no per Unit Configuration needed.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+
+#define CS_PIN          10
+
+BIC2200Bus bus;
+BIC2200 bic[BIC2200_MAX_DEVICES];
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial);
+
+    if (!bus.begin(CS_PIN)) {
+        Serial.println("CAN init failed");
+        while (1);
+    }
+
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        bic[i].begin(bus, i);
+        unsigned long start = micros();
+        bool found = bic[i].identify();
+        unsigned long elapsed = micros() - start;
+        if (!found) {
+            bus.detach(i);
+            continue;
+        }
+        const BIC2200Identity & id = bic[i].getIdentity();
+        BIC2200ModelLimits limits = bic[i].getLimits();
+        Serial.print("Adress ");
+        Serial.print(i);
+        Serial.print(": ");
+        Serial.print(id.manufacturer);
+        Serial.print(" ");
+        Serial.print(id.model);
+        Serial.print(", Serial ");
+        Serial.print(id.serial);
+        Serial.print(", Date ");
+        Serial.print(id.date);
+        Serial.print(", ");
+        Serial.print(id.voltage);
+        Serial.print(" V Variant, VOUT ");
+        Serial.print(limits.voutMin / 1000);
+        Serial.print(" - ");
+        Serial.print(limits.voutMax / 1000);
+        Serial.print(" V, IOUT max ");
+        Serial.print(limits.ioutMax / 1000);
+        Serial.print(" A (");
+        Serial.print(elapsed);
+        Serial.println(" us)");
+    }
+}
+
+void loop() {
+}
@@ -0,0 +1,77 @@
+//#################################################################################################
+// Multi Controller Example for the BIC-2200-XX-CAN Library
+// Serves 16 BIC-2200 on two MCP2515. Every Controller carries its own Bus with the Adresses
+// 0x00 - 0x07 and its own Interrupt Line. The Devices are polled Unit by Unit across both
+// Buses, so one Wire keeps working while a Request is sent on the other.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+
+#define CONTROLLERS     2
+#define CS_PIN_1        10
+#define IRQ_PIN_1       2
+#define CS_PIN_2        9
+#define IRQ_PIN_2       3
+
+MCP2515Class can2;
+BIC2200MCP2515Transport transport[CONTROLLERS] = {
+    BIC2200MCP2515Transport(CAN),
+    BIC2200MCP2515Transport(can2)
+};
+BIC2200Bus bus[CONTROLLERS];
+BIC2200 bic[CONTROLLERS][BIC2200_MAX_DEVICES];
+unsigned long replies = 0;
+unsigned long timeouts = 0;
+unsigned long lastReport;
+
+void onTelemetry(BIC2200 & device, int reg, const byte * data, byte len, bool valid) {
+    if (valid) {
+        ++replies;
+    } else {
+        ++timeouts;
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial);
+
+    transport[0].setPins(CS_PIN_1, IRQ_PIN_1);
+    transport[1].setPins(CS_PIN_2, IRQ_PIN_2);
+    for (byte c = 0; c < CONTROLLERS; c++) {
+        if (!bus[c].begin(transport[c])) {
+            Serial.print("CAN init failed on Controller ");
+            Serial.println(c);
+            while (1);
+        }
+        for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+            bic[c][i].begin(bus[c], i);
+            bic[c][i].onReply(onTelemetry);
+        }
+    }
+    lastReport = millis();
+}
+
+void loop() {
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        for (byte c = 0; c < CONTROLLERS; c++) {
+            if (!bic[c][i].isBusy()) {
+                bic[c][i].requestRead(CMD_READ_VOUT);
+                bic[c][i].requestRead(CMD_READ_IOUT);
+            }
+            bic[c][i].poll();
+        }
+    }
+
+    if (millis() - lastReport >= 1000) {
+        lastReport += 1000;
+        Serial.print("Replies/s: ");
+        Serial.print(replies);
+        Serial.print(", Timeouts: ");
+        Serial.println(timeouts);
+        replies = 0;
+        timeouts = 0;
+    }
+}
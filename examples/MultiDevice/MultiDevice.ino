@@ -0,0 +1,54 @@
+//#################################################################################################
+// Multi Device Example for the BIC-2200-XX-CAN Library
+// Serves several BIC-2200 on one MCP2515. The Bus sorts the Replies by Device Adress, so the
+// Reads of all Devices are on the Wire at the same Time.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+
+#define CS_PIN          10
+#define DEVICE_COUNT    4
+
+BIC2200Bus bus;
+BIC2200 bic[DEVICE_COUNT];
+
+void onTelemetry(BIC2200 & device, int reg, const byte * data, byte len, bool valid) {
+    for (byte i = 0; i < DEVICE_COUNT; i++) {
+        if (&device == &bic[i]) {
+            Serial.print("BIC ");
+            Serial.print(i);
+        }
+    }
+    Serial.print(" VOUT: ");
+    if (valid && len >= 2) {
+        Serial.println(((data[1] << 8) + data[0]) * 0.01);
+    } else {
+        Serial.println("timeout");
+    }
+}
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial);
+
+    if (!bus.begin(CS_PIN)) {
+        Serial.println("CAN init failed");
+        while (1);
+    }
+    for (byte i = 0; i < DEVICE_COUNT; i++) {
+        bic[i].begin(bus, i);
+        bic[i].onReply(onTelemetry);
+    }
+}
+
+void loop() {
+    if (!bus.isBusy()) {
+        for (byte i = 0; i < DEVICE_COUNT; i++) {
+            bic[i].requestRead(CMD_READ_VOUT);
+        }
+        delay(500);
+    }
+    bus.poll();
+}
@@ -0,0 +1,60 @@
+//#################################################################################################
+// Pipelined Telemetry Example for the BIC-2200-XX-CAN Library
+// Keeps the Telemetry Reads of one BIC-2200 outstanding at once and collects the Replies in a
+// Callback, so the Control Loop never waits for the Bus.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+
+#define CS_PIN          10
+#define BIC_ADDRESS     0x00
+#define SWEEP_PERIOD    100     // ms
+
+BIC2200 bic;
+
+const int telemetry[] = {
+    CMD_READ_VIN,
+    CMD_READ_VOUT,
+    CMD_READ_IOUT,
+    CMD_READ_TEMPERATURE_1,
+    CMD_SYSTEM_STATUS,
+    CMD_FAULT_STATUS
+};
+
+unsigned long lastSweep = 0;
+
+void onTelemetry(BIC2200 & device, int reg, const byte * data, byte len, bool valid) {
+    Serial.print("0x");
+    Serial.print(reg, HEX);
+    if (!valid || len < 2) {
+        Serial.println(": timeout");
+        return;
+    }
+    Serial.print(": ");
+    Serial.println((data[1] << 8) + data[0]);
+}
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial);
+
+    if (!bic.begin(CS_PIN, BIC_ADDRESS)) {
+        Serial.println("BIC2200 init failed");
+        while (1);
+    }
+    bic.onReply(onTelemetry);
+}
+
+void loop() {
+    if (millis() - lastSweep >= SWEEP_PERIOD && !bic.isBusy()) {
+        lastSweep = millis();
+        for (unsigned int i = 0; i < sizeof(telemetry) / sizeof(telemetry[0]); i++) {
+            bic.requestRead(telemetry[i]);
+        }
+    }
+    bic.poll();
+
+    // ... Control Loop continues here without waiting for the Replies
+}
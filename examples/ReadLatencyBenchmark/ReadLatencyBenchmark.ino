@@ -0,0 +1,118 @@
+//#################################################################################################
+// Read Latency Benchmark for the BIC-2200-XX-CAN Library
+// Measures the Time per Register Read of the old polling Read Loop (always waits the full
+// CAN_TIMEOUT Window) against the interrupt driven Read Path of the Library.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+
+#define CS_PIN          10
+#define BIC_ADDRESS     0x00
+#define ITERATIONS      200
+
+BIC2200 bic;
+
+int legacyRead(int reg, byte * data) {
+//#################################################################################################
+//  Function:       legacyRead
+//  Input:          reg (int) Register to Read
+//                  data (byte *) Destination of the Register Value
+//  Output:         (int) 0 = data Array not Valid; 1 = data Array is valid
+//  Description:    Copy of the previous polling Read Loop of the Library, used as Baseline
+//#################################################################################################
+    unsigned long startTime;
+    unsigned int index = 0;
+    int retVal = 0;
+    byte data_received[8];
+    bool blnDataValid = true;
+
+    CAN.beginExtendedPacket(MSG_ID_CAN_SEND_00 + BIC_ADDRESS);
+    CAN.write(lowByte(reg));
+    CAN.write(highByte(reg));
+    CAN.endPacket();
+
+    startTime = micros();
+
+    while (((micros() - startTime ) < CAN_TIMEOUT ) && blnDataValid ) {
+        int packetSize = CAN.parsePacket();
+        if (packetSize || CAN.packetId() != -1) {
+            index = 0;
+            while (CAN.available() && index < 8) {
+                data_received[index] = CAN.read();
+                ++index;
+            }
+            if (lowByte(reg) == data_received[0] && highByte(reg) == data_received[1]) {
+                for (unsigned int i = 0; i < (index - 2); i++) {
+                    data[i] = data_received[i + 2];
+                }
+                retVal = 1;
+            } else {
+                blnDataValid = false;
+            }
+        }
+    }
+    return retVal;
+}
+
+void printResult(const char * name, unsigned long total, unsigned long minTime, unsigned long maxTime, int ok) {
+    Serial.print(name);
+    Serial.print(": avg ");
+    Serial.print(total / ITERATIONS);
+    Serial.print(" us, min ");
+    Serial.print(minTime);
+    Serial.print(" us, max ");
+    Serial.print(maxTime);
+    Serial.print(" us, valid ");
+    Serial.print(ok);
+    Serial.print("/");
+    Serial.println(ITERATIONS);
+}
+
+void setup() {
+    byte data[8];
+    unsigned long start, elapsed, total, minTime, maxTime;
+    int ok;
+
+    Serial.begin(115200);
+    while (!Serial);
+
+    // Baseline: polling Read without Interrupt
+    CAN.setPins(CS_PIN);
+    CAN.setClockFrequency(CAN_CLK_FREQUENCY);
+    if (!CAN.begin(CAN_BAUDRATE)) {
+        Serial.println("CAN init failed");
+        while (1);
+    }
+    total = 0; minTime = 0xFFFFFFFF; maxTime = 0; ok = 0;
+    for (int i = 0; i < ITERATIONS; i++) {
+        start = micros();
+        ok += legacyRead(CMD_READ_VOUT, data);
+        elapsed = micros() - start;
+        total += elapsed;
+        if (elapsed < minTime) minTime = elapsed;
+        if (elapsed > maxTime) maxTime = elapsed;
+    }
+    printResult("polling   ", total, minTime, maxTime, ok);
+    CAN.end();
+
+    // Library: interrupt fed Ring Buffer, returns on first matching Reply
+    if (!bic.begin(CS_PIN, BIC_ADDRESS)) {
+        Serial.println("BIC2200 init failed");
+        while (1);
+    }
+    total = 0; minTime = 0xFFFFFFFF; maxTime = 0; ok = 0;
+    for (int i = 0; i < ITERATIONS; i++) {
+        start = micros();
+        ok += (bic.readOutputVoltage() >= 0.0);
+        elapsed = micros() - start;
+        total += elapsed;
+        if (elapsed < minTime) minTime = elapsed;
+        if (elapsed > maxTime) maxTime = elapsed;
+    }
+    printResult("interrupt ", total, minTime, maxTime, ok);
+}
+
+void loop() {
+}
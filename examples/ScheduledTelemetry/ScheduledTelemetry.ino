@@ -0,0 +1,89 @@
+//#################################################################################################
+// Scheduled Telemetry Example for the BIC-2200-XX-CAN Library
+// Polls IOUT / VOUT at 50 Hz, System and Fault Status at 10 Hz and Temperature / VIN at 1 Hz
+// on several BIC-2200 with the Poll Scheduler. Nothing in loop() blocks on the Bus.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+#include <bic2200_scheduler.h>
+
+#define CS_PIN          10
+#define DEVICE_COUNT    2
+
+BIC2200Bus bus;
+BIC2200 bic[DEVICE_COUNT];
+BIC2200Scheduler scheduler;
+
+int iout[DEVICE_COUNT];
+int vout[DEVICE_COUNT];
+int faultStatus[DEVICE_COUNT];
+
+void schedule(byte device, int reg, unsigned long period, byte priority, int * entry) {
+    *entry = scheduler.add(bic[device], reg, period, priority);
+    if (*entry < 0) {
+        Serial.print("rejected: BIC ");
+        Serial.print(device);
+        Serial.print(" Register 0x");
+        Serial.println(reg, HEX);
+    }
+}
+
+void setup() {
+    int unused;
+
+    Serial.begin(115200);
+    while (!Serial);
+
+    if (!bus.begin(CS_PIN)) {
+        Serial.println("CAN init failed");
+        while (1);
+    }
+    scheduler.begin(bus);
+    for (byte i = 0; i < DEVICE_COUNT; i++) {
+        bic[i].begin(bus, i);
+        schedule(i, CMD_READ_IOUT, 20, 3, &iout[i]);
+        schedule(i, CMD_READ_VOUT, 20, 3, &vout[i]);
+        schedule(i, CMD_SYSTEM_STATUS, 100, 2, &unused);
+        schedule(i, CMD_FAULT_STATUS, 100, 2, &faultStatus[i]);
+        schedule(i, CMD_READ_TEMPERATURE_1, 1000, 1, &unused);
+        schedule(i, CMD_READ_VIN, 1000, 1, &unused);
+    }
+    Serial.print("projected Bus Load: ");
+    Serial.print(scheduler.getLoad() / 100.0);
+    Serial.println(" %");
+}
+
+void loop() {
+    static unsigned long lastPrint = 0;
+    unsigned int value;
+
+    scheduler.run();
+
+    if (millis() - lastPrint >= 1000) {
+        lastPrint = millis();
+        for (byte i = 0; i < DEVICE_COUNT; i++) {
+            Serial.print("BIC ");
+            Serial.print(i);
+            if (scheduler.getValue(vout[i], value)) {
+                Serial.print(" VOUT ");
+                Serial.print(value * 0.01);
+            }
+            if (scheduler.getValue(iout[i], value)) {
+                Serial.print(" IOUT ");
+                Serial.print((int16_t)value * 0.01);
+            }
+            if (scheduler.getValue(faultStatus[i], value)) {
+                Serial.print(" FAULT 0x");
+                Serial.print(value, HEX);
+            }
+            BIC2200ScheduleStats stats = scheduler.getStats(iout[i]);
+            Serial.print(" | IOUT misses ");
+            Serial.print(stats.misses);
+            Serial.print(" jitter max ");
+            Serial.print(stats.jitterMax);
+            Serial.println(" us");
+        }
+    }
+}
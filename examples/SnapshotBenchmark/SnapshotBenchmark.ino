@@ -0,0 +1,60 @@
+//#################################################################################################
+// Snapshot Benchmark for the BIC-2200-XX-CAN Library
+// Compares the Rate of readSnapshot() with reading the same Values one Getter after another.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+
+#define CS_PIN          10
+#define BIC_ADDRESS     0x00
+#define ITERATIONS      100
+
+BIC2200 bic;
+
+void setup() {
+    unsigned long start, elapsed;
+    unsigned long spanTotal = 0;
+    int complete = 0;
+
+    Serial.begin(115200);
+    while (!Serial);
+
+    if (!bic.begin(CS_PIN, BIC_ADDRESS)) {
+        Serial.println("BIC2200 init failed");
+        while (1);
+    }
+
+    start = micros();
+    for (int i = 0; i < ITERATIONS; i++) {
+        bic.readInputVoltage();
+        bic.readOutputVoltage();
+        bic.readOutputCurrent();
+        bic.readTemperature();
+        bic.getSystemStatus();
+    }
+    elapsed = micros() - start;
+    Serial.print("sequential getters: ");
+    Serial.print(1.0E6 * ITERATIONS / elapsed);
+    Serial.println(" Hz");
+
+    start = micros();
+    for (int i = 0; i < ITERATIONS; i++) {
+        BIC2200Snapshot snapshot = bic.readSnapshot();
+        spanTotal += snapshot.span;
+        complete += (snapshot.valid == BIC2200_SNAP_ALL);
+    }
+    elapsed = micros() - start;
+    Serial.print("readSnapshot:       ");
+    Serial.print(1.0E6 * ITERATIONS / elapsed);
+    Serial.print(" Hz, avg span ");
+    Serial.print(spanTotal / ITERATIONS);
+    Serial.print(" us, complete ");
+    Serial.print(complete);
+    Serial.print("/");
+    Serial.println(ITERATIONS);
+}
+
+void loop() {
+}
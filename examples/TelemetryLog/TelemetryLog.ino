@@ -0,0 +1,45 @@
+//#################################################################################################
+// Binary Telemetry Log for the BIC-2200-XX-CAN Library
+// Logs a Snapshot of every Device 10 times per Second as raw Register Deltas and writes the
+// full Blocks to Serial. Capture the Port to a File and convert it on the PC with
+//   extras/host/build/logdecode capture.bin > telemetry.csv
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <bic2200.h>
+#include <bic2200_log.h>
+
+#define CS_PIN          10
+#define DEVICE_COUNT    2
+#define PERIOD_MS       100
+
+BIC2200Bus bus;
+BIC2200 bic[DEVICE_COUNT];
+BIC2200Log telemetry;
+unsigned long nextSample;
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial);
+
+    if (!bus.begin(CS_PIN)) {
+        while (1);
+    }
+    for (byte i = 0; i < DEVICE_COUNT; i++) {
+        bic[i].begin(bus, i);
+    }
+    telemetry.begin(bus);
+    nextSample = millis();
+}
+
+void loop() {
+    if ((long)(millis() - nextSample) >= 0) {
+        nextSample += PERIOD_MS;
+        for (byte i = 0; i < DEVICE_COUNT; i++) {
+            telemetry.logSnapshot(i, bic[i].readSnapshot());
+        }
+    }
+    // Only full Blocks, so every Write to the Port is ~120 Bytes
+    telemetry.flush(Serial);
+}
@@ -0,0 +1,267 @@
+//#################################################################################################
+// Host Check and Benchmark of the BIC-2200-XX-CAN Library API
+// Runs the unchanged BIC2200 API against the Simulator: checks the Getters and Setters, then
+// measures Read Latency, Snapshot Rate and the Effect of Pipelining in virtual Time.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include <math.h>
+#include "bic2200_sim.h"
+#include "bic2200_scheduler.h"
+
+static int failures = 0;
+
+static void check(bool condition, const char * what) {
+    printf("%-48s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        ++failures;
+    }
+}
+
+static void checkApi() {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 bic;
+
+    sim.device(3).setModel(48);
+    bus.begin(sim);
+    check(bic.begin(bus, 3) == 1, "begin(bus, 3)");
+
+    check(bic.getOutputVoltage() == 4800, "getOutputVoltage");
+    bic.setOutputVoltage(5200);
+    check(bic.getOutputVoltage() == 5200, "setOutputVoltage / getOutputVoltage");
+    bic.setReverseOutputCurrent(1234);
+    check(bic.getReverseOutputCurrent() == 1234, "setReverseOutputCurrent / get");
+    bic.setDirection(true);
+    check(bic.getDirection() == 1, "setDirection / getDirection");
+    bic.setOperation(false);
+    check(bic.getOperation() == 0, "setOperation / getOperation");
+    check(bic.getSystemConfig() == 0x0001, "getSystemConfig");
+
+    sim.device(3).setWord(CMD_READ_IOUT, (uint16_t)-2550);
+    check(bic.readOutputCurrentMilli() == -25500, "readOutputCurrentMilli (signed)");
+    check(bic.readOutputVoltageMilli() == 48000, "readOutputVoltageMilli");
+    check(bic.readInputVoltageMilli() == 230000, "readInputVoltageMilli");
+    check(bic.readTemperatureDeci() == 350, "readTemperatureDeci");
+
+    sim.device(3).setScalingFactor(BIC2200_FACTOR_0_1, BIC2200_FACTOR_0_1, BIC2200_FACTOR_1, BIC2200_FACTOR_1);
+    check(bic.loadScalingFactors(), "loadScalingFactors");
+    check(bic.readOutputVoltageMilli() == 480000, "readOutputVoltageMilli (factor 0.1)");
+    check(bic.readTemperatureDeci() == 3500, "readTemperatureDeci (factor 1)");
+
+    BIC2200Snapshot snapshot = bic.readSnapshot();
+    check(snapshot.valid == BIC2200_SNAP_ALL, "readSnapshot valid");
+    check(snapshot.iout == -2550, "readSnapshot iout");
+
+    // Reply with 1 Data Byte for a 16 Bit Register
+    uint16_t vin = 0xFFFF;
+    sim.device(3).setRegister(CMD_READ_VIN, (const byte *)"\x2A", 1);
+    check(bic.readInputVoltageMilli() == BIC2200_INVALID_VALUE && !bic.read<BIC2200Reg::ReadVin>(vin) && vin == 0xFFFF,
+        "short reply fails");
+    snapshot = bic.readSnapshot();
+    check(snapshot.valid == (BIC2200_SNAP_ALL & ~BIC2200_SNAP_VIN), "short reply fails in readSnapshot");
+    BIC2200Scheduler scheduler;
+    scheduler.begin(bus);
+    int entry = scheduler.add(bic, CMD_READ_VIN, 10, 1);
+    uint64_t polled = sim.nanos();
+    while (sim.nanos() - polled < 50000000ULL) {
+        scheduler.run();
+        sim.advance(100);
+    }
+    check(entry >= 0 && scheduler.getSamples(entry) == 0 && scheduler.getStats(entry).timeouts > 0,
+        "short reply fails in a scheduler poll");
+    scheduler.remove(entry);
+    sim.device(3).setWord(CMD_READ_VIN, 2300);
+
+    // Fixed Timeout and single Requests here, the adaptive Timeout is checked in bench_timeout
+#if BIC2200_ENABLE_ADAPTIVE_TIMEOUT
+    bic.setAdaptiveTimeout(false);
+    bic.setRetries(0);
+#endif
+    sim.device(3).present = false;
+    check(bic.getOutputVoltage() == -1, "timeout returns -1");
+    sim.device(3).present = true;
+
+#if BIC2200_ENABLE_STATS
+    const BIC2200Stats & stats = bic.getStats();
+    unsigned long bucketSum = 0;
+    for (byte i = 0; i < BIC2200_STATS_BUCKETS; i++) {
+        bucketSum += stats.histogram[i];
+    }
+    check(stats.timeouts == 1, "stats timeouts");
+    check(bic.getRegisterStats(CMD_VOUT_SET).timeouts == 1, "stats register timeouts");
+    check(stats.rttCount > 0 && bucketSum == stats.rttCount, "stats histogram");
+    check(stats.rttMin <= stats.rttAverage() && stats.rttAverage() <= stats.rttMax, "stats rtt min / avg / max");
+
+    bic.resetStats();
+    sim.device(3).replyLatency = CAN_REPLY_TIME + CAN_TIMEOUT;
+    check(bic.getOutputVoltage() == -1, "late reply times out");
+    sim.device(3).replyLatency = 100;
+    sim.advance(2000);
+    check(bic.getOutputVoltage() == 5200, "late reply is not taken for the next read");
+    check(stats.mismatches == 1 && stats.framesReceived == 2, "stats late reply counted as mismatch");
+#endif
+
+    // Frames dispatch() cannot hand to a Device: foreign ID, Reply of Adress 5, full Queue of 3
+    BIC2200Frame frame = { MSG_ID_CAN_SEND_00 + 3, 2, { 0x60, 0x00 } };
+    bus.resetStats();
+    bus.dispatch(frame);
+    frame.id = MSG_ID_CAN_RECEIVE_00 + 5;
+    bus.dispatch(frame);
+    frame.id = MSG_ID_CAN_RECEIVE_00 + 3;
+    for (byte i = 0; i < BIC2200_DEVICE_QUEUE_SIZE; i++) {
+        bus.dispatch(frame);
+    }
+    BIC2200BusStats busStats = bus.getStats();
+    check(busStats.received == 2 + BIC2200_DEVICE_QUEUE_SIZE && busStats.foreign == 1 && busStats.unattached == 1 &&
+        busStats.overflows == 1, "bus stats foreign / unattached / overflow");
+    bic.poll();
+
+#if BIC2200_ENABLE_FLOAT
+    sim.device(3).present = false;
+    check(isnan(bic.readOutputCurrent()) && isnan(bic.readTemperature()) && bic.readOutputVoltage() == -1.0f,
+        "float timeout: NAN for signed, -1.0 for Voltages");
+    sim.device(3).present = true;
+#endif
+}
+
+#if BIC2200_ENABLE_IDENTITY
+static void checkIdentity() {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 bic;
+
+    sim.device(5).setModel(96);
+    bus.begin(sim);
+    bic.begin(bus, 5);
+    sim.device(5).setScalingFactor(BIC2200_FACTOR_0_1, BIC2200_FACTOR_0_01, BIC2200_FACTOR_0_1, BIC2200_FACTOR_0_1);
+    sim.device(5).setWord(CMD_READ_VOUT, 960);
+
+    printf("\n");
+    check(bic.identify(), "identify");
+    const BIC2200Identity & id = bic.getIdentity();
+    check(strcmp(id.manufacturer, "MEAN WELL") == 0, "identity manufacturer");
+    check(strcmp(id.model, "BIC-2200-96") == 0, "identity model");
+    check(strcmp(id.serial, "SIM000000001") == 0, "identity serial");
+    check(strcmp(id.date, "240115") == 0 && strcmp(id.location, "TW") == 0, "identity date / location");
+    check(id.revision[0] == 0x0A && id.revision[2] == 0xFF, "identity revision");
+    check(id.voltage == 96 && bic.getLimits().ioutMax == 22500, "identity model voltage / limits");
+    check(bic.readOutputVoltageMilli() == 96000, "identify loads the scaling factors");
+    check(BIC2200::modelVoltage("BIC-2200-24CAN") == 24 && BIC2200::modelVoltage("BIC-2200-36") == 0 &&
+        BIC2200::modelVoltage("NPB-1200") == 0, "modelVoltage");
+    check(BIC2200::modelVoltage("BIC-2200-268") == 0 && BIC2200::modelVoltage("BIC-2200-304") == 0 &&
+        BIC2200::modelVoltage("BIC-2200-99999") == 0 && BIC2200::modelLimits(304).voltage == 0,
+        "modelVoltage out of range suffix is unknown");
+
+    sim.device(5).present = false;
+    check(!bic.identify() && !bic.getIdentity().valid, "identify without device fails");
+}
+
+static void benchIdentify() {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 bic;
+    BIC2200Bytes6 text;
+
+    sim.device(0).setModel(48);
+    bus.begin(sim);
+    bic.begin(bus, 0);
+
+    // 10 Requests + 10 Replies are ~8.6 ms of Wire Time at 250 kbit/s, the Pipeline hides the
+    // Reply Latency of the Device on top of it
+    printf("\nidentify (virtual us per device)\n");
+    printf("%-16s %12s %12s\n", "reply latency", "sequential", "identify()");
+    for (unsigned long latency = 100; latency <= 900; latency *= 3) {
+        sim.device(0).replyLatency = latency;
+        uint64_t start = sim.nanos();
+        bic.read<BIC2200Reg::ScalingFactor>(text);
+        bic.read<BIC2200Reg::MfrIdB0B5>(text);
+        bic.read<BIC2200Reg::MfrIdB6B11>(text);
+        bic.read<BIC2200Reg::MfrModelB0B5>(text);
+        bic.read<BIC2200Reg::MfrModelB6B11>(text);
+        bic.read<BIC2200Reg::MfrRevisionB0B5>(text);
+        bic.read<BIC2200Reg::MfrLocationB0B2>(text);
+        bic.read<BIC2200Reg::MfrDateB0B5>(text);
+        bic.read<BIC2200Reg::MfrSerialB0B5>(text);
+        bic.read<BIC2200Reg::MfrSerialB6B11>(text);
+        double sequential = (sim.nanos() - start) / 1000.0;
+        start = sim.nanos();
+        bool valid = bic.identify();
+        double burst = (sim.nanos() - start) / 1000.0;
+        printf("%13lu us %12.0f %12.0f\n", latency, sequential, burst);
+        check(valid && burst + 9 * latency / 2 < sequential, "identify is pipelined");
+    }
+}
+#endif
+
+static void benchReadLatency() {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 bic;
+    const int iterations = 1000;
+
+    sim.device(0).setModel(24);
+    bus.begin(sim);
+    bic.begin(bus, 0);
+
+    printf("\nread latency (virtual us, %d reads)\n", iterations);
+    printf("%-16s %10s %10s\n", "reply latency", "avg", "vs timeout");
+    for (unsigned long latency = 50; latency <= 400; latency += 50) {
+        sim.device(0).replyLatency = latency;
+        uint64_t start = sim.nanos();
+        for (int i = 0; i < iterations; i++) {
+            bic.readOutputVoltageMilli();
+        }
+        double avg = (sim.nanos() - start) / 1000.0 / iterations;
+        printf("%13lu us %10.1f %9.0f%%\n", latency, avg, 100.0 * avg / CAN_TIMEOUT);
+    }
+}
+
+static void benchSnapshot() {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 bic;
+    const int iterations = 500;
+
+    sim.device(0).setModel(48);
+    bus.begin(sim);
+    bic.begin(bus, 0);
+
+    printf("\nsnapshot rate (virtual time, %d snapshots)\n", iterations);
+    for (byte depth = 1; depth <= BIC2200_MAX_PENDING; depth *= 2) {
+        bic.setPipelineDepth(depth);
+        unsigned long spans = 0;
+        uint64_t start = sim.nanos();
+        for (int i = 0; i < iterations; i++) {
+            spans += bic.readSnapshot().span;
+        }
+        double seconds = (sim.nanos() - start) / 1e9;
+        printf("pipeline depth %u: %8.1f Hz, avg span %5lu us\n", depth, iterations / seconds, spans / iterations);
+    }
+
+    uint16_t faults;
+    uint64_t start = sim.nanos();
+    for (int i = 0; i < iterations; i++) {
+        bic.readInputVoltageMilli();
+        bic.readOutputVoltageMilli();
+        bic.readOutputCurrentMilli();
+        bic.readTemperatureDeci();
+        bic.getSystemStatus();
+        bic.read<BIC2200Reg::FaultStatus>(faults);
+    }
+    printf("sequential getters: %6.1f Hz\n", iterations / ((sim.nanos() - start) / 1e9));
+}
+
+int main() {
+    checkApi();
+#if BIC2200_ENABLE_IDENTITY
+    checkIdentity();
+    benchIdentify();
+#endif
+    benchReadLatency();
+    benchSnapshot();
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
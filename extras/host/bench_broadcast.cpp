@@ -0,0 +1,103 @@
+//#################################################################################################
+// Broadcast Setpoint Benchmark of the BIC-2200-XX-CAN Library
+// Changes IOUT_SET on a Rack of 1 - 8 simulated Units, once with per Unit setOutputCurrent()
+// and once with one Broadcast Frame, with and without Read-Back, and reports the Time until
+// all Units hold the new Value and the Skew between the first and the last Unit.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include "bic2200_sim.h"
+
+#define ROUNDS      100
+
+struct Result {
+    double converge;    // us from the first Call until the last Unit took the Value
+    double skew;        // us between the first and the last Unit
+    double done;        // us until the Call returned (incl. Read-Back)
+    bool confirmed;
+};
+
+static int failures = 0;
+
+static Result measure(int mode, byte count) {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 devices[BIC2200_MAX_DEVICES];
+    Result result = { 0.0, 0.0, 0.0, true };
+
+    bus.begin(sim);
+    for (byte d = 0; d < count; d++) {
+        sim.device(d).setModel(48);
+        devices[d].begin(bus, d);
+    }
+
+    for (int round = 0; round < ROUNDS; round++) {
+        uint16_t current = (round & 1) ? 2000 : 2500;
+        uint64_t start = sim.nanos();
+        bool confirmed = true;
+
+        switch (mode) {
+            case 0:
+                for (byte d = 0; d < count; d++) {
+                    devices[d].setOutputCurrent(current);
+                }
+                break;
+            case 1:
+                for (byte d = 0; d < count; d++) {
+                    devices[d].setOutputCurrent(current);
+                }
+                for (byte d = 0; d < count; d++) {
+                    confirmed &= (devices[d].getOutputCurrent() == current);
+                }
+                break;
+            case 2:
+                bus.broadcast<BIC2200Reg::IoutSet>(current);
+                break;
+            default:
+                confirmed = (bus.broadcastVerified<BIC2200Reg::IoutSet>(current) == bus.attachedMask());
+                break;
+        }
+        uint64_t done = sim.nanos();
+
+        uint64_t first = UINT64_MAX;
+        uint64_t last = 0;
+        for (byte d = 0; d < count; d++) {
+            uint64_t at = sim.device(d).lastWriteAt;
+            first = (at < first) ? at : first;
+            last = (at > last) ? at : last;
+            confirmed &= (sim.device(d).getWord(CMD_IOUT_SET) == current);
+        }
+        result.converge += (last - start) / 1000.0 / ROUNDS;
+        result.skew += (last - first) / 1000.0 / ROUNDS;
+        result.done += (done - start) / 1000.0 / ROUNDS;
+        result.confirmed &= confirmed;
+        sim.advance(5000);
+    }
+    return result;
+}
+
+int main() {
+    static const char * modes[] = {
+        "per unit",
+        "per unit + read-back",
+        "broadcast",
+        "broadcast + read-back"
+    };
+
+    printf("IOUT_SET change on a Rack, %d Rounds, virtual us\n", ROUNDS);
+    printf("%-24s %3s %10s %10s %10s %s\n", "mode", "dev", "converge", "skew", "returns", "check");
+    for (int mode = 0; mode < 4; mode++) {
+        for (byte count = 1; count <= BIC2200_MAX_DEVICES; count++) {
+            Result r = measure(mode, count);
+            printf("%-24s %3u %10.0f %10.0f %10.0f %s\n",
+                modes[mode], count, r.converge, r.skew, r.done, r.confirmed ? "ok" : "FAIL");
+            if (!r.confirmed) {
+                ++failures;
+            }
+        }
+    }
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,227 @@
+//#################################################################################################
+// Bus Throughput and Latency Benchmark of the BIC-2200-XX-CAN Library
+// Drives 1 - 8 simulated Devices on one CAN Bus with several Read / Write Mixes, blocking and
+// pipelined, and reports Transactions/s, p50 / p99 / max Round Trip Time and Bus Utilisation.
+// Usage: bench_bus [result.csv]
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+#include "bic2200_sim.h"
+
+#define RUN_TIME_US         1000000UL   // virtual Time per Configuration
+#define PIPELINE_DEPTH      4
+#define READ_REGISTERS      4
+
+struct Mix {
+    const char * name;
+    unsigned int writesPerMille;
+};
+
+static const Mix mixes[] = {
+    { "read100",        0 },
+    { "read90write10",  100 },
+    { "read50write50",  500 }
+};
+
+static const int benchRegisters[READ_REGISTERS] = {
+    CMD_READ_VOUT,
+    CMD_READ_VIN,
+    CMD_SYSTEM_STATUS,
+    CMD_FAULT_STATUS
+};
+
+struct Result {
+    unsigned long transactions;
+    unsigned long timeouts;
+    double seconds;
+    double p50;
+    double p99;
+    double max;
+    double utilisation;
+};
+
+// State of the pipelined Run, the Reply Callback has no User Pointer
+static BIC2200SimBus * runSim;
+static BIC2200 * runDevices;
+static uint64_t issuedAt[BIC2200_MAX_DEVICES][READ_REGISTERS];
+static bool outstanding[BIC2200_MAX_DEVICES][READ_REGISTERS];
+static std::vector<double> latencies;
+static unsigned long completed;
+static unsigned long timeouts;
+
+static double percentile(std::vector<double> & values, double p) {
+    if (values.empty()) {
+        return 0.0;
+    }
+    size_t index = (size_t)(p * (values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+static bool isWrite(unsigned long op, unsigned int writesPerMille) {
+    // Evenly spread Writes, e.g. 100 per Mille = every 10th Operation
+    return ((op + 1) * writesPerMille) / 1000 != (op * writesPerMille) / 1000;
+}
+
+static void timedWrite(BIC2200SimBus & sim, BIC2200 & bic, unsigned long op) {
+    uint64_t start = sim.nanos();
+    bic.write<BIC2200Reg::VoutSet>((op & 1) ? 4800 : 4810);
+    latencies.push_back((sim.nanos() - start) / 1000.0);
+    ++completed;
+}
+
+static void onReply(BIC2200 & bic, int reg, const byte * data, byte len, bool valid) {
+    byte device = &bic - runDevices;
+    for (byte r = 0; r < READ_REGISTERS; r++) {
+        if (benchRegisters[r] != reg || !outstanding[device][r]) {
+            continue;
+        }
+        outstanding[device][r] = false;
+        latencies.push_back((runSim->nanos() - issuedAt[device][r]) / 1000.0);
+        break;
+    }
+    if (valid) {
+        ++completed;
+    } else {
+        ++timeouts;
+    }
+    (void)data;
+    (void)len;
+}
+
+static void runBlocking(BIC2200SimBus & sim, BIC2200 * devices, byte count, const Mix & mix) {
+    unsigned long op = 0;
+    uint64_t end = sim.nanos() + RUN_TIME_US * 1000ULL;
+    while (sim.nanos() < end) {
+        BIC2200 & bic = devices[op % count];
+        if (isWrite(op, mix.writesPerMille)) {
+            timedWrite(sim, bic, op);
+        } else {
+            uint16_t value;
+            uint64_t start = sim.nanos();
+            bool ok;
+            switch ((op / count) % READ_REGISTERS) {
+                case 0:  ok = bic.read<BIC2200Reg::ReadVout>(value); break;
+                case 1:  ok = bic.read<BIC2200Reg::ReadVin>(value); break;
+                case 2:  ok = bic.read<BIC2200Reg::SystemStatus>(value); break;
+                default: ok = bic.read<BIC2200Reg::FaultStatus>(value); break;
+            }
+            latencies.push_back((sim.nanos() - start) / 1000.0);
+            if (ok) {
+                ++completed;
+            } else {
+                ++timeouts;
+            }
+        }
+        ++op;
+    }
+}
+
+static void runPipelined(BIC2200SimBus & sim, BIC2200Bus & bus, BIC2200 * devices, byte count, const Mix & mix) {
+    unsigned long op = 0;
+    uint64_t end = sim.nanos() + RUN_TIME_US * 1000ULL;
+
+    for (byte d = 0; d < count; d++) {
+        devices[d].setPipelineDepth(PIPELINE_DEPTH);
+        devices[d].onReply(onReply);
+    }
+    while (sim.nanos() < end) {
+        for (byte d = 0; d < count; d++) {
+            for (byte r = 0; r < READ_REGISTERS; r++) {
+                if (outstanding[d][r]) {
+                    continue;
+                }
+                if (isWrite(op++, mix.writesPerMille)) {
+                    timedWrite(sim, devices[d], op);
+                    continue;
+                }
+                if (devices[d].requestRead(benchRegisters[r])) {
+                    issuedAt[d][r] = sim.nanos();
+                    outstanding[d][r] = true;
+                }
+            }
+        }
+        bus.poll();
+    }
+    while (bus.isBusy()) {
+        bus.poll();
+    }
+    for (byte d = 0; d < count; d++) {
+        devices[d].onReply(NULL);
+    }
+}
+
+static Result run(bool pipelined, byte count, const Mix & mix) {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 devices[BIC2200_MAX_DEVICES];
+    Result result;
+
+    bus.begin(sim);
+    for (byte d = 0; d < count; d++) {
+        sim.device(d).setModel(48);
+        devices[d].begin(bus, d);
+    }
+    runSim = &sim;
+    runDevices = devices;
+    memset(outstanding, 0, sizeof(outstanding));
+    latencies.clear();
+    completed = 0;
+    timeouts = 0;
+    sim.resetCounters();
+
+    uint64_t start = sim.nanos();
+    if (pipelined) {
+        runPipelined(sim, bus, devices, count, mix);
+    } else {
+        runBlocking(sim, devices, count, mix);
+    }
+    uint64_t elapsed = sim.nanos() - start;
+
+    result.transactions = completed;
+    result.timeouts = timeouts;
+    result.seconds = elapsed / 1e9;
+    result.p50 = percentile(latencies, 0.50);
+    result.p99 = percentile(latencies, 0.99);
+    result.max = latencies.empty() ? 0.0 : *std::max_element(latencies.begin(), latencies.end());
+    result.utilisation = 100.0 * sim.busyNanos() / elapsed;
+    return result;
+}
+
+int main(int argc, char ** argv) {
+    const char * csvPath = (argc > 1) ? argv[1] : "build/bench_bus.csv";
+    FILE * csv = fopen(csvPath, "w");
+    if (csv == NULL) {
+        perror(csvPath);
+        return 1;
+    }
+    fprintf(csv, "mode,devices,mix,transactions,timeouts,seconds,tps,p50_us,p99_us,max_us,bus_util_pct\n");
+
+    printf("%d kbit/s, %lu us virtual Time per Run, Pipeline Depth %d\n",
+        (int)(CAN_BAUDRATE / 1000), RUN_TIME_US, PIPELINE_DEPTH);
+    printf("%-9s %3s %-14s %8s %6s %9s %8s %8s %8s %6s\n",
+        "mode", "dev", "mix", "txn", "tmo", "txn/s", "p50 us", "p99 us", "max us", "bus %");
+
+    for (int pipelined = 0; pipelined <= 1; pipelined++) {
+        for (byte count = 1; count <= BIC2200_MAX_DEVICES; count++) {
+            for (size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++) {
+                const char * mode = pipelined ? "pipelined" : "blocking";
+                Result r = run(pipelined, count, mixes[m]);
+                double tps = r.transactions / r.seconds;
+                printf("%-9s %3u %-14s %8lu %6lu %9.0f %8.0f %8.0f %8.0f %6.1f\n",
+                    mode, count, mixes[m].name, r.transactions, r.timeouts, tps,
+                    r.p50, r.p99, r.max, r.utilisation);
+                fprintf(csv, "%s,%u,%s,%lu,%lu,%.6f,%.1f,%.1f,%.1f,%.1f,%.2f\n",
+                    mode, count, mixes[m].name, r.transactions, r.timeouts, r.seconds, tps,
+                    r.p50, r.p99, r.max, r.utilisation);
+            }
+        }
+    }
+    fclose(csv);
+    printf("\nCSV written to %s\n", csvPath);
+    return 0;
+}
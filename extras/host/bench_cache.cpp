@@ -0,0 +1,151 @@
+//#################################################################################################
+// Register Cache Benchmark of the BIC-2200-XX-CAN Library
+// Checks Hits, Misses, Write-Through, skipped duplicate Writes and TTL Expiry of the Register
+// Shadow Cache on a simulated Unit, then runs the Control Loop of a Sketch (read back the
+// Setpoints and Config, read VOUT / IOUT, set the Current) with and without the Cache and
+// compares the Frames on the Bus and the Time per Pass.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include "bic2200_sim.h"
+
+#define PASSES          1000
+#define LOOP_TIME_US    1000
+#define CHANGE_EVERY    10      // Passes between two Changes of the Current Setpoint
+
+static int failures = 0;
+
+static void check(bool condition, const char * what) {
+    printf("%-48s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        ++failures;
+    }
+}
+
+static void checkCache() {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 bic;
+
+    sim.device(0).setModel(48);
+    bus.begin(sim);
+    bic.begin(bus, 0);
+    bic.enableCache(true);
+    bic.resetCacheStats();
+
+    // Setpoints: first Read from the Bus, then from the Shadow
+    sim.resetCounters();
+    check(bic.getOutputVoltage() == 4800 && bic.getCacheStats().misses == 1 && sim.framesOnWire() == 2,
+        "first Read is a Miss on the Bus");
+    sim.resetCounters();
+    check(bic.getOutputVoltage() == 4800 && bic.getCacheStats().hits == 1 && sim.framesOnWire() == 0,
+        "second Read is a Hit without Frame");
+
+    // Write-Through and duplicate Writes
+    bic.setOutputVoltage(5200);
+    sim.resetCounters();
+    check(bic.getOutputVoltage() == 5200 && sim.framesOnWire() == 0 && sim.device(0).getWord(CMD_VOUT_SET) == 5200,
+        "Write goes through and updates the Shadow");
+    unsigned long writes = sim.device(0).writes;
+    bic.setOutputVoltage(5200);
+    check(sim.device(0).writes == writes && bic.getCacheStats().skippedWrites == 1 && bic.getCacheStats().writes == 1,
+        "unchanged Write skipped");
+    bic.setOutputVoltage(5100);
+    check(sim.device(0).writes == writes + 1 && sim.device(0).getWord(CMD_VOUT_SET) == 5100, "changed Write sent");
+
+    // Changed behind the Library: held until invalidated
+    sim.device(0).setWord(CMD_VOUT_SET, 5000);
+    check(bic.getOutputVoltage() == 5100, "infinite TTL holds the Shadow");
+    bic.invalidateCache(CMD_VOUT_SET);
+    check(bic.getOutputVoltage() == 5000, "invalidateCache() reads the Device");
+
+    // Measurements are not cached by default, with a TTL until it expires
+    bic.resetCacheStats();
+    sim.resetCounters();
+    bic.readOutputVoltageMilli();
+    bic.readOutputVoltageMilli();
+    check(sim.framesOnWire() == 4 && bic.getCacheStats().hits == 0 && bic.getCacheStats().misses == 0,
+        "Measurements go to the Bus by default");
+    check(bic.setCacheTTL(CMD_READ_VOUT, 100), "setCacheTTL(READ_VOUT, 100 ms)");
+    // The Shadow holds the last Reply, start without it
+    bic.invalidateCache(CMD_READ_VOUT);
+    check(bic.readOutputVoltageMilli() == 48000 && bic.getCacheStats().misses == 1, "TTL: first Read is a Miss");
+    sim.device(0).setWord(CMD_READ_VOUT, 4900);
+    sim.advance(50000);
+    check(bic.readOutputVoltageMilli() == 48000 && bic.getCacheStats().hits == 1, "TTL: Hit before Expiry");
+    sim.advance(60000);
+    check(bic.readOutputVoltageMilli() == 49000 && bic.getCacheStats().misses == 2, "TTL: Miss after Expiry");
+
+    // 6 Byte Registers have no Shadow
+    check(!bic.setCacheTTL(CMD_SCALING_FACTOR, BIC2200_TTL_INFINITE), "no TTL for SCALING_FACTOR");
+    bic.resetCacheStats();
+    check(bic.loadScalingFactors() && bic.loadScalingFactors() && bic.getCacheStats().misses == 0,
+        "SCALING_FACTOR not counted as Miss");
+
+    bic.enableCache(false);
+    sim.resetCounters();
+    bic.getOutputVoltage();
+    check(sim.framesOnWire() == 2, "disabled Cache reads the Bus");
+}
+
+struct Traffic {
+    unsigned long frames;
+    double passUs;
+    BIC2200CacheStats stats;
+};
+
+// Control Loop of a Sketch: check the Setpoints and Config, read the Measurements, set the Current
+static Traffic controlLoop(bool cache) {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 bic;
+    Traffic traffic;
+    uint64_t busy = 0;
+
+    sim.device(0).setModel(48);
+    bus.begin(sim);
+    bic.begin(bus, 0);
+    bic.enableCache(cache);
+    bic.resetCacheStats();
+    sim.resetCounters();
+
+    for (int pass = 0; pass < PASSES; pass++) {
+        uint64_t start = sim.nanos();
+        bic.getOperation();
+        bic.getDirection();
+        bic.getOutputVoltage();
+        bic.getOutputCurrent();
+        bic.readOutputVoltageMilli();
+        bic.readOutputCurrentMilli();
+        bic.setOutputCurrent(1000 + (pass / CHANGE_EVERY) % 2 * 500);
+        busy += sim.nanos() - start;
+        sim.advance(LOOP_TIME_US);
+    }
+    traffic.frames = sim.framesOnWire();
+    traffic.passUs = busy / 1e3 / PASSES;
+    traffic.stats = bic.getCacheStats();
+    return traffic;
+}
+
+int main() {
+    checkCache();
+
+    Traffic plain = controlLoop(false);
+    Traffic cached = controlLoop(true);
+    printf("\nControl Loop, %d Passes, Current changed every %d Passes\n", PASSES, CHANGE_EVERY);
+    printf("%-12s %12s %12s %10s %10s %14s\n", "cache", "frames", "us/pass", "hits", "misses", "skipped writes");
+    printf("%-12s %12lu %12.0f %10lu %10lu %14lu\n", "off", plain.frames, plain.passUs, plain.stats.hits,
+        plain.stats.misses, plain.stats.skippedWrites);
+    printf("%-12s %12lu %12.0f %10lu %10lu %14lu\n\n", "on", cached.frames, cached.passUs, cached.stats.hits,
+        cached.stats.misses, cached.stats.skippedWrites);
+
+    check(cached.stats.hits == 4UL * PASSES - 4 && cached.stats.misses == 4, "Setpoints and Config read once");
+    check(cached.stats.skippedWrites == PASSES - PASSES / CHANGE_EVERY, "only changed Currents written");
+    check(cached.frames * 2 < plain.frames, "Cache halves the Frames on the Bus");
+    check(cached.passUs * 2 < plain.passUs, "Cache halves the Time per Pass");
+
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
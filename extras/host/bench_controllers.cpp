@@ -0,0 +1,120 @@
+//#################################################################################################
+// Multi Controller Benchmark of the BIC-2200-XX-CAN Library
+// One MCU drives 1 - 4 CAN Controllers with 8 simulated Units each and keeps every Unit busy
+// with pipelined Telemetry Reads. Reports the aggregate Reply Rate and Bus Utilisation, with a
+// blocking send() (MCP2515 with the Arduino CAN Library) and with 3 queued TX Buffers.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include "bic2200_sim.h"
+
+#define MAX_CONTROLLERS     4
+#define RUN_TIME_US         1000000UL   // virtual Time per Scenario
+#define DEPTH               2           // open Reads per Unit
+
+static int failures = 0;
+static unsigned long replies = 0;
+static unsigned long invalid = 0;
+static BIC2200 * devices = NULL;
+static byte outstanding[MAX_CONTROLLERS * BIC2200_MAX_DEVICES];
+
+static void onReply(BIC2200 & device, int reg, const byte * data, byte len, bool valid) {
+    (void)reg;
+    (void)data;
+    (void)len;
+    --outstanding[&device - devices];
+    if (valid) {
+        ++replies;
+    } else {
+        ++invalid;
+    }
+}
+
+static double scenario(byte controllers, byte txBuffers) {
+    static const int regs[] = { CMD_READ_VOUT, CMD_READ_IOUT };
+    BIC2200SimClock clock;
+    BIC2200SimBus * sims[MAX_CONTROLLERS];
+    BIC2200Bus buses[MAX_CONTROLLERS];
+    BIC2200 units[MAX_CONTROLLERS * BIC2200_MAX_DEVICES];
+    byte next = 0;
+
+    devices = units;
+    replies = 0;
+    invalid = 0;
+    for (byte c = 0; c < controllers; c++) {
+        sims[c] = new BIC2200SimBus(clock);
+        sims[c]->txBuffers = txBuffers;
+        sims[c]->setSeed(c + 1);
+        buses[c].begin(*sims[c]);
+        for (byte d = 0; d < BIC2200_MAX_DEVICES; d++) {
+            BIC2200 & unit = units[c * BIC2200_MAX_DEVICES + d];
+            sims[c]->device(d).setModel(48);
+            sims[c]->device(d).replyJitter = 100;
+            unit.begin(buses[c], d);
+            unit.onReply(onReply);
+            outstanding[c * BIC2200_MAX_DEVICES + d] = 0;
+        }
+        sims[c]->resetCounters();
+    }
+
+    uint64_t start = clock.now;
+    while (clock.now - start < RUN_TIME_US * 1000ULL) {
+        // Unit by Unit across the Controllers instead of BIC2200Bus::poll() per Controller:
+        // the other Wires keep working while one send() blocks
+        for (byte d = 0; d < BIC2200_MAX_DEVICES; d++) {
+            for (byte c = 0; c < controllers; c++) {
+                byte i = c * BIC2200_MAX_DEVICES + d;
+                while (outstanding[i] < DEPTH && units[i].requestRead(regs[next++ & 1])) {
+                    ++outstanding[i];
+                }
+                units[i].poll();
+            }
+        }
+    }
+    double seconds = (clock.now - start) / 1e9;
+    double rate = replies / seconds;
+
+    double utilisation = 0;
+    for (byte c = 0; c < controllers; c++) {
+        utilisation += 100.0 * sims[c]->busyNanos() / (clock.now - start) / controllers;
+        delete sims[c];
+    }
+    printf("%11u %7u %14.0f %14.0f %8.1f%% %8lu\n", controllers, controllers * BIC2200_MAX_DEVICES,
+        rate, rate / controllers, utilisation, invalid);
+    if (invalid > 0) {
+        ++failures;
+    }
+    return rate;
+}
+
+static void sweep(byte txBuffers, double minScaling) {
+    double single = 0;
+    double rate = 0;
+
+    if (txBuffers == 0) {
+        printf("\nblocking send()\n");
+    } else {
+        printf("\nsend() into %u TX Buffers\n", txBuffers);
+    }
+    printf("%11s %7s %14s %14s %9s %8s\n", "controllers", "units", "replies/s", "per bus", "bus load", "timeouts");
+    for (byte c = 1; c <= MAX_CONTROLLERS; c++) {
+        rate = scenario(c, txBuffers);
+        if (c == 1) {
+            single = rate;
+        }
+    }
+    printf("scaling %u controllers: %.2fx\n", MAX_CONTROLLERS, rate / single);
+    if (rate < minScaling * single) {
+        ++failures;
+    }
+}
+
+int main() {
+    // A blocking send() holds the CPU for the Request Frame Time, which bounds the Scaling
+    sweep(0, 1.8);
+    sweep(3, 3.5);
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
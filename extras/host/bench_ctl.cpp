@@ -0,0 +1,189 @@
+//#################################################################################################
+// Rack Configuration Benchmark of the BIC-2200-XX-CAN Library
+// Checks the Configuration Parser of bic2200ctl, the show -> apply Round Trip and that apply
+// writes only the differing Settings of a simulated Rack, then compares the Bus Time of a diffed
+// apply with writing every Setting blindly.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "bic2200_config.h"
+#include "bic2200_sim.h"
+#include "bic2200_socketcan.h"
+
+#define UNITS       8
+
+static const char * rackConfig =
+    "# Rack Setpoints\n"
+    "[*]\n"
+    "operation = on\n"
+    "vout = 52.80       ; V\n"
+    "iout = 20\n"
+    "reverse_vout = 46.5\n"
+    "reverse_iout = 15.00\n"
+    "\n"
+    "[0-1, 5]\n"
+    "direction = discharge\n"
+    "iout = 25.5\n"
+    "[7]\n"
+    "system_config = 0x0003\n";
+
+static int failures = 0;
+
+static void check(bool condition, const char * what) {
+    printf("%-48s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        ++failures;
+    }
+}
+
+static unsigned long totalWrites(BIC2200SimBus & sim) {
+    unsigned long writes = 0;
+    for (byte a = 0; a < UNITS; a++) {
+        writes += sim.device(a).writes;
+    }
+    return writes;
+}
+
+static bool syntaxError(const char * text, const char * expected) {
+    BIC2200Config config;
+    return !config.parse(text) && strstr(config.getError(), expected) != NULL;
+}
+
+// diff() + apply() for every Unit, returns Settings verified
+static int applyAll(BIC2200Config & config, BIC2200 * devices, int & differing) {
+    int verified = 0;
+    differing = 0;
+    for (byte a = 0; a < UNITS; a++) {
+        std::vector<BIC2200ConfigChange> changes;
+        differing += config.diff(devices[a], a, changes);
+        int ok = config.apply(devices[a], changes);
+        verified += (ok > 0) ? ok : 0;
+    }
+    return verified;
+}
+
+int main() {
+    BIC2200Config config;
+    long value;
+    byte mask;
+
+    // Parser
+    check(config.parse(rackConfig), "Rack Configuration parsed");
+    check(config.getAddresses() == 0xFF, "[*] applies to all Addresses");
+    check(config.get(0, BIC2200Config::findKey("iout"), value) && value == 25500 &&
+        config.get(2, BIC2200Config::findKey("iout"), value) && value == 20000, "later Section overrides [*]");
+    check(config.get(3, BIC2200Config::findKey("reverse_vout"), value) && value == 46500, "Setpoints in mV without float");
+    check(!config.get(6, BIC2200Config::findKey("system_config"), value) &&
+        config.get(7, BIC2200Config::findKey("system_config"), value) && value == 3, "Keys only for their Section");
+    check(BIC2200Config::parseAddresses("0-2, 6", mask) && mask == 0x47 && !BIC2200Config::parseAddresses("8", mask) &&
+        !BIC2200Config::parseAddresses("3-1", mask) && !BIC2200Config::parseAddresses("", mask), "Address Lists and Ranges");
+    check(syntaxError("vout = 48\nvot = 48\n", "line 2: unknown Key") &&
+        syntaxError("[0-3\nvout = 48\n", "line 1: Section") &&
+        syntaxError("vout = 48.0001\n", "invalid Value") &&
+        syntaxError("operation = maybe\n", "invalid Value") &&
+        syntaxError("iout\n", "key = value"), "Syntax Errors with Line Numbers");
+
+    // Rack of 8 Units with the Power-On Defaults of the BIC-2200-48
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 devices[UNITS];
+    for (byte a = 0; a < UNITS; a++) {
+        sim.device(a).setModel(48);
+    }
+    bus.begin(sim);
+    for (byte a = 0; a < UNITS; a++) {
+        devices[a].begin(bus, a);
+        devices[a].loadScalingFactors();
+        devices[a].identify();
+    }
+
+    // show -> Configuration -> diff is empty
+    BIC2200Config current;
+    bool complete = true;
+    for (byte a = 0; a < UNITS; a++) {
+        complete = current.read(devices[a], a) && complete;
+    }
+    char * text = NULL;
+    size_t size = 0;
+    FILE * out = open_memstream(&text, &size);
+    current.print(out, 0xFF);
+    fclose(out);
+    BIC2200Config shown;
+    int differing = 0;
+    bool parsed = shown.parse(text);
+    free(text);
+    for (byte a = 0; a < UNITS; a++) {
+        std::vector<BIC2200ConfigChange> changes;
+        differing += shown.diff(devices[a], a, changes);
+    }
+    check(complete && parsed && differing == 0, "show output applies without Change");
+
+    // apply writes only what differs: 4 Setpoints per Unit (operation is on already), direction on
+    // 0, 1 and 5, system_config on 7
+    sim.resetCounters();
+    uint64_t startedAt = sim.nanos();
+    int verified = applyAll(config, devices, differing);
+    uint64_t diffedNs = sim.nanos() - startedAt;
+    unsigned long frames = sim.framesOnWire();
+    unsigned long written = totalWrites(sim);
+    check(differing == 4 * UNITS + 4 && verified == differing && written == (unsigned long)differing,
+        "apply writes and verifies only the Differences");
+    check(sim.device(5).getWord(CMD_IOUT_SET) == 2550 && sim.device(5).getWord(CMD_DIRECTION_CTRL) == 1 &&
+        sim.device(7).getWord(CMD_SYSTEM_CONFIG) == 3, "Registers hold the configured Values");
+
+    sim.resetCounters();
+    startedAt = sim.nanos();
+    verified = applyAll(config, devices, differing);
+    uint64_t againNs = sim.nanos() - startedAt;
+    unsigned long againFrames = sim.framesOnWire();
+    check(differing == 0 && verified == 0 && totalWrites(sim) == 0, "second apply writes nothing");
+
+    // Blind: every configured Setting written, as a Sketch calling the Setters does
+    sim.resetCounters();
+    startedAt = sim.nanos();
+    for (byte a = 0; a < UNITS; a++) {
+        std::vector<BIC2200ConfigChange> all;
+        for (byte k = 0; k < BIC2200_CONFIG_KEYS; k++) {
+            if (config.get(a, k, value)) {
+                BIC2200ConfigChange change = { a, k, false, true, 0, BIC2200Config::toWord(devices[a], k, value) };
+                all.push_back(change);
+            }
+        }
+        config.apply(devices[a], all);
+    }
+    uint64_t blindNs = sim.nanos() - startedAt;
+    unsigned long blindFrames = sim.framesOnWire();
+
+    // Limits of the identified Model (BIC-2200-48: 38 - 65 V)
+    BIC2200Config tooHigh;
+    tooHigh.parse("[3]\nvout = 70\niout = 10\n");
+    std::vector<BIC2200ConfigChange> changes;
+    unsigned long writesBefore = totalWrites(sim);
+    tooHigh.diff(devices[3], 3, changes);
+    check(changes.size() == 2 && !changes[0].allowed && changes[1].allowed &&
+        tooHigh.apply(devices[3], changes) == -1 && totalWrites(sim) == writesBefore,
+        "Setpoint outside the Model Limits refused");
+
+    // Unplugged Unit
+    sim.device(4).present = false;
+    changes.clear();
+    check(config.diff(devices[4], 4, changes) == -1 && !changes.empty() && !changes[0].known,
+        "unplugged Unit reported as no Reply");
+
+    BIC2200SocketCANTransport socketcan("nosuchcan9");
+    BIC2200Bus canBus;
+    check(canBus.begin(socketcan) == 0 && socketcan.getError() != 0, "SocketCAN: missing Interface reported");
+
+    printf("\n%-22s %10s %10s\n", "apply over 8 Units", "bus ms", "frames");
+    printf("%-22s %10.1f %10lu\n", "diffed, first", diffedNs / 1e6, frames);
+    printf("%-22s %10.1f %10lu\n", "diffed, unchanged", againNs / 1e6, againFrames);
+    printf("%-22s %10.1f %10lu\n", "blind + read back", blindNs / 1e6, blindFrames);
+    check(againNs < blindNs, "unchanged Rack: diff cheaper than blind Writes");
+
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,199 @@
+//#################################################################################################
+// Power Dispatch Benchmark of the BIC-2200-XX-CAN Library
+// Steps the Power Target of a simulated Rack of 8 Units through Charge, Discharge and idle,
+// once with per Unit setOutputCurrent() / setReverseOutputCurrent() and setDirection() as a
+// Sketch does it and once with the Dispatcher, and compares Frames and Time per Step. Then
+// checks the Split with a hot, a faulted and an unplugged Unit and the Clamping to the Rating.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include "bic2200_sim.h"
+#include "bic2200_dispatch.h"
+
+#define UNITS           8
+#define LOOP_TIME_US    200
+#define VOUT_RAW        5280    // 52.8 V
+#define IOUT_MAX        45000   // mA, BIC-2200-48
+
+static const long steps[] = { 10000, 10000, 15000, 12000, -8000, -8000, -12000, 0, 6000, 6000, -3000, 18000 };
+#define STEPS           (sizeof(steps) / sizeof(steps[0]))
+
+static int failures = 0;
+
+static void check(bool condition, const char * what) {
+    printf("%-48s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        ++failures;
+    }
+}
+
+static long absolute(long value) {
+    return (value < 0) ? -value : value;
+}
+
+struct Rack {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 units[UNITS];
+    BIC2200Scheduler scheduler;
+    BIC2200FaultWatch watch;
+    BIC2200Dispatcher dispatcher;
+    bool added;
+
+    Rack() : added(true) {
+        for (byte a = 0; a < UNITS; a++) {
+            sim.device(a).setModel(48);
+            sim.device(a).setWord(CMD_READ_VOUT, VOUT_RAW);
+        }
+        bus.begin(sim);
+        scheduler.begin(bus);
+        watch.begin(scheduler, 50, 500);
+        dispatcher.begin(scheduler, &watch);
+        for (byte a = 0; a < UNITS; a++) {
+            units[a].begin(bus, a);
+            units[a].identify();
+            added = watch.watch(units[a]) && dispatcher.add(units[a]) && added;
+        }
+    }
+
+    // Loop of the Sketch between two Dispatches
+    void idle(unsigned long ms) {
+        uint64_t end = sim.nanos() + ms * 1000000ULL;
+        while (sim.nanos() < end) {
+            watch.run();
+            sim.advance(LOOP_TIME_US);
+        }
+    }
+
+    // Sum of the Setpoints on the simulated Units in the Direction they run, mA
+    long deviceCurrent() {
+        long sum = 0;
+        for (byte a = 0; a < UNITS; a++) {
+            BIC2200SimDevice & device = sim.device(a);
+            if (device.getWord(CMD_DIRECTION_CTRL) & 0x01) {
+                sum -= device.getWord(CMD_REVERSE_IOUT_SET) * 10L;
+            } else {
+                sum += device.getWord(CMD_IOUT_SET) * 10L;
+            }
+        }
+        return sum;
+    }
+};
+
+// What the Sketches do today: every Unit gets its Share and Direction on every Step
+static void dispatchNaive(Rack & rack, long power) {
+    long share = absolute(power) * 1000000L / (VOUT_RAW * 10L) / UNITS;
+    for (byte a = 0; a < UNITS; a++) {
+        if (power < 0) {
+            rack.units[a].setReverseOutputCurrent(share / 10);
+        } else {
+            rack.units[a].setOutputCurrent(share / 10);
+        }
+        rack.units[a].setDirection(power < 0);
+    }
+}
+
+int main() {
+    Rack naive;
+    Rack rack;
+    double naiveUs[STEPS];
+    double dispatchUs[STEPS];
+    unsigned long naiveFrames[STEPS];
+    int frames[STEPS];
+    bool followed = true;
+
+    check(naive.added && rack.added, "8 Units added, Polls admitted");
+    naive.idle(1100);
+    rack.idle(1100);
+
+    for (unsigned int s = 0; s < STEPS; s++) {
+        naive.sim.resetCounters();
+        uint64_t start = naive.sim.nanos();
+        dispatchNaive(naive, steps[s]);
+        naiveUs[s] = (naive.sim.nanos() - start) / 1e3;
+        naiveFrames[s] = naive.sim.framesOnWire();
+
+        start = rack.sim.nanos();
+        frames[s] = rack.dispatcher.dispatch(steps[s]);
+        dispatchUs[s] = (rack.sim.nanos() - start) / 1e3;
+        // Register Resolution 10 mA per Unit
+        followed = followed && absolute(rack.deviceCurrent() - steps[s] * 1000000L / (VOUT_RAW * 10L)) < 10 * UNITS &&
+            absolute(rack.dispatcher.getAllocated() - steps[s]) <= 5;
+
+        naive.idle(100);
+        rack.idle(100);
+    }
+
+    printf("\n%-10s %14s %12s %16s %12s\n", "target W", "per Unit us", "frames", "dispatcher us", "frames");
+    double naiveSum = 0;
+    double dispatchSum = 0;
+    for (unsigned int s = 0; s < STEPS; s++) {
+        printf("%-10ld %14.0f %12lu %16.0f %12d\n", steps[s], naiveUs[s], naiveFrames[s], dispatchUs[s], frames[s]);
+        naiveSum += naiveUs[s];
+        dispatchSum += dispatchUs[s];
+    }
+    printf("%-10s %14.0f %12s %16.0f\n\n", "mean", naiveSum / STEPS, "", dispatchSum / STEPS);
+
+    check(followed, "Units hold the Target within Register Resolution");
+    check(frames[0] == 1 && frames[2] == 1, "same Setpoint for all Units: one Broadcast");
+    check(frames[1] == 0 && frames[5] == 0 && frames[9] == 0, "unchanged Target: no Frame");
+    check(frames[4] == 2 && frames[11] == 2, "Sign Change: Current and Direction Broadcast");
+    check(frames[7] == 1 && frames[8] == 2, "0 W keeps the Direction");
+    check(dispatchSum * 4 < naiveSum, "Dispatch Time < 1/4 of per Unit Writes");
+
+    // Hot Unit: 60.0 deg C is halfway into the Derating, it takes half a Share
+    rack.sim.device(3).setWord(CMD_READ_TEMPERATURE_1, 600);
+    rack.idle(1100);
+    rack.dispatcher.resetStats();
+    int hotFrames = rack.dispatcher.dispatch(7500);
+    long cool = rack.dispatcher.getAllocation(rack.units[0]);
+    long hot = rack.dispatcher.getAllocation(rack.units[3]);
+    check(rack.dispatcher.getWeight(rack.units[3]) == BIC2200_DERATE_FULL / 2 && absolute(2 * hot - cool) <= 20,
+        "hot Unit takes half a Share");
+    check(hotFrames == UNITS && rack.dispatcher.getStats().broadcasts == 0, "different Setpoints: one Write per Unit");
+    check(absolute(rack.dispatcher.getAllocated() - 7500) <= 5, "others take over the Rest");
+
+    // Faulted Unit: Over Temperature takes it out until the Fault clears
+    rack.sim.device(5).setWord(CMD_FAULT_STATUS, 1 << BIC2200_FAULT_OTP);
+    rack.idle(100);
+    rack.dispatcher.resetStats();
+    rack.dispatcher.dispatch(7500);
+    check(rack.sim.device(5).getWord(CMD_IOUT_SET) == 0 && rack.dispatcher.getWeight(rack.units[5]) == 0 &&
+        absolute(rack.dispatcher.getAllocated() - 7500) <= 5, "faulted Unit gets 0, Target kept");
+    rack.sim.device(5).setWord(CMD_FAULT_STATUS, 0);
+    rack.sim.device(3).setWord(CMD_READ_TEMPERATURE_1, 350);
+    rack.idle(1100);
+    rack.dispatcher.dispatch(7500);
+    check(rack.dispatcher.getAllocation(rack.units[5]) == rack.dispatcher.getAllocation(rack.units[0]) &&
+        rack.dispatcher.getAllocation(rack.units[3]) == rack.dispatcher.getAllocation(rack.units[0]),
+        "cleared Fault and cooled Unit back in");
+
+    // Beyond the Rating of the Rack (8 * 45 A * 52.8 V = 19 kW)
+    rack.dispatcher.resetStats();
+    rack.dispatcher.dispatch(-25000);
+    check(rack.dispatcher.getStats().saturated == 1 &&
+        rack.dispatcher.getAllocated() == -(long)(UNITS * (IOUT_MAX / 1000) * VOUT_RAW / 100),
+        "Target clamped to the Rating");
+
+    // Unplugged Unit: degraded, skipped without Frames, no Broadcast to the Rest
+    rack.sim.device(6).present = false;
+    rack.idle(3000);
+    rack.sim.resetCounters();
+    rack.dispatcher.resetStats();
+    int degradedFrames = rack.dispatcher.dispatch(-10000);
+    check(rack.units[6].isDegraded() && rack.sim.device(6).writes == 0 && rack.dispatcher.getStats().broadcasts == 0 &&
+        degradedFrames == UNITS - 1 && absolute(rack.dispatcher.getAllocated() + 10000) <= 5,
+        "unplugged Unit skipped, Target kept");
+    rack.sim.device(6).present = true;
+    rack.idle(3000);
+    rack.sim.resetCounters();
+    rack.dispatcher.dispatch(-10000);
+    check(!rack.units[6].isDegraded() && rack.sim.device(6).writes >= 1 &&
+        rack.sim.device(6).getWord(CMD_REVERSE_IOUT_SET) == rack.sim.device(0).getWord(CMD_REVERSE_IOUT_SET),
+        "returned Unit rewritten");
+
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+//#################################################################################################
+// Energy Meter Benchmark of the BIC-2200-XX-CAN Library
+// Measures the Cost of one Integration Step, compares 30 Days of 50 Hz Samples in fixed Point
+// with a float Wh Counter, checks that a linear Ramp is integrated exactly and runs the Meter
+// through the Scheduler on a simulated Rack which switches from Charge to Discharge.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include <chrono>
+#include "bic2200_sim.h"
+#include "bic2200_energy.h"
+
+#define RATE_HZ         50
+#define DAYS            30
+#define LOOP_TIME_US    200
+#define CHARGE_US       60000000ULL
+#define DISCHARGE_US    30000000ULL
+
+static int failures = 0;
+
+static void check(bool condition, const char * what) {
+    printf("%-48s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        ++failures;
+    }
+}
+
+static long long absolute(long long value) {
+    return (value < 0) ? -value : value;
+}
+
+int main() {
+    BIC2200 device;
+    const unsigned long period = 1000000UL / RATE_HZ;
+
+    // Integration Cost and long Term Exactness: 2200 W (52.8 V, 41.666 A) for 30 Days
+    {
+        BIC2200EnergyMeter meter;
+        const long voltage = 52800;
+        const long current = 41666;
+        const unsigned long long samples = (unsigned long long)DAYS * 86400ULL * RATE_HZ;
+        float floatWh = 0;
+        unsigned long at = 0;
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for (unsigned long long n = 0; n <= samples; n++) {
+            meter.addSample(device, voltage, current, BIC2200_CHARGE, at);
+            at += period;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (unsigned long long n = 0; n < samples; n++) {
+            floatWh += (voltage / 1000.0f) * (current / 1000.0f) * (period / 1e6f) / 3600.0f;
+        }
+
+        BIC2200EnergyTotals totals = meter.getTotals(device);
+        // exact: mV * mA * us over the whole Time, in mWh (= 3.6e12 pJ)
+        long long expected = (long long)((long double)voltage * current * period * samples / 3.6e12L);
+        long long expectedAh = (long long)((long double)current * period * samples / 3.6e9L);
+        double nsPerSample = seconds * 1e9 / samples;
+
+        printf("\n%u Days at %u Hz, 2200 W\n", DAYS, RATE_HZ);
+        printf("%-24s %16s %12s\n", "counter", "mWh", "error mWh");
+        printf("%-24s %16lld %12s\n", "exact", expected, "-");
+        printf("%-24s %16lld %12lld\n", "fixed Point (64 Bit)", (long long)totals.energy[BIC2200_CHARGE],
+            (long long)totals.energy[BIC2200_CHARGE] - expected);
+        printf("%-24s %16.0f %12.0f\n", "float Wh", floatWh * 1000.0, floatWh * 1000.0 - expected);
+        printf("\n%.1f ns per Sample on this Host, %.4f %% of a %lu us Period for %u Units\n", nsPerSample,
+            nsPerSample * BIC2200_MAX_DEVICES / (period * 10.0), period, BIC2200_MAX_DEVICES);
+
+        check(absolute(totals.energy[BIC2200_CHARGE] - expected) <= 1, "fixed Point: 30 Days exact to 1 mWh");
+        check(absolute(totals.charge[BIC2200_CHARGE] - expectedAh) <= 1, "fixed Point: Ah exact to 1 mAh");
+        check(totals.samples == samples && totals.gaps == 0, "every Sample integrated");
+        check(sizeof(totals.time[0]) == 8 && totals.time[BIC2200_CHARGE] == DAYS * 86400000ULL,
+            "Time in 64 Bit ms, no Wrap on AVR");
+        check(absolute((long long)(floatWh * 1000.0) - expected) > expected / 100, "float Counter drifts > 1 %");
+        check(nsPerSample * BIC2200_MAX_DEVICES < period * 1000.0 / 1000, "8 Units integrate in < 0.1 % of the Period");
+    }
+
+    // Linear Ramp 0 -> 50 A at 50 V over 10 s, the Trapezoid is exact: 250 As, 12500 J
+    {
+        BIC2200EnergyMeter meter;
+        for (unsigned long n = 0; n <= 10 * RATE_HZ; n++) {
+            meter.addSample(device, 50000, 50000L * n / (10 * RATE_HZ), BIC2200_DISCHARGE, n * period);
+        }
+        meter.addSample(device, 50000, 0, BIC2200_DISCHARGE, 10 * RATE_HZ * period + 3000000UL);
+        BIC2200EnergyTotals totals = meter.getTotals(device);
+        check(totals.charge[BIC2200_DISCHARGE] == 69 && totals.energy[BIC2200_DISCHARGE] == 3472 &&
+            totals.energy[BIC2200_CHARGE] == 0, "Ramp integrated exactly, counted as Discharge");
+        check(totals.gaps == 1 && totals.time[BIC2200_DISCHARGE] == 10000, "Gap after a lost Unit not integrated");
+    }
+
+    // Scheduler on a simulated Rack: Unit 0 charges 20 A for 60 s, then discharges 15 A for 30 s
+    {
+        BIC2200SimBus sim;
+        BIC2200Bus bus;
+        BIC2200 units[2];
+        BIC2200Scheduler scheduler;
+        BIC2200EnergyMeter meter;
+
+        for (byte a = 0; a < 2; a++) {
+            sim.device(a).setModel(48);
+            sim.device(a).setWord(CMD_READ_VOUT, 5280);
+            sim.device(a).setWord(CMD_READ_IOUT, 0);
+        }
+        sim.device(0).setWord(CMD_READ_IOUT, 2000);
+        bus.begin(sim);
+        scheduler.begin(bus);
+        meter.begin(scheduler);
+        bool metered = true;
+        for (byte a = 0; a < 2; a++) {
+            units[a].begin(bus, a);
+            units[a].loadScalingFactors();
+            metered = meter.meter(units[a]) && metered;
+        }
+
+        uint64_t end = sim.nanos() + (CHARGE_US + DISCHARGE_US) * 1000ULL;
+        uint64_t switchAt = sim.nanos() + CHARGE_US * 1000ULL;
+        bool switched = false;
+        while (sim.nanos() < end) {
+            if (!switched && sim.nanos() >= switchAt) {
+                sim.device(0).setRegister(CMD_DIRECTION_CTRL, (const byte *)"\x01", 1);
+                sim.device(0).setWord(CMD_READ_IOUT, 1500);
+                switched = true;
+            }
+            meter.run();
+            sim.advance(LOOP_TIME_US);
+        }
+
+        BIC2200EnergyTotals charging = meter.getTotals(units[0]);
+        BIC2200EnergyTotals idle = meter.getTotals(units[1]);
+        // 52.8 V * 20 A * 60 s = 17600 mWh, 52.8 V * 15 A * 30 s = 6600 mWh. Around the Switch
+        // up to one Direction Period (100 ms) and one Trapezoid (20 ms) count for the wrong Side
+        const long long tolerance = 1056LL * (BIC2200_DIRECTION_PERIOD + BIC2200_ENERGY_PERIOD) / 3600 + 1;
+
+        printf("\n%-10s %12s %12s %10s %10s %9s\n", "unit", "charge mWh", "disch. mWh", "charge mAh",
+            "disch. mAh", "samples");
+        printf("%-10s %12lld %12lld %10lld %10lld %9lu\n", "0", (long long)charging.energy[BIC2200_CHARGE],
+            (long long)charging.energy[BIC2200_DISCHARGE], (long long)charging.charge[BIC2200_CHARGE],
+            (long long)charging.charge[BIC2200_DISCHARGE], charging.samples);
+        printf("%-10s %12lld %12lld %10lld %10lld %9lu\n\n", "1", (long long)idle.energy[BIC2200_CHARGE],
+            (long long)idle.energy[BIC2200_DISCHARGE], (long long)idle.charge[BIC2200_CHARGE],
+            (long long)idle.charge[BIC2200_DISCHARGE], idle.samples);
+
+        check(metered, "VOUT, IOUT and Direction Polls admitted");
+        check(absolute(charging.energy[BIC2200_CHARGE] - 17600) <= tolerance &&
+            absolute(charging.energy[BIC2200_DISCHARGE] - 6600) <= tolerance, "Rack: Wh per Direction within one Period");
+        check(absolute(charging.charge[BIC2200_CHARGE] - 333) <= 1 + tolerance / 50 &&
+            absolute(charging.charge[BIC2200_DISCHARGE] - 125) <= 1 + tolerance / 50, "Rack: Ah per Direction within one Period");
+        check(charging.samples >= (CHARGE_US + DISCHARGE_US) / period - 2 && charging.gaps == 0,
+            "Rack: IOUT integrated at 50 Hz");
+        check(idle.energy[BIC2200_CHARGE] == 0 && idle.energy[BIC2200_DISCHARGE] == 0, "Rack: idle Unit counts nothing");
+    }
+
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
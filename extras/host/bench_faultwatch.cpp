@@ -0,0 +1,126 @@
+//#################################################################################################
+// Fault Watch Benchmark of the BIC-2200-XX-CAN Library
+// Injects Faults into simulated Units while the Telemetry Schedule runs and measures the real
+// Detection Latency of the Fault Watch, its reported Bound and whether the Telemetry keeps its
+// Rates.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+#include "bic2200_sim.h"
+#include "bic2200_faultwatch.h"
+
+#define UNITS           4
+#define RUN_TIME_US     20000000UL
+#define LOOP_TIME_US    100
+#define FAULT_EVERY_US  37000       // mean Time between two injected Changes
+
+static BIC2200SimBus sim;
+static BIC2200 devices[UNITS];
+static uint64_t injectedAt[UNITS];
+static bool injected[UNITS];
+static std::vector<double> latencies;
+static unsigned long bounds = 0;
+static unsigned long wrongBound = 0;
+
+static void onEvent(BIC2200 & device, BIC2200Event event, bool active, unsigned long latency) {
+    byte d = &device - devices;
+    if (event != BIC2200_FAULT_OTP || !injected[d]) {
+        return;
+    }
+    double real = (sim.nanos() - injectedAt[d]) / 1000.0;
+    latencies.push_back(real);
+    injected[d] = false;
+    ++bounds;
+    // The Bound ends at the Reply, the real Latency at the Callback
+    if (latency + 1000 < real - LOOP_TIME_US - 1000) {
+        ++wrongBound;
+    }
+    (void)active;
+}
+
+int main() {
+    BIC2200Bus bus;
+    BIC2200Scheduler scheduler;
+    BIC2200FaultWatch watch;
+    int iout[UNITS];
+    int vout[UNITS];
+    int failures = 0;
+
+    bus.begin(sim);
+    scheduler.begin(bus);
+    scheduler.setBudget(85);
+    watch.begin(scheduler);
+    watch.onEvent(onEvent);
+    for (byte d = 0; d < UNITS; d++) {
+        sim.device(d).setModel(48);
+        sim.device(d).replyJitter = 50;
+        devices[d].begin(bus, d);
+        if (!watch.watch(devices[d])) {
+            ++failures;
+        }
+        iout[d] = scheduler.add(devices[d], CMD_READ_IOUT, 20, 3);
+        vout[d] = scheduler.add(devices[d], CMD_READ_VOUT, 20, 3);
+        scheduler.add(devices[d], CMD_READ_TEMPERATURE_1, 1000, 1);
+        scheduler.add(devices[d], CMD_READ_VIN, 1000, 1);
+    }
+    // Unit 0 starts with a Fault: the Baseline, not an Edge
+    sim.device(0).setWord(CMD_FAULT_STATUS, 1 << BIC2200_FAULT_OVP);
+    sim.setSeed(7);
+
+    uint64_t start = sim.nanos();
+    uint64_t nextFault = start + 100000000ULL;
+    unsigned long changes = 0;
+    while (sim.nanos() - start < RUN_TIME_US * 1000ULL) {
+        if (sim.nanos() >= nextFault) {
+            // Toggle OTP of a Unit whose last Change was already detected
+            byte d = rand() % UNITS;
+            if (!injected[d]) {
+                uint16_t faults = sim.device(d).getWord(CMD_FAULT_STATUS) ^ (1 << BIC2200_FAULT_OTP);
+                sim.device(d).setWord(CMD_FAULT_STATUS, faults);
+                injectedAt[d] = sim.nanos();
+                injected[d] = true;
+                ++changes;
+            }
+            nextFault = sim.nanos() + (uint64_t)(rand() % (2 * FAULT_EVERY_US)) * 1000;
+        }
+        watch.run();
+        sim.advance(LOOP_TIME_US);
+    }
+    double seconds = (sim.nanos() - start) / 1e9;
+
+    std::sort(latencies.begin(), latencies.end());
+    BIC2200FaultWatchStats stats = watch.getStats();
+    printf("%d Units, FAULT_STATUS every %d ms, SYSTEM_STATUS every %d ms, projected Bus Load %.1f %% of 85 %%\n",
+        UNITS, BIC2200_FAULT_PERIOD, BIC2200_STATUS_PERIOD, scheduler.getLoad() / 100.0);
+    printf("injected changes    %lu, detected %lu (events %lu, active at the first Sample %lu)\n",
+        changes, (unsigned long)latencies.size(), stats.events, stats.initial);
+    if (!latencies.empty()) {
+        printf("real latency        p50 %.0f us, p99 %.0f us, max %.0f us\n",
+            latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100], latencies.back());
+    }
+    printf("reported bound      avg %lu us, max %lu us, below real latency %lu\n",
+        stats.events ? stats.latencySum / stats.events : 0, stats.latencyMax, wrongBound);
+
+    printf("telemetry           ");
+    for (byte d = 0; d < UNITS; d++) {
+        BIC2200ScheduleStats i = scheduler.getStats(iout[d]);
+        BIC2200ScheduleStats v = scheduler.getStats(vout[d]);
+        printf("%.1f/%.1f Hz (%lu misses)  ", i.received / seconds, v.received / seconds, i.misses + v.misses);
+        if (i.received / seconds < 49.0 || v.received / seconds < 49.0) {
+            ++failures;
+        }
+    }
+    printf("\n");
+    if (stats.initial != 1 || stats.events != bounds) {
+        ++failures;
+    }
+    if (latencies.empty() || latencies.back() > 2 * BIC2200_FAULT_PERIOD * 1000 || wrongBound > 0) {
+        ++failures;
+    }
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,226 @@
+//#################################################################################################
+// Telemetry Log Benchmark of the BIC-2200-XX-CAN Library
+// Logs Snapshots of several simulated Units with drifting Measurements into BIC2200Log and
+// compares Bytes per Sample and Encode Cost with printing the same Values as Text. Checks that
+// the decoded Stream matches the logged Words exactly, also across Ring Overflow and Wrap.
+// Usage: bench_log [log.bin]   (the Stream is kept for logdecode)
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "bic2200_sim.h"
+#include "bic2200_logreader.h"
+
+#define UNITS           4
+#define RUN_TIME_MS     60000UL     // virtual Time
+#define PERIOD_MS       100         // Snapshot Period per Unit
+
+static int failures = 0;
+
+static void check(bool condition, const char * what) {
+    printf("%-48s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        ++failures;
+    }
+}
+
+class BufferPrint : public Print {
+public:
+    std::vector<uint8_t> data;
+
+    size_t write(uint8_t value) { data.push_back(value); return 1; }
+    size_t write(const uint8_t * buffer, size_t size) { data.insert(data.end(), buffer, buffer + size); return size; }
+};
+
+static uint32_t randomState = 0x1234567;
+
+static int randomStep(int range) {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return (int)(randomState % (2 * range + 1)) - range;
+}
+
+// The Line a Sketch prints per Snapshot: millis, Address and the float Readers with 2 Decimals
+static int formatText(char * line, size_t size, unsigned long time, byte address, const BIC2200Snapshot & s) {
+    return snprintf(line, size, "%lu,%u,%.2f,%.2f,%.2f,%.2f,%u,%u\n", time, address,
+        s.vin * 0.1, s.vout * 0.01, s.iout * 0.01, s.temperature * 0.1, s.systemStatus, s.faultStatus);
+}
+
+// tolerance: ms the Log Timestamp may differ, the Simulator Clock advances with every Call
+static bool sameSamples(const std::vector<BIC2200LogSample> & a, const std::vector<BIC2200LogSample> & b,
+    unsigned long tolerance = 0) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        unsigned long skew = (a[i].time > b[i].time) ? a[i].time - b[i].time : b[i].time - a[i].time;
+        if (skew > tolerance || a[i].address != b[i].address || a[i].reg != b[i].reg ||
+            a[i].value != b[i].value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void benchTelemetry(const char * binPath) {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 devices[UNITS];
+    BIC2200Log log;
+    BufferPrint out;
+    std::vector<BIC2200LogSample> expected;
+    std::vector<BIC2200Snapshot> snapshots;
+    std::vector<unsigned long> times;
+    unsigned long textBytes = 0;
+    char line[96];
+
+    bus.begin(sim);
+    for (byte d = 0; d < UNITS; d++) {
+        sim.device(d).setModel(48);
+        sim.device(d).setWord(CMD_READ_IOUT, 2000);
+        devices[d].begin(bus, d);
+    }
+    log.begin(bus);
+
+    unsigned long start = sim.millis();
+    while (sim.millis() - start < RUN_TIME_MS) {
+        for (byte d = 0; d < UNITS; d++) {
+            BIC2200SimDevice & unit = sim.device(d);
+            unit.setWord(CMD_READ_VOUT, unit.getWord(CMD_READ_VOUT) + randomStep(2));
+            unit.setWord(CMD_READ_IOUT, unit.getWord(CMD_READ_IOUT) + randomStep(30));
+            unit.setWord(CMD_READ_VIN, 2300 + randomStep(5));
+            if (randomStep(50) == 0) {
+                unit.setWord(CMD_READ_TEMPERATURE_1, unit.getWord(CMD_READ_TEMPERATURE_1) + randomStep(1));
+            }
+
+            BIC2200Snapshot snapshot = devices[d].readSnapshot();
+            unsigned long now = sim.millis();
+            log.logSnapshot(d, snapshot);
+            textBytes += formatText(line, sizeof(line), now, d, snapshot);
+
+            const int regs[] = { CMD_READ_VIN, CMD_READ_VOUT, CMD_READ_IOUT, CMD_READ_TEMPERATURE_1,
+                CMD_SYSTEM_STATUS, CMD_FAULT_STATUS };
+            const uint16_t values[] = { snapshot.vin, snapshot.vout, (uint16_t)snapshot.iout,
+                (uint16_t)snapshot.temperature, snapshot.systemStatus, snapshot.faultStatus };
+            for (byte i = 0; i < 6; i++) {
+                BIC2200LogSample sample = { now, d, regs[i], values[i] };
+                expected.push_back(sample);
+            }
+            snapshots.push_back(snapshot);
+            times.push_back(now);
+        }
+        log.flush(out);
+        sim.advance(PERIOD_MS * 1000UL - (sim.millis() - start) % PERIOD_MS * 1000UL);
+    }
+    log.flush(out, true);
+
+    BIC2200LogStats stats = log.getStats();
+    BIC2200LogReader reader;
+    std::vector<BIC2200LogSample> decoded;
+    reader.decode(out.data.data(), out.data.size(), decoded);
+
+    double logPerSample = (double)out.data.size() / stats.samples;
+    double textPerSample = (double)textBytes / expected.size();
+    printf("\n%u Units, Snapshot every %u ms, %lu s: %lu Samples\n", UNITS, PERIOD_MS, RUN_TIME_MS / 1000, stats.samples);
+    printf("%-10s %10s %12s %12s\n", "format", "bytes", "bytes/sample", "bytes/s");
+    printf("%-10s %10lu %12.2f %12.1f\n", "text", textBytes, textPerSample, textBytes * 1000.0 / RUN_TIME_MS);
+    printf("%-10s %10zu %12.2f %12.1f\n", "BIC2200Log", out.data.size(), logPerSample,
+        out.data.size() * 1000.0 / RUN_TIME_MS);
+    printf("%lu Blocks, %lu dropped\n", reader.getStats().blocks, stats.dropped);
+
+    check(sameSamples(decoded, expected, 1), "decoded Samples match logged Words");
+    check(stats.dropped == 0 && stats.lost == 0, "no Block lost with regular flush()");
+    check(logPerSample < textPerSample / 2, "log needs < 1/2 of the Text Bytes");
+
+    // Encode Cost on this Host: the same Samples again, against formatting them as Text
+    BIC2200Log replay;
+    BufferPrint sink;
+    replay.begin(bus);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < snapshots.size(); i++) {
+        replay.logSnapshot(i % UNITS, snapshots[i]);
+        replay.flush(sink);
+    }
+    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+    volatile unsigned long sinkText = 0;
+    for (size_t i = 0; i < snapshots.size(); i++) {
+        sinkText += formatText(line, sizeof(line), times[i], i % UNITS, snapshots[i]);
+    }
+    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
+    double logNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / expected.size();
+    double textNs = std::chrono::duration<double, std::nano>(t2 - t1).count() / expected.size();
+    printf("encode cost per Sample on the Host: log %.0f ns (incl. Simulator millis()), text %.0f ns\n",
+        logNs, textNs);
+
+    if (binPath != NULL) {
+        FILE * bin = fopen(binPath, "wb");
+        if (bin != NULL) {
+            fwrite(out.data.data(), 1, out.data.size(), bin);
+            fclose(bin);
+            printf("Stream written to %s\n", binPath);
+        }
+    }
+}
+
+static void checkEdges() {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200Log log;
+    BufferPrint out;
+    std::vector<BIC2200LogSample> expected;
+    const uint16_t words[] = { 0, 0xFFFF, 0, 0x8000, 0x7FFF, 0x8001, 1, 0xFFFE, 0x1234 };
+
+    bus.begin(sim);
+    log.begin(bus);
+    printf("\n");
+    check(!log.log(8, CMD_READ_VOUT, 0), "log() rejects Address 8");
+    check(!log.log(0, CMD_MFR_ID_B0B5, 0), "log() rejects MFR Registers");
+
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        sim.advance(i * 70000UL);
+        BIC2200LogSample sample = { sim.millis(), 7, CMD_BIDIRECTIONAL_CONFIG, words[i] };
+        log.log(sample.address, sample.reg, sample.value);
+        expected.push_back(sample);
+    }
+    log.flush(out, true);
+    BIC2200LogReader reader;
+    std::vector<BIC2200LogSample> decoded;
+    reader.decode(out.data.data(), out.data.size(), decoded);
+    check(sameSamples(decoded, expected), "Delta Wrap and long Time Gaps decode");
+
+    // Without flush() the Ring overflows: the oldest Blocks go, the Rest still decodes
+    BufferPrint late;
+    log.resetStats();
+    for (unsigned int i = 0; i < 2000; i++) {
+        sim.advance(1000);
+        log.log(i % 8, CMD_READ_IOUT, i * 37);
+    }
+    log.flush(late, true);
+    BIC2200LogReader lateReader;
+    std::vector<BIC2200LogSample> kept;
+    lateReader.decode(late.data.data(), late.data.size(), kept);
+    bool tail = !kept.empty() && kept.back().value == (uint16_t)(1999 * 37) && kept.back().address == 1999 % 8;
+    check(log.getStats().dropped > 0 && tail && lateReader.getStats().broken == 0,
+        "Overflow drops whole Blocks, newest kept");
+
+    // Text between the Blocks (same Serial Port) is skipped
+    BufferPrint mixed;
+    const char * text = "boot ok\r\n";
+    mixed.write((const uint8_t *)text, strlen(text));
+    mixed.write(out.data.data(), out.data.size());
+    BIC2200LogReader mixedReader;
+    decoded.clear();
+    mixedReader.decode(mixed.data.data(), mixed.data.size(), decoded);
+    check(sameSamples(decoded, expected), "Text before the Blocks is skipped");
+}
+
+int main(int argc, char ** argv) {
+    benchTelemetry(argc > 1 ? argv[1] : NULL);
+    checkEdges();
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
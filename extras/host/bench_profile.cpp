@@ -0,0 +1,287 @@
+//#################################################################################################
+// Charge Profile Benchmark of the BIC-2200-XX-CAN Library
+// Charges and discharges a simulated Battery (linear open Circuit Voltage, internal Resistance)
+// through a simulated BIC-2200 with the Profile Engine and checks when CC -> CV -> Float and the
+// Discharge Transitions are detected against the Moment the Battery crossed the Thresholds.
+// Compares the Loop Period of the Engine with a blocking read / set Loop as Sketches use it.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include "bic2200_sim.h"
+#include "bic2200_profile.h"
+
+#define LOOP_TIME_US    200
+#define DROP_PER_MILLE  5
+#define V_EMPTY         48.0    // V open Circuit at 0 As
+#define V_SLOPE         6.0     // V from empty to full
+#define CAPACITY        2000.0  // As
+#define RESISTANCE      0.020   // Ohm
+
+#define CHARGE_VOLTAGE  54400
+#define FLOAT_VOLTAGE   53600
+#define CUTOFF_VOLTAGE  50000
+#define CV_BAND         100
+
+static int failures = 0;
+
+static void check(bool condition, const char * what) {
+    printf("%-48s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        ++failures;
+    }
+}
+
+// Battery on the DC Side of one Unit, the Unit limits Current and Voltage like the BIC-2200
+struct Battery {
+    double charge;              // As
+    double voltage;             // V at the Terminals
+    double current;             // A, Magnitude
+    long vout;                  // mV and mA as the Unit reports them
+    long iout;
+
+    void update(BIC2200SimDevice & device, double dt) {
+        double open = V_EMPTY + V_SLOPE * charge / CAPACITY;
+        if (device.getWord(CMD_DIRECTION_CTRL) & 0x01) {
+            double limit = device.getWord(CMD_REVERSE_IOUT_SET) * 0.01;
+            current = (open - device.getWord(CMD_REVERSE_VOUT_SET) * 0.01) / RESISTANCE;
+            current = (current < 0) ? 0 : (current > limit) ? limit : current;
+            voltage = open - current * RESISTANCE;
+            charge -= current * dt;
+        } else {
+            double limit = device.getWord(CMD_IOUT_SET) * 0.01;
+            current = (device.getWord(CMD_VOUT_SET) * 0.01 - open) / RESISTANCE;
+            current = (current < 0) ? 0 : (current > limit) ? limit : current;
+            voltage = open + current * RESISTANCE;
+            charge += current * dt;
+        }
+        vout = (long)(voltage * 100 + 0.5) * 10;
+        iout = (long)(current * 100 + 0.5) * 10;
+        device.setWord(CMD_READ_VOUT, vout / 10);
+        device.setWord(CMD_READ_IOUT, iout / 10);
+    }
+};
+
+static BIC2200SimBus * simClock = NULL;
+static uint64_t enteredAt[6];
+
+static void onTransition(BIC2200 & device, byte state) {
+    (void)device;
+    enteredAt[state] = simClock->nanos();
+}
+
+struct LoopTime {
+    uint64_t min = ~0ULL;
+    uint64_t max = 0;
+    uint64_t sum = 0;
+    unsigned long count = 0;
+
+    void add(uint64_t ns) {
+        min = (ns < min) ? ns : min;
+        max = (ns > max) ? ns : max;
+        sum += ns;
+        ++count;
+    }
+};
+
+int main() {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 unit;
+    BIC2200Scheduler scheduler;
+    BIC2200ProfileEngine engine;
+    Battery battery = { 600.0, 0, 0, 0, 0 };
+    LoopTime engineLoop;
+    unsigned long maxFramesPerTick = 0;
+
+    simClock = &sim;
+    sim.device(0).setModel(48);
+    sim.device(0).dropPerMille = DROP_PER_MILLE;
+    sim.setSeed(7);
+    bus.begin(sim);
+    scheduler.begin(bus);
+    engine.begin(scheduler);
+    engine.onTransition(onTransition);
+    unit.begin(bus, 0);
+    battery.update(sim.device(0), 0);
+
+    // Loop of the Sketch: Engine, then the Battery follows the Setpoints for the elapsed Time.
+    // crossed = ns when the Battery first met the Condition, stops at the wanted State
+    auto loop = [&](byte until, uint64_t limitNs, bool (*condition)(const Battery &), uint64_t & crossed) {
+        uint64_t end = sim.nanos() + limitNs;
+        uint64_t last = sim.nanos();
+        crossed = 0;
+        while (sim.nanos() < end && engine.getState(unit) != until) {
+            uint64_t start = sim.nanos();
+            unsigned long frames = engine.getStats().frames;
+            engine.run();
+            engineLoop.add(sim.nanos() - start);
+            frames = engine.getStats().frames - frames;
+            maxFramesPerTick = (frames > maxFramesPerTick) ? frames : maxFramesPerTick;
+            sim.advance(LOOP_TIME_US);
+            battery.update(sim.device(0), (sim.nanos() - last) / 1e9);
+            last = sim.nanos();
+            if (crossed == 0 && condition != NULL && condition(battery)) {
+                crossed = sim.nanos();
+            }
+        }
+    };
+    const uint64_t period = BIC2200_PROFILE_PERIOD * 1000000ULL;
+    const uint64_t margin = 5000000ULL;     // Poll Request, Reply and one Retry
+
+    // Charge: CC 20 A ramped in 2 s, CV 54.4 V until IOUT <= 2 A for 5 s, Float 53.6 V at 200 mV/s
+    BIC2200ProfileConfig charge = BIC2200ProfileEngine::chargeConfig(CHARGE_VOLTAGE, 20000, FLOAT_VOLTAGE);
+    charge.cvBand = CV_BAND;
+    charge.tailCurrent = 2000;
+    charge.tailTime = 5000;
+    charge.currentRamp = 10000;
+    charge.voltageRamp = 200;
+    check(engine.start(unit, charge), "Charge Profile started, Polls admitted");
+
+    uint64_t startedAt = sim.nanos();
+    uint64_t crossed;
+    loop(BIC2200_PROFILE_CV, 1000000000ULL, NULL, crossed);
+    long rampCurrent = sim.device(0).getWord(CMD_IOUT_SET);
+    unsigned long rampFrames = engine.getStats().frames;
+    loop(BIC2200_PROFILE_CV, 2000000000ULL, NULL, crossed);
+    rampFrames = engine.getStats().frames - rampFrames;
+    check(rampCurrent >= 900 && rampCurrent <= 1100 && sim.device(0).getWord(CMD_IOUT_SET) == 2000,
+        "Current ramped to 20 A in 2 s");
+    check(rampFrames <= 2000 / BIC2200_PROFILE_RAMP_STEP + 2, "Ramp written every BIC2200_PROFILE_RAMP_STEP");
+
+    loop(BIC2200_PROFILE_CV, 300000000000ULL, [](const Battery & b) {
+        return b.vout >= CHARGE_VOLTAGE - CV_BAND;
+    }, crossed);
+    uint64_t chargeCv = enteredAt[BIC2200_PROFILE_CV] - crossed;
+    check(engine.getState(unit) == BIC2200_PROFILE_CV && crossed != 0 && chargeCv <= period + margin,
+        "CC -> CV within one Poll Period");
+
+    loop(BIC2200_PROFILE_FLOAT, 300000000000ULL, [](const Battery & b) { return b.iout <= 2000; }, crossed);
+    uint64_t chargeFloat = enteredAt[BIC2200_PROFILE_FLOAT] - crossed;
+    check(engine.getState(unit) == BIC2200_PROFILE_FLOAT && crossed != 0 &&
+        chargeFloat >= charge.tailTime * 1000000ULL - period &&
+        chargeFloat <= charge.tailTime * 1000000ULL + 2 * period + margin,
+        "CV -> Float after Tail Time + one Poll Period");
+
+    loop(BIC2200_PROFILE_DONE, 10000000000ULL, NULL, crossed);
+    check(sim.device(0).getWord(CMD_VOUT_SET) == FLOAT_VOLTAGE / 10 && engine.getState(unit) == BIC2200_PROFILE_FLOAT,
+        "Float Voltage ramped down and held");
+    double chargeSeconds = (sim.nanos() - startedAt) / 1e9;
+
+    // Discharge: CC 30 A down to 50.0 V, CV until IOUT <= 3 A for 2 s, then DONE
+    BIC2200ProfileConfig discharge = BIC2200ProfileEngine::dischargeConfig(CUTOFF_VOLTAGE, 30000);
+    discharge.cvBand = CV_BAND;
+    discharge.tailCurrent = 3000;
+    discharge.tailTime = 2000;
+    engine.start(unit, discharge);
+    loop(BIC2200_PROFILE_CV, 300000000000ULL, [](const Battery & b) {
+        return b.vout <= CUTOFF_VOLTAGE + CV_BAND;
+    }, crossed);
+    uint64_t dischargeCv = enteredAt[BIC2200_PROFILE_CV] - crossed;
+    check(sim.device(0).getWord(CMD_DIRECTION_CTRL) == 1 && sim.device(0).getWord(CMD_REVERSE_IOUT_SET) == 3000 &&
+        sim.device(0).getWord(CMD_REVERSE_VOUT_SET) == CUTOFF_VOLTAGE / 10, "Discharge Setpoints in REVERSE_*_SET");
+    check(engine.getState(unit) == BIC2200_PROFILE_CV && crossed != 0 && dischargeCv <= period + margin,
+        "Discharge CC -> CV within one Poll Period");
+    loop(BIC2200_PROFILE_DONE, 300000000000ULL, [](const Battery & b) { return b.iout <= 3000; }, crossed);
+    uint64_t dischargeDone = enteredAt[BIC2200_PROFILE_DONE] - crossed;
+    check(engine.getState(unit) == BIC2200_PROFILE_DONE && crossed != 0 &&
+        dischargeDone <= discharge.tailTime * 1000000ULL + 2 * period + margin, "Discharge CV -> DONE after Tail Time");
+    loop(BIC2200_PROFILE_IDLE, 100000000ULL, NULL, crossed);
+    check(sim.device(0).getWord(CMD_REVERSE_IOUT_SET) == 0, "DONE sets the Current to 0");
+    check(scheduler.getDemand() > 0, "DONE keeps polling");
+    engine.stop(unit);
+    for (int pass = 0; pass < 50; pass++) {
+        engine.run();
+        sim.advance(LOOP_TIME_US);
+    }
+    check(engine.getState(unit) == BIC2200_PROFILE_IDLE && scheduler.getDemand() == 0,
+        "stop() removes the Polls and frees the Slot");
+
+    // Blocking Loop of today's Sketches: read VOUT and IOUT, set the Current every Pass
+    LoopTime blockingLoop;
+    for (int pass = 0; pass < 20000; pass++) {
+        uint64_t start = sim.nanos();
+        long voltage = unit.readOutputVoltageMilli();
+        long current = unit.readOutputCurrentMilli();
+        unit.setOutputCurrent((voltage >= CHARGE_VOLTAGE - CV_BAND || current < 0) ? 1000 : 2000);
+        blockingLoop.add(sim.nanos() - start);
+        sim.advance(LOOP_TIME_US);
+    }
+
+    // Telemetry lost: the Profile stops
+    engine.start(unit, charge);
+    sim.device(0).present = false;
+    uint64_t lostAt = sim.nanos();
+    loop(BIC2200_PROFILE_ERROR, 5000000000ULL, NULL, crossed);
+    check(engine.getState(unit) == BIC2200_PROFILE_ERROR &&
+        sim.nanos() - lostAt <= (BIC2200_PROFILE_TIMEOUT + BIC2200_PROFILE_PERIOD) * 1000000ULL + margin,
+        "lost Telemetry stops the Profile");
+
+    // 4 Units started at once share BIC2200_PROFILE_WRITES Frames per tick()
+    {
+        BIC2200SimBus rackSim;
+        BIC2200Bus rackBus;
+        BIC2200 units[4];
+        BIC2200Scheduler rackScheduler;
+        BIC2200ProfileEngine rackEngine;
+        unsigned long rackMax = 0;
+
+        rackBus.begin(rackSim);
+        rackScheduler.begin(rackBus);
+        rackEngine.begin(rackScheduler);
+        for (byte a = 0; a < 4; a++) {
+            rackSim.device(a).setModel(48);
+            units[a].begin(rackBus, a);
+            rackEngine.start(units[a], BIC2200ProfileEngine::chargeConfig(CHARGE_VOLTAGE, 10000, FLOAT_VOLTAGE));
+        }
+        for (int pass = 0; pass < 50; pass++) {
+            unsigned long frames = rackEngine.getStats().frames;
+            rackEngine.run();
+            frames = rackEngine.getStats().frames - frames;
+            rackMax = (frames > rackMax) ? frames : rackMax;
+            rackSim.advance(LOOP_TIME_US);
+        }
+        bool all = true;
+        for (byte a = 0; a < 4; a++) {
+            all = all && rackSim.device(a).getWord(CMD_IOUT_SET) == 1000 &&
+                rackSim.device(a).getWord(CMD_VOUT_SET) == CHARGE_VOLTAGE / 10;
+        }
+        check(rackMax <= BIC2200_PROFILE_WRITES && rackEngine.getStats().deferred > 0 && all,
+            "4 Units: Setpoints spread over Ticks");
+
+        // Stopped in CC: the Current goes to 0 before the Polls of the Unit are removed
+        unsigned long demand = rackScheduler.getDemand();
+        rackEngine.stop(units[0]);
+        for (int pass = 0; pass < 50; pass++) {
+            rackEngine.run();
+            rackSim.advance(LOOP_TIME_US);
+        }
+        check(rackSim.device(0).getWord(CMD_IOUT_SET) == 0 &&
+            rackScheduler.getDemand() == demand - 2 * BIC2200Scheduler::loadOf(CMD_READ_VOUT, BIC2200_PROFILE_PERIOD * 1000UL) &&
+            rackEngine.getState(units[1]) == BIC2200_PROFILE_CC, "stop() in CC: Current 0, Polls removed");
+    }
+
+    printf("\n%-24s %14s %14s\n", "transition", "detected ms", "bound ms");
+    printf("%-24s %14.1f %14llu\n", "Charge CC -> CV", chargeCv / 1e6, (unsigned long long)(period + margin) / 1000000);
+    printf("%-24s %14.1f %14lu\n", "Charge CV -> Float", chargeFloat / 1e6,
+        charge.tailTime + (unsigned long)((2 * period + margin) / 1000000));
+    printf("%-24s %14.1f %14llu\n", "Discharge CC -> CV", dischargeCv / 1e6, (unsigned long long)(period + margin) / 1000000);
+    printf("%-24s %14.1f %14lu\n", "Discharge CV -> DONE", dischargeDone / 1e6,
+        discharge.tailTime + (unsigned long)((2 * period + margin) / 1000000));
+    printf("Charge ran %.0f s of simulated Time\n", chargeSeconds);
+    printf("\n%-24s %10s %10s %10s %10s\n", "loop", "min us", "mean us", "max us", "jitter us");
+    printf("%-24s %10.0f %10.0f %10.0f %10.0f\n", "Profile Engine", engineLoop.min / 1e3,
+        engineLoop.sum / 1e3 / engineLoop.count, engineLoop.max / 1e3, (engineLoop.max - engineLoop.min) / 1e3);
+    printf("%-24s %10.0f %10.0f %10.0f %10.0f\n\n", "blocking read / set", blockingLoop.min / 1e3,
+        blockingLoop.sum / 1e3 / blockingLoop.count, blockingLoop.max / 1e3, (blockingLoop.max - blockingLoop.min) / 1e3);
+
+    // run() sends the due Poll Requests and at most one Setpoint Write, each waits for the Wire
+    uint64_t bound = 3ULL * BIC2200SimBus::frameBits(8) * 1000000000ULL / BIC2200_SIM_BITRATE + 100000ULL;
+    check(maxFramesPerTick <= BIC2200_PROFILE_WRITES, "at most BIC2200_PROFILE_WRITES Frames per tick()");
+    check(engineLoop.max <= bound, "Engine Loop bounded by 3 Frames on the Wire");
+    check(engineLoop.max - engineLoop.min < blockingLoop.max - blockingLoop.min, "Engine jitters less than blocking Loop");
+
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
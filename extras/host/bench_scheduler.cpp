@@ -0,0 +1,119 @@
+//#################################################################################################
+// Poll Scheduler Benchmark of the BIC-2200-XX-CAN Library
+// Runs the typical Telemetry Schedule (IOUT / VOUT 50 Hz, SYSTEM / FAULT_STATUS 10 Hz,
+// Temperature / VIN 1 Hz) for several simulated Units and reports achieved Rates, Deadline
+// Misses, Jitter and projected against measured Bus Load, also when the Schedule is over Budget.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include "bic2200_sim.h"
+#include "bic2200_scheduler.h"
+
+#define RUN_TIME_US     10000000UL  // virtual Time per Scenario
+#define LOOP_TIME_US    100         // other Work of the Sketch per loop()
+
+struct Signal {
+    const char * name;
+    int reg;
+    unsigned long period;   // ms
+    byte priority;
+};
+
+static const Signal signals[] = {
+    { "IOUT",          CMD_READ_IOUT,          20,   3 },
+    { "VOUT",          CMD_READ_VOUT,          20,   3 },
+    { "SYSTEM_STATUS", CMD_SYSTEM_STATUS,      100,  2 },
+    { "FAULT_STATUS",  CMD_FAULT_STATUS,       100,  2 },
+    { "TEMPERATURE",   CMD_READ_TEMPERATURE_1, 1000, 1 },
+    { "VIN",           CMD_READ_VIN,           1000, 1 }
+};
+#define SIGNALS     (sizeof(signals) / sizeof(signals[0]))
+
+static int failures = 0;
+
+static void scenario(const char * title, byte units, byte budget, bool lowFirst, bool expectShed) {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 devices[BIC2200_MAX_DEVICES];
+    BIC2200Scheduler scheduler;
+    int entries[BIC2200_MAX_DEVICES][SIGNALS];
+    int rejected = 0;
+
+    bus.begin(sim);
+    for (byte d = 0; d < units; d++) {
+        sim.device(d).setModel(48);
+        sim.device(d).replyJitter = 50;
+        devices[d].begin(bus, d);
+    }
+    scheduler.begin(bus);
+    scheduler.setBudget(budget);
+    for (size_t n = 0; n < SIGNALS; n++) {
+        size_t s = lowFirst ? SIGNALS - 1 - n : n;
+        for (byte d = 0; d < units; d++) {
+            entries[d][s] = scheduler.add(devices[d], signals[s].reg, signals[s].period, signals[s].priority);
+            rejected += (entries[d][s] < 0);
+        }
+    }
+
+    sim.resetCounters();
+    uint64_t start = sim.nanos();
+    while (sim.nanos() - start < RUN_TIME_US * 1000ULL) {
+        scheduler.run();
+        sim.advance(LOOP_TIME_US);
+    }
+    double seconds = (sim.nanos() - start) / 1e9;
+
+    printf("\n%s: %u Units, Budget %u %%, projected %.1f %% of %.1f %% demanded, measured %.1f %%, %d rejected\n",
+        title, units, budget, scheduler.getLoad() / 100.0, scheduler.getDemand() / 100.0,
+        100.0 * sim.busyNanos() / (sim.nanos() - start), rejected);
+    printf("%-14s %6s %9s %6s %6s %6s %10s %10s\n",
+        "signal", "target", "achieved", "shed", "miss", "tmo", "jitter avg", "jitter max");
+
+    unsigned int shed = 0;
+    for (size_t s = 0; s < SIGNALS; s++) {
+        BIC2200ScheduleStats total = {};
+        unsigned int shedUnits = 0;
+        unsigned int activeUnits = 0;
+        for (byte d = 0; d < units; d++) {
+            if (entries[d][s] < 0) {
+                continue;
+            }
+            if (scheduler.isShed(entries[d][s])) {
+                ++shedUnits;
+                continue;
+            }
+            ++activeUnits;
+            BIC2200ScheduleStats stats = scheduler.getStats(entries[d][s]);
+            total.issued += stats.issued;
+            total.received += stats.received;
+            total.timeouts += stats.timeouts;
+            total.misses += stats.misses;
+            total.jitterSum += stats.jitterSum;
+            if (stats.jitterMax > total.jitterMax) {
+                total.jitterMax = stats.jitterMax;
+            }
+        }
+        shed += shedUnits;
+        double target = 1000.0 / signals[s].period;
+        double achieved = activeUnits ? total.received / seconds / activeUnits : 0.0;
+        printf("%-14s %4.0fHz %7.1fHz %6u %6lu %6lu %8.0fus %8luus\n",
+            signals[s].name, target, achieved, shedUnits, total.misses, total.timeouts,
+            total.issued ? (double)total.jitterSum / total.issued : 0.0, total.jitterMax);
+        if (activeUnits && (achieved < 0.98 * target || total.timeouts > 0)) {
+            ++failures;
+        }
+    }
+    if ((shed > 0) != expectShed) {
+        ++failures;
+    }
+}
+
+int main() {
+    scenario("within budget", 4, BIC2200_SCHEDULER_BUDGET, false, false);
+    scenario("over budget, low priorities added first", 8, BIC2200_SCHEDULER_BUDGET, true, true);
+    scenario("full bus", 8, 100, false, false);
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
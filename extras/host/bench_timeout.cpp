@@ -0,0 +1,291 @@
+//#################################################################################################
+// Adaptive Timeout Benchmark of the BIC-2200-XX-CAN Library
+// Compares the fixed CAN_REPLY_TIME + CAN_TIMEOUT with the Timeout learned from the Round Trip
+// Times on a Unit which loses Replies, a slow Unit (e.g. while it is paralleled) and a Rack with
+// one unplugged Unit, then checks Retries, Backoff, the degraded State and the Expiry of Requests
+// to an unplugged Unit while the other Units keep the Bus busy.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include "bic2200_sim.h"
+
+#define READS           20000
+#define RACK_UNITS      4
+#define RACK_ROUNDS     5000
+
+struct Policy {
+    const char * name;
+    bool adaptive;
+    byte retries;
+    byte degradeAfter;
+};
+
+static const Policy policies[] = {
+    { "fixed", false, 0, 0 },
+    { "fixed + retries", false, BIC2200_RETRIES, 0 },
+    { "adaptive", true, BIC2200_RETRIES, BIC2200_DEGRADE_AFTER }
+};
+#define POLICIES    (sizeof(policies) / sizeof(policies[0]))
+
+struct Result {
+    double readsPerSecond;
+    double validPercent;        // Reads with the current Value (not the late Reply of an older Read)
+    double waitPerTimeout;      // us per expired Request
+    double savedMs;             // against the fixed Timeout, per 1000 Reads
+    unsigned long requests;     // Requests sent to the Unit in Question
+    BIC2200TimeoutStats stats;
+};
+
+static int failures = 0;
+
+static void check(bool condition, const char * what) {
+    printf("%-48s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        ++failures;
+    }
+}
+
+static void apply(BIC2200 & device, const Policy & policy) {
+    device.setAdaptiveTimeout(policy.adaptive);
+    device.setRetries(policy.retries);
+    device.setDegradeAfter(policy.degradeAfter);
+}
+
+static void printHeader(const char * scenario) {
+    printf("\n%s\n", scenario);
+    printf("%-16s %9s %8s %9s %8s %8s %12s %11s\n", "policy", "reads/s", "valid", "timeouts", "retries",
+        "timeout", "us/timeout", "saved ms/1k");
+}
+
+static void printResult(const Policy & policy, const Result & result) {
+    printf("%-16s %9.0f %7.2f%% %9lu %8lu %6luus %12.0f %11.1f\n", policy.name, result.readsPerSecond,
+        result.validPercent, result.stats.expired, result.stats.retries, result.stats.timeout,
+        result.waitPerTimeout, result.savedMs);
+}
+
+// Blocking Reads of one Unit
+static Result single(const Policy & policy, unsigned long latency, unsigned long jitter, unsigned int drops) {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 bic;
+    unsigned long valid = 0;
+    const int reg = CMD_READ_IOUT;
+    unsigned int value;
+
+    sim.device(0).setModel(48);
+    sim.device(0).replyLatency = latency;
+    sim.device(0).replyJitter = jitter;
+    sim.device(0).dropPerMille = drops;
+    bus.begin(sim);
+    bic.begin(bus, 0);
+    apply(bic, policy);
+
+    uint64_t start = sim.nanos();
+    for (unsigned long i = 0; i < READS; i++) {
+        sim.device(0).setWord(reg, (uint16_t)i);
+        if (bic.readRegisters(&reg, 1, &value) == 1 && value == (uint16_t)i) {
+            ++valid;
+        }
+    }
+    double seconds = (sim.nanos() - start) / 1e9;
+
+    Result result;
+    result.stats = bic.getTimeoutStats();
+    result.readsPerSecond = READS / seconds;
+    result.validPercent = 100.0 * valid / READS;
+    result.waitPerTimeout = result.stats.expired ? (double)result.stats.waitActual / result.stats.expired : 0;
+    result.savedMs = result.stats.timeSaved() / 1000.0 / (READS / 1000.0);
+    result.requests = bic.getStats().framesSent;
+    return result;
+}
+
+// Snapshot Rounds over a Rack, the last Unit is unplugged
+static Result rack(const Policy & policy) {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 devices[RACK_UNITS];
+    unsigned long reads = 0;
+    unsigned long valid = 0;
+    BIC2200TimeoutStats missing = {};
+
+    bus.begin(sim);
+    for (byte d = 0; d < RACK_UNITS; d++) {
+        sim.device(d).setModel(48);
+        sim.device(d).replyJitter = 50;
+        devices[d].begin(bus, d);
+        apply(devices[d], policy);
+    }
+    sim.device(RACK_UNITS - 1).present = false;
+
+    uint64_t start = sim.nanos();
+    for (unsigned long round = 0; round < RACK_ROUNDS; round++) {
+        for (byte d = 0; d < RACK_UNITS; d++) {
+            BIC2200Snapshot snapshot = devices[d].readSnapshot();
+            for (byte bit = 0; bit < 6; bit++) {
+                valid += (snapshot.valid >> bit) & 1;
+            }
+            reads += 6;
+        }
+        sim.advance(1000);
+    }
+    double seconds = (sim.nanos() - start) / 1e9;
+    missing = devices[RACK_UNITS - 1].getTimeoutStats();
+
+    Result result;
+    result.stats = missing;
+    result.readsPerSecond = reads / seconds;
+    result.validPercent = 100.0 * valid / reads;
+    result.waitPerTimeout = missing.expired ? (double)missing.waitActual / missing.expired : 0;
+    result.savedMs = missing.timeSaved() / 1000.0 / (reads / 1000.0);
+    result.requests = devices[RACK_UNITS - 1].getStats().framesSent;
+    return result;
+}
+
+// Non-blocking Reads on a Rack whose live Units keep the Bus busy, the last Unit is unplugged.
+// Their Replies restart the Timeout, BIC2200_TIMEOUT_LIMIT still expires the Requests
+static void checkBusyRack() {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 devices[RACK_UNITS];
+    BIC2200 & dead = devices[RACK_UNITS - 1];
+    const int reg = CMD_READ_VOUT;
+    unsigned int value;
+
+    bus.begin(sim);
+    for (byte d = 0; d < RACK_UNITS; d++) {
+        sim.device(d).setModel(48);
+        devices[d].begin(bus, d);
+    }
+    sim.device(RACK_UNITS - 1).present = false;
+
+    dead.requestRead(reg);
+    uint64_t start = sim.nanos();
+    uint64_t expiredAt = 0;
+    unsigned long live = 0;
+    while (sim.nanos() - start < 200000000ULL) {
+        for (byte d = 0; d < RACK_UNITS - 1; d++) {
+            if (!devices[d].isBusy()) {
+                devices[d].getResult(reg, (byte *)&value, 2);
+                devices[d].requestRead(reg);
+                ++live;
+            }
+        }
+        bus.poll();
+        if (expiredAt == 0 && dead.getResult(reg, (byte *)&value, 2) == 0) {
+            expiredAt = sim.nanos();
+        }
+        if (expiredAt != 0 && !dead.isDegraded() && !dead.isBusy()) {
+            dead.requestRead(reg);
+            dead.getResult(reg, (byte *)&value, 2);
+        }
+        sim.advance(20);
+    }
+    // Every Try expires BIC2200_TIMEOUT_LIMIT after its Request, checked by a poll() that waits
+    // for the Wire of the busy Bus
+    uint64_t limit = (uint64_t)(BIC2200_RETRIES + 1) * (BIC2200_TIMEOUT_LIMIT + 2 * (CAN_REPLY_TIME + CAN_TIMEOUT)) * 1000ULL;
+    printf("\nbusy Rack: %lu live Reads, Read of the unplugged Unit failed after %.1f ms\n", live,
+        expiredAt ? (expiredAt - start) / 1e6 : -1.0);
+    check(expiredAt != 0 && expiredAt - start <= limit, "busy Rack: Request to unplugged Unit expires");
+    check(dead.isDegraded(), "busy Rack: unplugged Unit degraded");
+}
+
+static void benchSingle(const char * scenario, unsigned long latency, unsigned long jitter, unsigned int drops,
+    Result * results) {
+    printHeader(scenario);
+    for (byte p = 0; p < POLICIES; p++) {
+        results[p] = single(policies[p], latency, jitter, drops);
+        printResult(policies[p], results[p]);
+    }
+}
+
+static void checkStates() {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 bic;
+    unsigned int value;
+    const int reg = CMD_READ_VOUT;
+
+    printf("\n");
+    check(bic.getTimeout() == CAN_REPLY_TIME + CAN_TIMEOUT, "fixed Timeout until the first Sample");
+
+    sim.device(2).setModel(24);
+    bus.begin(sim);
+    bic.begin(bus, 2);
+    for (int i = 0; i < 50; i++) {
+        bic.readRegisters(&reg, 1, &value);
+    }
+    BIC2200TimeoutStats stats = bic.getTimeoutStats();
+    check(stats.rtt > 0 && stats.timeout < CAN_REPLY_TIME + CAN_TIMEOUT, "Timeout learned below the fixed one");
+    check(stats.timeout >= stats.rtt + BIC2200_TIMEOUT_MARGIN, "Timeout keeps the Margin above the RTT");
+
+    // One lost Reply: the Retry answers, the Timeout is backed off until the next Sample
+    unsigned long learned = bic.getTimeout();
+    sim.device(2).dropPerMille = 1000;
+    bic.requestRead(reg);
+    while (bic.getTimeoutStats().retries == 0) {
+        bic.poll();
+    }
+    sim.device(2).dropPerMille = 0;
+    check(bic.getTimeout() >= 2 * learned || bic.getTimeout() == BIC2200_TIMEOUT_MAX, "Timeout backed off");
+    while (bic.isBusy()) {
+        bic.poll();
+    }
+    check(bic.getResult(reg, (byte *)&value, 2) == 1 && bic.getTimeoutStats().recovered == 1, "Retry recovers the Read");
+    bic.readRegisters(&reg, 1, &value);
+    check(bic.getTimeout() == learned, "Backoff ends with the next Sample");
+
+    // Unplugged: degraded after BIC2200_DEGRADE_AFTER failed Reads, then only probed
+    bic.resetTimeoutStats();
+    sim.device(2).present = false;
+    for (int i = 0; i < BIC2200_DEGRADE_AFTER; i++) {
+        bic.readRegisters(&reg, 1, &value);
+    }
+    check(bic.isDegraded(), "degraded after failed Reads");
+    unsigned long requests = bic.getStats().framesSent;
+    uint64_t start = sim.nanos();
+    for (int i = 0; i < 100; i++) {
+        bic.readRegisters(&reg, 1, &value);
+    }
+    check(bic.getStats().framesSent == requests && sim.nanos() - start < 100 * 10000ULL,
+        "degraded Reads fail at once without Bus Access");
+    check(bic.getTimeoutStats().skipped == 100, "skipped Reads counted");
+
+    sim.device(2).present = true;
+    sim.advance(BIC2200_PROBE_INTERVAL * 1000UL);
+    check(bic.readRegisters(&reg, 1, &value) == 1 && !bic.isDegraded(), "Probe Reply makes the Device healthy");
+
+    bic.setAdaptiveTimeout(false);
+    check(bic.getTimeout() == CAN_REPLY_TIME + CAN_TIMEOUT, "setAdaptiveTimeout(false) is fixed");
+}
+
+int main() {
+    Result lossy[POLICIES];
+    Result slow[POLICIES];
+    Result racks[POLICIES];
+
+    benchSingle("Unit with 2 % lost Replies, 100 - 150 us Latency", 100, 50, 20, lossy);
+    benchSingle("slow Unit, 900 - 1300 us Latency (paralleled)", 900, 400, 0, slow);
+
+    printHeader("Rack of 4, Unit 3 unplugged, Snapshot Rounds (Timeouts of Unit 3)");
+    for (byte p = 0; p < POLICIES; p++) {
+        racks[p] = rack(policies[p]);
+        printResult(policies[p], racks[p]);
+        printf("%-16s %lu Requests to Unit 3\n", "", racks[p].requests);
+    }
+
+    printf("\n");
+    check(lossy[2].waitPerTimeout < 0.8 * lossy[0].waitPerTimeout, "lossy: shorter Wait per Timeout");
+    check(lossy[2].readsPerSecond > lossy[1].readsPerSecond, "lossy: more Reads/s than fixed + retries");
+    check(lossy[2].validPercent > 99.9 && lossy[2].savedMs > 0, "lossy: Retries recover, Time saved");
+    check(slow[0].validPercent < 50.0, "slow: fixed Timeout loses the Replies");
+    check(slow[2].validPercent > 99.0, "slow: adaptive Timeout follows the Unit");
+    check(racks[2].readsPerSecond > racks[0].readsPerSecond, "rack: degraded Unit costs no Bus Time");
+    check(racks[2].requests < racks[0].requests / 100, "rack: degraded Unit only probed");
+
+    checkStates();
+    checkBusyRack();
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
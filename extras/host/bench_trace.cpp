@@ -0,0 +1,290 @@
+//#################################################################################################
+// Frame Trace and Replay Benchmark of the BIC-2200-XX-CAN Library
+// Captures Snapshot Rounds over a simulated Rack (one Unit loses Replies) with BIC2200Trace,
+// in both Formats, and replays the Trace through the Library: timed with the same Workload
+// (same Requests, same Values), reactive with a pipelined Workload (same Values per Register)
+// and in real Time at accelerated Speed. Reports Trace Size and Replay Throughput.
+// Usage: bench_trace [trace.log]   (the candump Text is kept for canplayer / tracedump)
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "bic2200_sim.h"
+#include "bic2200_replay.h"
+
+#define UNITS           4
+#define ROUNDS          400
+#define PERIOD_US       20000       // Idle Time after every Round
+#define SPEED           50          // real Time Replay
+
+static const int regs[6] = { CMD_READ_VIN, CMD_READ_VOUT, CMD_READ_IOUT, CMD_READ_TEMPERATURE_1,
+    CMD_SYSTEM_STATUS, CMD_FAULT_STATUS };
+
+// valid Words per Unit and Register in the Order they were read
+typedef std::vector<uint16_t> Series[UNITS][6];
+
+struct Capture {
+    std::vector<uint8_t> data;
+    std::vector<BIC2200Snapshot> snapshots;
+    BIC2200TraceStats stats;
+    uint64_t durationUs;
+};
+
+static int failures = 0;
+
+static void check(bool condition, const char * what) {
+    printf("%-48s %s\n", what, condition ? "ok" : "FAIL");
+    if (!condition) {
+        ++failures;
+    }
+}
+
+class BufferPrint : public Print {
+public:
+    std::vector<uint8_t> & data;
+
+    explicit BufferPrint(std::vector<uint8_t> & buffer) : data(buffer) {}
+    size_t write(uint8_t value) { data.push_back(value); return 1; }
+    size_t write(const uint8_t * buffer, size_t size) { data.insert(data.end(), buffer, buffer + size); return size; }
+};
+
+static uint16_t words(const BIC2200Snapshot & s, byte i) {
+    const uint16_t values[6] = { s.vin, s.vout, (uint16_t)s.iout, (uint16_t)s.temperature, s.systemStatus, s.faultStatus };
+    return values[i];
+}
+
+static void addSnapshot(Series & series, byte unit, const BIC2200Snapshot & s) {
+    for (byte i = 0; i < 6; i++) {
+        if (s.valid & (1 << i)) {
+            series[unit][i].push_back(words(s, i));
+        }
+    }
+}
+
+static bool sameSeries(const Series & a, const Series & b) {
+    for (byte d = 0; d < UNITS; d++) {
+        for (byte i = 0; i < 6; i++) {
+            if (a[d][i] != b[d][i]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool sameSnapshots(const std::vector<BIC2200Snapshot> & a, const std::vector<BIC2200Snapshot> & b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t n = 0; n < a.size(); n++) {
+        if (a[n].valid != b[n].valid) {
+            return false;
+        }
+        for (byte i = 0; i < 6; i++) {
+            if ((a[n].valid & (1 << i)) && words(a[n], i) != words(b[n], i)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool sameRecords(const std::vector<BIC2200TraceRecord> & a, const std::vector<BIC2200TraceRecord> & b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].time != b[i].time || a[i].transmit != b[i].transmit || a[i].frame.id != b[i].frame.id ||
+            a[i].frame.len != b[i].frame.len || memcmp(a[i].frame.data, b[i].frame.data, a[i].frame.len) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Production Stand-in: drifting Measurements, Jitter, Unit 1 loses 2 % of its Replies
+static void capture(byte format, Capture & result) {
+    BIC2200SimBus sim;
+    BIC2200Bus bus;
+    BIC2200 devices[UNITS];
+    BIC2200Trace trace;
+    BufferPrint out(result.data);
+    uint32_t random = 0x1234567;
+
+    sim.setSeed(7);
+    for (byte d = 0; d < UNITS; d++) {
+        sim.device(d).setModel(48);
+        sim.device(d).replyJitter = 200;
+    }
+    sim.device(1).dropPerMille = 20;
+    bus.begin(sim);
+    trace.begin(bus);
+    for (byte d = 0; d < UNITS; d++) {
+        devices[d].begin(bus, d);
+    }
+
+    for (int round = 0; round < ROUNDS; round++) {
+        for (byte d = 0; d < UNITS; d++) {
+            BIC2200SimDevice & unit = sim.device(d);
+            random ^= random << 13;
+            random ^= random >> 17;
+            random ^= random << 5;
+            unit.setWord(CMD_READ_VOUT, 4800 + random % 16);
+            unit.setWord(CMD_READ_IOUT, 2000 + (random >> 8) % 400);
+            unit.setWord(CMD_READ_VIN, 2300 + (random >> 16) % 10);
+            result.snapshots.push_back(devices[d].readSnapshot());
+            trace.flush(out, format);
+        }
+        sim.advance(PERIOD_US);
+    }
+    trace.end();
+    trace.flush(out, format);
+    result.stats = trace.getStats();
+    result.durationUs = sim.nanos() / 1000;
+}
+
+// The captured Workload again, on the Replay
+static void snapshotRounds(BIC2200ReplayTransport & replay, std::vector<BIC2200Snapshot> & snapshots) {
+    BIC2200Bus bus;
+    BIC2200 devices[UNITS];
+
+    bus.begin(replay);
+    for (byte d = 0; d < UNITS; d++) {
+        devices[d].begin(bus, d);
+    }
+    for (int round = 0; round < ROUNDS; round++) {
+        for (byte d = 0; d < UNITS; d++) {
+            snapshots.push_back(devices[d].readSnapshot());
+        }
+        replay.advance(PERIOD_US);
+    }
+}
+
+// A changed Scheduler: all Registers of all Units pipelined in one Burst per Round
+static void pipelinedRounds(BIC2200ReplayTransport & replay, Series & series) {
+    BIC2200Bus bus;
+    BIC2200 devices[UNITS];
+    uint16_t value;
+
+    bus.begin(replay);
+    for (byte d = 0; d < UNITS; d++) {
+        devices[d].begin(bus, d);
+    }
+    for (int round = 0; round < ROUNDS; round++) {
+        for (byte i = 0; i < 6; i++) {
+            for (byte d = 0; d < UNITS; d++) {
+                devices[d].requestRead(regs[i]);
+            }
+        }
+        while (bus.isBusy()) {
+            bus.poll();
+        }
+        for (byte d = 0; d < UNITS; d++) {
+            for (byte i = 0; i < 6; i++) {
+                if (devices[d].getResult(regs[i], (byte *)&value, 2) == 1) {
+                    series[d][i].push_back(value);
+                }
+            }
+        }
+        replay.advance(PERIOD_US);
+    }
+}
+
+static double seconds(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+static void printReplay(const char * name, const BIC2200ReplayStats & stats, double wall) {
+    printf("%-18s %9lu %9lu %8lu %8lu %8lu %10.1f %12.0f\n", name, stats.delivered, stats.requests, stats.mismatched,
+        stats.unexpected, stats.unanswered, wall * 1000, (stats.delivered + stats.requests) / wall);
+}
+
+int main(int argc, char ** argv) {
+    Capture text;
+    Capture binary;
+    BIC2200TraceReader reader;
+    std::vector<BIC2200TraceRecord> fromText;
+    std::vector<BIC2200TraceRecord> fromBinary;
+    Series expected;
+
+    capture(BIC2200_TRACE_CANDUMP, text);
+    capture(BIC2200_TRACE_BINARY, binary);
+    reader.decode(text.data.data(), text.data.size(), fromText);
+    reader.decode(binary.data.data(), binary.data.size(), fromBinary);
+    for (size_t n = 0; n < text.snapshots.size(); n++) {
+        addSnapshot(expected, n % UNITS, text.snapshots[n]);
+    }
+
+    printf("\n%u Units, %u Snapshot Rounds, %.2f s Trace, %lu Frames\n", UNITS, ROUNDS, text.durationUs / 1e6,
+        text.stats.frames);
+    printf("%-10s %10s %12s\n", "format", "bytes", "bytes/frame");
+    printf("%-10s %10zu %12.2f\n", "candump", text.data.size(), (double)text.data.size() / text.stats.frames);
+    printf("%-10s %10zu %12.2f\n", "binary", binary.data.size(), (double)binary.data.size() / binary.stats.frames);
+
+    check(text.stats.dropped == 0 && text.stats.lost == 0, "no Frame dropped with flush() per Snapshot");
+    check(fromText.size() == text.stats.frames && reader.getStats().skipped == 0, "every candump Line parsed");
+    check(sameRecords(fromText, fromBinary), "candump and binary decode to the same Frames");
+    check(binary.data.size() * 4 < text.data.size(), "binary needs < 1/4 of the candump Bytes");
+
+    printf("\n%-18s %9s %9s %8s %8s %8s %10s %12s\n", "replay", "delivered", "requests", "mismatch", "extra",
+        "no reply", "wall ms", "frames/s");
+
+    // Timed on the virtual Clock: the unchanged Workload sees the recorded Traffic again
+    std::vector<BIC2200Snapshot> replayed;
+    BIC2200ReplayTransport timed(fromBinary, BIC2200_REPLAY_TIMED);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    snapshotRounds(timed, replayed);
+    double timedWall = seconds(start);
+    BIC2200ReplayStats timedStats = timed.getStats();
+    uint64_t timedUs = timed.nanos() / 1000;
+    printReplay("timed", timedStats, timedWall);
+
+    // Reactive: a pipelined Scheduler gets the recorded Reply of every Request
+    Series pipelined;
+    BIC2200ReplayTransport reactive(fromBinary, BIC2200_REPLAY_REACTIVE);
+    start = std::chrono::steady_clock::now();
+    pipelinedRounds(reactive, pipelined);
+    double reactiveWall = seconds(start);
+    BIC2200ReplayStats reactiveStats = reactive.getStats();
+    printReplay("reactive", reactiveStats, reactiveWall);
+    uint64_t reactiveUs = reactive.nanos() / 1000;
+
+    // Reactive in real Time, SPEED Times faster than recorded
+    Series paced;
+    BIC2200ReplayTransport realTime(fromText, BIC2200_REPLAY_REACTIVE, SPEED);
+    start = std::chrono::steady_clock::now();
+    pipelinedRounds(realTime, paced);
+    double realWall = seconds(start);
+    printReplay("reactive, x50", realTime.getStats(), realWall);
+
+    printf("\ntimed Replay: %.2f s, max. %lu us off the Trace; pipelined Rounds: %.2f s; captured: %.2f s\n",
+        timedUs / 1e6, timedStats.maxDrift, reactiveUs / 1e6, text.durationUs / 1e6);
+
+    check(timedStats.mismatched == 0 && timedStats.unexpected == 0 && timed.finished(),
+        "timed: Library repeats the recorded Requests");
+    check(sameSnapshots(replayed, text.snapshots), "timed: same Snapshots as captured");
+    check(reactiveStats.unexpected == 0 && reactiveStats.unanswered > 0 && reactive.finished(),
+        "reactive: every Request found, lost Replies kept");
+    check(sameSeries(pipelined, expected), "reactive: same Values per Register as captured");
+    // the Rounds are Wire-bound at 250 kbit/s, the lost Replies cost the same Timeouts
+    check(reactiveUs < text.durationUs * 101 / 100, "reactive: pipelined Rounds as fast as captured");
+    // Host Scheduling shows up SPEED Times larger, a late poll() may cost a Retry
+    check(realTime.getStats().delivered >= reactiveStats.delivered * 99 / 100, "real Time: Replies delivered");
+    check(realWall >= 0.9 * reactiveUs / 1e6 / SPEED, "real Time: paced at the Replay Speed");
+
+    if (argc > 1) {
+        FILE * log = fopen(argv[1], "wb");
+        if (log == NULL) {
+            perror(argv[1]);
+            return 1;
+        }
+        fwrite(text.data.data(), 1, text.data.size(), log);
+        fclose(log);
+    }
+
+    printf("\n%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,619 @@
+//#################################################################################################
+// Declarative Configuration of BIC-2200-XX-CAN Racks
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string>
+#include "bic2200_config.h"
+
+const BIC2200ConfigKey BIC2200Config::keys[BIC2200_CONFIG_KEYS] = {
+    { "system_config",          CMD_SYSTEM_CONFIG,          BIC2200_CONFIG_WORD },
+    { "bidirectional_config",   CMD_BIDIRECTIONAL_CONFIG,   BIC2200_CONFIG_WORD },
+    { "vout",                   CMD_VOUT_SET,               BIC2200_CONFIG_VOLTAGE },
+    { "iout",                   CMD_IOUT_SET,               BIC2200_CONFIG_CURRENT },
+    { "reverse_vout",           CMD_REVERSE_VOUT_SET,       BIC2200_CONFIG_VOLTAGE },
+    { "reverse_iout",           CMD_REVERSE_IOUT_SET,       BIC2200_CONFIG_CURRENT },
+    { "direction",              CMD_DIRECTION_CTRL,         BIC2200_CONFIG_DIRECTION },
+    { "operation",              CMD_OPERATION,              BIC2200_CONFIG_SWITCH }
+};
+
+static char * trim(char * text) {
+    while (isspace((unsigned char)*text)) {
+        ++text;
+    }
+    char * end = text + strlen(text);
+    while (end > text && isspace((unsigned char)end[-1])) {
+        *--end = '\0';
+    }
+    return text;
+}
+
+bool BIC2200Config::load(const char * path) {
+//#################################################################################################
+//  Function:       load
+//  Access:         Public
+//  Input:          path (const char *) Configuration File
+//  Output:         (bool) false = File not readable or not valid, see getError()
+//  Description:    Reads a File and parses it on top of the current Settings
+//#################################################################################################
+    FILE * in = fopen(path, "r");
+    if (in == NULL) {
+        snprintf(_error, sizeof(_error), "%s: cannot open", path);
+        return false;
+    }
+    std::string text;
+    char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        text.append(buffer, n);
+    }
+    fclose(in);
+    return parse(text.c_str());
+}
+
+bool BIC2200Config::parse(const char * text) {
+//#################################################################################################
+//  Function:       parse
+//  Access:         Public
+//  Input:          text (const char *) Configuration, see bic2200_config.h
+//  Output:         (bool) false = Syntax Error, see getError(); Settings up to the Error are kept
+//  Description:    "[addresses]" selects the Addresses of the following Keys ("*" = all, Lists
+//                  and Ranges like "0-3, 6"), before the first Section Keys apply to all.
+//                  "#" and ";" start a Comment
+//#################################################################################################
+    char line[160];
+    byte mask = 0xFF;
+    unsigned int number = 0;
+
+    _error[0] = '\0';
+    while (*text) {
+        size_t n = strcspn(text, "\n");
+        ++number;
+        if (n >= sizeof(line)) {
+            snprintf(_error, sizeof(_error), "line %u: too long", number);
+            return false;
+        }
+        memcpy(line, text, n);
+        line[n] = '\0';
+        text += n;
+        if (*text == '\n') {
+            ++text;
+        }
+        line[strcspn(line, "#;")] = '\0';
+        char * content = trim(line);
+        if (*content == '\0') {
+            continue;
+        }
+
+        if (*content == '[') {
+            char * close = strchr(content, ']');
+            if (close == NULL || *trim(close + 1) != '\0') {
+                snprintf(_error, sizeof(_error), "line %u: Section without ]", number);
+                return false;
+            }
+            *close = '\0';
+            if (!parseAddresses(content + 1, mask)) {
+                snprintf(_error, sizeof(_error), "line %u: invalid Addresses '%s'", number, content + 1);
+                return false;
+            }
+            continue;
+        }
+
+        char * equals = strchr(content, '=');
+        if (equals == NULL) {
+            snprintf(_error, sizeof(_error), "line %u: expected key = value", number);
+            return false;
+        }
+        *equals = '\0';
+        char * name = trim(content);
+        char * value = trim(equals + 1);
+        int key = findKey(name);
+        long parsed;
+        if (key < 0) {
+            snprintf(_error, sizeof(_error), "line %u: unknown Key '%s'", number, name);
+            return false;
+        }
+        if (!parseValue(key, value, parsed)) {
+            snprintf(_error, sizeof(_error), "line %u: invalid Value '%s' for %s", number, value, name);
+            return false;
+        }
+        for (byte address = 0; address < BIC2200_MAX_DEVICES; address++) {
+            if (mask & (1 << address)) {
+                set(address, key, parsed);
+            }
+        }
+    }
+    return true;
+}
+
+void BIC2200Config::clear() {
+//#################################################################################################
+//  Function:       clear
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Removes all Settings
+//#################################################################################################
+    memset(_set, 0, sizeof(_set));
+    _error[0] = '\0';
+}
+
+void BIC2200Config::set(byte address, byte key, long value) {
+//#################################################################################################
+//  Function:       set
+//  Access:         Public
+//  Input:          address (byte) Device Address [0-7]
+//                  key (byte) Index into keys
+//                  value (long) mV, mA, Word or 0 / 1
+//  Output:         -
+//  Description:    Sets one Setting
+//#################################################################################################
+    if (address >= BIC2200_MAX_DEVICES || key >= BIC2200_CONFIG_KEYS) {
+        return;
+    }
+    _values[address][key] = value;
+    _set[address] |= (1 << key);
+}
+
+bool BIC2200Config::get(byte address, byte key, long & value) const {
+//#################################################################################################
+//  Function:       get
+//  Access:         Public
+//  Input:          address (byte) Device Address [0-7]
+//                  key (byte) Index into keys
+//                  value (long &) mV, mA, Word or 0 / 1
+//  Output:         (bool) false = not configured
+//  Description:    Reads one Setting
+//#################################################################################################
+    if (address >= BIC2200_MAX_DEVICES || key >= BIC2200_CONFIG_KEYS || !(_set[address] & (1 << key))) {
+        return false;
+    }
+    value = _values[address][key];
+    return true;
+}
+
+byte BIC2200Config::getAddresses() const {
+//#################################################################################################
+//  Function:       getAddresses
+//  Access:         Public
+//  Input:          -
+//  Output:         (byte) Bit i = Address i has Settings
+//  Description:    Addresses the Configuration applies to
+//#################################################################################################
+    byte mask = 0;
+    for (byte address = 0; address < BIC2200_MAX_DEVICES; address++) {
+        if (_set[address]) {
+            mask |= (1 << address);
+        }
+    }
+    return mask;
+}
+
+bool BIC2200Config::read(BIC2200 & device, byte address) {
+//#################################################################################################
+//  Function:       read
+//  Access:         Public
+//  Input:          device (BIC2200 &) Device with loaded Scaling Factors
+//                  address (byte) Address the Settings are stored for
+//  Output:         (bool) false = not all Registers answered, the answered ones are stored
+//  Description:    Takes the current Settings of a Device in one pipelined Burst
+//#################################################################################################
+    int regs[BIC2200_CONFIG_KEYS];
+    unsigned int words[BIC2200_CONFIG_KEYS];
+
+    for (byte k = 0; k < BIC2200_CONFIG_KEYS; k++) {
+        regs[k] = keys[k].reg;
+    }
+    unsigned long valid = device.readRegisters(regs, BIC2200_CONFIG_KEYS, words);
+    for (byte k = 0; k < BIC2200_CONFIG_KEYS; k++) {
+        if (valid & (1UL << k)) {
+            set(address, k, toValue(device, k, words[k]));
+        }
+    }
+    return valid == (1UL << BIC2200_CONFIG_KEYS) - 1;
+}
+
+void BIC2200Config::print(FILE * out, byte addresses) const {
+//#################################################################################################
+//  Function:       print
+//  Access:         Public
+//  Input:          out (FILE *) Destination
+//                  addresses (byte) Bit i = print Address i
+//  Output:         -
+//  Description:    Writes the Settings as Configuration File, one Section per Address, so the
+//                  Output of bic2200ctl show can be edited and applied again
+//#################################################################################################
+    char text[24];
+
+    for (byte address = 0; address < BIC2200_MAX_DEVICES; address++) {
+        if (!(addresses & (1 << address)) || !_set[address]) {
+            continue;
+        }
+        fprintf(out, "[%u]\n", address);
+        for (byte k = 0; k < BIC2200_CONFIG_KEYS; k++) {
+            if (_set[address] & (1 << k)) {
+                formatValue(k, _values[address][k], text, sizeof(text));
+                fprintf(out, "%s = %s\n", keys[k].name, text);
+            }
+        }
+        fprintf(out, "\n");
+    }
+}
+
+int BIC2200Config::diff(BIC2200 & device, byte address, std::vector<BIC2200ConfigChange> & changes) {
+//#################################################################################################
+//  Function:       diff
+//  Access:         Public
+//  Input:          device (BIC2200 &) Device with loaded Scaling Factors, identify() enables
+//                  the Limit Check of the Setpoints
+//                  address (byte) Settings to compare with
+//                  changes (std::vector<BIC2200ConfigChange> &) differing Settings are appended
+//  Output:         (int) Number of differing Settings, -1 = a configured Register did not answer
+//  Description:    Reads the configured Registers in one pipelined Burst and compares the raw
+//                  Words, so Values below the Resolution of the Register are no Change
+//#################################################################################################
+    int regs[BIC2200_CONFIG_KEYS];
+    unsigned int words[BIC2200_CONFIG_KEYS];
+    byte index[BIC2200_CONFIG_KEYS];
+    byte count = 0;
+    int found = 0;
+    bool complete = true;
+
+    if (address >= BIC2200_MAX_DEVICES) {
+        return 0;
+    }
+    for (byte k = 0; k < BIC2200_CONFIG_KEYS; k++) {
+        if (_set[address] & (1 << k)) {
+            index[count] = k;
+            regs[count++] = keys[k].reg;
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+#if BIC2200_ENABLE_IDENTITY
+    BIC2200ModelLimits limits = device.getLimits();
+#else
+    BIC2200ModelLimits limits = {};
+#endif
+    unsigned long valid = device.readRegisters(regs, count, words);
+    for (byte i = 0; i < count; i++) {
+        BIC2200ConfigChange change;
+        long value = _values[address][index[i]];
+        change.address = address;
+        change.key = index[i];
+        change.known = (valid & (1UL << i)) != 0;
+        change.current = change.known ? words[i] : 0;
+        change.wanted = toWord(device, index[i], value);
+        change.allowed = true;
+        if (limits.voltage != 0 && keys[index[i]].kind == BIC2200_CONFIG_VOLTAGE) {
+            change.allowed = value >= limits.voutMin && value <= limits.voutMax;
+        } else if (limits.voltage != 0 && keys[index[i]].kind == BIC2200_CONFIG_CURRENT) {
+            change.allowed = value >= 0 && value <= limits.ioutMax;
+        }
+        if (!change.known) {
+            complete = false;
+        }
+        if (!change.known || change.current != change.wanted) {
+            changes.push_back(change);
+            ++found;
+        }
+    }
+    return complete ? found : -1;
+}
+
+int BIC2200Config::apply(BIC2200 & device, std::vector<BIC2200ConfigChange> & changes) {
+//#################################################################################################
+//  Function:       apply
+//  Access:         Public
+//  Input:          device (BIC2200 &) Device with loaded Scaling Factors
+//                  changes (std::vector<BIC2200ConfigChange> &) Result of diff() for this Device,
+//                  current is updated to the Value read back
+//  Output:         (int) Settings written and read back equal, -1 = nothing written because a
+//                  Setpoint is outside the Limits of the Model
+//  Description:    Writes the differing Settings in Table Order and verifies them with one
+//                  pipelined Read Burst, the BIC-2200 does not acknowledge Writes
+//#################################################################################################
+    int regs[BIC2200_CONFIG_KEYS];
+    unsigned int words[BIC2200_CONFIG_KEYS];
+    byte count = 0;
+    int verified = 0;
+
+    for (size_t i = 0; i < changes.size(); i++) {
+        if (!changes[i].allowed) {
+            return -1;
+        }
+    }
+    for (size_t i = 0; i < changes.size() && count < BIC2200_CONFIG_KEYS; i++) {
+        _write(device, changes[i].key, changes[i].wanted);
+        regs[count++] = keys[changes[i].key].reg;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    unsigned long valid = device.readRegisters(regs, count, words);
+    for (byte i = 0; i < count; i++) {
+        changes[i].known = (valid & (1UL << i)) != 0;
+        if (changes[i].known) {
+            changes[i].current = words[i];
+            if (words[i] == changes[i].wanted) {
+                ++verified;
+            }
+        }
+    }
+    return verified;
+}
+
+int BIC2200Config::findKey(const char * name) {
+//#################################################################################################
+//  Function:       findKey
+//  Access:         Public (static)
+//  Input:          name (const char *) Key Name, e.g. "vout"
+//  Output:         (int) Index into keys, -1 = unknown
+//  Description:    Looks a Key up by Name
+//#################################################################################################
+    for (byte k = 0; k < BIC2200_CONFIG_KEYS; k++) {
+        if (strcmp(keys[k].name, name) == 0) {
+            return k;
+        }
+    }
+    return -1;
+}
+
+bool BIC2200Config::parseAddresses(const char * text, byte & mask) {
+//#################################################################################################
+//  Function:       parseAddresses
+//  Access:         Public (static)
+//  Input:          text (const char *) "*", or a List of Addresses and Ranges, e.g. "0-3, 6"
+//                  mask (byte &) Bit i = Address i
+//  Output:         (bool) false = not valid or Address above 7
+//  Description:    Parses the Address Selection of a Section or of bic2200ctl -a
+//#################################################################################################
+    byte result = 0;
+
+    while (isspace((unsigned char)*text)) {
+        ++text;
+    }
+    if (strcmp(text, "*") == 0) {
+        mask = 0xFF;
+        return true;
+    }
+    while (*text) {
+        char * end;
+        unsigned long first = strtoul(text, &end, 0);
+        unsigned long last = first;
+        if (end == text) {
+            return false;
+        }
+        text = end;
+        while (isspace((unsigned char)*text)) {
+            ++text;
+        }
+        if (*text == '-') {
+            last = strtoul(text + 1, &end, 0);
+            if (end == text + 1) {
+                return false;
+            }
+            text = end;
+        }
+        if (last < first || last >= BIC2200_MAX_DEVICES) {
+            return false;
+        }
+        for (unsigned long a = first; a <= last; a++) {
+            result |= (1 << a);
+        }
+        while (isspace((unsigned char)*text)) {
+            ++text;
+        }
+        if (*text == ',') {
+            ++text;
+        } else if (*text) {
+            return false;
+        }
+    }
+    if (result == 0) {
+        return false;
+    }
+    mask = result;
+    return true;
+}
+
+bool BIC2200Config::parseValue(byte key, const char * text, long & value) {
+//#################################################################################################
+//  Function:       parseValue
+//  Access:         Public (static)
+//  Input:          key (byte) Index into keys
+//                  text (const char *) Value as written in the File
+//                  value (long &) mV, mA, Word or 0 / 1
+//  Output:         (bool) false = not valid for the Key
+//  Description:    Converts the Text of a Value by the Kind of its Key
+//#################################################################################################
+    char * end;
+
+    switch (keys[key].kind) {
+        case BIC2200_CONFIG_WORD:
+            value = strtol(text, &end, 0);
+            return end != text && *end == '\0' && value >= 0 && value <= 0xFFFF;
+        case BIC2200_CONFIG_VOLTAGE:
+        case BIC2200_CONFIG_CURRENT:
+            return _parseMilli(text, value) && value >= 0;
+        case BIC2200_CONFIG_SWITCH:
+            if (strcmp(text, "on") == 0 || strcmp(text, "1") == 0) {
+                value = 1;
+                return true;
+            }
+            if (strcmp(text, "off") == 0 || strcmp(text, "0") == 0) {
+                value = 0;
+                return true;
+            }
+            return false;
+        case BIC2200_CONFIG_DIRECTION:
+            if (strcmp(text, "discharge") == 0 || strcmp(text, "1") == 0) {
+                value = 1;
+                return true;
+            }
+            if (strcmp(text, "charge") == 0 || strcmp(text, "0") == 0) {
+                value = 0;
+                return true;
+            }
+            return false;
+    }
+    return false;
+}
+
+void BIC2200Config::formatValue(byte key, long value, char * text, size_t size) {
+//#################################################################################################
+//  Function:       formatValue
+//  Access:         Public (static)
+//  Input:          key (byte) Index into keys
+//                  value (long) mV, mA, Word or 0 / 1
+//                  text (char *), size (size_t) Destination
+//  Output:         -
+//  Description:    Inverse of parseValue(), Setpoints with 2 Decimals unless finer
+//#################################################################################################
+    switch (keys[key].kind) {
+        case BIC2200_CONFIG_WORD:
+            snprintf(text, size, "0x%04lX", value);
+            break;
+        case BIC2200_CONFIG_VOLTAGE:
+        case BIC2200_CONFIG_CURRENT:
+            if (value % 10) {
+                snprintf(text, size, "%ld.%03ld", value / 1000, value % 1000);
+            } else {
+                snprintf(text, size, "%ld.%02ld", value / 1000, (value % 1000) / 10);
+            }
+            break;
+        case BIC2200_CONFIG_SWITCH:
+            snprintf(text, size, "%s", value ? "on" : "off");
+            break;
+        case BIC2200_CONFIG_DIRECTION:
+            snprintf(text, size, "%s", value ? "discharge" : "charge");
+            break;
+        default:
+            snprintf(text, size, "%ld", value);
+    }
+}
+
+long BIC2200Config::toValue(BIC2200 & device, byte key, unsigned int word) {
+//#################################################################################################
+//  Function:       toValue
+//  Access:         Public (static)
+//  Input:          device (BIC2200 &) Device with loaded Scaling Factors
+//                  key (byte) Index into keys
+//                  word (unsigned int) raw Register Word
+//  Output:         (long) mV, mA, Word or 0 / 1
+//  Description:    Converts a Register Word with the Scale of the Device
+//#################################################################################################
+    switch (keys[key].kind) {
+        case BIC2200_CONFIG_VOLTAGE:
+        case BIC2200_CONFIG_CURRENT:
+            return device.getScale(keys[key].reg).apply(word);
+        case BIC2200_CONFIG_SWITCH:
+        case BIC2200_CONFIG_DIRECTION:
+            return word & 0x01;
+    }
+    return word;
+}
+
+unsigned int BIC2200Config::toWord(BIC2200 & device, byte key, long value) {
+//#################################################################################################
+//  Function:       toWord
+//  Access:         Public (static)
+//  Input:          device (BIC2200 &) Device with loaded Scaling Factors
+//                  key (byte) Index into keys
+//                  value (long) mV, mA, Word or 0 / 1
+//  Output:         (unsigned int) raw Register Word
+//  Description:    Inverse of toValue(), Setpoints are cut to the Resolution of the Register
+//#################################################################################################
+    switch (keys[key].kind) {
+        case BIC2200_CONFIG_VOLTAGE:
+        case BIC2200_CONFIG_CURRENT:
+            return (unsigned int)device.getScale(keys[key].reg).unapply(value) & 0xFFFF;
+    }
+    return (unsigned int)value & 0xFFFF;
+}
+
+bool BIC2200Config::_parseMilli(const char * text, long & value) {
+//#################################################################################################
+//  Function:       _parseMilli
+//  Access:         Private (static)
+//  Input:          text (const char *) Decimal Number with up to 3 Decimals, e.g. "52.8"
+//                  value (long &) Number * 1000
+//  Output:         (bool) false = not a Number or more than 3 Decimals
+//  Description:    Fixed Point Parser, no Rounding Errors of float
+//#################################################################################################
+    const char * p = text;
+    long whole = 0;
+    long fraction = 0;
+    byte decimals = 0;
+
+    if (!isdigit((unsigned char)*p)) {
+        return false;
+    }
+    while (isdigit((unsigned char)*p)) {
+        whole = whole * 10 + (*p++ - '0');
+        if (whole > 1000000L) {
+            return false;
+        }
+    }
+    if (*p == '.') {
+        ++p;
+        while (isdigit((unsigned char)*p)) {
+            if (++decimals > 3) {
+                return false;
+            }
+            fraction = fraction * 10 + (*p++ - '0');
+        }
+    }
+    if (*p != '\0') {
+        return false;
+    }
+    while (decimals++ < 3) {
+        fraction *= 10;
+    }
+    value = whole * 1000 + fraction;
+    return true;
+}
+
+void BIC2200Config::_write(BIC2200 & device, byte key, unsigned int word) {
+//#################################################################################################
+//  Function:       _write
+//  Access:         Private (static)
+//  Input:          device (BIC2200 &) Destination
+//                  key (byte) Index into keys
+//                  word (unsigned int) raw Register Word
+//  Output:         -
+//  Description:    Writes one Setting with the Setter of the Library API
+//#################################################################################################
+    switch (keys[key].reg) {
+        case CMD_SYSTEM_CONFIG:
+            device.setSystemConfig(word);
+            break;
+        case CMD_BIDIRECTIONAL_CONFIG:
+            device.setBidirecitonalConfig(word);
+            break;
+        case CMD_VOUT_SET:
+            device.setOutputVoltage(word);
+            break;
+        case CMD_IOUT_SET:
+            device.setOutputCurrent(word);
+            break;
+        case CMD_REVERSE_VOUT_SET:
+            device.setReverseOutputVoltage(word);
+            break;
+        case CMD_REVERSE_IOUT_SET:
+            device.setReverseOutputCurrent(word);
+            break;
+        case CMD_DIRECTION_CTRL:
+            device.setDirection(word != 0);
+            break;
+        case CMD_OPERATION:
+            device.setOperation(word != 0);
+            break;
+    }
+}
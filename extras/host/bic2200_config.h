@@ -0,0 +1,94 @@
+//#################################################################################################
+// Declarative Configuration of BIC-2200-XX-CAN Racks
+// Parses Setpoint Files for several Addresses, diffs them against the Registers of the Devices
+// and writes only what changed (the BIC-2200 keeps its Setpoints in EEPROM). Used by bic2200ctl.
+//
+//   # Setpoints of all Units, later Sections override earlier ones
+//   [*]
+//   operation = on
+//   vout = 52.80              ; V
+//   iout = 20.00              ; A
+//   [0-1, 5]
+//   direction = discharge
+//   reverse_iout = 15
+//
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_CONFIG_H
+#define BIC2200_CONFIG_H
+
+#include <stdio.h>
+#include <vector>
+#include "bic2200.h"
+
+#define BIC2200_CONFIG_KEYS     8
+
+// Value Kinds of a Key, Values are held in the Unit in Brackets
+#define BIC2200_CONFIG_WORD         0   // Register Word, decimal or 0x hex
+#define BIC2200_CONFIG_VOLTAGE      1   // V with up to 3 Decimals (mV)
+#define BIC2200_CONFIG_CURRENT      2   // A with up to 3 Decimals (mA)
+#define BIC2200_CONFIG_SWITCH       3   // off / on (0 / 1)
+#define BIC2200_CONFIG_DIRECTION    4   // charge / discharge (0 = AC->DC / 1 = DC->AC)
+
+struct BIC2200ConfigKey {
+    const char * name;
+    int reg;
+    byte kind;
+};
+
+// One Setting of a Device which differs from the File
+struct BIC2200ConfigChange {
+    byte address;
+    byte key;                   // Index into BIC2200Config::keys
+    bool known;                 // current Value read
+    bool allowed;               // Setpoint within the Limits of the Model (or Model unknown)
+    unsigned int current;       // raw Register Word
+    unsigned int wanted;        // raw Register Word
+};
+
+//#################################################################################################
+//  Class:          BIC2200Config
+//  Description:    Settings per Address and Key. Keys are written in Table Order: Configuration
+//                  Registers first, Setpoints, then Direction and Operation, so a Unit is
+//                  switched on with its new Setpoints
+//#################################################################################################
+class BIC2200Config {
+
+public:
+    static const BIC2200ConfigKey keys[BIC2200_CONFIG_KEYS];
+
+    bool load(const char * path);
+    bool parse(const char * text);
+    const char * getError() const { return _error; }
+
+    void clear();
+    void set(byte address, byte key, long value);
+    bool get(byte address, byte key, long & value) const;
+    byte getAddresses() const;
+
+    bool read(BIC2200 & device, byte address);
+    void print(FILE * out, byte addresses) const;
+
+    int diff(BIC2200 & device, byte address, std::vector<BIC2200ConfigChange> & changes);
+    int apply(BIC2200 & device, std::vector<BIC2200ConfigChange> & changes);
+
+    static int findKey(const char * name);
+    static bool parseAddresses(const char * text, byte & mask);
+    static bool parseValue(byte key, const char * text, long & value);
+    static void formatValue(byte key, long value, char * text, size_t size);
+    static long toValue(BIC2200 & device, byte key, unsigned int word);
+    static unsigned int toWord(BIC2200 & device, byte key, long value);
+
+private:
+    long _values[BIC2200_MAX_DEVICES][BIC2200_CONFIG_KEYS] = {};
+    byte _set[BIC2200_MAX_DEVICES] = {};        // Bit k = Key k configured
+    char _error[96] = "";
+
+    static bool _parseMilli(const char * text, long & value);
+    static void _write(BIC2200 & device, byte key, unsigned int word);
+
+};
+
+#endif
@@ -0,0 +1,124 @@
+//#################################################################################################
+// Host Decoder of the binary BIC-2200-XX-CAN Telemetry Log
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200_logreader.h"
+
+size_t BIC2200LogReader::decode(const uint8_t * data, size_t len, std::vector<BIC2200LogSample> & samples) {
+//#################################################################################################
+//  Function:       decode
+//  Access:         Public
+//  Input:          data (const uint8_t *) Log Stream, may start and end anywhere
+//                  len (size_t) Bytes in data
+//                  samples (std::vector<BIC2200LogSample> &) decoded Samples are appended
+//  Output:         (size_t) Bytes consumed, an incomplete last Block is left for the next Call
+//  Description:    Decodes all complete Blocks
+//#################################################################################################
+    size_t pos = 0;
+
+    while (pos < len) {
+        if (data[pos] != BIC2200_LOG_MAGIC) {
+            ++pos;
+            ++_stats.skipped;
+            continue;
+        }
+        if (len - pos < BIC2200_LOG_HEADER) {
+            break;
+        }
+        size_t records = data[pos + 1];
+        if (records == 0) {
+            ++pos;
+            ++_stats.skipped;
+            continue;
+        }
+        if (len - pos < BIC2200_LOG_HEADER + records) {
+            break;
+        }
+        unsigned long time = (unsigned long)data[pos + 2] | ((unsigned long)data[pos + 3] << 8) |
+            ((unsigned long)data[pos + 4] << 16) | ((unsigned long)data[pos + 5] << 24);
+        if (!_decodeBlock(&data[pos + BIC2200_LOG_HEADER], records, time, samples)) {
+            ++_stats.broken;
+        }
+        ++_stats.blocks;
+        pos += BIC2200_LOG_HEADER + records;
+    }
+    return pos;
+}
+
+bool BIC2200LogReader::_decodeBlock(const uint8_t * data, size_t len, unsigned long time,
+    std::vector<BIC2200LogSample> & samples) {
+//#################################################################################################
+//  Function:       _decodeBlock
+//  Access:         Private
+//  Input:          data (const uint8_t *) Records of one Block
+//                  len (size_t) Record Bytes
+//                  time (unsigned long) Start Time of the Block
+//                  samples (std::vector<BIC2200LogSample> &) decoded Samples are appended
+//  Output:         (bool) false = invalid Record, the Rest of the Block is ignored
+//  Description:    Mirrors BIC2200Log::_encode(), the Delta References start empty
+//#################################################################################################
+    uint16_t previous[128];
+    bool known[128] = {};
+    size_t pos = 0;
+
+    while (pos < len) {
+        byte header = data[pos++];
+        byte key = header & ~BIC2200_LOG_TIME;
+        unsigned long field;
+
+        if (header & BIC2200_LOG_TIME) {
+            unsigned long delta;
+            if (!_getVarint(data, len, pos, delta)) {
+                return false;
+            }
+            time += delta;
+        }
+        if (!_getVarint(data, len, pos, field)) {
+            return false;
+        }
+        int reg = BIC2200::slotRegister(BIC2200_LOG_SLOT(header));
+        if (reg < 0) {
+            return false;
+        }
+        if (field & 1) {
+            previous[key] = (uint16_t)(field >> 1);
+        } else if (known[key]) {
+            uint16_t zigzag = (uint16_t)(field >> 1);
+            int16_t delta = (int16_t)((zigzag >> 1) ^ -(zigzag & 1));
+            previous[key] = (uint16_t)(previous[key] + delta);
+        } else {
+            return false;
+        }
+        known[key] = true;
+
+        BIC2200LogSample sample = { time, (byte)BIC2200_LOG_ADDRESS(header), reg, previous[key] };
+        samples.push_back(sample);
+    }
+    return true;
+}
+
+bool BIC2200LogReader::_getVarint(const uint8_t * data, size_t len, size_t & pos, unsigned long & value) {
+//#################################################################################################
+//  Function:       _getVarint
+//  Access:         Private (static)
+//  Input:          data, len: Records of one Block
+//                  pos (size_t &) Read Position, advanced behind the Varint
+//                  value (unsigned long &) decoded Number
+//  Output:         (bool) false = Varint runs past the Block or is longer than 5 Bytes
+//  Description:    Inverse of BIC2200Log::_putVarint()
+//#################################################################################################
+    value = 0;
+    for (byte shift = 0; shift < 35; shift += 7) {
+        if (pos >= len) {
+            return false;
+        }
+        byte b = data[pos++];
+        value |= (unsigned long)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
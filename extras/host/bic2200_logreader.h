@@ -0,0 +1,48 @@
+//#################################################################################################
+// Host Decoder of the binary BIC-2200-XX-CAN Telemetry Log
+// Reads the Block Stream written by BIC2200Log::flush(), see bic2200_log.h for the Format.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_LOGREADER_H
+#define BIC2200_LOGREADER_H
+
+#include <stdint.h>
+#include <vector>
+#include "bic2200_log.h"
+
+struct BIC2200LogSample {
+    unsigned long time;         // ms, millis() of the Bus when logged
+    byte address;
+    int reg;
+    uint16_t value;             // raw Register Word
+};
+
+struct BIC2200LogReaderStats {
+    unsigned long blocks;       // Blocks decoded
+    unsigned long skipped;      // Bytes skipped to find the next Block
+    unsigned long broken;       // Blocks with invalid Records, decoded up to the Error
+};
+
+//#################################################################################################
+//  Class:          BIC2200LogReader
+//  Description:    Decodes a Log Stream into Samples. Blocks are independent: garbage between
+//                  Blocks (e.g. Text on the same Serial Port) is skipped up to the next Magic
+//#################################################################################################
+class BIC2200LogReader {
+
+public:
+    size_t decode(const uint8_t * data, size_t len, std::vector<BIC2200LogSample> & samples);
+    BIC2200LogReaderStats getStats() const { return _stats; }
+
+private:
+    BIC2200LogReaderStats _stats = {};
+
+    bool _decodeBlock(const uint8_t * data, size_t len, unsigned long time,
+        std::vector<BIC2200LogSample> & samples);
+    static bool _getVarint(const uint8_t * data, size_t len, size_t & pos, unsigned long & value);
+
+};
+
+#endif
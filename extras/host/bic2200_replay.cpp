@@ -0,0 +1,455 @@
+//#################################################################################################
+// Host Replay of BIC-2200-XX-CAN Frame Traces
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <string.h>
+#include <thread>
+#include "bic2200_replay.h"
+#include "bic2200_sim.h"
+
+#define BIC2200_REPLAY_WRITE    0x80000000UL    // Key Bit of Writes, they are never answered
+
+BIC2200ReplayTransport::BIC2200ReplayTransport(const std::vector<BIC2200TraceRecord> & trace, byte mode,
+    double speed, unsigned long bitrate) : _trace(trace), _mode(mode), _speed(speed), _bitrate(bitrate) {
+}
+
+int BIC2200ReplayTransport::begin(BIC2200Bus & bus) {
+//#################################################################################################
+//  Function:       begin
+//  Access:         Public
+//  Input:          bus (BIC2200Bus &) Bus the Library runs on
+//  Output:         (int) 1
+//  Description:    Starts the Replay at Trace Time 0 and prepares the Mode
+//#################################################################################################
+    _bus = &bus;
+    _virtual = 0;
+    _startedAt = std::chrono::steady_clock::now();
+    _stats = BIC2200ReplayStats();
+    _next = 0;
+    _nextTx = 0;
+    _scheduled.clear();
+    _wireFreeAt = 0;
+
+    if (_mode == BIC2200_REPLAY_TIMED) {
+        long cause = -1;
+        _cause.assign(_trace.size(), -1);
+        _shift.assign(_trace.size(), 0);
+        for (size_t i = 0; i < _trace.size(); i++) {
+            if (_trace[i].transmit) {
+                cause = (long)i;
+            } else {
+                _cause[i] = cause;
+            }
+        }
+    } else {
+        _pairReplies();
+    }
+    return 1;
+}
+
+bool BIC2200ReplayTransport::send(const BIC2200Frame & frame) {
+//#################################################################################################
+//  Function:       send
+//  Access:         Public
+//  Input:          frame (const BIC2200Frame &) Frame from the Library
+//  Output:         (bool) true
+//  Description:    Compares the Frame with the Trace (timed) or schedules its recorded Reply
+//                  (reactive), then blocks until the Frame is on the Wire
+//#################################################################################################
+    uint64_t now = _now();
+    uint64_t end;
+
+    ++_stats.requests;
+    if (_mode == BIC2200_REPLAY_TIMED) {
+        _deliverTimed(now);
+        _sendTimed(frame, now);
+        end = now + _wireTime(frame.len);
+    } else {
+        _deliverScheduled(now);
+        end = _arbitrate(now, _wireTime(frame.len));
+        _sendReactive(frame, end);
+    }
+
+    if (_speed <= 0) {
+        _virtual = end;
+    } else {
+        while (_now() < end) {
+        }
+    }
+    return true;
+}
+
+void BIC2200ReplayTransport::service() {
+//#################################################################################################
+//  Function:       service
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Hands every recorded Frame which is due to the Bus
+//#################################################################################################
+    uint64_t now = _now();
+
+    if (_mode == BIC2200_REPLAY_TIMED) {
+        _deliverTimed(now);
+    } else {
+        _deliverScheduled(now);
+    }
+}
+
+unsigned long BIC2200ReplayTransport::micros() {
+    return (unsigned long)(_now() / 1000);
+}
+
+unsigned long BIC2200ReplayTransport::millis() {
+    return (unsigned long)(_now() / 1000000);
+}
+
+void BIC2200ReplayTransport::advance(unsigned long us) {
+//#################################################################################################
+//  Function:       advance
+//  Access:         Public
+//  Input:          us (unsigned long) Trace Time to pass
+//  Output:         -
+//  Description:    Idle Time of a Control Loop: virtual Time jumps, real Time sleeps us / speed
+//#################################################################################################
+    if (_speed <= 0) {
+        _virtual += (uint64_t)us * 1000;
+    } else {
+        std::this_thread::sleep_for(std::chrono::nanoseconds((long long)(us * 1000.0 / _speed)));
+    }
+}
+
+uint64_t BIC2200ReplayTransport::nanos() {
+//#################################################################################################
+//  Function:       nanos
+//  Access:         Public
+//  Input:          -
+//  Output:         (uint64_t) ns of Trace Time since begin()
+//  Description:    Replay Clock without the Cost of a Transport Call
+//#################################################################################################
+    if (_speed <= 0) {
+        return _virtual;
+    }
+    return (uint64_t)(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - _startedAt).count() * _speed);
+}
+
+bool BIC2200ReplayTransport::finished() const {
+//#################################################################################################
+//  Function:       finished
+//  Access:         Public
+//  Input:          -
+//  Output:         (bool) true = every recorded Frame was delivered and every recorded Request repeated
+//  Description:    End of the Trace
+//#################################################################################################
+    if (_mode == BIC2200_REPLAY_REACTIVE) {
+        return _pending == 0 && _scheduled.empty();
+    }
+    for (size_t i = _next; i < _trace.size(); i++) {
+        if (!_trace[i].transmit) {
+            return false;
+        }
+    }
+    for (size_t i = _nextTx; i < _trace.size(); i++) {
+        if (_trace[i].transmit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint64_t BIC2200ReplayTransport::duration() const {
+//#################################################################################################
+//  Function:       duration
+//  Access:         Public
+//  Input:          -
+//  Output:         (uint64_t) us from the Start of the Trace to its last Frame
+//  Description:    Recorded Length of the Trace
+//#################################################################################################
+    return _trace.empty() ? 0 : _trace.back().time;
+}
+
+uint64_t BIC2200ReplayTransport::_now() {
+//#################################################################################################
+//  Function:       _now
+//  Access:         Private
+//  Input:          -
+//  Output:         (uint64_t) ns of Trace Time since begin()
+//  Description:    Every Call of the Library costs cpuCost on the virtual Clock
+//#################################################################################################
+    if (_speed <= 0) {
+        _virtual += cpuCost;
+    }
+    return nanos();
+}
+
+void BIC2200ReplayTransport::_deliverTimed(uint64_t now) {
+//#################################################################################################
+//  Function:       _deliverTimed
+//  Access:         Private
+//  Input:          now (uint64_t) ns of Trace Time
+//  Output:         -
+//  Description:    Delivers received Frames in recorded Order. A Frame waits for the Library
+//                  to send the Request in front of it and keeps its recorded Distance to it
+//#################################################################################################
+    while (true) {
+        while (_next < _trace.size() && _trace[_next].transmit) {
+            ++_next;
+        }
+        if (_next >= _trace.size()) {
+            return;
+        }
+        long cause = _cause[_next];
+        if (cause >= (long)_nextTx) {
+            return;
+        }
+        int64_t due = (int64_t)_trace[_next].time * 1000 + ((cause < 0) ? 0 : _shift[cause]);
+        if ((int64_t)now < due) {
+            return;
+        }
+        if (_bus != NULL) {
+            _bus->dispatch(_trace[_next].frame);
+        }
+        ++_stats.delivered;
+        ++_next;
+    }
+}
+
+void BIC2200ReplayTransport::_deliverScheduled(uint64_t now) {
+//#################################################################################################
+//  Function:       _deliverScheduled
+//  Access:         Private
+//  Input:          now (uint64_t) ns of Trace Time
+//  Output:         -
+//  Description:    Delivers the Replies scheduled by _sendReactive() which are due
+//#################################################################################################
+    size_t delivered = 0;
+    while (delivered < _scheduled.size() && _scheduled[delivered].deliverAt <= now) {
+        if (_bus != NULL) {
+            _bus->dispatch(_scheduled[delivered].frame);
+        }
+        ++delivered;
+    }
+    _scheduled.erase(_scheduled.begin(), _scheduled.begin() + delivered);
+    _stats.delivered += delivered;
+}
+
+void BIC2200ReplayTransport::_sendTimed(const BIC2200Frame & frame, uint64_t now) {
+//#################################################################################################
+//  Function:       _sendTimed
+//  Access:         Private
+//  Input:          frame (const BIC2200Frame &) Frame from the Library
+//                  now (uint64_t) ns of Trace Time
+//  Output:         -
+//  Description:    Compares the Frame with the next recorded Request. Either Way it takes the
+//                  Place of it, so the Replay goes on after a Difference
+//#################################################################################################
+    while (_nextTx < _trace.size() && !_trace[_nextTx].transmit) {
+        ++_nextTx;
+    }
+    if (_nextTx >= _trace.size()) {
+        ++_stats.unexpected;
+        return;
+    }
+    const BIC2200Frame & recorded = _trace[_nextTx].frame;
+    if (recorded.id == frame.id && recorded.len == frame.len && memcmp(recorded.data, frame.data, frame.len) == 0) {
+        ++_stats.matched;
+    } else {
+        ++_stats.mismatched;
+    }
+    int64_t shift = (int64_t)now - (int64_t)_trace[_nextTx].time * 1000;
+    unsigned long drift = (unsigned long)(((shift < 0) ? -shift : shift) / 1000);
+    if (drift > _stats.maxDrift) {
+        _stats.maxDrift = drift;
+    }
+    _shift[_nextTx] = shift;
+    ++_nextTx;
+}
+
+uint64_t BIC2200ReplayTransport::_arbitrate(uint64_t now, uint64_t wire) {
+//#################################################################################################
+//  Function:       _arbitrate
+//  Access:         Private
+//  Input:          now (uint64_t) ns when the Library sends a Request
+//                  wire (uint64_t) ns Wire Time of the Request
+//  Output:         (uint64_t) ns when the Request is completely sent
+//  Description:    Replies which are ready win the Arbitration (lower CAN ID), the Request
+//                  follows them and delays the Replies which get ready later
+//#################################################################################################
+    uint64_t start = now;
+    size_t ready = 0;
+
+    while (ready < _scheduled.size() && _scheduled[ready].ready <= now) {
+        if (_scheduled[ready].deliverAt > start) {
+            start = _scheduled[ready].deliverAt;
+        }
+        ++ready;
+    }
+    uint64_t end = start + wire;
+    uint64_t free = end;
+    for (size_t i = ready; i < _scheduled.size(); i++) {
+        Scheduled & reply = _scheduled[i];
+        reply.deliverAt = ((reply.ready > free) ? reply.ready : free) + _wireTime(reply.frame.len);
+        free = reply.deliverAt;
+    }
+    _wireFreeAt = free;
+    return end;
+}
+
+void BIC2200ReplayTransport::_sendReactive(const BIC2200Frame & frame, uint64_t now) {
+//#################################################################################################
+//  Function:       _sendReactive
+//  Access:         Private
+//  Input:          frame (const BIC2200Frame &) Frame from the Library
+//                  now (uint64_t) ns when the Request is completely sent
+//  Output:         -
+//  Description:    Takes the next recorded Reply of the Device and Register. It is ready the
+//                  recorded Service Time after the Request and queues on the Wire behind the
+//                  Frames scheduled before. Broadcasts have no Reply
+//#################################################################################################
+    unsigned long key;
+
+    if (!_key(frame, MSG_ID_CAN_SEND_00, key)) {
+        if (frame.id == MSG_ID_BROADCAST) {
+            ++_stats.matched;
+        } else {
+            ++_stats.unexpected;
+        }
+        return;
+    }
+    if (frame.len > 2) {
+        key |= BIC2200_REPLAY_WRITE;
+    }
+    std::map<unsigned long, std::vector<Reply> >::const_iterator replies = _replies.find(key);
+    size_t & taken = _taken[key];
+    if (replies == _replies.end() || taken >= replies->second.size()) {
+        ++_stats.unexpected;
+        return;
+    }
+    const Reply & reply = replies->second[taken++];
+    --_pending;
+    ++_stats.matched;
+    if (!reply.answered) {
+        if (!(key & BIC2200_REPLAY_WRITE)) {
+            ++_stats.unanswered;
+        }
+        return;
+    }
+
+    uint64_t ready = now + reply.service;
+    Scheduled scheduled = { ready, ((_wireFreeAt > ready) ? _wireFreeAt : ready) + _wireTime(reply.frame.len),
+        reply.frame };
+    _wireFreeAt = scheduled.deliverAt;
+    size_t pos = _scheduled.size();
+    while (pos > 0 && _scheduled[pos - 1].deliverAt > scheduled.deliverAt) {
+        --pos;
+    }
+    _scheduled.insert(_scheduled.begin() + pos, scheduled);
+}
+
+void BIC2200ReplayTransport::_pairReplies() {
+//#################################################################################################
+//  Function:       _pairReplies
+//  Access:         Private
+//  Input:          -
+//  Output:         -
+//  Description:    A received Reply belongs to the latest Read of the same Device and Register
+//                  sent at least CAN_REPLY_MIN_TIME before, like the Library matches it: after a
+//                  Retry the first Request counts as lost, a Reply right after the Retry belongs
+//                  to the first Request. The Service Time of the Device runs from the End of the Request (or of the
+//                  Frame in front of the Reply, if later) to the Start of the Reply, so it does
+//                  not carry the Wire Queueing of the recorded Request Order. Writes get no Reply
+//#################################################################################################
+    struct Outstanding {
+        unsigned long key;
+        size_t index;
+        uint64_t time;                  // ns, Request recorded
+        uint64_t end;                   // ns, End of the Request on the Wire
+    };
+    std::vector<Outstanding> outstanding[BIC2200_MAX_DEVICES];
+    uint64_t wireEnd = 0;               // ns, End of the previous Frame
+    unsigned long key;
+
+    _replies.clear();
+    _taken.clear();
+    _pending = 0;
+    for (size_t i = 0; i < _trace.size(); i++) {
+        const BIC2200TraceRecord & record = _trace[i];
+        uint64_t time = record.time * 1000;
+        uint64_t wire = _wireTime(record.frame.len);
+
+        if (record.transmit) {
+            // Requests are recorded before, Replies after they were on the Wire
+            uint64_t end = time + wire;
+            if (_key(record.frame, MSG_ID_CAN_SEND_00, key)) {
+                if (record.frame.len > 2) {
+                    key |= BIC2200_REPLAY_WRITE;
+                }
+                Reply reply = {};
+                std::vector<Reply> & replies = _replies[key];
+                replies.push_back(reply);
+                ++_pending;
+                if (!(key & BIC2200_REPLAY_WRITE)) {
+                    Outstanding request = { key, replies.size() - 1, time, end };
+                    outstanding[key >> 16].push_back(request);
+                }
+            }
+            wireEnd = end;
+            continue;
+        }
+        if (_key(record.frame, MSG_ID_CAN_RECEIVE_00, key)) {
+            std::vector<Outstanding> & requests = outstanding[key >> 16];
+            long match = -1;
+            for (size_t r = 0; r < requests.size(); r++) {
+                if (requests[r].key == key && (match < 0 || time - requests[r].time >= CAN_REPLY_MIN_TIME * 1000ULL)) {
+                    match = (long)r;
+                }
+            }
+            if (match >= 0) {
+                Reply & reply = _replies[key][requests[match].index];
+                uint64_t from = (requests[match].end > wireEnd) ? requests[match].end : wireEnd;
+                uint64_t start = (time > wire) ? time - wire : 0;
+                reply.answered = true;
+                reply.service = (start > from) ? start - from : 0;
+                reply.frame = record.frame;
+                for (long r = match; r >= 0; r--) {
+                    if (requests[r].key == key) {
+                        requests.erase(requests.begin() + r);
+                    }
+                }
+            }
+        }
+        wireEnd = time;
+    }
+}
+
+uint64_t BIC2200ReplayTransport::_wireTime(byte len) {
+//#################################################################################################
+//  Function:       _wireTime
+//  Access:         Private
+//  Input:          len (byte) Data Bytes of an Extended Frame
+//  Output:         (uint64_t) ns the Frame occupies the Wire
+//  Description:    Frame Bits incl. worst Case Stuffing at the Bitrate of the Trace
+//#################################################################################################
+    return (uint64_t)BIC2200SimBus::frameBits(len) * 1000000000ULL / _bitrate;
+}
+
+bool BIC2200ReplayTransport::_key(const BIC2200Frame & frame, unsigned long base, unsigned long & key) {
+//#################################################################################################
+//  Function:       _key
+//  Access:         Private (static)
+//  Input:          frame (const BIC2200Frame &) Request or Reply
+//                  base (unsigned long) MSG_ID_CAN_SEND_00 or MSG_ID_CAN_RECEIVE_00
+//                  key (unsigned long &) Address << 16 | Register
+//  Output:         (bool) false = no Frame of a Device with a Register
+//  Description:    Pairing Key of Requests and Replies
+//#################################################################################################
+    unsigned long address = frame.id - base;
+    if (address >= BIC2200_MAX_DEVICES || frame.len < 2) {
+        return false;
+    }
+    key = (address << 16) | frame.data[0] | ((unsigned long)frame.data[1] << 8);
+    return true;
+}
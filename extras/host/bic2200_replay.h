@@ -0,0 +1,114 @@
+//#################################################################################################
+// Host Replay of BIC-2200-XX-CAN Frame Traces
+// Feeds a Trace captured with BIC2200Trace (or candump) back through the unchanged Library, on
+// a virtual Clock as fast as possible or in real Time at recorded or accelerated Speed. Used to
+// benchmark and regression-test Parser and Scheduler Changes against Production Traffic.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_REPLAY_H
+#define BIC2200_REPLAY_H
+
+#include <stdint.h>
+#include <chrono>
+#include <map>
+#include <vector>
+#include "bic2200_tracereader.h"
+
+#define BIC2200_REPLAY_TIMED        0   // recorded Frames in recorded Order, the Requests of the
+                                        // Library are checked against the recorded ones
+#define BIC2200_REPLAY_REACTIVE     1   // every Request gets the Reply recorded for the same
+                                        // Device and Register, for changed Request Orders
+
+struct BIC2200ReplayStats {
+    unsigned long delivered;    // recorded Frames handed to the Bus
+    unsigned long requests;     // Frames sent by the Library
+    unsigned long matched;      // Requests equal to the recorded one (timed) / with a recorded Request (reactive)
+    unsigned long mismatched;   // timed: Request differs from the recorded one at its Position
+    unsigned long unexpected;   // Requests beyond the Trace / without a recorded Request left
+    unsigned long unanswered;   // reactive: Requests whose recorded Request got no Reply
+    unsigned long maxDrift;     // timed: us the Library ran ahead of or behind the Trace at most
+};
+
+//#################################################################################################
+//  Class:          BIC2200ReplayTransport
+//  Description:    BIC2200Transport which plays a Trace instead of a CAN Controller.
+//                  Timed: a received Frame is held until the Library sent the Request in front
+//                  of it in the Trace, then delivered with the recorded Distance to that Request,
+//                  so Reply Latencies stay exact while the Library runs faster or slower.
+//                  Reactive: Requests are paired with their Replies when the Trace is loaded,
+//                  the n-th Request of a Device and Register gets the n-th recorded Reply (or
+//                  none, as recorded) after its recorded Service Time, queued on the Wire.
+//                  speed 0 runs on a virtual Clock (cpuCost ns per Call, deterministic), speed
+//                  > 0 on the real Clock scaled by speed (1 = recorded, 10 = ten Times faster).
+//                  send() blocks until the Frame is on the Wire like the MCP2515 does
+//#################################################################################################
+class BIC2200ReplayTransport final : public BIC2200Transport {
+
+public:
+    unsigned long cpuCost = 2000;       // ns of virtual Time per Transport Call (speed 0)
+
+    explicit BIC2200ReplayTransport(const std::vector<BIC2200TraceRecord> & trace,
+        byte mode = BIC2200_REPLAY_TIMED, double speed = 0, unsigned long bitrate = 250000UL);
+
+    int begin(BIC2200Bus & bus);
+    bool send(const BIC2200Frame & frame);
+    void service();
+
+    unsigned long micros();
+    unsigned long millis();
+    void advance(unsigned long us);
+    uint64_t nanos();
+
+    bool finished() const;
+    uint64_t duration() const;
+    BIC2200ReplayStats getStats() const { return _stats; }
+
+private:
+    struct Reply {
+        bool answered;
+        uint64_t service;               // ns, see _pairReplies()
+        BIC2200Frame frame;
+    };
+    struct Scheduled {
+        uint64_t ready;                 // ns, Device has the Reply ready
+        uint64_t deliverAt;             // ns, Reply completely received
+        BIC2200Frame frame;
+    };
+
+    const std::vector<BIC2200TraceRecord> & _trace;
+    byte _mode;
+    double _speed;
+    unsigned long _bitrate;
+    BIC2200Bus * _bus = NULL;
+    uint64_t _virtual = 0;              // ns, speed 0
+    std::chrono::steady_clock::time_point _startedAt;
+    BIC2200ReplayStats _stats = {};
+
+    // Timed
+    size_t _next = 0;                   // next received Frame to deliver
+    size_t _nextTx = 0;                 // next recorded Request to compare with
+    std::vector<long> _cause;           // Index of the Request in front of a received Frame, -1 = none
+    std::vector<int64_t> _shift;        // ns the Library sent a Request later than recorded
+
+    // Reactive
+    std::map<unsigned long, std::vector<Reply> > _replies;     // Key: Address << 16 | Register
+    std::map<unsigned long, size_t> _taken;
+    size_t _pending = 0;                // recorded Requests not yet repeated by the Library
+    uint64_t _wireFreeAt = 0;           // ns, End of the last Frame sent or scheduled
+    std::vector<Scheduled> _scheduled;
+
+    uint64_t _now();
+    void _deliverTimed(uint64_t now);
+    void _deliverScheduled(uint64_t now);
+    void _sendTimed(const BIC2200Frame & frame, uint64_t now);
+    void _sendReactive(const BIC2200Frame & frame, uint64_t now);
+    uint64_t _arbitrate(uint64_t now, uint64_t wire);
+    void _pairReplies();
+    uint64_t _wireTime(byte len);
+    static bool _key(const BIC2200Frame & frame, unsigned long base, unsigned long & key);
+
+};
+
+#endif
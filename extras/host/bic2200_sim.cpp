@@ -0,0 +1,400 @@
+//#################################################################################################
+// Host Simulator for the BIC-2200-XX-CAN Library
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include "bic2200_sim.h"
+#include <algorithm>
+#include <stdio.h>
+
+void BIC2200SimDevice::setModel(int voltage) {
+//#################################################################################################
+//  Function:       setModel
+//  Access:         Public
+//  Input:          voltage (int) 12, 24, 48 or 96 - Output Voltage Variant
+//  Output:         -
+//  Description:    Plugs the Device in and fills the Register File with Power-On Values of the
+//                  Variant: Setpoints at nominal Voltage and ~2200 W, 230 V Input, 35 deg C
+//#################################################################################################
+    char model[13];
+    unsigned int ratedCurrent = 220000UL / voltage;     // 0.01 A
+
+    present = true;
+    _registers.clear();
+
+    setScalingFactor(BIC2200_FACTOR_0_01, BIC2200_FACTOR_0_01, BIC2200_FACTOR_0_1, BIC2200_FACTOR_0_1);
+    setRegister(CMD_OPERATION, (const byte *)"\x01", 1);
+    setRegister(CMD_DIRECTION_CTRL, (const byte *)"\x00", 1);
+    setWord(CMD_VOUT_SET, voltage * 100);
+    setWord(CMD_IOUT_SET, ratedCurrent);
+    setWord(CMD_REVERSE_VOUT_SET, voltage * 100 - voltage * 10);
+    setWord(CMD_REVERSE_IOUT_SET, ratedCurrent);
+    setWord(CMD_FAULT_STATUS, 0x0000);
+    setWord(CMD_READ_VIN, 2300);
+    setWord(CMD_READ_VOUT, voltage * 100);
+    setWord(CMD_READ_IOUT, 0);
+    setWord(CMD_READ_TEMPERATURE_1, 350);
+    setWord(CMD_SYSTEM_STATUS, 0x0000);
+    setWord(CMD_SYSTEM_CONFIG, 0x0001);
+    setWord(CMD_BIDIRECTIONAL_CONFIG, 0x0001);
+
+    snprintf(model, sizeof(model), "BIC-2200-%02d", voltage);
+    setText(CMD_MFR_ID_B0B5, CMD_MFR_ID_B6B11, "MEAN WELL");
+    setText(CMD_MFR_MODEL_B0B5, CMD_MFR_MODEL_B6B11, model);
+    setText(CMD_MFR_REVISION_B0B5, -1, "\x0A\x0A\xFF\xFF\xFF\xFF");
+    setText(CMD_MFR_LOCATION_B0B2, -1, "TW");
+    setText(CMD_MFR_DATE_B0B5, -1, "240115");
+    setText(CMD_MFR_SERIAL_B0B5, CMD_MFR_SERIAL_B6B11, "SIM000000001");
+}
+
+void BIC2200SimDevice::setScalingFactor(byte vout, byte iout, byte vin, byte temperature) {
+//#################################################################################################
+//  Function:       setScalingFactor
+//  Access:         Public
+//  Input:          vout, iout, vin, temperature (byte) BIC2200_FACTOR_* Codes
+//  Output:         -
+//  Description:    Sets the CMD_SCALING_FACTOR Register the Library reads in begin()
+//#################################################################################################
+    byte data[6] = {};
+    data[0] = (vout & 0x0F) | ((iout & 0x0F) << 4);
+    data[1] = vin & 0x0F;
+    data[2] = temperature & 0x0F;
+    setRegister(CMD_SCALING_FACTOR, data, 6);
+}
+
+void BIC2200SimDevice::setRegister(int reg, const byte * data, byte len) {
+//#################################################################################################
+//  Function:       setRegister
+//  Access:         Public
+//  Input:          reg (int) Register
+//                  data (const byte *) Value
+//                  len (byte) [1 - 6] Number of Bytes
+//  Output:         -
+//  Description:    Creates or overwrites a Register of the Register File
+//#################################################################################################
+    Register * entry = _find(reg);
+    if (entry == NULL) {
+        Register added = {};
+        added.reg = reg;
+        _registers.push_back(added);
+        entry = &_registers.back();
+    }
+    entry->len = std::min<byte>(len, 6);
+    memcpy(entry->data, data, entry->len);
+}
+
+bool BIC2200SimDevice::getRegister(int reg, byte * data, byte & len) const {
+//#################################################################################################
+//  Function:       getRegister
+//  Access:         Public
+//  Input:          reg (int) Register
+//                  data (byte *) Destination, 6 Bytes
+//                  len (byte &) Number of valid Bytes
+//  Output:         (bool) false = Register does not exist
+//  Description:    Reads a Register of the Register File
+//#################################################################################################
+    const Register * entry = _find(reg);
+    if (entry == NULL) {
+        return false;
+    }
+    len = entry->len;
+    memcpy(data, entry->data, len);
+    return true;
+}
+
+void BIC2200SimDevice::setWord(int reg, uint16_t value) {
+//#################################################################################################
+//  Function:       setWord
+//  Access:         Public
+//  Input:          reg (int) Register
+//                  value (uint16_t) 16 Bit Value
+//  Output:         -
+//  Description:    Sets a 16 Bit Register (Little Endian)
+//#################################################################################################
+    byte data[2] = { lowByte(value), highByte(value) };
+    setRegister(reg, data, 2);
+}
+
+uint16_t BIC2200SimDevice::getWord(int reg) const {
+//#################################################################################################
+//  Function:       getWord
+//  Access:         Public
+//  Input:          reg (int) Register
+//  Output:         (uint16_t) 16 Bit Value, 0 if the Register does not exist
+//  Description:    Reads a 1 or 2 Byte Register
+//#################################################################################################
+    const Register * entry = _find(reg);
+    if (entry == NULL || entry->len == 0) {
+        return 0;
+    }
+    return (entry->len > 1) ? ((entry->data[1] << 8) + entry->data[0]) : entry->data[0];
+}
+
+void BIC2200SimDevice::setText(int regB0B5, int regB6B11, const char * text) {
+//#################################################################################################
+//  Function:       setText
+//  Access:         Public
+//  Input:          regB0B5 (int) Register of Character 0 - 5
+//                  regB6B11 (int) Register of Character 6 - 11, -1 = none
+//                  text (const char *) Text, padded with Spaces
+//  Output:         -
+//  Description:    Fills a MFR_* Text split over one or two 6 Byte Registers
+//#################################################################################################
+    byte data[12];
+    size_t length = strlen(text);
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (i < length) ? text[i] : ' ';
+    }
+    setRegister(regB0B5, data, 6);
+    if (regB6B11 >= 0) {
+        setRegister(regB6B11, data + 6, 6);
+    }
+}
+
+BIC2200SimDevice::Register * BIC2200SimDevice::_find(int reg) {
+    for (size_t i = 0; i < _registers.size(); i++) {
+        if (_registers[i].reg == reg) {
+            return &_registers[i];
+        }
+    }
+    return NULL;
+}
+
+const BIC2200SimDevice::Register * BIC2200SimDevice::_find(int reg) const {
+    for (size_t i = 0; i < _registers.size(); i++) {
+        if (_registers[i].reg == reg) {
+            return &_registers[i];
+        }
+    }
+    return NULL;
+}
+
+BIC2200SimBus::BIC2200SimBus(unsigned long bitrate) : _bitrate(bitrate), _now(_ownClock.now) {
+}
+
+BIC2200SimBus::BIC2200SimBus(BIC2200SimClock & clock, unsigned long bitrate) : _bitrate(bitrate), _now(clock.now) {
+}
+
+BIC2200SimDevice & BIC2200SimBus::device(byte address) {
+//#################################################################################################
+//  Function:       device
+//  Access:         Public
+//  Input:          address (byte) [0x00 - 0x07] CAN Bus Adress
+//  Output:         (BIC2200SimDevice &) simulated Device at this Adress
+//  Description:    Gives access to a Device, e.g. device(0).setModel(48)
+//#################################################################################################
+    return _devices[address & (BIC2200_MAX_DEVICES - 1)];
+}
+
+void BIC2200SimBus::setSeed(uint32_t seed) {
+//#################################################################################################
+//  Function:       setSeed
+//  Access:         Public
+//  Input:          seed (uint32_t) != 0
+//  Output:         -
+//  Description:    Seeds the Random Source of Jitter and dropped Replies, Runs are reproducible
+//#################################################################################################
+    _random = seed ? seed : 1;
+}
+
+int BIC2200SimBus::begin(BIC2200Bus & bus) {
+    _bus = &bus;
+    return 1;
+}
+
+bool BIC2200SimBus::send(const BIC2200Frame & frame) {
+//#################################################################################################
+//  Function:       send
+//  Access:         Public
+//  Input:          frame (const BIC2200Frame &) Frame from the Library
+//  Output:         (bool) true = Frame sent
+//  Description:    Puts the Frame on the Wire and blocks (in virtual Time) until it is
+//                  transmitted, like endPacket() of the MCP2515. Devices see it at the End.
+//                  With txBuffers it only waits until one of the TX Buffers is free
+//#################################################################################################
+    _now += cpuCost;
+    _arbitrate(_now);
+    while (!_txBusy.empty() && _txBusy.front() <= _now) {
+        _txBusy.erase(_txBusy.begin());
+    }
+    if (txBuffers > 0 && _txBusy.size() >= txBuffers) {
+        _now = _txBusy.front();
+        _txBusy.erase(_txBusy.begin());
+        _arbitrate(_now);
+    }
+    uint64_t sentAt = _transmit(_now, frame.len);
+    if (txBuffers == 0) {
+        _now = sentAt;
+    } else {
+        _txBusy.push_back(sentAt);
+    }
+
+    unsigned long address = frame.id - MSG_ID_CAN_SEND_00;
+    if (address < BIC2200_MAX_DEVICES) {
+        _handleRequest(address, frame, sentAt);
+    } else if (frame.id == MSG_ID_BROADCAST && frame.len > 2) {
+        for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+            _handleRequest(i, frame, sentAt);
+        }
+    }
+    return true;
+}
+
+void BIC2200SimBus::service() {
+//#################################################################################################
+//  Function:       service
+//  Access:         Public
+//  Input:          -
+//  Output:         -
+//  Description:    Hands every Reply which has completely arrived to the Bus
+//#################################################################################################
+    _now += cpuCost;
+    _arbitrate(_now);
+    size_t delivered = 0;
+    while (delivered < _onWire.size() && _onWire[delivered].deliverAt <= _now) {
+        if (_bus != NULL) {
+            _bus->dispatch(_onWire[delivered].frame);
+        }
+        ++delivered;
+    }
+    _onWire.erase(_onWire.begin(), _onWire.begin() + delivered);
+}
+
+unsigned long BIC2200SimBus::micros() {
+    _now += cpuCost;
+    return (unsigned long)(_now / 1000);
+}
+
+unsigned long BIC2200SimBus::millis() {
+    _now += cpuCost;
+    return (unsigned long)(_now / 1000000);
+}
+
+void BIC2200SimBus::advance(unsigned long us) {
+//#################################################################################################
+//  Function:       advance
+//  Access:         Public
+//  Input:          us (unsigned long) Time to pass
+//  Output:         -
+//  Description:    Lets virtual Time pass, e.g. for the Idle Time of a Control Loop
+//#################################################################################################
+    _now += (uint64_t)us * 1000;
+    _arbitrate(_now);
+}
+
+unsigned int BIC2200SimBus::frameBits(byte len) {
+//#################################################################################################
+//  Function:       frameBits
+//  Access:         Public (static)
+//  Input:          len (byte) [0 - 8] Data Bytes
+//  Output:         (unsigned int) Bits of an Extended Data Frame incl. Interframe Space
+//  Description:    64 + 8 * len Frame Bits + 3 Bit IFS. Stuff Bits depend on the Data and are
+//                  not counted (worst Case adds (53 + 8 * len) / 4)
+//#################################################################################################
+    return 67 + 8 * len;
+}
+
+void BIC2200SimBus::resetCounters() {
+    _busyNs = 0;
+    _frames = 0;
+    for (byte i = 0; i < BIC2200_MAX_DEVICES; i++) {
+        _devices[i].requests = 0;
+        _devices[i].replies = 0;
+        _devices[i].drops = 0;
+        _devices[i].writes = 0;
+    }
+}
+
+uint64_t BIC2200SimBus::_transmit(uint64_t readyAt, byte len) {
+//#################################################################################################
+//  Function:       _transmit
+//  Access:         Private
+//  Input:          readyAt (uint64_t) ns when the Frame is ready to send
+//                  len (byte) Data Bytes
+//  Output:         (uint64_t) ns when the Frame has been transmitted
+//  Description:    Occupies the Wire after the previous Frame for the Bit Time of this Frame
+//#################################################################################################
+    uint64_t start = std::max(readyAt, _busFreeAt);
+    uint64_t duration = (uint64_t)frameBits(len) * 1000000000ULL / _bitrate;
+    _busFreeAt = start + duration;
+    _busyNs += duration;
+    ++_frames;
+    return _busFreeAt;
+}
+
+void BIC2200SimBus::_arbitrate(uint64_t until) {
+//#################################################################################################
+//  Function:       _arbitrate
+//  Access:         Private
+//  Input:          until (uint64_t) ns
+//  Output:         -
+//  Description:    Puts every Reply which got ready before until on the Wire in Order
+//#################################################################################################
+    std::stable_sort(_waiting.begin(), _waiting.end(),
+        [](const Pending & a, const Pending & b) { return a.readyAt < b.readyAt; });
+    size_t placed = 0;
+    while (placed < _waiting.size() && _waiting[placed].readyAt <= until) {
+        Pending reply = _waiting[placed];
+        reply.deliverAt = _transmit(reply.readyAt, reply.frame.len);
+        _onWire.push_back(reply);
+        ++placed;
+    }
+    _waiting.erase(_waiting.begin(), _waiting.begin() + placed);
+}
+
+void BIC2200SimBus::_handleRequest(byte address, const BIC2200Frame & frame, uint64_t receivedAt) {
+//#################################################################################################
+//  Function:       _handleRequest
+//  Access:         Private
+//  Input:          address (byte) Device Adress
+//                  frame (const BIC2200Frame &) Request or Write
+//                  receivedAt (uint64_t) ns when the Frame was on the Wire
+//  Output:         -
+//  Description:    2 Byte Frames are Read Requests and get the Register echoed in the Reply,
+//                  longer Frames write the Register. Broadcasts arrive here once per Device
+//#################################################################################################
+    BIC2200SimDevice & device = _devices[address];
+    if (!device.present || frame.len < 2) {
+        return;
+    }
+    int reg = frame.data[0] | (frame.data[1] << 8);
+
+    if (frame.len > 2) {
+        device.setRegister(reg, frame.data + 2, frame.len - 2);
+        device.lastWriteAt = receivedAt;
+        ++device.writes;
+        return;
+    }
+
+    ++device.requests;
+    if (device.dropPerMille > 0 && (_nextRandom() % 1000) < device.dropPerMille) {
+        ++device.drops;
+        return;
+    }
+    Pending reply;
+    byte len;
+    if (!device.getRegister(reg, reply.frame.data + 2, len)) {
+        return;
+    }
+    unsigned long latency = device.replyLatency;
+    if (device.replyJitter > 0) {
+        latency += _nextRandom() % (device.replyJitter + 1);
+    }
+    reply.frame.id = MSG_ID_CAN_RECEIVE_00 + address;
+    reply.frame.len = len + 2;
+    reply.frame.data[0] = frame.data[0];
+    reply.frame.data[1] = frame.data[1];
+    reply.readyAt = receivedAt + (uint64_t)latency * 1000;
+    reply.deliverAt = 0;
+    _waiting.push_back(reply);
+    ++device.replies;
+}
+
+uint32_t BIC2200SimBus::_nextRandom() {
+    // xorshift32
+    _random ^= _random << 13;
+    _random ^= _random >> 17;
+    _random ^= _random << 5;
+    return _random;
+}
@@ -0,0 +1,125 @@
+//#################################################################################################
+// Host Simulator for the BIC-2200-XX-CAN Library
+// Models a CAN Bus with BIC-2200 Devices on a virtual Clock, so the unchanged Library API can
+// be tested and benchmarked on a Linux Machine.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_SIM_H
+#define BIC2200_SIM_H
+
+#include <stdint.h>
+#include <vector>
+#include "bic2200.h"
+
+#define BIC2200_SIM_BITRATE     250000UL
+
+//#################################################################################################
+//  Class:          BIC2200SimDevice
+//  Description:    Register File of one simulated BIC-2200. Answers Read Requests after a
+//                  configurable Latency, stores Writes, can drop Replies and be unplugged.
+//#################################################################################################
+class BIC2200SimDevice {
+
+public:
+    bool present = false;
+    unsigned long replyLatency = 100;   // us from End of Request to Reply ready
+    unsigned long replyJitter = 0;      // us, uniformly added on top of replyLatency
+    unsigned int dropPerMille = 0;      // Requests without Reply per 1000
+
+    unsigned long requests = 0;
+    unsigned long replies = 0;
+    unsigned long drops = 0;
+    unsigned long writes = 0;
+    uint64_t lastWriteAt = 0;           // ns when the last Write was on the Wire
+
+    void setModel(int voltage);
+    void setScalingFactor(byte vout, byte iout, byte vin, byte temperature);
+
+    void setRegister(int reg, const byte * data, byte len);
+    bool getRegister(int reg, byte * data, byte & len) const;
+    void setWord(int reg, uint16_t value);
+    uint16_t getWord(int reg) const;
+    void setText(int regB0B5, int regB6B11, const char * text);
+
+private:
+    struct Register {
+        int reg;
+        byte len;
+        byte data[6];
+    };
+    std::vector<Register> _registers;
+
+    Register * _find(int reg);
+    const Register * _find(int reg) const;
+
+};
+
+// Virtual Time shared by several simulated Buses, i.e. one MCU driving several Controllers
+struct BIC2200SimClock {
+    uint64_t now = 0;           // ns
+};
+
+//#################################################################################################
+//  Class:          BIC2200SimBus
+//  Description:    Simulated CAN Bus and Clock behind the BIC2200Transport Interface. Frames
+//                  occupy the Wire for their Extended Frame Bit Length, every Call of the
+//                  Library into the Transport costs cpuCost ns of virtual Time. Buses built on
+//                  the same BIC2200SimClock share the CPU Time of one MCU.
+//#################################################################################################
+class BIC2200SimBus final : public BIC2200Transport {
+
+public:
+    unsigned long cpuCost = 2000;       // ns of virtual Time per Transport Call
+    byte txBuffers = 0;                 // 0 = send() waits until the Frame is on the Wire
+                                        // (MCP2515 with the CAN Library); N = waits for 1 of N
+
+    explicit BIC2200SimBus(unsigned long bitrate = BIC2200_SIM_BITRATE);
+    explicit BIC2200SimBus(BIC2200SimClock & clock, unsigned long bitrate = BIC2200_SIM_BITRATE);
+
+    BIC2200SimDevice & device(byte address);
+    void setSeed(uint32_t seed);
+
+    int begin(BIC2200Bus & bus);
+    bool send(const BIC2200Frame & frame);
+    void service();
+
+    unsigned long micros();
+    unsigned long millis();
+    void advance(unsigned long us);
+    uint64_t nanos() const { return _now; }
+
+    static unsigned int frameBits(byte len);
+    uint64_t busyNanos() const { return _busyNs; }
+    unsigned long framesOnWire() const { return _frames; }
+    void resetCounters();
+
+private:
+    struct Pending {
+        uint64_t readyAt;
+        uint64_t deliverAt;
+        BIC2200Frame frame;
+    };
+
+    unsigned long _bitrate;
+    BIC2200SimClock _ownClock;
+    uint64_t & _now;
+    uint64_t _busFreeAt = 0;
+    uint64_t _busyNs = 0;
+    unsigned long _frames = 0;
+    uint32_t _random = 0x2545F491;
+    BIC2200Bus * _bus = NULL;
+    BIC2200SimDevice _devices[BIC2200_MAX_DEVICES];
+    std::vector<Pending> _waiting;      // Replies ready, not yet on the Wire
+    std::vector<Pending> _onWire;       // Replies on the Wire, delivered at deliverAt
+    std::vector<uint64_t> _txBusy;      // ns when the Frames in the TX Buffers are sent
+
+    uint64_t _transmit(uint64_t readyAt, byte len);
+    void _arbitrate(uint64_t until);
+    void _handleRequest(byte address, const BIC2200Frame & frame, uint64_t receivedAt);
+    uint32_t _nextRandom();
+
+};
+
+#endif
@@ -0,0 +1,237 @@
+//#################################################################################################
+// Host Reader of BIC-2200-XX-CAN Frame Traces
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bic2200_tracereader.h"
+
+bool BIC2200TraceReader::load(const char * path, std::vector<BIC2200TraceRecord> & records) {
+//#################################################################################################
+//  Function:       load
+//  Access:         Public
+//  Input:          path (const char *) Trace File, NULL = stdin
+//                  records (std::vector<BIC2200TraceRecord> &) decoded Frames are appended
+//  Output:         (bool) false = File not readable or Trace broken
+//  Description:    Reads a whole File and decodes it
+//#################################################################################################
+    FILE * in = path ? fopen(path, "rb") : stdin;
+    if (in == NULL) {
+        return false;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        data.insert(data.end(), buffer, buffer + n);
+    }
+    if (path) {
+        fclose(in);
+    }
+    return decode(data.data(), data.size(), records);
+}
+
+bool BIC2200TraceReader::decode(const uint8_t * data, size_t len, std::vector<BIC2200TraceRecord> & records) {
+//#################################################################################################
+//  Function:       decode
+//  Access:         Public
+//  Input:          data (const uint8_t *) whole Trace, binary or Text
+//                  len (size_t) Bytes in data
+//                  records (std::vector<BIC2200TraceRecord> &) decoded Frames are appended
+//  Output:         (bool) false = binary Stream broken, decoded up to the Error
+//  Description:    Detects the Format and decodes all Frames
+//#################################################################################################
+    if (isBinary(data, len)) {
+        return _decodeBinary(data, len, records);
+    }
+    return _decodeText(data, len, records);
+}
+
+bool BIC2200TraceReader::isBinary(const uint8_t * data, size_t len) {
+//#################################################################################################
+//  Function:       isBinary
+//  Access:         Public (static)
+//  Input:          data, len: Start of a Trace
+//  Output:         (bool) true = Stream Header of the binary Format
+//  Description:    Checks Magic and Version
+//#################################################################################################
+    return len >= BIC2200_TRACE_HEADER && data[0] == 'B' && data[1] == '2' && data[2] == 'T' &&
+        data[3] == BIC2200_TRACE_VERSION;
+}
+
+bool BIC2200TraceReader::isTransmit(unsigned long id) {
+//#################################################################################################
+//  Function:       isTransmit
+//  Access:         Public (static)
+//  Input:          id (unsigned long) Extended CAN ID
+//  Output:         (bool) true = Request to a Device or Broadcast
+//  Description:    Direction of a candump Frame
+//#################################################################################################
+    return (id - MSG_ID_CAN_SEND_00 < BIC2200_MAX_DEVICES) || id == MSG_ID_BROADCAST;
+}
+
+bool BIC2200TraceReader::_decodeBinary(const uint8_t * data, size_t len, std::vector<BIC2200TraceRecord> & records) {
+//#################################################################################################
+//  Function:       _decodeBinary
+//  Access:         Private
+//  Input:          data, len: binary Stream incl. Header
+//                  records (std::vector<BIC2200TraceRecord> &) decoded Frames are appended
+//  Output:         (bool) false = Stream ends inside a Record
+//  Description:    Mirrors BIC2200Trace::_encode(), Times are taken relative to the first Frame
+//#################################################################################################
+    size_t pos = BIC2200_TRACE_HEADER;
+    uint64_t time = 0;
+    uint64_t start = 0;
+    bool first = true;
+
+    while (pos < len) {
+        BIC2200TraceRecord record;
+        byte header = data[pos++];
+        unsigned long delta;
+
+        if (!_getVarint(data, len, pos, delta)) {
+            ++_stats.broken;
+            return false;
+        }
+        time += delta;
+        if (first) {
+            start = time;
+            first = false;
+        }
+        record.time = time - start;
+        record.transmit = (header & BIC2200_TRACE_TX) != 0;
+        if (header & BIC2200_TRACE_RAW) {
+            if (len - pos < 5) {
+                ++_stats.broken;
+                return false;
+            }
+            record.frame.id = (unsigned long)data[pos] | ((unsigned long)data[pos + 1] << 8) |
+                ((unsigned long)data[pos + 2] << 16) | ((unsigned long)data[pos + 3] << 24);
+            record.frame.len = data[pos + 4];
+            pos += 5;
+        } else {
+            record.frame.id = (record.transmit ? MSG_ID_CAN_SEND_00 : MSG_ID_CAN_RECEIVE_00) +
+                BIC2200_TRACE_ADDRESS(header);
+            record.frame.len = BIC2200_TRACE_LENGTH(header);
+        }
+        if (record.frame.len > 8 || len - pos < record.frame.len) {
+            ++_stats.broken;
+            return false;
+        }
+        memcpy(record.frame.data, &data[pos], record.frame.len);
+        pos += record.frame.len;
+        records.push_back(record);
+        ++_stats.frames;
+    }
+    return true;
+}
+
+bool BIC2200TraceReader::_decodeText(const uint8_t * data, size_t len, std::vector<BIC2200TraceRecord> & records) {
+//#################################################################################################
+//  Function:       _decodeText
+//  Access:         Private
+//  Input:          data, len: candump -L Text
+//                  records (std::vector<BIC2200TraceRecord> &) decoded Frames are appended
+//  Output:         (bool) true, Lines which are no CAN Frame are counted as skipped
+//  Description:    Times are taken relative to the first Frame
+//#################################################################################################
+    char line[128];
+    size_t pos = 0;
+    bool first = true;
+    uint64_t start = 0;
+
+    while (pos < len) {
+        size_t n = 0;
+        while (pos < len && data[pos] != '\n') {
+            if (n < sizeof(line) - 1) {
+                line[n++] = data[pos];
+            }
+            ++pos;
+        }
+        ++pos;
+        line[n] = '\0';
+        if (n == 0) {
+            continue;
+        }
+
+        BIC2200TraceRecord record;
+        uint64_t time;
+        if (!_parseLine(line, time, record.frame)) {
+            ++_stats.skipped;
+            continue;
+        }
+        if (first) {
+            start = time;
+            first = false;
+        }
+        record.time = time - start;
+        record.transmit = isTransmit(record.frame.id);
+        records.push_back(record);
+        ++_stats.frames;
+    }
+    return true;
+}
+
+bool BIC2200TraceReader::_parseLine(const char * line, uint64_t & time, BIC2200Frame & frame) {
+//#################################################################################################
+//  Function:       _parseLine
+//  Access:         Private
+//  Input:          line (const char *) "(seconds.micros) interface ID#DATA"
+//                  time (uint64_t &) Timestamp in us
+//                  frame (BIC2200Frame &) decoded Frame
+//  Output:         (bool) false = no Data Frame
+//  Description:    Parses one candump -L Line. Remote Frames (ID#R) and CAN FD (ID##) are no
+//                  Data Frames of a BIC-2200
+//#################################################################################################
+    unsigned long seconds;
+    unsigned long micros;
+    char id[16];
+    char payload[40];
+
+    if (sscanf(line, " (%lu.%lu) %*s %15[0-9A-Fa-f]#%39s", &seconds, &micros, id, payload) == 4) {
+        // full Format
+    } else if (sscanf(line, " (%lu.%lu) %*s %15[0-9A-Fa-f]#", &seconds, &micros, id) == 3) {
+        payload[0] = '\0';
+    } else {
+        return false;
+    }
+    size_t digits = strlen(payload);
+    if (digits > 16 || digits % 2 != 0 || strspn(payload, "0123456789ABCDEFabcdef") != digits) {
+        return false;
+    }
+    time = (uint64_t)seconds * 1000000ULL + micros;
+    frame.id = strtoul(id, NULL, 16);
+    frame.len = digits / 2;
+    for (byte i = 0; i < frame.len; i++) {
+        char hex[3] = { payload[2 * i], payload[2 * i + 1], '\0' };
+        frame.data[i] = (byte)strtoul(hex, NULL, 16);
+    }
+    return true;
+}
+
+bool BIC2200TraceReader::_getVarint(const uint8_t * data, size_t len, size_t & pos, unsigned long & value) {
+//#################################################################################################
+//  Function:       _getVarint
+//  Access:         Private (static)
+//  Input:          data, len: binary Stream
+//                  pos (size_t &) Read Position, advanced behind the Varint
+//                  value (unsigned long &) decoded Number
+//  Output:         (bool) false = Varint runs past the Stream or is longer than 5 Bytes
+//  Description:    Inverse of BIC2200Trace::_putVarint()
+//#################################################################################################
+    value = 0;
+    for (byte shift = 0; shift < 35; shift += 7) {
+        if (pos >= len) {
+            return false;
+        }
+        byte b = data[pos++];
+        value |= (unsigned long)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
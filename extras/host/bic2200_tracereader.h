@@ -0,0 +1,54 @@
+//#################################################################################################
+// Host Reader of BIC-2200-XX-CAN Frame Traces
+// Reads the binary Stream written by BIC2200Trace::flush() (see bic2200_trace.h for the Format)
+// and candump -L Text, written by BIC2200Trace or by candump -l on a SocketCAN Interface.
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#ifndef BIC2200_TRACEREADER_H
+#define BIC2200_TRACEREADER_H
+
+#include <stdint.h>
+#include <vector>
+#include "bic2200_trace.h"
+
+struct BIC2200TraceRecord {
+    uint64_t time;              // us since the first Frame of the Trace
+    bool transmit;              // sent by the Library (Request or Broadcast)
+    BIC2200Frame frame;
+};
+
+struct BIC2200TraceReaderStats {
+    unsigned long frames;       // Records decoded
+    unsigned long skipped;      // Text Lines which are no CAN Frame (Comments, Remote Frames, CAN FD)
+    unsigned long broken;       // binary Stream ended inside a Record
+};
+
+//#################################################################################################
+//  Class:          BIC2200TraceReader
+//  Description:    Decodes a Trace into Records with Times relative to its first Frame. The Format is
+//                  detected by the Stream Header. candump Text has no Direction, Frames to
+//                  MSG_ID_CAN_SEND_00 + Address and MSG_ID_BROADCAST count as sent
+//#################################################################################################
+class BIC2200TraceReader {
+
+public:
+    bool load(const char * path, std::vector<BIC2200TraceRecord> & records);
+    bool decode(const uint8_t * data, size_t len, std::vector<BIC2200TraceRecord> & records);
+    BIC2200TraceReaderStats getStats() const { return _stats; }
+
+    static bool isBinary(const uint8_t * data, size_t len);
+    static bool isTransmit(unsigned long id);
+
+private:
+    BIC2200TraceReaderStats _stats = {};
+
+    bool _decodeBinary(const uint8_t * data, size_t len, std::vector<BIC2200TraceRecord> & records);
+    bool _decodeText(const uint8_t * data, size_t len, std::vector<BIC2200TraceRecord> & records);
+    bool _parseLine(const char * line, uint64_t & time, BIC2200Frame & frame);
+    static bool _getVarint(const uint8_t * data, size_t len, size_t & pos, unsigned long & value);
+
+};
+
+#endif
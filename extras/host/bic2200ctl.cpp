@@ -0,0 +1,351 @@
+//#################################################################################################
+// bic2200ctl - Commissioning and Diagnostics of BIC-2200-XX-CAN Racks from Linux
+// Runs the Library over SocketCAN (or the in-process Simulator) and applies a declarative
+// Configuration (see bic2200_config.h) to many Addresses at once, writing only what changed.
+//   bic2200ctl [-i can0 | -s units] [-a addresses] scan
+//   bic2200ctl [-i can0 | -s units] [-a addresses] show > rack.conf
+//   bic2200ctl [-i can0 | -s units] [-a addresses] diff rack.conf
+//   bic2200ctl [-i can0 | -s units] [-a addresses] [-n] apply rack.conf
+//   bic2200ctl [-i can0 | -s units] [-a addresses] [-r hz] [-c rounds] watch > telemetry.csv
+// Exit Code: 0 = ok, 1 = Error, 2 = diff found Differences / apply not verified or refused
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "bic2200_config.h"
+#include "bic2200_sim.h"
+#include "bic2200_socketcan.h"
+
+static const int telemetry[6] = { CMD_READ_VIN, CMD_READ_VOUT, CMD_READ_IOUT, CMD_READ_TEMPERATURE_1,
+    CMD_SYSTEM_STATUS, CMD_FAULT_STATUS };
+
+static BIC2200SimBus * sim = NULL;
+static BIC2200Bus bus;
+static BIC2200 devices[BIC2200_MAX_DEVICES];
+static volatile sig_atomic_t stopped = 0;
+
+static void usage() {
+    fprintf(stderr,
+        "usage: bic2200ctl [-i interface | -s units] [-a addresses] [-n] [-r hz] [-c rounds] command [file]\n"
+        "  -i interface  SocketCAN Interface, default can0\n"
+        "  -s units      in-process Simulator with Units (48 V) at Address 0 .. units-1\n"
+        "  -a addresses  e.g. 0-3,6; default all (scan, show, watch) or the configured ones\n"
+        "  -n            apply: only print what would be written\n"
+        "  -r hz         watch: Rounds per Second, 0 = as fast as the Bus allows; default 10\n"
+        "  -c rounds     watch: stop after Rounds, default 0 = until Ctrl-C\n"
+        "commands: scan | show | diff file | apply file | watch\n");
+}
+
+static void onSignal(int) {
+    stopped = 1;
+}
+
+// Fixed Point mV / mA / 0.001 deg C as Decimal
+static void printMilli(long value) {
+    const char * sign = (value < 0) ? "-" : "";
+    unsigned long magnitude = (value < 0) ? -(unsigned long)value : value;
+    printf("%s%lu.%03lu", sign, magnitude / 1000, magnitude % 1000);
+}
+
+static void sleepUntil(unsigned long due) {
+    long left = (long)(due - bus.micros());
+    if (left <= 0) {
+        return;
+    }
+    if (sim) {
+        sim->advance(left);
+    } else {
+        struct timespec wait = { left / 1000000L, (left % 1000000L) * 1000L };
+        nanosleep(&wait, NULL);
+    }
+}
+
+// All selected Addresses at once, a missing Unit costs one Timeout instead of several
+static byte probe(byte selected) {
+    byte present = 0;
+    uint16_t status;
+
+    for (byte a = 0; a < BIC2200_MAX_DEVICES; a++) {
+        if (selected & (1 << a)) {
+#if BIC2200_ENABLE_ADAPTIVE_TIMEOUT
+            devices[a].setRetries(0);
+#endif
+            devices[a].requestRead(CMD_SYSTEM_STATUS);
+        }
+    }
+    while (bus.isBusy()) {
+        bus.poll();
+    }
+    for (byte a = 0; a < BIC2200_MAX_DEVICES; a++) {
+        if (!(selected & (1 << a))) {
+            continue;
+        }
+        if (devices[a].getResult(CMD_SYSTEM_STATUS, (byte *)&status, 2) == 1 && devices[a].loadScalingFactors()) {
+            present |= (1 << a);
+#if BIC2200_ENABLE_IDENTITY
+            devices[a].identify();
+#endif
+        }
+#if BIC2200_ENABLE_ADAPTIVE_TIMEOUT
+        devices[a].setRetries(BIC2200_RETRIES);
+#endif
+    }
+    return present;
+}
+
+static int scan(byte present) {
+    for (byte a = 0; a < BIC2200_MAX_DEVICES; a++) {
+        if (!(present & (1 << a))) {
+            continue;
+        }
+#if BIC2200_ENABLE_IDENTITY
+        const BIC2200Identity & id = devices[a].getIdentity();
+        printf("%u  %-12s  %-12s  %-12s  %s\n", a, id.manufacturer, id.model, id.serial, id.date);
+#else
+        printf("%u\n", a);
+#endif
+    }
+    return 0;
+}
+
+static int show(byte present) {
+    BIC2200Config current;
+    int result = 0;
+
+    for (byte a = 0; a < BIC2200_MAX_DEVICES; a++) {
+        if ((present & (1 << a)) && !current.read(devices[a], a)) {
+            fprintf(stderr, "%u: not all Registers answered\n", a);
+            result = 1;
+        }
+    }
+    current.print(stdout, present);
+    return result;
+}
+
+static void printChange(const BIC2200Config & config, const BIC2200ConfigChange & change, const char * note) {
+    char current[24] = "?";
+    char wanted[24];
+    long value;
+
+    if (change.known) {
+        BIC2200Config::formatValue(change.key, BIC2200Config::toValue(devices[change.address], change.key,
+            change.current), current, sizeof(current));
+    }
+    config.get(change.address, change.key, value);
+    BIC2200Config::formatValue(change.key, value, wanted, sizeof(wanted));
+    printf("%u %-20s %12s -> %s%s\n", change.address, BIC2200Config::keys[change.key].name, current, wanted, note);
+}
+
+// diff: 2 = Differences; apply: 2 = a Unit missing, refused or not verified
+static int diffOrApply(BIC2200Config & config, byte selected, byte present, bool write) {
+    unsigned int differing = 0;
+    unsigned int written = 0;
+    unsigned int verified = 0;
+    unsigned int failed = 0;
+
+    for (byte a = 0; a < BIC2200_MAX_DEVICES; a++) {
+        if (!(selected & (1 << a))) {
+            continue;
+        }
+        if (!(present & (1 << a))) {
+            fprintf(stderr, "%u: no Reply\n", a);
+            ++failed;
+            continue;
+        }
+        std::vector<BIC2200ConfigChange> changes;
+        bool allowed = true;
+        config.diff(devices[a], a, changes);
+        for (size_t i = 0; i < changes.size(); i++) {
+            allowed = allowed && changes[i].allowed;
+            printChange(config, changes[i], !changes[i].allowed ? "  outside the Model Limits" :
+                !changes[i].known ? "  no Reply" : "");
+        }
+        differing += changes.size();
+        if (!write || changes.empty()) {
+            continue;
+        }
+        if (!allowed) {
+            fprintf(stderr, "%u: refused, nothing written\n", a);
+            ++failed;
+            continue;
+        }
+        int ok = config.apply(devices[a], changes);
+        written += changes.size();
+        verified += ok;
+        if (ok != (int)changes.size()) {
+            fprintf(stderr, "%u: %zu of %zu Settings read back different\n", a, changes.size() - ok, changes.size());
+            ++failed;
+        }
+    }
+    if (write) {
+        fprintf(stderr, "%u Settings written, %u verified, %u Units failed\n", written, verified, failed);
+        return failed ? 2 : 0;
+    }
+    return (differing || failed) ? 2 : 0;
+}
+
+static int watch(byte present, unsigned long hz, unsigned long rounds) {
+    unsigned long period = hz ? 1000000UL / hz : 0;
+    unsigned long start = bus.micros();
+    unsigned long due = start;
+    unsigned long done = 0;
+    unsigned int words[BIC2200_MAX_DEVICES][6];
+    byte valid[BIC2200_MAX_DEVICES];
+
+    printf("time_ms,address,vin_v,vout_v,iout_a,temperature_c,system_status,fault_status\n");
+    while (!stopped && (rounds == 0 || done < rounds)) {
+        // one Burst over all Units, the Replies of one Unit overlap the Requests of the next
+        unsigned long at = bus.micros();
+        for (byte i = 0; i < 6; i++) {
+            for (byte a = 0; a < BIC2200_MAX_DEVICES; a++) {
+                if (present & (1 << a)) {
+                    devices[a].requestRead(telemetry[i]);
+                }
+            }
+        }
+        while (bus.isBusy()) {
+            bus.poll();
+        }
+        for (byte a = 0; a < BIC2200_MAX_DEVICES; a++) {
+            if (!(present & (1 << a))) {
+                continue;
+            }
+            valid[a] = 0;
+            for (byte i = 0; i < 6; i++) {
+                uint16_t word = 0;
+                if (devices[a].getResult(telemetry[i], (byte *)&word, 2) == 1) {
+                    words[a][i] = word;
+                    valid[a] |= (1 << i);
+                }
+            }
+            printf("%lu,%u,", (at - start) / 1000, a);
+            for (byte i = 0; i < 4; i++) {
+                if (valid[a] & (1 << i)) {
+                    long raw = (i == 2 || i == 3) ? (int16_t)words[a][i] : (long)words[a][i];
+                    long value = devices[a].getScale(telemetry[i]).apply(raw);
+                    printMilli(i == 3 ? value * 100 : value);
+                }
+                printf(",");
+            }
+            for (byte i = 4; i < 6; i++) {
+                if (valid[a] & (1 << i)) {
+                    printf("0x%04X", words[a][i]);
+                }
+                printf(i == 4 ? "," : "\n");
+            }
+        }
+        ++done;
+        if (period) {
+            due += period;
+            sleepUntil(due);
+        }
+    }
+    double seconds = (bus.micros() - start) / 1e6;
+    fprintf(stderr, "%lu Rounds in %.2f s, %.1f Rounds/s\n", done, seconds, seconds > 0 ? done / seconds : 0.0);
+    return 0;
+}
+
+int main(int argc, char ** argv) {
+    const char * interface = "can0";
+    unsigned long units = 0;
+    byte selected = 0;
+    bool dryRun = false;
+    unsigned long hz = 10;
+    unsigned long rounds = 0;
+    int option;
+
+    while ((option = getopt(argc, argv, "i:s:a:nr:c:h")) != -1) {
+        switch (option) {
+            case 'i':
+                interface = optarg;
+                break;
+            case 's':
+                units = strtoul(optarg, NULL, 0);
+                if (units < 1 || units > BIC2200_MAX_DEVICES) {
+                    fprintf(stderr, "-s: 1 to %u Units\n", BIC2200_MAX_DEVICES);
+                    return 1;
+                }
+                break;
+            case 'a':
+                if (!BIC2200Config::parseAddresses(optarg, selected)) {
+                    fprintf(stderr, "-a: invalid Addresses '%s'\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'n':
+                dryRun = true;
+                break;
+            case 'r':
+                hz = strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                rounds = strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage();
+                return option == 'h' ? 0 : 1;
+        }
+    }
+    if (optind >= argc) {
+        usage();
+        return 1;
+    }
+    const char * command = argv[optind];
+    bool withFile = strcmp(command, "diff") == 0 || strcmp(command, "apply") == 0;
+    if (withFile != (optind + 1 < argc) || optind + 2 < argc ||
+        (!withFile && strcmp(command, "scan") && strcmp(command, "show") && strcmp(command, "watch"))) {
+        usage();
+        return 1;
+    }
+
+    BIC2200Config config;
+    if (withFile) {
+        if (!config.load(argv[optind + 1])) {
+            fprintf(stderr, "%s: %s\n", argv[optind + 1], config.getError());
+            return 1;
+        }
+        if (!selected) {
+            selected = config.getAddresses();
+        }
+    }
+    if (!selected) {
+        selected = 0xFF;
+    }
+
+    BIC2200SocketCANTransport socketcan(interface);
+    BIC2200SimBus simulator;
+    if (units) {
+        for (byte a = 0; a < units; a++) {
+            simulator.device(a).setModel(48);
+        }
+        sim = &simulator;
+        bus.begin(simulator);
+    } else if (!bus.begin(socketcan)) {
+        fprintf(stderr, "%s: %s\n", interface, strerror(socketcan.getError()));
+        return 1;
+    }
+    for (byte a = 0; a < BIC2200_MAX_DEVICES; a++) {
+        devices[a].begin(bus, a);
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    byte present = probe(selected);
+    if (strcmp(command, "scan") == 0) {
+        return scan(present);
+    }
+    if (strcmp(command, "show") == 0) {
+        return show(present);
+    }
+    if (strcmp(command, "watch") == 0) {
+        return watch(present, hz, rounds);
+    }
+    return diffOrApply(config, selected, present, strcmp(command, "apply") == 0 && !dryRun);
+}
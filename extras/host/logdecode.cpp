@@ -0,0 +1,123 @@
+//#################################################################################################
+// Decoder of the binary BIC-2200-XX-CAN Telemetry Log (BIC2200Log) to CSV
+// Usage: logdecode [-f vout,iout,vin,temperature] [log.bin] > log.csv
+//   -f   BIC2200_FACTOR_* Codes of the Devices (CMD_SCALING_FACTOR), Default 5,5,6,6 as in
+//        the Datasheet. Without File the Log is read from stdin, e.g. a captured Serial Port
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "bic2200_logreader.h"
+
+struct Column {
+    int reg;
+    const char * name;
+    byte scale;                 // BIC2200_SCALE_*
+    bool isSigned;
+};
+
+static const Column columns[] = {
+    { CMD_OPERATION,            "OPERATION",            BIC2200_SCALE_NONE,        false },
+    { CMD_VOUT_SET,             "VOUT_SET",             BIC2200_SCALE_VOUT,        false },
+    { CMD_IOUT_SET,             "IOUT_SET",             BIC2200_SCALE_IOUT,        false },
+    { CMD_FAULT_STATUS,         "FAULT_STATUS",         BIC2200_SCALE_NONE,        false },
+    { CMD_READ_VIN,             "READ_VIN",             BIC2200_SCALE_VIN,         false },
+    { CMD_READ_VOUT,            "READ_VOUT",            BIC2200_SCALE_VOUT,        false },
+    { CMD_READ_IOUT,            "READ_IOUT",            BIC2200_SCALE_IOUT,        true },
+    { CMD_READ_TEMPERATURE_1,   "READ_TEMPERATURE_1",   BIC2200_SCALE_TEMPERATURE, true },
+    { CMD_SCALING_FACTOR,       "SCALING_FACTOR",       BIC2200_SCALE_NONE,        false },
+    { CMD_SYSTEM_STATUS,        "SYSTEM_STATUS",        BIC2200_SCALE_NONE,        false },
+    { CMD_SYSTEM_CONFIG,        "SYSTEM_CONFIG",        BIC2200_SCALE_NONE,        false },
+    { CMD_DIRECTION_CTRL,       "DIRECTION_CTRL",       BIC2200_SCALE_NONE,        false },
+    { CMD_REVERSE_VOUT_SET,     "REVERSE_VOUT_SET",     BIC2200_SCALE_VOUT,        false },
+    { CMD_REVERSE_IOUT_SET,     "REVERSE_IOUT_SET",     BIC2200_SCALE_IOUT,        false },
+    { CMD_BIDIRECTIONAL_CONFIG, "BIDIRECTIONAL_CONFIG", BIC2200_SCALE_NONE,        false }
+};
+
+static const Column * findColumn(int reg) {
+    for (size_t i = 0; i < sizeof(columns) / sizeof(columns[0]); i++) {
+        if (columns[i].reg == reg) {
+            return &columns[i];
+        }
+    }
+    return NULL;
+}
+
+static void printValue(const Column & column, uint16_t raw, const byte * factors) {
+    long value = column.isSigned ? (long)(int16_t)raw : (long)raw;
+    long scaled;
+
+    switch (column.scale) {
+        case BIC2200_SCALE_VOUT:
+        case BIC2200_SCALE_IOUT:
+        case BIC2200_SCALE_VIN:
+            // mV / mA -> V / A with 3 Decimals
+            scaled = BIC2200Scale::fromFactor(factors[column.scale - 1], BIC2200_FACTOR_0_001).apply(value);
+            printf("%s%ld.%03ld,%s\n", scaled < 0 ? "-" : "", labs(scaled) / 1000, labs(scaled) % 1000,
+                column.scale == BIC2200_SCALE_IOUT ? "A" : "V");
+            break;
+        case BIC2200_SCALE_TEMPERATURE:
+            scaled = BIC2200Scale::fromFactor(factors[3], BIC2200_FACTOR_0_1).apply(value);
+            printf("%s%ld.%ld,C\n", scaled < 0 ? "-" : "", labs(scaled) / 10, labs(scaled) % 10);
+            break;
+        default:
+            printf("%ld,\n", value);
+            break;
+    }
+}
+
+int main(int argc, char ** argv) {
+    byte factors[4] = { BIC2200_FACTOR_0_01, BIC2200_FACTOR_0_01, BIC2200_FACTOR_0_1, BIC2200_FACTOR_0_1 };
+    const char * path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            unsigned int f[4];
+            if (sscanf(argv[++i], "%x,%x,%x,%x", &f[0], &f[1], &f[2], &f[3]) != 4) {
+                fprintf(stderr, "logdecode: -f needs 4 Factor Codes, e.g. 5,5,6,6\n");
+                return 2;
+            }
+            for (byte n = 0; n < 4; n++) {
+                factors[n] = f[n];
+            }
+        } else {
+            path = argv[i];
+        }
+    }
+
+    FILE * in = path ? fopen(path, "rb") : stdin;
+    if (in == NULL) {
+        perror(path);
+        return 1;
+    }
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        data.insert(data.end(), buffer, buffer + n);
+    }
+    if (path) {
+        fclose(in);
+    }
+
+    BIC2200LogReader reader;
+    std::vector<BIC2200LogSample> samples;
+    size_t used = reader.decode(data.data(), data.size(), samples);
+
+    printf("time_ms,address,register,raw,value,unit\n");
+    for (size_t i = 0; i < samples.size(); i++) {
+        const BIC2200LogSample & sample = samples[i];
+        const Column * column = findColumn(sample.reg);
+        printf("%lu,%u,%s,%u,", sample.time, sample.address, column->name, sample.value);
+        printValue(*column, sample.value, factors);
+    }
+
+    BIC2200LogReaderStats stats = reader.getStats();
+    fprintf(stderr, "logdecode: %lu Blocks, %zu Samples, %lu Bytes skipped, %lu broken Blocks, %zu Bytes incomplete\n",
+        stats.blocks, samples.size(), stats.skipped, stats.broken, data.size() - used);
+    return stats.broken ? 1 : 0;
+}
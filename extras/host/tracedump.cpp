@@ -0,0 +1,50 @@
+//#################################################################################################
+// Converter of BIC-2200-XX-CAN Frame Traces (BIC2200Trace) to candump -L Text
+// Usage: tracedump [-i interface] [trace.bin] > trace.log
+//   -i   Interface Name of the Lines, Default can0 (canplayer maps it with vcan0=can0)
+//   Without File the Trace is read from stdin, e.g. a captured Serial Port. Times start at 0
+// Copyright (c) Dominic Eichinger. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+//#################################################################################################
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "bic2200_tracereader.h"
+
+int main(int argc, char ** argv) {
+    const char * interface = BIC2200_TRACE_INTERFACE;
+    const char * path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            interface = argv[++i];
+        } else {
+            path = argv[i];
+        }
+    }
+
+    BIC2200TraceReader reader;
+    std::vector<BIC2200TraceRecord> records;
+    if (!reader.load(path, records) && records.empty()) {
+        perror(path ? path : "stdin");
+        return 1;
+    }
+
+    unsigned long sent = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        const BIC2200TraceRecord & record = records[i];
+        printf("(%010llu.%06llu) %s %08lX#", (unsigned long long)(record.time / 1000000),
+            (unsigned long long)(record.time % 1000000), interface, record.frame.id);
+        for (byte n = 0; n < record.frame.len; n++) {
+            printf("%02X", record.frame.data[n]);
+        }
+        printf("\n");
+        sent += record.transmit ? 1 : 0;
+    }
+
+    BIC2200TraceReaderStats stats = reader.getStats();
+    fprintf(stderr, "tracedump: %lu Frames (%lu sent, %lu received), %lu Lines skipped, %s\n",
+        stats.frames, sent, stats.frames - sent, stats.skipped, stats.broken ? "Stream broken" : "complete");
+    return stats.broken ? 1 : 0;
+}